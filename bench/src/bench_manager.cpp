@@ -0,0 +1,142 @@
+#include "./bench_manager.h"
+
+#include <containers/vec.h>
+#include <core/clock.h>
+#include <core/logger.h>
+#include <core/string.h>
+#include <core/string/strbuf.h>
+#include <platform/filesystem.h>
+
+#include <cstring>
+
+struct bench_entry {
+  PFN_bench func;
+  cstr desc;
+  u64 iterations;
+  u64 granularity;
+};
+
+// Times of a benchmark, in nanoseconds per iteration
+struct bench_result {
+  cstr desc;
+  u64 sample_iterations;
+  f64 median;
+  f64 p10;
+  f64 p90;
+  f64 min;
+  f64 mean;
+};
+
+static ns::Vec<bench_entry> benches;
+static ns::Vec<bench_result> results;
+
+void bench_manager_register_bench(PFN_bench fn, cstr desc, u64 iterations,
+                                  u64 granularity) {
+  benches.push({fn, desc, iterations, granularity ? granularity : 1});
+}
+
+static f64 bench_time_sample(bench_entry const &b, u64 iterations) {
+  ns::tick_clock_t clock;
+  clock.start();
+  b.func(iterations);
+  clock.update();
+  return clock.elapsed() * 1000000000.0 / static_cast<f64>(iterations);
+}
+
+// Nearest rank percentile of sorted samples
+static f64 bench_percentile(f64 const *sorted, u32 count, u32 percent) {
+  u32 rank = (percent * count + 99) / 100;
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static bench_result bench_run(bench_entry const &b) {
+  u64 iterations = b.iterations / BENCH_SAMPLE_COUNT;
+  iterations = (iterations + b.granularity - 1) / b.granularity;
+  iterations = (iterations > 0 ? iterations : 1) * b.granularity;
+
+  // Caches, branch predictors and clock frequency settle on the warm-up.
+  bench_time_sample(b, iterations);
+
+  f64 samples[BENCH_SAMPLE_COUNT];
+  f64 sum = 0.0;
+  for (u32 i = 0; i < BENCH_SAMPLE_COUNT; i++) {
+    f64 t = bench_time_sample(b, iterations);
+    u32 j = i;
+    for (; j > 0 && samples[j - 1] > t; j--) {
+      samples[j] = samples[j - 1];
+    }
+    samples[j] = t;
+    sum += t;
+  }
+
+  bench_result r;
+  r.desc = b.desc;
+  r.sample_iterations = iterations;
+  r.median = bench_percentile(samples, BENCH_SAMPLE_COUNT, 50);
+  r.p10 = bench_percentile(samples, BENCH_SAMPLE_COUNT, 10);
+  r.p90 = bench_percentile(samples, BENCH_SAMPLE_COUNT, 90);
+  r.min = samples[0];
+  r.mean = sum / BENCH_SAMPLE_COUNT;
+  return r;
+}
+
+static bool bench_write_json(cstr path) {
+  ns::fs::File file;
+  if (!ns::fs::open(path, ns::fs::Mode::WRITE, false, &file)) {
+    NS_ERROR("bench: unable to open '%s' for writing.", path);
+    return false;
+  }
+
+  char line[512];
+  ns::string_fmt(line, sizeof(line),
+                 "{\"samples_per_bench\":%u,\"benches\":[",
+                 BENCH_SAMPLE_COUNT);
+  ns::fs::write_line(&file, line);
+  for (usize i = 0; i < results.len(); i++) {
+    bench_result const &r = results[i];
+    ns::StrBuf buf(line);
+    buf.push("{\"name\":\"");
+    for (cstr c = r.desc; *c; c++) {
+      if (*c == '"' || *c == '\\') {
+        buf.push('\\');
+      }
+      buf.push(*c);
+    }
+    buf.push_fmt("\",\"iterations\":%llu,\"median_ns\":%.4f,\"p10_ns\":%.4f,"
+                 "\"p90_ns\":%.4f,\"min_ns\":%.4f,\"mean_ns\":%.4f}%s",
+                 r.sample_iterations, r.median, r.p10, r.p90, r.min, r.mean,
+                 i + 1 < results.len() ? "," : "");
+    ns::fs::write_line(&file, buf.c_str());
+  }
+  ns::fs::write_line(&file, "]}");
+  ns::fs::close(&file);
+
+  NS_INFO("bench: wrote %llu results to '%s'.", results.len(), path);
+  return true;
+}
+
+bool bench_manager_run_benches(bench_run_options const &options) {
+  ns::tick_clock_t total_time;
+  total_time.start();
+
+  for (usize i = 0; i < benches.len(); i++) {
+    bench_entry const &b = benches[i];
+    if (options.filter && !std::strstr(b.desc, options.filter)) {
+      continue;
+    }
+    bench_result r = bench_run(b);
+    NS_INFO("%-48s %12.3f ns/op (p10 %.3f, p90 %.3f, %u x %llu iterations)",
+            r.desc, r.median, r.p10, r.p90, BENCH_SAMPLE_COUNT,
+            r.sample_iterations);
+    results.push(r);
+  }
+
+  total_time.update();
+  NS_INFO("Ran %llu benchmarks in %.6f sec.", results.len(),
+          total_time.elapsed());
+
+  if (options.json_path) {
+    return bench_write_json(options.json_path);
+  }
+  return true;
+}
@@ -0,0 +1,60 @@
+#ifndef BENCH_MANAGER_HEADER_INCLUDED
+#define BENCH_MANAGER_HEADER_INCLUDED
+
+#include <defines.h>
+
+/**
+ * A benchmark runs its measured operation `iterations` times.
+ */
+typedef void (*PFN_bench)(u64 iterations);
+
+#define LAZY_REGISTER_BENCH(fn, iterations)                                    \
+  bench_manager_register_bench(fn, #fn, iterations)
+
+/**
+ * Number of timed samples of each benchmark, after one warm-up sample. The
+ * iterations are split between the samples.
+ */
+#define BENCH_SAMPLE_COUNT 11
+
+/**
+ * Registers a benchmark
+ * @param fn the benchmark
+ * @param desc the name shown in the report
+ * @param iterations the total number of iterations of the timed samples
+ * @param granularity the benchmark runs its operation by groups of that many
+ *        iterations (e.g. one pass over an array): the iterations of a sample
+ *        are rounded up to a multiple of it
+ */
+void bench_manager_register_bench(PFN_bench fn, cstr desc, u64 iterations,
+                                  u64 granularity = 1);
+
+/**
+ * Options of a run
+ * @field filter only run the benchmarks whose name contains this text (null
+ *        for all)
+ * @field json_path also write the results to this file as JSON (null for
+ *        none)
+ */
+struct bench_run_options {
+  cstr filter;
+  cstr json_path;
+};
+
+/**
+ * Runs the benchmarks. Each one runs a warm-up sample, then
+ * BENCH_SAMPLE_COUNT timed samples, and reports the median, 10th and 90th
+ * percentiles, minimum and mean time per iteration.
+ * @param options the options of the run
+ * @returns false if the JSON report could not be written
+ */
+bool bench_manager_run_benches(bench_run_options const &options = {});
+
+/**
+ * Prevents the compiler from optimizing away a value.
+ */
+template <typename T> inline void bench_do_not_optimize(T const &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif // BENCH_MANAGER_HEADER_INCLUDED
@@ -0,0 +1,64 @@
+#include "./bench_manager.h"
+
+#include "./math/batch_bench.h"
+#include "./math/bounds_bench.h"
+#include "./math/fast_bench.h"
+#include "./math/random_bench.h"
+#include "./math/simd_bench.h"
+#include "./math/transform_bench.h"
+#include "./platform/mapped_file_bench.h"
+#include "./platform/ticks_bench.h"
+#include "./resources/block_compression_bench.h"
+#include "./resources/material_bench.h"
+#include "./resources/mesh_bench.h"
+#include "./resources/mesh_optimizer_bench.h"
+#include "./resources/mipmap_bench.h"
+#include "./resources/pack_bench.h"
+#include "./resources/resource_cache_bench.h"
+#include "./resources/texture_cache_bench.h"
+
+#include <core/logger.h>
+#include <core/memory.h>
+#include <core/string.h>
+
+// Usage: bench [--filter <text>] [--json <path>]
+int main(int argc, char **argv) {
+  bench_run_options options = {};
+  for (i32 i = 1; i < argc; i++) {
+    if (ns::string_eq(argv[i], "--filter") && i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (ns::string_eq(argv[i], "--json") && i + 1 < argc) {
+      options.json_path = argv[++i];
+    } else {
+      NS_ERROR("Usage: %s [--filter <text>] [--json <path>]", argv[0]);
+      return 1;
+    }
+  }
+
+  NS_DEBUG("Starting benchmarks...");
+
+  // Before the first allocation, and never shut down: the benchmark lists
+  // are freed at exit
+  ns::memory_system_configuration memory_config;
+  memory_config.total_alloc_size = 256 * 1024 * 1024;
+  ns::memory_system_initialize(memory_config);
+
+  ticks_register_benches();
+  simd_register_benches();
+  batch_register_benches();
+  random_register_benches();
+  bounds_register_benches();
+  fast_register_benches();
+  transform_register_benches();
+  pack_register_benches();
+  material_register_benches();
+  texture_cache_register_benches();
+  mipmap_register_benches();
+  block_compression_register_benches();
+  mesh_register_benches();
+  mesh_optimizer_register_benches();
+  resource_cache_register_benches();
+  mapped_file_register_benches();
+
+  return bench_manager_run_benches(options) ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+#include "./batch_bench.h"
+#include "../bench_manager.h"
+
+#include <core/logger.h>
+#include <defines.h>
+#include <math/batch.h>
+#include <math/math.h>
+
+#include <thread>
+#include <vector>
+
+// Throughput of the batch kernels: one iteration is one element, so ns/op is
+// the time per point (1e9 / ns/op points per second). The arrays are
+// transformed in place, in passes over the whole array, from 1K elements (in
+// L1) to 10M elements (120MB, memory bound).
+
+#define BATCH_BENCH_MAX_COUNT 10000000
+#define BATCH_BENCH_MAX_MATRICES 100000
+
+static ns::vec3_soa bench_points;
+static ns::quat_soa bench_rotations;
+static ns::vec3_soa bench_scales;
+static ns::mat4 *bench_matrices;
+static ns::mat4 bench_transform;
+
+template <usize COUNT> static void batch_bench_points(u64 iterations) {
+  for (u64 done = 0; done < iterations; done += COUNT) {
+    ns::batch_transform_points(bench_transform, bench_points, bench_points,
+                               COUNT);
+    bench_do_not_optimize(bench_points.x[0]);
+  }
+}
+
+template <usize COUNT> static void batch_bench_points_scalar(u64 iterations) {
+  // mat4 * vec4 is a column vector product
+  ns::mat4 t = bench_transform.transposed();
+  for (u64 done = 0; done < iterations; done += COUNT) {
+    for (usize i = 0; i < COUNT; i++) {
+      ns::vec4 p = t * ns::vec4(bench_points.x[i], bench_points.y[i],
+                                bench_points.z[i], 1.0f);
+      bench_points.x[i] = p.x;
+      bench_points.y[i] = p.y;
+      bench_points.z[i] = p.z;
+    }
+    bench_do_not_optimize(bench_points.x[0]);
+  }
+}
+
+template <usize COUNT> static void batch_bench_directions(u64 iterations) {
+  for (u64 done = 0; done < iterations; done += COUNT) {
+    ns::batch_transform_directions(bench_transform, bench_points,
+                                   bench_points, COUNT);
+    bench_do_not_optimize(bench_points.x[0]);
+  }
+}
+
+// Same as batch_bench_points, with the array split between threads
+static void batch_bench_points_threaded(u64 iterations) {
+  const usize count = BATCH_BENCH_MAX_COUNT;
+  usize thread_count = std::thread::hardware_concurrency();
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  usize chunk_size = (count + thread_count - 1) / thread_count;
+  usize chunk_count = ns::batch_chunk_count(count, chunk_size);
+  std::vector<std::thread> threads;
+  for (u64 done = 0; done < iterations; done += count) {
+    for (usize c = 0; c < chunk_count; c++) {
+      threads.emplace_back([c, count, chunk_size]() {
+        ns::batch_range r = ns::batch_chunk(c, count, chunk_size);
+        ns::vec3_soa arrays = bench_points.offset(r.begin);
+        ns::batch_transform_points(bench_transform, arrays, arrays, r.count());
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    threads.clear();
+    bench_do_not_optimize(bench_points.x[0]);
+  }
+}
+
+template <usize COUNT> static void batch_bench_model_matrices(u64 iterations) {
+  for (u64 done = 0; done < iterations; done += COUNT) {
+    ns::batch_model_matrices(bench_points, bench_rotations, bench_scales,
+                             bench_matrices, COUNT);
+    bench_do_not_optimize(bench_matrices[0]);
+  }
+}
+
+template <usize COUNT>
+static void batch_bench_model_matrices_scalar(u64 iterations) {
+  for (u64 done = 0; done < iterations; done += COUNT) {
+    for (usize i = 0; i < COUNT; i++) {
+      ns::quat q(bench_rotations.x[i], bench_rotations.y[i],
+                 bench_rotations.z[i], bench_rotations.w[i]);
+      bench_matrices[i] =
+          ns::mat4::mk_scale(ns::vec3(bench_scales.x[i], bench_scales.y[i],
+                                      bench_scales.z[i])) *
+          q.matrix() *
+          ns::mat4::mk_translate(ns::vec3(
+              bench_points.x[i], bench_points.y[i], bench_points.z[i]));
+    }
+    bench_do_not_optimize(bench_matrices[0]);
+  }
+}
+
+static f32 *batch_bench_array(usize count, f32 value) {
+  f32 *array = new f32[count];
+  for (usize i = 0; i < count; i++) {
+    array[i] = value * static_cast<f32>(i % 1000);
+  }
+  return array;
+}
+
+void batch_register_benches() {
+  bench_points = {batch_bench_array(BATCH_BENCH_MAX_COUNT, 0.01f),
+                  batch_bench_array(BATCH_BENCH_MAX_COUNT, -0.02f),
+                  batch_bench_array(BATCH_BENCH_MAX_COUNT, 0.03f)};
+  bench_scales = {batch_bench_array(BATCH_BENCH_MAX_MATRICES, 0.001f),
+                  batch_bench_array(BATCH_BENCH_MAX_MATRICES, 0.002f),
+                  batch_bench_array(BATCH_BENCH_MAX_MATRICES, 0.003f)};
+  bench_rotations = {new f32[BATCH_BENCH_MAX_MATRICES],
+                     new f32[BATCH_BENCH_MAX_MATRICES],
+                     new f32[BATCH_BENCH_MAX_MATRICES],
+                     new f32[BATCH_BENCH_MAX_MATRICES]};
+  for (usize i = 0; i < BATCH_BENCH_MAX_MATRICES; i++) {
+    f32 f = static_cast<f32>(i % 64);
+    ns::quat q = ns::quat(f * 0.1f, 1.0f, -f * 0.2f, 0.5f).normalized();
+    bench_rotations.x[i] = q.x;
+    bench_rotations.y[i] = q.y;
+    bench_rotations.z[i] = q.z;
+    bench_rotations.w[i] = q.w;
+  }
+  bench_matrices = new ns::mat4[BATCH_BENCH_MAX_MATRICES];
+  // A rotation, so that repeated passes neither overflow nor vanish.
+  bench_transform = ns::mat4::mk_euler_xyz(0.01f, 0.02f, 0.03f);
+
+  bench_manager_register_bench(batch_bench_points<1000>,
+                               "batch points (1K)", 100000000, 1000);
+  bench_manager_register_bench(batch_bench_points<10000>,
+                               "batch points (10K)", 100000000, 10000);
+  bench_manager_register_bench(batch_bench_points<100000>,
+                               "batch points (100K)", 100000000, 100000);
+  bench_manager_register_bench(batch_bench_points<1000000>,
+                               "batch points (1M)", 100000000, 1000000);
+  bench_manager_register_bench(batch_bench_points<10000000>,
+                               "batch points (10M)", 100000000, 10000000);
+  bench_manager_register_bench(batch_bench_points_threaded,
+                               "batch points (10M, threaded)", 100000000,
+                               BATCH_BENCH_MAX_COUNT);
+  bench_manager_register_bench(batch_bench_points_scalar<10000>,
+                               "batch points (10K, mat4 * vec4 reference)",
+                               100000000, 10000);
+  bench_manager_register_bench(batch_bench_directions<10000>,
+                               "batch directions (10K)", 100000000, 10000);
+  bench_manager_register_bench(batch_bench_model_matrices<1000>,
+                               "batch model matrices (1K)", 10000000, 1000);
+  bench_manager_register_bench(batch_bench_model_matrices<100000>,
+                               "batch model matrices (100K)", 10000000,
+                               100000);
+  bench_manager_register_bench(
+      batch_bench_model_matrices_scalar<1000>,
+      "batch model matrices (1K, mat4 reference)", 10000000, 1000);
+}
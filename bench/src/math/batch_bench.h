@@ -0,0 +1,6 @@
+#ifndef BATCH_BENCH_HEADER_INCLUDED
+#define BATCH_BENCH_HEADER_INCLUDED
+
+void batch_register_benches();
+
+#endif // BATCH_BENCH_HEADER_INCLUDED
@@ -0,0 +1,84 @@
+#include "./bounds_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <math/bounds.h>
+#include <math/math.h>
+#include <math/random.h>
+
+// Culling 100K objects scattered around the renderer's default camera. One
+// iteration is one object.
+
+#define BOUNDS_BENCH_COUNT 100000
+
+static ns::frustum bench_frustum;
+static ns::aabb_soa bench_boxes;
+static ns::sphere_soa bench_spheres;
+static ns::aabb *bench_aabbs;
+static u32 bench_visibility[ns::cull_mask_word_count(BOUNDS_BENCH_COUNT)];
+
+static void bounds_bench_cull_aabbs(u64 iterations) {
+  for (u64 done = 0; done < iterations; done += BOUNDS_BENCH_COUNT) {
+    u32 visible = ns::frustum_cull_aabbs(bench_frustum, bench_boxes,
+                                         BOUNDS_BENCH_COUNT, bench_visibility);
+    bench_do_not_optimize(visible);
+  }
+}
+
+static void bounds_bench_cull_spheres(u64 iterations) {
+  for (u64 done = 0; done < iterations; done += BOUNDS_BENCH_COUNT) {
+    u32 visible = ns::frustum_cull_spheres(
+        bench_frustum, bench_spheres, BOUNDS_BENCH_COUNT, bench_visibility);
+    bench_do_not_optimize(visible);
+  }
+}
+
+static void bounds_bench_cull_scalar(u64 iterations) {
+  for (u64 done = 0; done < iterations; done += BOUNDS_BENCH_COUNT) {
+    u32 visible = 0;
+    for (u32 i = 0; i < BOUNDS_BENCH_COUNT; i++) {
+      visible += bench_frustum.intersects(bench_aabbs[i]);
+    }
+    bench_do_not_optimize(visible);
+  }
+}
+
+void bounds_register_benches() {
+  bench_frustum = ns::frustum(
+      ns::mat4::mk_translate({0.0f, 0.0f, -30.0f}) *
+      ns::mat4::perspective(ns::PI_1_4<f32>, 1280.0f / 720.0f, 0.01f, 1000.0f));
+
+  f32 *arrays[6];
+  for (f32 *&a : arrays) {
+    a = new f32[BOUNDS_BENCH_COUNT];
+  }
+  bench_boxes = {arrays[0], arrays[1], arrays[2],
+                 arrays[3], arrays[4], arrays[5]};
+  bench_spheres = {arrays[0], arrays[1], arrays[2], arrays[3]};
+  bench_aabbs = new ns::aabb[BOUNDS_BENCH_COUNT];
+
+  ns::rng g(1);
+  for (u32 i = 0; i < BOUNDS_BENCH_COUNT; i++) {
+    ns::vec3 c(g.range_f32(-500.0f, 500.0f), g.range_f32(-500.0f, 500.0f),
+               g.range_f32(-1000.0f, 100.0f));
+    ns::vec3 e(g.range_f32(0.5f, 10.0f), g.range_f32(0.5f, 10.0f),
+               g.range_f32(0.5f, 10.0f));
+    bench_boxes.center_x[i] = c.x;
+    bench_boxes.center_y[i] = c.y;
+    bench_boxes.center_z[i] = c.z;
+    bench_boxes.extent_x[i] = e.x;
+    bench_boxes.extent_y[i] = e.y;
+    bench_boxes.extent_z[i] = e.z;
+    bench_aabbs[i] = ns::aabb(c - e, c + e);
+  }
+
+  bench_manager_register_bench(bounds_bench_cull_aabbs,
+                               "frustum_cull_aabbs (100K)", 100000000,
+                               BOUNDS_BENCH_COUNT);
+  bench_manager_register_bench(bounds_bench_cull_spheres,
+                               "frustum_cull_spheres (100K)", 100000000,
+                               BOUNDS_BENCH_COUNT);
+  bench_manager_register_bench(bounds_bench_cull_scalar,
+                               "frustum::intersects(aabb) (100K)", 100000000,
+                               BOUNDS_BENCH_COUNT);
+}
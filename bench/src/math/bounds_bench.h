@@ -0,0 +1,6 @@
+#ifndef BOUNDS_BENCH_HEADER_INCLUDED
+#define BOUNDS_BENCH_HEADER_INCLUDED
+
+void bounds_register_benches();
+
+#endif // BOUNDS_BENCH_HEADER_INCLUDED
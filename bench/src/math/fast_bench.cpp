@@ -0,0 +1,121 @@
+#include "./fast_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <math/fast.h>
+#include <math/math.h>
+
+#include <math.h>
+
+// The fast approximations against libm and the exported ns:: wrappers. One
+// iteration is one value, taken from a small array (in L1).
+
+#define FAST_BENCH_SET_SIZE 1024
+
+alignas(16) static f32 bench_angles[FAST_BENCH_SET_SIZE];
+alignas(16) static f32 bench_positives[FAST_BENCH_SET_SIZE];
+static ns::vec3 bench_vectors[FAST_BENCH_SET_SIZE];
+
+template <f32 (*FN)(f32)> static void fast_bench_scalar(u64 iterations) {
+  f32 acc = 0.0f;
+  for (u64 i = 0; i < iterations; i++) {
+    acc += FN(bench_angles[i % FAST_BENCH_SET_SIZE]);
+  }
+  bench_do_not_optimize(acc);
+}
+
+static f32 libm_sinf(f32 x) { return sinf(x); }
+static f32 libm_cosf(f32 x) { return cosf(x); }
+static f32 exported_sin(f32 x) { return ns::sin(x); }
+static f32 inlined_fast_sin(f32 x) { return ns::fast_sin(x); }
+static f32 inlined_fast_cos(f32 x) { return ns::fast_cos(x); }
+
+static void fast_bench_libm_rsqrt(u64 iterations) {
+  f32 acc = 0.0f;
+  for (u64 i = 0; i < iterations; i++) {
+    acc += 1.0f / sqrtf(bench_positives[i % FAST_BENCH_SET_SIZE]);
+  }
+  bench_do_not_optimize(acc);
+}
+
+static void fast_bench_exported_rsqrt(u64 iterations) {
+  f32 acc = 0.0f;
+  for (u64 i = 0; i < iterations; i++) {
+    acc += 1.0f / ns::sqrt(bench_positives[i % FAST_BENCH_SET_SIZE]);
+  }
+  bench_do_not_optimize(acc);
+}
+
+static void fast_bench_rsqrt(u64 iterations) {
+  f32 acc = 0.0f;
+  for (u64 i = 0; i < iterations; i++) {
+    acc += ns::fast_rsqrt(bench_positives[i % FAST_BENCH_SET_SIZE]);
+  }
+  bench_do_not_optimize(acc);
+}
+
+#if defined(NS_USE_SIMD)
+template <__m128 (*FN)(__m128), bool POSITIVE>
+static void fast_bench_simd(u64 iterations) {
+  __m128 acc = _mm_setzero_ps();
+  f32 const *values = POSITIVE ? bench_positives : bench_angles;
+  for (u64 i = 0; i < iterations; i += 4) {
+    acc = _mm_add_ps(acc, FN(_mm_load_ps(values + i % FAST_BENCH_SET_SIZE)));
+  }
+  bench_do_not_optimize(acc);
+}
+
+static __m128 simd_fast_sin(__m128 x) { return ns::simd_fast_sin(x); }
+static __m128 simd_fast_rsqrt(__m128 x) { return ns::simd_fast_rsqrt(x); }
+#endif
+
+static void fast_bench_vec3_normalized(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::vec3 n = bench_vectors[i % FAST_BENCH_SET_SIZE].normalized();
+    bench_do_not_optimize(n);
+  }
+}
+
+static void fast_bench_vec3_normalized_fast(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::vec3 n = bench_vectors[i % FAST_BENCH_SET_SIZE].normalized_fast();
+    bench_do_not_optimize(n);
+  }
+}
+
+void fast_register_benches() {
+  for (u32 i = 0; i < FAST_BENCH_SET_SIZE; i++) {
+    f32 f = static_cast<f32>(i);
+    bench_angles[i] = (f - 512.0f) * 0.37f;
+    bench_positives[i] = 0.01f + f * 3.7f;
+    bench_vectors[i] = ns::vec3(f + 1.0f, 2.0f - f, f * 0.5f);
+  }
+
+  bench_manager_register_bench(fast_bench_scalar<libm_sinf>, "libm sinf",
+                               100000000);
+  bench_manager_register_bench(fast_bench_scalar<exported_sin>,
+                               "ns::sin (exported)", 100000000);
+  bench_manager_register_bench(fast_bench_scalar<inlined_fast_sin>,
+                               "ns::fast_sin", 100000000);
+  bench_manager_register_bench(fast_bench_scalar<libm_cosf>, "libm cosf",
+                               100000000);
+  bench_manager_register_bench(fast_bench_scalar<inlined_fast_cos>,
+                               "ns::fast_cos", 100000000);
+#if defined(NS_USE_SIMD)
+  bench_manager_register_bench(fast_bench_simd<simd_fast_sin, false>,
+                               "ns::simd_fast_sin (per value)", 100000000, 4);
+#endif
+  bench_manager_register_bench(fast_bench_libm_rsqrt, "1 / sqrtf", 100000000);
+  bench_manager_register_bench(fast_bench_exported_rsqrt,
+                               "1 / ns::sqrt (exported)", 100000000);
+  bench_manager_register_bench(fast_bench_rsqrt, "ns::fast_rsqrt", 100000000);
+#if defined(NS_USE_SIMD)
+  bench_manager_register_bench(fast_bench_simd<simd_fast_rsqrt, true>,
+                               "ns::simd_fast_rsqrt (per value)", 100000000,
+                               4);
+#endif
+  bench_manager_register_bench(fast_bench_vec3_normalized, "vec3::normalized",
+                               100000000);
+  bench_manager_register_bench(fast_bench_vec3_normalized_fast,
+                               "vec3::normalized_fast", 100000000);
+}
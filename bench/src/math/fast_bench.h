@@ -0,0 +1,6 @@
+#ifndef FAST_BENCH_HEADER_INCLUDED
+#define FAST_BENCH_HEADER_INCLUDED
+
+void fast_register_benches();
+
+#endif // FAST_BENCH_HEADER_INCLUDED
@@ -0,0 +1,107 @@
+#include "./random_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <math/math.h>
+#include <math/random.h>
+
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+// The engine generators against libc rand(), which ns::rand used to wrap.
+// The threaded variants split the iterations between 4 threads: libc rand()
+// shares a locked global state, thread_rng does not.
+
+#define RANDOM_BENCH_THREADS 4
+#define RANDOM_BENCH_FILL_SIZE 4096
+
+static void random_bench_libc_rand(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    i32 v = ::rand();
+    bench_do_not_optimize(v);
+  }
+}
+
+static void random_bench_libc_randrange(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    i32 v = ::rand() % 100;
+    bench_do_not_optimize(v);
+  }
+}
+
+static void random_bench_ns_rand(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    i32 v = ns::rand();
+    bench_do_not_optimize(v);
+  }
+}
+
+static void random_bench_rng_next_u64(u64 iterations) {
+  ns::rng g(1);
+  for (u64 i = 0; i < iterations; i++) {
+    u64 v = g.next_u64();
+    bench_do_not_optimize(v);
+  }
+}
+
+static void random_bench_rng_range(u64 iterations) {
+  ns::rng g(1);
+  for (u64 i = 0; i < iterations; i++) {
+    i32 v = g.range(0, 99);
+    bench_do_not_optimize(v);
+  }
+}
+
+static void random_bench_rng_next_f32(u64 iterations) {
+  ns::rng g(1);
+  for (u64 i = 0; i < iterations; i++) {
+    f32 v = g.next_f32();
+    bench_do_not_optimize(v);
+  }
+}
+
+static f32 random_bench_floats[RANDOM_BENCH_FILL_SIZE];
+
+// One iteration is one float
+static void random_bench_rng_fill_f32(u64 iterations) {
+  ns::rng g(1);
+  for (u64 done = 0; done < iterations; done += RANDOM_BENCH_FILL_SIZE) {
+    g.fill_f32(random_bench_floats, RANDOM_BENCH_FILL_SIZE, -1.0f, 1.0f);
+    bench_do_not_optimize(random_bench_floats[0]);
+  }
+}
+
+template <void (*FN)(u64)> static void random_bench_threaded(u64 iterations) {
+  std::vector<std::thread> threads;
+  for (u32 t = 0; t < RANDOM_BENCH_THREADS; t++) {
+    threads.emplace_back(FN, iterations / RANDOM_BENCH_THREADS);
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+void random_register_benches() {
+  bench_manager_register_bench(random_bench_libc_rand, "libc rand()",
+                               100000000);
+  bench_manager_register_bench(random_bench_libc_randrange,
+                               "libc rand() % 100", 100000000);
+  bench_manager_register_bench(random_bench_ns_rand, "ns::rand (thread_rng)",
+                               100000000);
+  bench_manager_register_bench(random_bench_rng_next_u64, "rng::next_u64",
+                               100000000);
+  bench_manager_register_bench(random_bench_rng_range, "rng::range(0, 99)",
+                               100000000);
+  bench_manager_register_bench(random_bench_rng_next_f32, "rng::next_f32",
+                               100000000);
+  bench_manager_register_bench(random_bench_rng_fill_f32,
+                               "rng::fill_f32 (per float)", 100000000,
+                               RANDOM_BENCH_FILL_SIZE);
+  bench_manager_register_bench(random_bench_threaded<random_bench_libc_rand>,
+                               "libc rand() (4 threads)", 40000000,
+                               RANDOM_BENCH_THREADS);
+  bench_manager_register_bench(random_bench_threaded<random_bench_ns_rand>,
+                               "ns::rand (4 threads)", 40000000,
+                               RANDOM_BENCH_THREADS);
+}
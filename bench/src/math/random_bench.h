@@ -0,0 +1,6 @@
+#ifndef RANDOM_BENCH_HEADER_INCLUDED
+#define RANDOM_BENCH_HEADER_INCLUDED
+
+void random_register_benches();
+
+#endif // RANDOM_BENCH_HEADER_INCLUDED
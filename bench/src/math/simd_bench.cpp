@@ -0,0 +1,181 @@
+#include "./simd_bench.h"
+#include "../bench_manager.h"
+
+#include <core/logger.h>
+#include <defines.h>
+#include <math/math.h>
+
+// Small working sets (in L1) so the arithmetic is measured, not memory.
+#define SIMD_BENCH_SET_SIZE 64
+
+static ns::mat4 bench_matrices[SIMD_BENCH_SET_SIZE];
+static ns::vec4 bench_vectors[SIMD_BENCH_SET_SIZE];
+static ns::quat bench_quats[SIMD_BENCH_SET_SIZE];
+
+static void simd_bench_fill() {
+  for (u32 i = 0; i < SIMD_BENCH_SET_SIZE; i++) {
+    f32 f = static_cast<f32>(i);
+    bench_matrices[i] = ns::mat4::mk_euler_xyz(f * 0.1f, f * 0.2f, f * 0.3f)
+                            .pre_translate(ns::vec3(f, -f, 2.0f * f));
+    bench_vectors[i] = ns::vec4(f + 1.0f, 2.0f - f, f * 0.5f, 1.0f);
+    bench_quats[i] = ns::quat(f * 0.1f, 1.0f, -f * 0.2f, 0.5f).normalized();
+  }
+}
+
+// Scalar reference, as the engine compiles it without NS_USE_SIMD
+static ns::mat4 scalar_mat4_mul(ns::mat4 const &a, ns::mat4 const &b) {
+  ns::mat4 out;
+  for (u32 i = 0; i < 4; i++) {
+    for (u32 j = 0; j < 4; j++) {
+      out.d[i][j] = a.d[i][0] * b.d[0][j] + a.d[i][1] * b.d[1][j] +
+                    a.d[i][2] * b.d[2][j] + a.d[i][3] * b.d[3][j];
+    }
+  }
+  return out;
+}
+
+void simd_bench_mat4_mul(u64 iterations) {
+  ns::mat4 acc = ns::mat4::identity();
+  for (u64 i = 0; i < iterations; i++) {
+    acc = bench_matrices[i % SIMD_BENCH_SET_SIZE] *
+          bench_matrices[(i + 1) % SIMD_BENCH_SET_SIZE];
+    bench_do_not_optimize(acc);
+  }
+}
+
+void simd_bench_mat4_mul_scalar(u64 iterations) {
+  ns::mat4 acc = ns::mat4::identity();
+  for (u64 i = 0; i < iterations; i++) {
+    acc = scalar_mat4_mul(bench_matrices[i % SIMD_BENCH_SET_SIZE],
+                          bench_matrices[(i + 1) % SIMD_BENCH_SET_SIZE]);
+    bench_do_not_optimize(acc);
+  }
+}
+
+void simd_bench_mat4_mul_vec4(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::vec4 v = bench_matrices[i % SIMD_BENCH_SET_SIZE] *
+                 bench_vectors[i % SIMD_BENCH_SET_SIZE];
+    bench_do_not_optimize(v);
+  }
+}
+
+void simd_bench_mat4_transposed(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::mat4 t = bench_matrices[i % SIMD_BENCH_SET_SIZE].transposed();
+    bench_do_not_optimize(t);
+  }
+}
+
+void simd_bench_mat4_inverse(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::mat4 inv = bench_matrices[i % SIMD_BENCH_SET_SIZE].inverse();
+    bench_do_not_optimize(inv);
+  }
+}
+
+// A chain of dependent products over a 10K matrix array (640KB): this is
+// dominated by the cost of the products and of the copies.
+#define MAT4_CHAIN_LENGTH 10000
+
+static ns::mat4 *bench_chain;
+
+void simd_bench_mat4_chain(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::mat4 acc = ns::mat4::identity();
+    for (u32 j = 0; j < MAT4_CHAIN_LENGTH; j++) {
+      acc = acc * bench_chain[j];
+    }
+    bench_do_not_optimize(acc);
+  }
+}
+
+void simd_bench_mat4_lookat(u64 iterations) {
+  ns::vec3 up(0.0f, 1.0f, 0.0f);
+  for (u64 i = 0; i < iterations; i++) {
+    ns::vec4 const &p = bench_vectors[i % SIMD_BENCH_SET_SIZE];
+    ns::vec4 const &t = bench_vectors[(i + 1) % SIMD_BENCH_SET_SIZE];
+    ns::mat4 view = ns::mat4::lookat(ns::vec3(p.x, p.y, p.z),
+                                     ns::vec3(t.x, t.y, t.z), up);
+    bench_do_not_optimize(view);
+  }
+}
+
+void simd_bench_vec3_normalize(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::vec4 const &v = bench_vectors[i % SIMD_BENCH_SET_SIZE];
+    ns::vec3 n = ns::vec3(v.x, v.y, v.z).normalized();
+    bench_do_not_optimize(n);
+  }
+}
+
+void simd_bench_vec4_normalize(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::vec4 n = bench_vectors[i % SIMD_BENCH_SET_SIZE].normalized();
+    bench_do_not_optimize(n);
+  }
+}
+
+void simd_bench_vec4_dot(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    f32 d = bench_vectors[i % SIMD_BENCH_SET_SIZE].dot(
+        bench_vectors[(i + 1) % SIMD_BENCH_SET_SIZE]);
+    bench_do_not_optimize(d);
+  }
+}
+
+void simd_bench_quat_mul(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::quat q = bench_quats[i % SIMD_BENCH_SET_SIZE] *
+                 bench_quats[(i + 1) % SIMD_BENCH_SET_SIZE];
+    bench_do_not_optimize(q);
+  }
+}
+
+void simd_bench_quat_slerp(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::quat q(bench_quats[i % SIMD_BENCH_SET_SIZE],
+               bench_quats[(i + 1) % SIMD_BENCH_SET_SIZE], 0.3f);
+    bench_do_not_optimize(q);
+  }
+}
+
+void simd_register_benches() {
+#if defined(NS_USE_SIMD) && defined(__FMA__)
+  NS_INFO("Math types: SIMD (AVX2, FMA)");
+#elif defined(NS_USE_SIMD) && defined(__AVX2__)
+  NS_INFO("Math types: SIMD (AVX2)");
+#elif defined(NS_USE_SIMD)
+  NS_INFO("Math types: SIMD (SSE4.1)");
+#else
+  NS_INFO("Math types: scalar");
+#endif
+  simd_bench_fill();
+  bench_chain = new ns::mat4[MAT4_CHAIN_LENGTH];
+  for (u32 i = 0; i < MAT4_CHAIN_LENGTH; i++) {
+    // Rotations, so the chain neither overflows nor vanishes.
+    bench_chain[i] = ns::mat4::mk_euler_xyz(0.001f * static_cast<f32>(i), 0.3f,
+                                            -0.002f * static_cast<f32>(i));
+  }
+
+  bench_manager_register_bench(simd_bench_mat4_mul, "mat4 * mat4", 10000000);
+  bench_manager_register_bench(simd_bench_mat4_mul_scalar,
+                               "mat4 * mat4 (scalar reference)", 10000000);
+  bench_manager_register_bench(simd_bench_mat4_chain,
+                               "mat4 chain (10K products)", 200);
+  bench_manager_register_bench(simd_bench_mat4_mul_vec4, "mat4 * vec4",
+                               10000000);
+  bench_manager_register_bench(simd_bench_mat4_transposed, "mat4::transposed",
+                               10000000);
+  bench_manager_register_bench(simd_bench_mat4_inverse, "mat4::inverse",
+                               10000000);
+  bench_manager_register_bench(simd_bench_mat4_lookat, "mat4::lookat",
+                               10000000);
+  bench_manager_register_bench(simd_bench_vec3_normalize, "vec3::normalized",
+                               10000000);
+  bench_manager_register_bench(simd_bench_vec4_normalize, "vec4::normalized",
+                               10000000);
+  bench_manager_register_bench(simd_bench_vec4_dot, "vec4::dot", 10000000);
+  bench_manager_register_bench(simd_bench_quat_mul, "quat * quat", 10000000);
+  bench_manager_register_bench(simd_bench_quat_slerp, "quat slerp", 10000000);
+}
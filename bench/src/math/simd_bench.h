@@ -0,0 +1,6 @@
+#ifndef SIMD_BENCH_HEADER_INCLUDED
+#define SIMD_BENCH_HEADER_INCLUDED
+
+void simd_register_benches();
+
+#endif // SIMD_BENCH_HEADER_INCLUDED
@@ -0,0 +1,83 @@
+#include "./transform_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <math/math.h>
+#include <math/transform.h>
+
+// Rigid matrices (camera-like) in L1: the general inverse against the rigid
+// fast path, and the view matrix of the testbed camera before and after the
+// transform type.
+#define TRANSFORM_BENCH_SET_SIZE 64
+
+static ns::mat4 bench_rigid[TRANSFORM_BENCH_SET_SIZE];
+static ns::vec3 bench_positions[TRANSFORM_BENCH_SET_SIZE];
+static ns::vec3 bench_eulers[TRANSFORM_BENCH_SET_SIZE];
+static ns::transform bench_transforms[TRANSFORM_BENCH_SET_SIZE];
+
+static void transform_bench_inverse(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::mat4 inv = bench_rigid[i % TRANSFORM_BENCH_SET_SIZE].inverse();
+    bench_do_not_optimize(inv);
+  }
+}
+
+static void transform_bench_inverse_rigid(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::mat4 inv = bench_rigid[i % TRANSFORM_BENCH_SET_SIZE].inverse_rigid();
+    bench_do_not_optimize(inv);
+  }
+}
+
+static void transform_bench_view_euler(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    u64 j = i % TRANSFORM_BENCH_SET_SIZE;
+    ns::mat4 view = ns::mat4::mk_euler_xyz(bench_eulers[j])
+                        .translate(bench_positions[j])
+                        .inverse();
+    bench_do_not_optimize(view);
+  }
+}
+
+static void transform_bench_view_transform(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::transform &t = bench_transforms[i % TRANSFORM_BENCH_SET_SIZE];
+    // Moved every frame: the matrix is recomputed
+    t.translate(ns::vec3(0.0f));
+    ns::mat4 view = t.inverse_matrix();
+    bench_do_not_optimize(view);
+  }
+}
+
+static void transform_bench_local_cached(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::mat4 const &m =
+        bench_transforms[i % TRANSFORM_BENCH_SET_SIZE].local_matrix();
+    bench_do_not_optimize(m);
+  }
+}
+
+void transform_register_benches() {
+  for (u32 i = 0; i < TRANSFORM_BENCH_SET_SIZE; i++) {
+    f32 f = static_cast<f32>(i);
+    bench_positions[i] = ns::vec3(f, -f, 2.0f * f);
+    bench_eulers[i] = ns::vec3(f * 0.01f, f * 0.05f, 0.0f);
+    bench_rigid[i] = ns::mat4::mk_euler_xyz(bench_eulers[i])
+                         .translate(bench_positions[i]);
+    bench_transforms[i] = ns::transform(
+        bench_positions[i], ns::quat::from_euler_xyz(bench_eulers[i]));
+  }
+
+  bench_manager_register_bench(transform_bench_inverse,
+                               "mat4::inverse (rigid matrix)", 10000000);
+  bench_manager_register_bench(transform_bench_inverse_rigid,
+                               "mat4::inverse_rigid", 10000000);
+  bench_manager_register_bench(transform_bench_view_euler,
+                               "camera view (euler matrices, inverse)",
+                               10000000);
+  bench_manager_register_bench(transform_bench_view_transform,
+                               "camera view (transform, rigid inverse)",
+                               10000000);
+  bench_manager_register_bench(transform_bench_local_cached,
+                               "transform::local_matrix (cached)", 10000000);
+}
@@ -0,0 +1,6 @@
+#ifndef TRANSFORM_BENCH_HEADER_INCLUDED
+#define TRANSFORM_BENCH_HEADER_INCLUDED
+
+void transform_register_benches();
+
+#endif // TRANSFORM_BENCH_HEADER_INCLUDED
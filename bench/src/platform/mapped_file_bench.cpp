@@ -0,0 +1,204 @@
+#include "./mapped_file_bench.h"
+#include "../bench_manager.h"
+#include "../resources/bench_resources.h"
+
+#include <core/logger.h>
+#include <core/memory.h>
+#include <platform/filesystem.h>
+#include <systems/resource_system.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Loading a large binary file (one iteration), then reading every page of
+// it: read into an allocation (the binary loader before, open, fsize, alloc,
+// read_all_bytes), mapped without a hint, and mapped by the binary loader
+// (read ahead with WILL_NEED). The file is in the page cache.
+//
+// The first load of each logs the memory of the process while the file is
+// loaded, from /proc/self/status: the read copy is private (RssAnon, on top
+// of the page cache), the mapped pages are the page cache ones (RssFile,
+// shared and dropped under memory pressure). The read copy of the report is
+// a new malloc block (not the memory system one, already resident), whose
+// pages are all new to the process.
+
+#define MAPPED_FILE_BENCH_DIR "bench_mapped_file"
+#define MAPPED_FILE_BENCH_NAME "large.bin"
+#define MAPPED_FILE_BENCH_PATH MAPPED_FILE_BENCH_DIR "/" MAPPED_FILE_BENCH_NAME
+#define MAPPED_FILE_BENCH_SIZE (64 * 1024 * 1024)
+#define MAPPED_FILE_BENCH_PAGE_SIZE 4096
+
+struct mapped_file_bench_memory {
+  u64 anon;
+  u64 file;
+};
+
+static bool bench_file_written = false;
+
+static void mapped_file_bench_cleanup() {
+  ns::fs::remove(MAPPED_FILE_BENCH_PATH);
+  std::remove(MAPPED_FILE_BENCH_DIR);
+}
+
+static bool mapped_file_bench_init() {
+  if (bench_file_written) {
+    return true;
+  }
+  ns::fs::create_directory(MAPPED_FILE_BENCH_DIR);
+  std::vector<u8> data(MAPPED_FILE_BENCH_SIZE);
+  u32 state = 12345;
+  for (usize i = 0; i < data.size(); i += 4) {
+    state = state * 1664525u + 1013904223u;
+    std::memcpy(&data[i], &state, 4);
+  }
+  ns::fs::File f;
+  usize written = 0;
+  bool ok = ns::fs::open(MAPPED_FILE_BENCH_PATH, ns::fs::Mode::WRITE, true,
+                         &f) &&
+            ns::fs::write(&f, data.size(), data.data(), &written);
+  ns::fs::close(&f);
+  if (!ok) {
+    NS_WARN("Failed to write '%s'", MAPPED_FILE_BENCH_PATH);
+    return false;
+  }
+  std::atexit(mapped_file_bench_cleanup);
+  bench_file_written = true;
+  return true;
+}
+
+static u64 mapped_file_bench_touch(u8 const *data, usize size) {
+  u64 sum = 0;
+  for (usize i = 0; i < size; i += MAPPED_FILE_BENCH_PAGE_SIZE) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+static mapped_file_bench_memory mapped_file_bench_resident() {
+  mapped_file_bench_memory memory = {};
+#ifdef __linux__
+  FILE *status = std::fopen("/proc/self/status", "r");
+  if (!status) {
+    return memory;
+  }
+  char line[256];
+  while (std::fgets(line, sizeof(line), status)) {
+    unsigned long long kib = 0;
+    if (std::sscanf(line, "RssAnon: %llu kB", &kib) == 1) {
+      memory.anon = kib * 1024;
+    } else if (std::sscanf(line, "RssFile: %llu kB", &kib) == 1) {
+      memory.file = kib * 1024;
+    }
+  }
+  std::fclose(status);
+#endif
+  return memory;
+}
+
+static f64 mapped_file_bench_mib(u64 before, u64 after) {
+  return (static_cast<f64>(after) - static_cast<f64>(before)) /
+         (1024.0 * 1024.0);
+}
+
+static void mapped_file_bench_report(cstr what,
+                                     mapped_file_bench_memory before,
+                                     mapped_file_bench_memory loaded) {
+  NS_INFO("%s: %+.1f MiB private (RssAnon), %+.1f MiB mapped (RssFile)",
+          what, mapped_file_bench_mib(before.anon, loaded.anon),
+          mapped_file_bench_mib(before.file, loaded.file));
+}
+
+static void mapped_file_bench_read(u64 iterations) {
+  if (!mapped_file_bench_init()) {
+    return;
+  }
+  for (u64 i = 0; i < iterations; i++) {
+    ns::fs::File f;
+    usize size = 0;
+    if (!ns::fs::open(MAPPED_FILE_BENCH_PATH, ns::fs::Mode::READ, true, &f) ||
+        !ns::fs::fsize(&f, &size)) {
+      return;
+    }
+    u8 *data = reinterpret_cast<u8 *>(ns::alloc(size, ns::MemTag::ARRAY));
+    ns::fs::read_all_bytes(&f, data, nullptr);
+    ns::fs::close(&f);
+    bench_do_not_optimize(mapped_file_bench_touch(data, size));
+    ns::free(data, size, ns::MemTag::ARRAY);
+  }
+  static bool reported = false;
+  if (!reported && iterations > 0) {
+    reported = true;
+    mapped_file_bench_memory before = mapped_file_bench_resident();
+    ns::fs::File f;
+    u8 *data = reinterpret_cast<u8 *>(std::malloc(MAPPED_FILE_BENCH_SIZE));
+    if (ns::fs::open(MAPPED_FILE_BENCH_PATH, ns::fs::Mode::READ, true, &f)) {
+      ns::fs::read_all_bytes(&f, data, nullptr);
+    }
+    ns::fs::close(&f);
+    bench_do_not_optimize(
+        mapped_file_bench_touch(data, MAPPED_FILE_BENCH_SIZE));
+    mapped_file_bench_report("read", before, mapped_file_bench_resident());
+    std::free(data);
+  }
+}
+
+static void mapped_file_bench_map(u64 iterations) {
+  if (!mapped_file_bench_init()) {
+    return;
+  }
+  static bool reported = false;
+  for (u64 i = 0; i < iterations; i++) {
+    mapped_file_bench_memory before = {};
+    if (!reported) {
+      before = mapped_file_bench_resident();
+    }
+    ns::fs::MappedFile file;
+    if (!ns::fs::map(MAPPED_FILE_BENCH_PATH, &file)) {
+      return;
+    }
+    bench_do_not_optimize(mapped_file_bench_touch(file.data, file.size));
+    if (!reported) {
+      reported = true;
+      mapped_file_bench_report("map", before, mapped_file_bench_resident());
+    }
+    ns::fs::unmap(&file);
+  }
+}
+
+static void mapped_file_bench_binary_loader(u64 iterations) {
+  if (!mapped_file_bench_init()) {
+    return;
+  }
+  bench_resource_system_use(MAPPED_FILE_BENCH_DIR, nullptr, 0);
+  static bool reported = false;
+  for (u64 i = 0; i < iterations; i++) {
+    mapped_file_bench_memory before = {};
+    if (!reported) {
+      before = mapped_file_bench_resident();
+    }
+    ns::Resource resource;
+    if (!ns::resource_system_load(MAPPED_FILE_BENCH_NAME,
+                                  ns::ResourceType::BINARY, &resource)) {
+      return;
+    }
+    bench_do_not_optimize(mapped_file_bench_touch(
+        reinterpret_cast<u8 const *>(resource.data), resource.data_size));
+    if (!reported) {
+      reported = true;
+      mapped_file_bench_report("binary loader", before,
+                               mapped_file_bench_resident());
+    }
+    ns::resource_system_unload(&resource);
+  }
+}
+
+void mapped_file_register_benches() {
+  bench_manager_register_bench(mapped_file_bench_read,
+                               "64 MiB file: read into an allocation", 20);
+  bench_manager_register_bench(mapped_file_bench_map,
+                               "64 MiB file: mapped", 20);
+  bench_manager_register_bench(mapped_file_bench_binary_loader,
+                               "64 MiB file: binary loader (will need)", 20);
+}
@@ -0,0 +1,6 @@
+#ifndef MAPPED_FILE_BENCH_HEADER_INCLUDED
+#define MAPPED_FILE_BENCH_HEADER_INCLUDED
+
+void mapped_file_register_benches();
+
+#endif // MAPPED_FILE_BENCH_HEADER_INCLUDED
@@ -0,0 +1,64 @@
+#include "./ticks_bench.h"
+#include "../bench_manager.h"
+
+#include <core/clock.h>
+#include <core/logger.h>
+#include <defines.h>
+#include <platform/platform.h>
+
+#include <time.h>
+
+void ticks_bench_get_ticks(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(ns::platform::get_ticks());
+  }
+}
+
+void ticks_bench_get_absolute_time(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(ns::platform::get_absolute_time());
+  }
+}
+
+void ticks_bench_clock_gettime(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    bench_do_not_optimize(now);
+  }
+}
+
+void ticks_bench_clock_update(u64 iterations) {
+  ns::clock_t clock;
+  clock.start();
+  for (u64 i = 0; i < iterations; i++) {
+    clock.update();
+    bench_do_not_optimize(clock.elapsed);
+  }
+}
+
+void ticks_bench_tick_clock_update(u64 iterations) {
+  ns::tick_clock_t clock;
+  clock.start();
+  for (u64 i = 0; i < iterations; i++) {
+    clock.update();
+    bench_do_not_optimize(clock.elapsed_ticks);
+  }
+}
+
+void ticks_register_benches() {
+  NS_INFO("Tick source: %s, %llu ticks/sec",
+          ns::platform::ticks_use_tsc() ? "invariant TSC" : "monotonic clock",
+          ns::platform::get_tick_frequency());
+
+  bench_manager_register_bench(ticks_bench_get_ticks, "platform::get_ticks",
+                               10000000);
+  bench_manager_register_bench(ticks_bench_get_absolute_time,
+                               "platform::get_absolute_time", 10000000);
+  bench_manager_register_bench(ticks_bench_clock_gettime,
+                               "clock_gettime(CLOCK_MONOTONIC)", 10000000);
+  bench_manager_register_bench(ticks_bench_clock_update, "clock_t::update",
+                               10000000);
+  bench_manager_register_bench(ticks_bench_tick_clock_update,
+                               "tick_clock_t::update", 10000000);
+}
@@ -0,0 +1,6 @@
+#ifndef TICKS_BENCH_HEADER_INCLUDED
+#define TICKS_BENCH_HEADER_INCLUDED
+
+void ticks_register_benches();
+
+#endif // TICKS_BENCH_HEADER_INCLUDED
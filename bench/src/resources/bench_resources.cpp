@@ -0,0 +1,61 @@
+#include "./bench_resources.h"
+
+#include <core/memory.h>
+#include <core/string.h>
+#include <systems/resource_system.h>
+
+#include <cstdlib>
+
+static ptr bench_resource_state;
+static usize bench_resource_requirement;
+static ns::resource_system_config bench_resource_config;
+
+static void bench_resource_system_shutdown() {
+  if (bench_resource_state) {
+    ns::resource_system_shutdown(bench_resource_state);
+    ns::free(bench_resource_state, bench_resource_requirement,
+             ns::MemTag::APPLICATION);
+    bench_resource_state = nullptr;
+  }
+}
+
+static bool bench_same_path(cstr a, cstr b) {
+  return a == b || (a && b && ns::string_eq(a, b));
+}
+
+void bench_resource_system_use(cstr asset_base_path, cstr texture_cache_path,
+                               u64 texture_cache_budget,
+                               bool compress_textures,
+                               u64 resource_cache_budget,
+                               bool cook_materials) {
+  ns::resource_system_config &config = bench_resource_config;
+  if (bench_resource_state &&
+      bench_same_path(config.asset_base_path, asset_base_path) &&
+      bench_same_path(config.texture_cache_path, texture_cache_path) &&
+      config.texture_cache_budget == texture_cache_budget &&
+      config.compress_textures == compress_textures &&
+      config.cache.budget == resource_cache_budget &&
+      config.cook_materials == cook_materials) {
+    return;
+  }
+  static bool registered = false;
+  if (!registered) {
+    std::atexit(bench_resource_system_shutdown);
+    registered = true;
+  }
+  bench_resource_system_shutdown();
+
+  config = {};
+  config.asset_base_path = asset_base_path;
+  config.texture_cache_path = texture_cache_path;
+  config.texture_cache_budget = texture_cache_budget;
+  config.compress_textures = compress_textures;
+  config.cache.max_entry_count = resource_cache_budget > 0 ? 256 : 0;
+  config.cache.budget = resource_cache_budget;
+  config.cook_materials = cook_materials;
+  ns::resource_system_initialize(&bench_resource_requirement, nullptr, config);
+  bench_resource_state =
+      ns::alloc(bench_resource_requirement, ns::MemTag::APPLICATION);
+  ns::resource_system_initialize(&bench_resource_requirement,
+                                 bench_resource_state, config);
+}
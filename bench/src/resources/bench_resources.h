@@ -0,0 +1,26 @@
+#ifndef BENCH_RESOURCES_HEADER_INCLUDED
+#define BENCH_RESOURCES_HEADER_INCLUDED
+
+#include <defines.h>
+
+/**
+ * Makes sure the resource system runs with this configuration. There is only
+ * one resource system: the benchmarks needing one call this first, and it is
+ * only reinitialized when the configuration changes (so in their warm-up
+ * sample, since the benchmarks of a module run one after the other).
+ * @param asset_base_path the directory of the assets
+ * @param texture_cache_path the directory of the texture cache, nullptr for
+ *        none
+ * @param texture_cache_budget the budget of the texture cache
+ * @param compress_textures whether the images are block compressed
+ * @param resource_cache_budget the budget of the cache of the released
+ *        resources, 0 for none
+ * @param cook_materials whether the material text files are read
+ */
+void bench_resource_system_use(cstr asset_base_path, cstr texture_cache_path,
+                               u64 texture_cache_budget,
+                               bool compress_textures = false,
+                               u64 resource_cache_budget = 0,
+                               bool cook_materials = false);
+
+#endif // BENCH_RESOURCES_HEADER_INCLUDED
@@ -0,0 +1,173 @@
+#include "./block_compression_bench.h"
+#include "../bench_manager.h"
+#include "./bench_resources.h"
+
+#include <core/logger.h>
+#include <math/random.h>
+#include <platform/filesystem.h>
+#include <resources/block_compression.h>
+#include <resources/loaders/image_loader.h>
+#include <resources/mipmap.h>
+
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+// Compression of a 1024x1024 level (one iteration): on one thread, then on
+// one thread per core.
+//
+// Loading the textures of the testbed compressed (one iteration), as
+// texture_cache_bench.cpp does uncompressed: cold (decode, compress and
+// store) and warm (map). The first warm run logs the size of the textures
+// in VRAM, uncompressed and compressed.
+
+#ifndef NS_BENCH_ASSET_PATH
+#define NS_BENCH_ASSET_PATH "../assets"
+#endif
+
+#define BLOCK_COMPRESSION_BENCH_SIZE 1024
+#define BLOCK_COMPRESSION_BENCH_DIR "bench_block_compression_cache"
+#define BLOCK_COMPRESSION_BENCH_BUDGET (64 * 1024 * 1024)
+
+static cstr bench_textures[] = {
+    "Brick_01", "Brick_01_Nrm", "Brick_02", "Brick_02_Nrm", "Brick_03",
+    "Brick_03_Nrm", "Brick_04", "Brick_04_Nrm", "prototype",
+};
+
+static std::vector<u8> bench_rgba;
+static std::vector<u8> bench_blocks;
+static std::vector<u8> bench_staging;
+
+static void block_compression_bench_init() {
+  if (!bench_rgba.empty()) {
+    return;
+  }
+  // A gradient with noise: the fit iterates more on noise than on flat
+  // blocks, texture content is in between
+  u32 size = BLOCK_COMPRESSION_BENCH_SIZE;
+  bench_rgba.resize(static_cast<usize>(size) * size * 4);
+  ns::rng g(1);
+  for (u32 y = 0; y < size; y++) {
+    for (u32 x = 0; x < size; x++) {
+      u8 *texel = &bench_rgba[(static_cast<usize>(y) * size + x) * 4];
+      u32 noise = g.next_u32();
+      texel[0] = static_cast<u8>((x >> 2) + (noise & 31));
+      texel[1] = static_cast<u8>((y >> 2) + ((noise >> 8) & 31));
+      texel[2] = static_cast<u8>(((x + y) >> 3) + ((noise >> 16) & 31));
+      texel[3] = static_cast<u8>(noise >> 24);
+    }
+  }
+  bench_blocks.resize(
+      ns::texture_format_level_size(ns::TextureFormat::BC3, size, size));
+}
+
+template <ns::TextureFormat FORMAT, u32 THREAD_COUNT>
+static void block_compression_bench_compress(u64 iterations) {
+  block_compression_bench_init();
+  for (u64 i = 0; i < iterations; i++) {
+    ns::bc_compress(FORMAT, bench_rgba.data(), BLOCK_COMPRESSION_BENCH_SIZE,
+                    BLOCK_COMPRESSION_BENCH_SIZE, bench_blocks.data(),
+                    THREAD_COUNT);
+    bench_do_not_optimize(bench_blocks.back());
+  }
+}
+
+static u64 block_compression_bench_load_all(u64 *rgba_size,
+                                            u64 *compressed_size) {
+  u64 sum = 0;
+  for (cstr name : bench_textures) {
+    ns::ImageResourceData image;
+    if (!ns::image_loader_decode(name, &image)) {
+      continue;
+    }
+    usize size = ns::texture_format_chain_size(image.format, image.width,
+                                               image.height, image.mip_count);
+    if (size > bench_staging.size()) {
+      bench_staging.resize(size);
+    }
+    std::memcpy(bench_staging.data(), image.pixels, size);
+    sum += bench_staging[size / 2];
+    *rgba_size += ns::mip_chain_size(image.width, image.height,
+                                     image.mip_count);
+    *compressed_size += size;
+    ns::image_loader_free_pixels(&image);
+  }
+  return sum;
+}
+
+static void block_compression_bench_clear() {
+  std::error_code error;
+  for (auto const &entry : std::filesystem::directory_iterator(
+           BLOCK_COMPRESSION_BENCH_DIR, error)) {
+    ns::fs::remove(entry.path().string().c_str());
+  }
+}
+
+static void block_compression_bench_cold(u64 iterations) {
+  bench_resource_system_use(NS_BENCH_ASSET_PATH, BLOCK_COMPRESSION_BENCH_DIR,
+                            BLOCK_COMPRESSION_BENCH_BUDGET, true);
+  u64 rgba_size = 0;
+  u64 compressed_size = 0;
+  for (u64 i = 0; i < iterations; i++) {
+    block_compression_bench_clear();
+    bench_do_not_optimize(
+        block_compression_bench_load_all(&rgba_size, &compressed_size));
+  }
+}
+
+static void block_compression_bench_warm(u64 iterations) {
+  bench_resource_system_use(NS_BENCH_ASSET_PATH, BLOCK_COMPRESSION_BENCH_DIR,
+                            BLOCK_COMPRESSION_BENCH_BUDGET, true);
+  u64 rgba_size = 0;
+  u64 compressed_size = 0;
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(
+        block_compression_bench_load_all(&rgba_size, &compressed_size));
+  }
+  static bool reported = false;
+  if (!reported && iterations > 0) {
+    reported = true;
+    NS_INFO("testbed textures in VRAM: %.2f MiB RGBA8, %.2f MiB compressed "
+            "(normal maps RGBA8)",
+            rgba_size / iterations / (1024.0 * 1024.0),
+            compressed_size / iterations / (1024.0 * 1024.0));
+  }
+}
+
+static void block_compression_bench_cleanup() {
+  std::error_code error;
+  std::filesystem::remove_all(BLOCK_COMPRESSION_BENCH_DIR, error);
+}
+
+void block_compression_register_benches() {
+  bench_manager_register_bench(
+      block_compression_bench_compress<ns::TextureFormat::BC1, 1>,
+      "BC1 1024: 1 thread", 22);
+  bench_manager_register_bench(
+      block_compression_bench_compress<ns::TextureFormat::BC1, 0>,
+      "BC1 1024: threaded", 22);
+  bench_manager_register_bench(
+      block_compression_bench_compress<ns::TextureFormat::BC3, 1>,
+      "BC3 1024: 1 thread", 22);
+  bench_manager_register_bench(
+      block_compression_bench_compress<ns::TextureFormat::BC3, 0>,
+      "BC3 1024: threaded", 22);
+
+  std::string first = std::string(NS_BENCH_ASSET_PATH "/textures/") +
+                      bench_textures[0] + ".png";
+  if (!ns::fs::exists(first.c_str())) {
+    NS_WARN("Assets not found in '%s', skipping the compressed texture "
+            "benchmarks.",
+            NS_BENCH_ASSET_PATH);
+    return;
+  }
+  std::atexit(block_compression_bench_cleanup);
+
+  bench_manager_register_bench(
+      block_compression_bench_cold,
+      "testbed textures: compressed, cold cache (decode + compress + store)",
+      11);
+  bench_manager_register_bench(block_compression_bench_warm,
+                               "testbed textures: compressed, warm cache (map)",
+                               1100);
+}
@@ -0,0 +1,145 @@
+#include "./material_bench.h"
+#include "../bench_manager.h"
+#include "./bench_resources.h"
+
+#include <containers/hashtable.h>
+#include <core/logger.h>
+#include <core/memory.h>
+#include <resources/loaders/material_loader.h>
+#include <systems/resource_system.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <new>
+
+// The cost of material_system_acquire(name) without the renderer: the
+// registry is a chashtable like the one of the material system.
+//
+// Loaded: the material is registered. Before, the file was still loaded and
+// parsed to get the name of the material, now only the registry is read.
+// Cold: the material is loaded from its cooked file (in the page cache),
+// checked against its text file as in development, or without a text file.
+
+#define MATERIAL_BENCH_DIR "bench_materials"
+#define MATERIAL_BENCH_TABLE_SIZE 1024
+
+// Same as in material_system.cpp
+struct material_bench_reference {
+  u64 reference_count;
+  u32 handle;
+  bool auto_release;
+};
+
+static ns::chashtable *bench_registry;
+
+static u64 material_bench_lookup(cstr name) {
+  material_bench_reference ref{};
+  bench_registry->get(name, &ref);
+  ref.reference_count++;
+  bench_registry->set(name, &ref);
+  return ref.handle;
+}
+
+static u64 material_bench_load(cstr name) {
+  ns::Resource resource;
+  if (!ns::resource_system_load(name, ns::ResourceType::MATERIAL, &resource)) {
+    return 0;
+  }
+  u64 sum = reinterpret_cast<ns::MaterialConfig *>(resource.data)->name[0];
+  ns::resource_system_unload(&resource);
+  return sum;
+}
+
+static void material_bench_acquire_loaded_before(u64 iterations) {
+  bench_resource_system_use(MATERIAL_BENCH_DIR, nullptr, 0, false, 0, true);
+  for (u64 i = 0; i < iterations; i++) {
+    ns::Resource resource;
+    ns::resource_system_load("text", ns::ResourceType::MATERIAL, &resource);
+    auto config = reinterpret_cast<ns::MaterialConfig *>(resource.data);
+    bench_do_not_optimize(material_bench_lookup(config->name));
+    ns::resource_system_unload(&resource);
+  }
+}
+
+static void material_bench_acquire_loaded(u64 iterations) {
+  bench_resource_system_use(MATERIAL_BENCH_DIR, nullptr, 0, false, 0, true);
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(material_bench_lookup("text"));
+  }
+}
+
+static void material_bench_load_text(u64 iterations) {
+  bench_resource_system_use(MATERIAL_BENCH_DIR, nullptr, 0, false, 0, true);
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(material_bench_load("text"));
+  }
+}
+
+static void material_bench_load_cooked(u64 iterations) {
+  bench_resource_system_use(MATERIAL_BENCH_DIR, nullptr, 0, false, 0, true);
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(material_bench_load("cooked"));
+  }
+}
+
+static void material_bench_cleanup() {
+  std::filesystem::remove_all(MATERIAL_BENCH_DIR);
+}
+
+static bool material_bench_write(cstr path, void const *data, usize size) {
+  FILE *f = std::fopen(path, "wb");
+  if (!f) {
+    return false;
+  }
+  bool written = std::fwrite(data, 1, size, f) == size;
+  std::fclose(f);
+  return written;
+}
+
+void material_register_benches() {
+  // "text" is a .nsmt file, cooked on its first load, "cooked" only a .nsmb
+  // file
+  cstr text = "# comment\n"
+              "version=0.1\n"
+              "name=text\n"
+              "diffuse_color=0.8 0.6 0.4 1.0\n"
+              "diffuse_map_name=Brick_01\n"
+              "type=world\n";
+  ns::material_binary binary;
+  ns::material_cook("cooked", text, std::strlen(text), &binary);
+  std::error_code error;
+  std::filesystem::create_directories(MATERIAL_BENCH_DIR "/materials", error);
+  if (error ||
+      !material_bench_write(MATERIAL_BENCH_DIR "/materials/text.nsmt", text,
+                            std::strlen(text)) ||
+      !material_bench_write(MATERIAL_BENCH_DIR "/materials/cooked.nsmb",
+                            &binary, sizeof(binary))) {
+    NS_WARN("Can't write '%s', skipping the material benchmarks.",
+            MATERIAL_BENCH_DIR);
+    return;
+  }
+
+  std::atexit(material_bench_cleanup);
+
+  ptr table = ns::alloc(sizeof(material_bench_reference) *
+                            MATERIAL_BENCH_TABLE_SIZE,
+                        ns::MemTag::APPLICATION);
+  bench_registry = ns::alloc_n<ns::chashtable>(1, ns::MemTag::APPLICATION);
+  new (bench_registry) ns::chashtable(sizeof(material_bench_reference),
+                                      MATERIAL_BENCH_TABLE_SIZE, table);
+  material_bench_reference loaded = {1, 0, true};
+  bench_registry->set("text", &loaded);
+
+  bench_manager_register_bench(material_bench_acquire_loaded_before,
+                               "material acquire, loaded (load + lookup)",
+                               22000);
+  bench_manager_register_bench(material_bench_acquire_loaded,
+                               "material acquire, loaded (lookup)", 2200000);
+  bench_manager_register_bench(
+      material_bench_load_text,
+      "material load, cold (.nsmb checked against the .nsmt)", 22000);
+  bench_manager_register_bench(material_bench_load_cooked,
+                               "material load, cold (.nsmb cooked)", 22000);
+}
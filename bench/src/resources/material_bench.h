@@ -0,0 +1,6 @@
+#ifndef MATERIAL_BENCH_HEADER_INCLUDED
+#define MATERIAL_BENCH_HEADER_INCLUDED
+
+void material_register_benches();
+
+#endif // MATERIAL_BENCH_HEADER_INCLUDED
@@ -0,0 +1,123 @@
+#include "./mesh_bench.h"
+#include "../bench_manager.h"
+#include "./bench_resources.h"
+
+#include <core/logger.h>
+#include <platform/filesystem.h>
+#include <resources/loaders/mesh_loader.h>
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdio.h>
+#include <vector>
+
+// Loading a mesh of 1M triangles (one iteration), then copying it to a
+// staging buffer as renderer_create_geometry does.
+//
+// Import: the .nsmesh file is deleted first, so the .obj file is parsed,
+// its corners deduplicated, its normals and tangents generated and the
+// .nsmesh file written. Cooked: the .nsmesh file is mapped. The files are in
+// the page cache.
+//
+// The mesh is a wavy grid of 708 x 708 quads, with texcoords and without
+// normals, written in the working directory by the first benchmark.
+
+#define MESH_BENCH_ASSETS "bench_mesh_assets"
+#define MESH_BENCH_NAME "grid"
+#define MESH_BENCH_GRID_SIZE 708
+
+static std::vector<u8> bench_staging;
+
+static void mesh_bench_cleanup() {
+  std::error_code error;
+  std::filesystem::remove_all(MESH_BENCH_ASSETS, error);
+}
+
+static bool mesh_bench_write_grid() {
+  std::error_code error;
+  std::filesystem::create_directories(MESH_BENCH_ASSETS "/models", error);
+  FILE *f = fopen(MESH_BENCH_ASSETS "/models/" MESH_BENCH_NAME ".obj", "wb");
+  if (!f) {
+    return false;
+  }
+  u32 n = MESH_BENCH_GRID_SIZE + 1;
+  for (u32 y = 0; y < n; y++) {
+    for (u32 x = 0; x < n; x++) {
+      f32 h = 0.25f * std::sin(x * 0.05f) * std::cos(y * 0.07f);
+      fprintf(f, "v %.6f %.6f %.6f\n", x * 0.01f, h, y * 0.01f);
+    }
+  }
+  for (u32 y = 0; y < n; y++) {
+    for (u32 x = 0; x < n; x++) {
+      fprintf(f, "vt %.6f %.6f\n", static_cast<f32>(x) / (n - 1),
+              static_cast<f32>(y) / (n - 1));
+    }
+  }
+  for (u32 y = 0; y + 1 < n; y++) {
+    for (u32 x = 0; x + 1 < n; x++) {
+      u32 a = y * n + x + 1;
+      u32 b = a + 1;
+      u32 c = a + n + 1;
+      u32 d = a + n;
+      fprintf(f, "f %u/%u %u/%u %u/%u\nf %u/%u %u/%u %u/%u\n", a, a, d, d, c,
+              c, a, a, c, c, b, b);
+    }
+  }
+  return fclose(f) == 0;
+}
+
+static void mesh_bench_init() {
+  static bool written = false;
+  if (written) {
+    return;
+  }
+  written = true;
+  std::atexit(mesh_bench_cleanup);
+  if (!mesh_bench_write_grid()) {
+    NS_WARN("Failed to write the mesh of the benchmarks in '%s'.",
+            MESH_BENCH_ASSETS);
+  }
+}
+
+static u64 mesh_bench_load() {
+  ns::MeshResourceData mesh;
+  if (!ns::mesh_loader_decode(MESH_BENCH_NAME, &mesh)) {
+    return 0;
+  }
+  usize vertices_size = sizeof(ns::vertex_3d) * mesh.vertex_count;
+  usize indices_size = static_cast<usize>(mesh.index_size) * mesh.index_count;
+  if (vertices_size + indices_size > bench_staging.size()) {
+    bench_staging.resize(vertices_size + indices_size);
+  }
+  std::memcpy(bench_staging.data(), mesh.vertices, vertices_size);
+  std::memcpy(bench_staging.data() + vertices_size, mesh.indices,
+              indices_size);
+  u64 sum = bench_staging[vertices_size / 2] + mesh.index_count;
+  ns::mesh_loader_free(&mesh);
+  return sum;
+}
+
+static void mesh_bench_import(u64 iterations) {
+  mesh_bench_init();
+  bench_resource_system_use(MESH_BENCH_ASSETS, nullptr, 0);
+  for (u64 i = 0; i < iterations; i++) {
+    ns::fs::remove(MESH_BENCH_ASSETS "/models/" MESH_BENCH_NAME ".nsmesh");
+    bench_do_not_optimize(mesh_bench_load());
+  }
+}
+
+static void mesh_bench_cooked(u64 iterations) {
+  mesh_bench_init();
+  bench_resource_system_use(MESH_BENCH_ASSETS, nullptr, 0);
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(mesh_bench_load());
+  }
+}
+
+void mesh_register_benches() {
+  bench_manager_register_bench(mesh_bench_import,
+                               "mesh 1M triangles: import (parse + cook)", 11);
+  bench_manager_register_bench(mesh_bench_cooked,
+                               "mesh 1M triangles: cooked (map)", 110);
+}
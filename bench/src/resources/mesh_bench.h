@@ -0,0 +1,6 @@
+#ifndef MESH_BENCH_HEADER_INCLUDED
+#define MESH_BENCH_HEADER_INCLUDED
+
+void mesh_register_benches();
+
+#endif // MESH_BENCH_HEADER_INCLUDED
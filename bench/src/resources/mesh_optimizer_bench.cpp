@@ -0,0 +1,124 @@
+#include "./mesh_optimizer_bench.h"
+#include "../bench_manager.h"
+
+#include <core/logger.h>
+#include <resources/mesh_optimizer.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// The passes of mesh_optimizer.h on a grid of 512 x 512 quads (524288
+// triangles, one iteration each): the vertex cache order from the shuffled
+// triangles, the overdraw order from the vertex cache one, then the vertex
+// fetch order.
+//
+// The first vertex cache run logs the ACMR and ATVR of the rows order of
+// the grid (as exported), of the shuffled order and of the optimized one.
+
+#define MESH_OPTIMIZER_BENCH_GRID_SIZE 512
+
+static std::vector<ns::vec3> bench_positions;
+static std::vector<u32> bench_rows;
+static std::vector<u32> bench_shuffled;
+static std::vector<u32> bench_optimized;
+static std::vector<u32> bench_work;
+static std::vector<u32> bench_remap;
+
+static void mesh_optimizer_bench_init() {
+  if (!bench_rows.empty()) {
+    return;
+  }
+  u32 n = MESH_OPTIMIZER_BENCH_GRID_SIZE + 1;
+  for (u32 y = 0; y < n; y++) {
+    for (u32 x = 0; x < n; x++) {
+      f32 h = 0.25f * std::sin(x * 0.05f) * std::cos(y * 0.07f);
+      bench_positions.push_back(ns::vec3{x * 0.01f, h, y * 0.01f});
+    }
+  }
+  for (u32 y = 0; y + 1 < n; y++) {
+    for (u32 x = 0; x + 1 < n; x++) {
+      u32 a = y * n + x;
+      u32 quad[6] = {a, a + n, a + n + 1, a, a + n + 1, a + 1};
+      bench_rows.insert(bench_rows.end(), quad, quad + 6);
+    }
+  }
+  bench_shuffled = bench_rows;
+  u32 state = 12345;
+  for (u32 t = static_cast<u32>(bench_shuffled.size() / 3) - 1; t > 0; t--) {
+    state = state * 1664525u + 1013904223u;
+    u32 other = (state >> 8) % (t + 1);
+    for (u32 k = 0; k < 3; k++) {
+      std::swap(bench_shuffled[t * 3 + k], bench_shuffled[other * 3 + k]);
+    }
+  }
+  bench_optimized = bench_shuffled;
+  ns::mesh_optimize_vertex_cache(bench_optimized.data(),
+                                 static_cast<u32>(bench_optimized.size()),
+                                 static_cast<u32>(bench_positions.size()));
+  bench_work.resize(bench_rows.size());
+  bench_remap.resize(bench_positions.size());
+}
+
+static void mesh_optimizer_bench_report(cstr order,
+                                        std::vector<u32> const &indices) {
+  ns::mesh_cache_stats stats = ns::mesh_analyze_vertex_cache(
+      indices.data(), static_cast<u32>(indices.size()),
+      static_cast<u32>(bench_positions.size()), MESH_CACHE_SIMULATION_SIZE);
+  NS_INFO("grid %s: ACMR %.3f, ATVR %.3f (FIFO of %u)", order, stats.acmr,
+          stats.atvr, MESH_CACHE_SIMULATION_SIZE);
+}
+
+static void mesh_optimizer_bench_vertex_cache(u64 iterations) {
+  mesh_optimizer_bench_init();
+  u32 index_count = static_cast<u32>(bench_shuffled.size());
+  for (u64 i = 0; i < iterations; i++) {
+    std::memcpy(bench_work.data(), bench_shuffled.data(),
+                sizeof(u32) * index_count);
+    ns::mesh_optimize_vertex_cache(bench_work.data(), index_count,
+                                   static_cast<u32>(bench_positions.size()));
+    bench_do_not_optimize(bench_work[index_count / 2]);
+  }
+  static bool reported = false;
+  if (!reported && iterations > 0) {
+    reported = true;
+    mesh_optimizer_bench_report("rows", bench_rows);
+    mesh_optimizer_bench_report("shuffled", bench_shuffled);
+    mesh_optimizer_bench_report("vertex cache order", bench_work);
+  }
+}
+
+static void mesh_optimizer_bench_overdraw(u64 iterations) {
+  mesh_optimizer_bench_init();
+  u32 index_count = static_cast<u32>(bench_optimized.size());
+  for (u64 i = 0; i < iterations; i++) {
+    std::memcpy(bench_work.data(), bench_optimized.data(),
+                sizeof(u32) * index_count);
+    ns::mesh_optimize_overdraw(bench_work.data(), index_count,
+                               bench_positions.data(), sizeof(ns::vec3),
+                               static_cast<u32>(bench_positions.size()),
+                               MESH_OVERDRAW_DEFAULT_THRESHOLD);
+    bench_do_not_optimize(bench_work[index_count / 2]);
+  }
+}
+
+static void mesh_optimizer_bench_vertex_fetch(u64 iterations) {
+  mesh_optimizer_bench_init();
+  u32 index_count = static_cast<u32>(bench_optimized.size());
+  for (u64 i = 0; i < iterations; i++) {
+    std::memcpy(bench_work.data(), bench_optimized.data(),
+                sizeof(u32) * index_count);
+    bench_do_not_optimize(ns::mesh_optimize_vertex_fetch(
+        bench_work.data(), index_count,
+        static_cast<u32>(bench_positions.size()), bench_remap.data()));
+  }
+}
+
+void mesh_optimizer_register_benches() {
+  bench_manager_register_bench(mesh_optimizer_bench_vertex_cache,
+                               "mesh 512K triangles: vertex cache order", 11);
+  bench_manager_register_bench(mesh_optimizer_bench_overdraw,
+                               "mesh 512K triangles: overdraw order", 11);
+  bench_manager_register_bench(mesh_optimizer_bench_vertex_fetch,
+                               "mesh 512K triangles: vertex fetch order", 110);
+}
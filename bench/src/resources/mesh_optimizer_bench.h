@@ -0,0 +1,6 @@
+#ifndef MESH_OPTIMIZER_BENCH_HEADER_INCLUDED
+#define MESH_OPTIMIZER_BENCH_HEADER_INCLUDED
+
+void mesh_optimizer_register_benches();
+
+#endif // MESH_OPTIMIZER_BENCH_HEADER_INCLUDED
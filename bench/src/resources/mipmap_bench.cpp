@@ -0,0 +1,69 @@
+#include "./mipmap_bench.h"
+#include "../bench_manager.h"
+
+#include <defines.h>
+#include <math/random.h>
+#include <resources/mipmap.h>
+
+#include <vector>
+
+// Generation of the mip chain of a 1024x1024 sRGB image (one iteration), as
+// the image loader does after decoding: the scalar reference, the SIMD code
+// on one thread, then on one thread per core (at most
+// ROW_BANDS_MAX_THREAD_COUNT, see row_bands.h).
+
+#define MIPMAP_BENCH_SIZE 1024
+
+static std::vector<u8> bench_levels;
+
+static void mipmap_bench_init() {
+  if (!bench_levels.empty()) {
+    return;
+  }
+  u32 count = ns::mip_count(MIPMAP_BENCH_SIZE, MIPMAP_BENCH_SIZE);
+  bench_levels.resize(
+      ns::mip_chain_size(MIPMAP_BENCH_SIZE, MIPMAP_BENCH_SIZE, count));
+  // Noise: the values do not change the cost
+  ns::rng g(1);
+  for (usize i = 0; i < MIPMAP_BENCH_SIZE * MIPMAP_BENCH_SIZE * 4; i++) {
+    bench_levels[i] = static_cast<u8>(g.next_u32());
+  }
+}
+
+template <ns::MipFilter FILTER, bool REFERENCE, u32 THREAD_COUNT>
+static void mipmap_bench_generate(u64 iterations) {
+  mipmap_bench_init();
+  u32 count = ns::mip_count(MIPMAP_BENCH_SIZE, MIPMAP_BENCH_SIZE);
+  ns::mip_config config = {FILTER, true, THREAD_COUNT};
+  for (u64 i = 0; i < iterations; i++) {
+    if (REFERENCE) {
+      ns::mip_generate_reference(bench_levels.data(), MIPMAP_BENCH_SIZE,
+                                 MIPMAP_BENCH_SIZE, count, &config);
+    } else {
+      ns::mip_generate(bench_levels.data(), MIPMAP_BENCH_SIZE,
+                       MIPMAP_BENCH_SIZE, count, &config);
+    }
+    bench_do_not_optimize(bench_levels.back());
+  }
+}
+
+void mipmap_register_benches() {
+  bench_manager_register_bench(
+      mipmap_bench_generate<ns::MipFilter::BOX, true, 1>,
+      "mip chain 1024 box: scalar reference", 110);
+  bench_manager_register_bench(
+      mipmap_bench_generate<ns::MipFilter::BOX, false, 1>,
+      "mip chain 1024 box: 1 thread", 110);
+  bench_manager_register_bench(
+      mipmap_bench_generate<ns::MipFilter::BOX, false, 0>,
+      "mip chain 1024 box: threaded", 110);
+  bench_manager_register_bench(
+      mipmap_bench_generate<ns::MipFilter::KAISER, true, 1>,
+      "mip chain 1024 kaiser: scalar reference", 22);
+  bench_manager_register_bench(
+      mipmap_bench_generate<ns::MipFilter::KAISER, false, 1>,
+      "mip chain 1024 kaiser: 1 thread", 22);
+  bench_manager_register_bench(
+      mipmap_bench_generate<ns::MipFilter::KAISER, false, 0>,
+      "mip chain 1024 kaiser: threaded", 22);
+}
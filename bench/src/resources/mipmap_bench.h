@@ -0,0 +1,6 @@
+#ifndef MIPMAP_BENCH_HEADER_INCLUDED
+#define MIPMAP_BENCH_HEADER_INCLUDED
+
+void mipmap_register_benches();
+
+#endif // MIPMAP_BENCH_HEADER_INCLUDED
@@ -0,0 +1,214 @@
+#include "./pack_bench.h"
+#include "../bench_manager.h"
+
+#include <core/logger.h>
+#include <core/memory.h>
+#include <platform/filesystem.h>
+#include <resources/pack.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Loading every file of the asset tree (one iteration), from the loose files
+// like binary_loader (open, read into an allocation, close) against the
+// mapped pack (lookup, then touching every page of the file).
+//
+// Warm: the files are in the page cache, and the pack is already mapped.
+// Cold: the pack is mapped and checked in the iteration, and the "uncached"
+// variants also drop the files from the page cache first (posix_fadvise, the
+// kernel may ignore it, e.g. on tmpfs).
+
+#ifndef NS_BENCH_ASSET_PATH
+#define NS_BENCH_ASSET_PATH "../assets"
+#endif
+
+#define PACK_BENCH_PATH "bench_assets.nspak"
+#define PACK_BENCH_LZ4_PATH "bench_assets_lz4.nspak"
+#define PACK_BENCH_PAGE_SIZE 4096
+
+struct pack_bench_file {
+  std::string name;
+  std::string path;
+};
+
+static std::vector<pack_bench_file> bench_files;
+static ns::pack bench_pack;
+static ns::pack bench_pack_lz4;
+static std::vector<u8> bench_buffer;
+
+static void pack_bench_drop_cache(cstr path) {
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+static u64 pack_bench_touch(u8 const *data, usize size) {
+  u64 sum = 0;
+  for (usize i = 0; i < size; i += PACK_BENCH_PAGE_SIZE) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+static u64 pack_bench_load_loose() {
+  u64 sum = 0;
+  for (pack_bench_file const &file : bench_files) {
+    ns::fs::File f;
+    usize size = 0;
+    if (!ns::fs::open(file.path.c_str(), ns::fs::Mode::READ, true, &f) ||
+        !ns::fs::fsize(&f, &size)) {
+      continue;
+    }
+    u8 *data = reinterpret_cast<u8 *>(ns::alloc(size, ns::MemTag::ARRAY));
+    ns::fs::read_all_bytes(&f, data, nullptr);
+    ns::fs::close(&f);
+    sum += pack_bench_touch(data, size);
+    ns::free(data, size, ns::MemTag::ARRAY);
+  }
+  return sum;
+}
+
+// Compressed entries are decompressed in a reused buffer
+static u64 pack_bench_load_packed(ns::pack const *p) {
+  u64 sum = 0;
+  for (pack_bench_file const &file : bench_files) {
+    ns::pack_entry const *e = ns::pack_find(p, file.name.c_str());
+    ns::Slice<u8> view = ns::Slice<u8>::from_parts(nullptr, 0);
+    if (!ns::pack_view(p, e, &view)) {
+      ns::pack_read(p, e, bench_buffer.data());
+      view = ns::Slice<u8>::from_parts(bench_buffer.data(), e->size);
+    }
+    sum += pack_bench_touch(view.begin(), view.len());
+  }
+  return sum;
+}
+
+static void pack_bench_loose_warm(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(pack_bench_load_loose());
+  }
+}
+
+static void pack_bench_loose_uncached(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    for (pack_bench_file const &file : bench_files) {
+      pack_bench_drop_cache(file.path.c_str());
+    }
+    bench_do_not_optimize(pack_bench_load_loose());
+  }
+}
+
+static void pack_bench_pack_warm(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(pack_bench_load_packed(&bench_pack));
+  }
+}
+
+static void pack_bench_pack_lz4_warm(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(pack_bench_load_packed(&bench_pack_lz4));
+  }
+}
+
+static void pack_bench_pack_cold(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    ns::pack p;
+    ns::pack_open(PACK_BENCH_PATH, &p);
+    bench_do_not_optimize(pack_bench_load_packed(&p));
+    ns::pack_close(&p);
+  }
+}
+
+static void pack_bench_pack_uncached(u64 iterations) {
+  for (u64 i = 0; i < iterations; i++) {
+    pack_bench_drop_cache(PACK_BENCH_PATH);
+    ns::pack p;
+    ns::pack_open(PACK_BENCH_PATH, &p);
+    bench_do_not_optimize(pack_bench_load_packed(&p));
+    ns::pack_close(&p);
+  }
+}
+
+static void pack_bench_cleanup() {
+  ns::pack_close(&bench_pack);
+  ns::pack_close(&bench_pack_lz4);
+  std::remove(PACK_BENCH_PATH);
+  std::remove(PACK_BENCH_LZ4_PATH);
+}
+
+static bool pack_bench_write_packs() {
+  std::filesystem::path root = NS_BENCH_ASSET_PATH;
+  std::error_code error;
+  for (auto const &entry :
+       std::filesystem::recursive_directory_iterator(root, error)) {
+    if (entry.is_regular_file()) {
+      bench_files.push_back(
+          {entry.path().lexically_relative(root).generic_string(),
+           entry.path().string()});
+    }
+  }
+  if (error || bench_files.empty()) {
+    return false;
+  }
+
+  std::vector<ns::pack_source> sources;
+  usize total_size = 0;
+  for (pack_bench_file const &file : bench_files) {
+    ns::fs::File f;
+    usize size = 0;
+    if (!ns::fs::open(file.path.c_str(), ns::fs::Mode::READ, true, &f) ||
+        !ns::fs::fsize(&f, &size)) {
+      break;
+    }
+    u8 *data = reinterpret_cast<u8 *>(ns::alloc(size, ns::MemTag::ARRAY));
+    ns::fs::read_all_bytes(&f, data, nullptr);
+    ns::fs::close(&f);
+    sources.push_back({file.name.c_str(), data, size});
+    total_size += size;
+    if (size > bench_buffer.size()) {
+      bench_buffer.resize(size);
+    }
+  }
+  bool ok = sources.size() == bench_files.size() &&
+            ns::pack_write(PACK_BENCH_PATH, sources.data(),
+                           static_cast<u32>(sources.size()), false) &&
+            ns::pack_write(PACK_BENCH_LZ4_PATH, sources.data(),
+                           static_cast<u32>(sources.size()), true);
+  for (ns::pack_source const &s : sources) {
+    ns::free(const_cast<u8 *>(s.data), s.size, ns::MemTag::ARRAY);
+  }
+  NS_INFO("Asset tree: %llu files, %llu bytes.", bench_files.size(),
+          total_size);
+  return ok;
+}
+
+void pack_register_benches() {
+  if (!pack_bench_write_packs() ||
+      !ns::pack_open(PACK_BENCH_PATH, &bench_pack) ||
+      !ns::pack_open(PACK_BENCH_LZ4_PATH, &bench_pack_lz4)) {
+    NS_WARN("Assets not found in '%s', skipping the pack benchmarks.",
+            NS_BENCH_ASSET_PATH);
+    return;
+  }
+  std::atexit(pack_bench_cleanup);
+
+  bench_manager_register_bench(pack_bench_loose_warm,
+                               "asset tree: loose files (warm)", 220);
+  bench_manager_register_bench(pack_bench_loose_uncached,
+                               "asset tree: loose files (uncached)", 110);
+  bench_manager_register_bench(pack_bench_pack_warm,
+                               "asset tree: pack (warm)", 2200);
+  bench_manager_register_bench(pack_bench_pack_lz4_warm,
+                               "asset tree: pack, LZ4 (warm)", 220);
+  bench_manager_register_bench(pack_bench_pack_cold,
+                               "asset tree: pack (cold, open + map)", 2200);
+  bench_manager_register_bench(pack_bench_pack_uncached,
+                               "asset tree: pack (uncached)", 110);
+}
@@ -0,0 +1,6 @@
+#ifndef PACK_BENCH_HEADER_INCLUDED
+#define PACK_BENCH_HEADER_INCLUDED
+
+void pack_register_benches();
+
+#endif // PACK_BENCH_HEADER_INCLUDED
@@ -0,0 +1,64 @@
+#include "./resource_cache_bench.h"
+#include "../bench_manager.h"
+#include "./bench_resources.h"
+
+#include <core/logger.h>
+#include <systems/resource_system.h>
+
+// The texture swap of the debug event, at the resource level: the current
+// image is released and the other one loaded (one iteration per swap).
+//
+// Uncached: every swap decodes the PNG file again. Cached: the released
+// image stays in the resource cache, and the swap back is a hit. The first
+// cached run logs the stats of the cache.
+
+#ifndef NS_BENCH_ASSET_PATH
+#define NS_BENCH_ASSET_PATH "../assets"
+#endif
+
+#define RESOURCE_CACHE_BENCH_BUDGET (64ull * 1024 * 1024)
+
+static cstr const bench_swap_names[2] = {"Brick_01", "Brick_02"};
+
+static void resource_cache_bench_swap(u64 iterations) {
+  ns::Resource current;
+  if (!ns::resource_system_load(bench_swap_names[0], ns::ResourceType::IMAGE,
+                                &current)) {
+    return;
+  }
+  for (u64 i = 0; i < iterations; i++) {
+    ns::resource_system_unload(&current);
+    ns::resource_system_load(bench_swap_names[(i + 1) % 2],
+                             ns::ResourceType::IMAGE, &current);
+    bench_do_not_optimize(current.data);
+  }
+  ns::resource_system_unload(&current);
+}
+
+static void resource_cache_bench_uncached(u64 iterations) {
+  bench_resource_system_use(NS_BENCH_ASSET_PATH, nullptr, 0);
+  resource_cache_bench_swap(iterations);
+}
+
+static void resource_cache_bench_cached(u64 iterations) {
+  bench_resource_system_use(NS_BENCH_ASSET_PATH, nullptr, 0, false,
+                            RESOURCE_CACHE_BENCH_BUDGET);
+  resource_cache_bench_swap(iterations);
+  static bool reported = false;
+  if (!reported && iterations > 0) {
+    reported = true;
+    ns::resource_cache_stats stats =
+        ns::resource_cache_get_stats(ns::resource_system_resource_cache());
+    NS_INFO("resource cache: %llu hits, %llu misses, %llu evictions, %.2f "
+            "MiB cached",
+            stats.hit_count, stats.miss_count, stats.eviction_count,
+            stats.size / (1024.0 * 1024.0));
+  }
+}
+
+void resource_cache_register_benches() {
+  bench_manager_register_bench(resource_cache_bench_uncached,
+                               "texture swap: uncached (decode)", 110);
+  bench_manager_register_bench(resource_cache_bench_cached,
+                               "texture swap: resource cache (hit)", 1100);
+}
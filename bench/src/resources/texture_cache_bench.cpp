@@ -0,0 +1,110 @@
+#include "./texture_cache_bench.h"
+#include "../bench_manager.h"
+#include "./bench_resources.h"
+
+#include <core/logger.h>
+#include <platform/filesystem.h>
+#include <resources/loaders/image_loader.h>
+#include <resources/block_compression.h>
+
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+// Loading the textures of the testbed at startup (one iteration), as the
+// texture system does: the image of each texture is loaded with its mip
+// chain, then copied to a staging buffer by renderer_create_texture.
+//
+// No cache: the PNG files are decoded. Cold: the cache files are deleted
+// first, so the images are decoded and written to the cache. Warm: the cache
+// files are mapped. The files are in the page cache.
+
+#ifndef NS_BENCH_ASSET_PATH
+#define NS_BENCH_ASSET_PATH "../assets"
+#endif
+
+#define TEXTURE_CACHE_BENCH_DIR "bench_texture_cache"
+#define TEXTURE_CACHE_BENCH_BUDGET (64 * 1024 * 1024)
+
+static cstr bench_textures[] = {
+    "Brick_01", "Brick_01_Nrm", "Brick_02", "Brick_02_Nrm", "Brick_03",
+    "Brick_03_Nrm", "Brick_04", "Brick_04_Nrm", "prototype",
+};
+
+static std::vector<u8> bench_staging;
+
+static u64 texture_cache_bench_load_all() {
+  u64 sum = 0;
+  for (cstr name : bench_textures) {
+    ns::ImageResourceData image;
+    if (!ns::image_loader_decode(name, &image)) {
+      continue;
+    }
+    usize size = ns::texture_format_chain_size(image.format, image.width,
+                                               image.height, image.mip_count);
+    if (size > bench_staging.size()) {
+      bench_staging.resize(size);
+    }
+    std::memcpy(bench_staging.data(), image.pixels, size);
+    sum += bench_staging[size / 2];
+    ns::image_loader_free_pixels(&image);
+  }
+  return sum;
+}
+
+static void texture_cache_bench_clear() {
+  std::error_code error;
+  for (auto const &entry :
+       std::filesystem::directory_iterator(TEXTURE_CACHE_BENCH_DIR, error)) {
+    ns::fs::remove(entry.path().string().c_str());
+  }
+}
+
+static void texture_cache_bench_no_cache(u64 iterations) {
+  bench_resource_system_use(NS_BENCH_ASSET_PATH, nullptr, 0);
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(texture_cache_bench_load_all());
+  }
+}
+
+static void texture_cache_bench_cold(u64 iterations) {
+  bench_resource_system_use(NS_BENCH_ASSET_PATH, TEXTURE_CACHE_BENCH_DIR,
+                            TEXTURE_CACHE_BENCH_BUDGET);
+  for (u64 i = 0; i < iterations; i++) {
+    texture_cache_bench_clear();
+    bench_do_not_optimize(texture_cache_bench_load_all());
+  }
+}
+
+static void texture_cache_bench_warm(u64 iterations) {
+  bench_resource_system_use(NS_BENCH_ASSET_PATH, TEXTURE_CACHE_BENCH_DIR,
+                            TEXTURE_CACHE_BENCH_BUDGET);
+  for (u64 i = 0; i < iterations; i++) {
+    bench_do_not_optimize(texture_cache_bench_load_all());
+  }
+}
+
+static void texture_cache_bench_cleanup() {
+  std::error_code error;
+  std::filesystem::remove_all(TEXTURE_CACHE_BENCH_DIR, error);
+}
+
+void texture_cache_register_benches() {
+  std::string first = std::string(NS_BENCH_ASSET_PATH "/textures/") +
+                      bench_textures[0] + ".png";
+  if (!ns::fs::exists(first.c_str())) {
+    NS_WARN("Assets not found in '%s', skipping the texture cache "
+            "benchmarks.",
+            NS_BENCH_ASSET_PATH);
+    return;
+  }
+  std::atexit(texture_cache_bench_cleanup);
+
+  bench_manager_register_bench(texture_cache_bench_no_cache,
+                               "testbed textures: decode (no cache)", 55);
+  bench_manager_register_bench(texture_cache_bench_cold,
+                               "testbed textures: cold cache (decode + store)",
+                               55);
+  bench_manager_register_bench(texture_cache_bench_warm,
+                               "testbed textures: warm cache (map)", 1100);
+}
@@ -0,0 +1,6 @@
+#ifndef TEXTURE_CACHE_BENCH_HEADER_INCLUDED
+#define TEXTURE_CACHE_BENCH_HEADER_INCLUDED
+
+void texture_cache_register_benches();
+
+#endif // TEXTURE_CACHE_BENCH_HEADER_INCLUDED
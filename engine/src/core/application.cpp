@@ -6,6 +6,7 @@
 #include "./input.h"
 #include "./logger.h"
 #include "./memory.h"
+#include "./profiler.h"
 #include "./string.h"
 
 #include "../memory/linear_allocator.h"
@@ -24,6 +25,11 @@
 
 namespace ns {
 
+// Longest frame delta fed to the fixed-timestep accumulator, in seconds.
+#define MAX_FRAME_DELTA 0.25
+// Maximum number of fixed updates run in a single frame.
+#define MAX_UPDATE_STEPS_PER_FRAME 8
+
 struct application_state {
   game *game_inst;
   bool is_running;
@@ -32,8 +38,13 @@ struct application_state {
   i16 height;
   clock_t clock;
   f64 last_time;
+  frame_pacer pacer;
+  f64 update_accumulator;
   linear_allocator systems_allocator;
 
+  u64 profiler_system_memory_requirement;
+  ptr profiler_system_state;
+
   u64 event_system_memory_requirement;
   ptr event_system_state;
 
@@ -91,7 +102,7 @@ bool application_on_debug_event(u16, ptr, ptr, event_context) {
 
   if (app_state->test_geometry) {
     app_state->test_geometry->material->diffuse_map.texture =
-        texture_system_acquire(names[choice], true);
+        texture_system_acquire_async(names[choice], true);
     if (!app_state->test_geometry->material->diffuse_map.texture) {
       NS_WARN("Unable to load texture '%s' for test geometry, using default.",
               names[choice]);
@@ -135,6 +146,14 @@ bool application_create(game *game_inst) {
       linear_allocator(systems_allocator_total_size, nullptr);
 
   // initialize subsystems
+  profiler_config profiler_cfg{8, 4096, 256, 120, 65536};
+  profiler_system_initialize(&app_state->profiler_system_memory_requirement,
+                             nullptr, profiler_cfg);
+  app_state->profiler_system_state = app_state->systems_allocator.allocate(
+      app_state->profiler_system_memory_requirement);
+  profiler_system_initialize(&app_state->profiler_system_memory_requirement,
+                             app_state->profiler_system_state, profiler_cfg);
+
   event_system_initialize(&app_state->event_system_memory_requirement, nullptr);
   app_state->event_system_state = app_state->systems_allocator.allocate(
       app_state->event_system_memory_requirement);
@@ -177,7 +196,17 @@ bool application_create(game *game_inst) {
     return false;
   }
 
-  resource_system_config resource_sys_cfg{32, "../assets"};
+  // The decoded images are compressed (when the device supports it, see the
+  // renderer below) and cached in the working directory.
+  // The released resources stay loaded within 64 MiB, so that the textures
+  // swapped back and forth are not read again.
+  resource_system_config resource_sys_cfg;
+  resource_sys_cfg.texture_cache_path = "texture_cache";
+  resource_sys_cfg.texture_cache_budget = 256 * 1024 * 1024;
+  resource_sys_cfg.compress_textures = true;
+  resource_sys_cfg.cook_materials = game_inst->app_config.cook_materials;
+  resource_sys_cfg.cache.max_entry_count = 256;
+  resource_sys_cfg.cache.budget = 64 * 1024 * 1024;
   resource_system_initialize(&app_state->resource_system_memory_requirement,
                              nullptr, resource_sys_cfg);
   app_state->resource_system_state = app_state->systems_allocator.allocate(
@@ -199,8 +228,11 @@ bool application_create(game *game_inst) {
     NS_FATAL("Failed to initialize renderer. Aborting application.");
     return false;
   }
+  // Before the first texture: the renderer only needed the shaders so far
+  resource_system_set_compress_textures(
+      renderer_supports_texture_compression());
 
-  texture_system_config texture_sys_cfg{65536};
+  texture_system_config texture_sys_cfg{65536, 2, 256, 4};
   texture_system_initialize(&app_state->texture_system_memory_requirement,
                             nullptr, texture_sys_cfg);
   app_state->texture_system_state = app_state->systems_allocator.allocate(
@@ -239,11 +271,13 @@ bool application_create(game *game_inst) {
   // TEMP
   geometry_config config = geometry_config::plane(
       10.0f, 10.0f, 5, 5, 2.0f, 2.0f, "test geometry", "test_material");
+  config.vertex_format = VertexFormat::PACKED_HALF_UV;
   app_state->test_geometry = geometry_system_acquire(config, true);
 
   ns::free(config.vertices, sizeof(vertex_3d) * config.vertex_count,
            MemTag::ARRAY);
-  ns::free(config.indices, sizeof(u32) * config.index_count, MemTag::ARRAY);
+  ns::free(config.indices, config.index_size * config.index_count,
+           MemTag::ARRAY);
 
   geometry_config config2{};
   config2.vertex_size = sizeof(vertex_2d);
@@ -282,15 +316,21 @@ bool application_run() {
   app_state->clock.start();
   app_state->clock.update();
   app_state->last_time = app_state->clock.elapsed;
-  f64 running_time [[maybe_unused]] = 0.0;
-  u8 frame_count [[maybe_unused]] = 0;
-  f64 target_frame_seconds = 1.0 / 60.0;
+  application_config const &config = app_state->game_inst->app_config;
+  app_state->pacer.start(config.target_frame_rate);
+  app_state->update_accumulator = 0.0;
+  f64 fixed_delta =
+      config.fixed_update_rate > 0.0f ? 1.0 / config.fixed_update_rate : 0.0;
 
   NS_TRACE(get_memory_usage_str());
 
   while (app_state->is_running) {
-    if (!platform::pump_messages()) {
-      app_state->is_running = false;
+    NS_PROFILE_FRAME_BEGIN();
+    {
+      NS_PROFILE_SCOPE("pump_messages");
+      if (!platform::pump_messages()) {
+        app_state->is_running = false;
+      }
     }
 
     if (app_state->is_suspended)
@@ -299,20 +339,64 @@ bool application_run() {
     app_state->clock.update();
     f64 current_time = app_state->clock.elapsed;
     f64 delta = (current_time - app_state->last_time);
-    f64 frame_start_time = platform::get_absolute_time();
+    app_state->last_time = current_time;
+    f32 interpolation = 1.0f;
+
+    if (fixed_delta > 0.0) {
+      NS_PROFILE_SCOPE("update");
+      // Clamp to avoid spiraling when the updates are slower than real time.
+      app_state->update_accumulator +=
+          delta < MAX_FRAME_DELTA ? delta : MAX_FRAME_DELTA;
+      u32 steps = 0;
+      while (app_state->update_accumulator >= fixed_delta) {
+        if (!app_state->game_inst->update(app_state->game_inst,
+                                          static_cast<f32>(fixed_delta))) {
+          NS_FATAL("Game update failed, shutting down.");
+          app_state->is_running = false;
+          break;
+        }
+        // Input edges (pressed/released) are consumed by one update.
+        InputManager::update(fixed_delta);
+        app_state->update_accumulator -= fixed_delta;
+        if (++steps >= MAX_UPDATE_STEPS_PER_FRAME) {
+          app_state->update_accumulator = 0.0;
+          break;
+        }
+      }
+      if (!app_state->is_running) {
+        break;
+      }
+      interpolation =
+          static_cast<f32>(app_state->update_accumulator / fixed_delta);
+    } else {
+      NS_PROFILE_SCOPE("update");
+      if (!app_state->game_inst->update(app_state->game_inst,
+                                        static_cast<f32>(delta))) {
+        NS_FATAL("Game update failed, shutting down.");
+        app_state->is_running = false;
+        break;
+      }
+      InputManager::update(delta);
+    }
 
-    if (!app_state->game_inst->update(app_state->game_inst,
-                                      static_cast<f32>(delta))) {
-      NS_FATAL("Game update failed, shutting down.");
-      app_state->is_running = false;
-      break;
+    if (config.late_input_sampling) {
+      // Input received from here on is seen by render now, and by the next
+      // update as new (the input update above already ran).
+      NS_PROFILE_SCOPE("late_input");
+      if (!platform::pump_messages()) {
+        app_state->is_running = false;
+      }
     }
 
-    if (!app_state->game_inst->render(app_state->game_inst,
-                                      static_cast<f32>(delta))) {
-      NS_FATAL("Game render failed, shutting down.");
-      app_state->is_running = false;
-      break;
+    {
+      NS_PROFILE_SCOPE("render");
+      if (!app_state->game_inst->render(app_state->game_inst,
+                                        static_cast<f32>(delta),
+                                        interpolation)) {
+        NS_FATAL("Game render failed, shutting down.");
+        app_state->is_running = false;
+        break;
+      }
     }
 
     // TODO(ClementChambard): refactor packet creation
@@ -331,27 +415,16 @@ bool application_run() {
     packet.ui_geometry_count = 1;
     packet.ui_geometries = &test_ui_render;
 
-    renderer_draw_frame(&packet);
-
-    f64 frame_end_time = platform::get_absolute_time();
-    f64 frame_elapsed_time = frame_end_time - frame_start_time;
-    running_time += frame_elapsed_time;
-    f64 remaining_seconds = target_frame_seconds - frame_elapsed_time;
-
-    if (remaining_seconds > 0.0) {
-      u64 remaining_ms = (remaining_seconds * 1000);
+    // Between two frames: the uploads don't wait for a render pass
+    texture_system_process_async_loads();
 
-      bool limit_frames = false;
-      if (remaining_ms > 0 && limit_frames) {
-        platform::sleep(remaining_ms - 1);
-      }
+    renderer_draw_frame(&packet);
 
-      frame_count++;
+    {
+      NS_PROFILE_SCOPE("frame_pacing");
+      app_state->pacer.end_frame(config.limit_frames);
     }
-
-    InputManager::update(delta);
-
-    app_state->last_time = current_time;
+    NS_PROFILE_FRAME_END();
   }
 
   // temp
@@ -377,6 +450,8 @@ bool application_run() {
 
   event_system_shutdown(app_state->event_system_state);
 
+  profiler_system_shutdown(app_state->profiler_system_state);
+
   app_state->systems_allocator.~linear_allocator();
 
   game *game_inst = app_state->game_inst;
@@ -396,6 +471,10 @@ void application_get_framebuffer_size(u32 *width, u32 *height) {
   *height = app_state->height;
 }
 
+void application_get_frame_stats(frame_pacer_stats *out_stats) {
+  app_state->pacer.get_stats(out_stats);
+}
+
 bool application_on_event(u16 code, ptr, ptr, event_context) {
   switch (code) {
   case EVENT_CODE_APPLICATION_QUIT: {
@@ -2,6 +2,7 @@
 #define APPLICATION_HEADER_INCLUDED
 
 #include "../defines.h"
+#include "./frame_pacer.h"
 
 struct game;
 
@@ -13,6 +14,27 @@ struct application_config {
   i16 start_width;
   i16 start_height;
   cstr name;
+  /** Target frame rate of the main loop (0 for unlimited). */
+  f32 target_frame_rate;
+  /** Whether to wait for the target frame rate at the end of each frame. */
+  bool limit_frames;
+  /**
+   * Rate of the game update (0 to update once per frame with the frame's
+   * delta time). When set, update is called with a fixed delta time as many
+   * times as needed to catch up, and render receives the interpolation
+   * factor between the last two updates.
+   */
+  f32 fixed_update_rate;
+  /**
+   * Whether to pump the platform messages a second time right before render,
+   * so that render sees the most recent input (mouse position, keys).
+   */
+  bool late_input_sampling;
+  /**
+   * Whether the material text files are read, and cooked when they change,
+   * as in development. Off, only the materials cooked by nspak are read.
+   */
+  bool cook_materials;
 };
 
 NS_API bool application_create(game *game_inst);
@@ -21,6 +43,12 @@ NS_API bool application_run();
 
 void application_get_framebuffer_size(u32 *width, u32 *height);
 
+/**
+ * Gets the frame time statistics of the main loop
+ * @param out_stats the statistics
+ */
+NS_API void application_get_frame_stats(frame_pacer_stats *out_stats);
+
 } // namespace ns
 
 #endif // APPLICATION_HEADER_INCLUDED
@@ -17,4 +17,21 @@ void clock_t::start() {
 
 void clock_t::stop() { start_time = 0.0; }
 
+void tick_clock_t::update() {
+  if (start_ticks != 0) {
+    elapsed_ticks = platform::get_ticks() - start_ticks;
+  }
+}
+
+void tick_clock_t::start() {
+  start_ticks = platform::get_ticks();
+  elapsed_ticks = 0;
+}
+
+void tick_clock_t::stop() { start_ticks = 0; }
+
+f64 tick_clock_t::elapsed() const {
+  return platform::ticks_to_seconds(elapsed_ticks);
+}
+
 } // namespace ns
@@ -14,6 +14,26 @@ struct clock_t {
   void stop();
 };
 
+/**
+ * Same as clock_t, but counts platform ticks (see platform::get_ticks) as
+ * integers: cheaper to update and exact when accumulating many short
+ * intervals.
+ */
+struct tick_clock_t {
+  u64 start_ticks;
+  u64 elapsed_ticks;
+
+  void update();
+  void start();
+  void stop();
+
+  /**
+   * Gets the elapsed time
+   * @returns the elapsed time in seconds
+   */
+  f64 elapsed() const;
+};
+
 } // namespace ns
 
 #endif // CLOCK_HEADER_INCLUDED
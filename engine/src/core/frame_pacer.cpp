@@ -0,0 +1,127 @@
+#include "./frame_pacer.h"
+
+#include "../math/math.h"
+#include "../platform/platform.h"
+#include "./memory.h"
+
+namespace ns {
+
+// Threshold above which a frame is considered to have missed its deadline.
+#define FRAME_PACER_MISS_TOLERANCE 0.0005
+
+NS_INLINE void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+static f64 frame_pacer_platform_now(ptr) {
+  return platform::get_absolute_time();
+}
+
+static void frame_pacer_platform_sleep(ptr, u64 ms) { platform::sleep(ms); }
+
+void frame_pacer::start(f64 target_rate, frame_pacer_clock const *clock) {
+  mem_zero(this, sizeof(frame_pacer));
+  if (clock) {
+    this->clock = *clock;
+  } else {
+    this->clock.now = frame_pacer_platform_now;
+    this->clock.sleep = frame_pacer_platform_sleep;
+  }
+  // Pessimistic until the first sleeps are measured.
+  sleep_estimate = 0.005;
+  set_target_rate(target_rate);
+  last_frame_end = this->clock.now(this->clock.user_data);
+  deadline = last_frame_end + target_seconds;
+}
+
+void frame_pacer::set_target_rate(f64 target_rate) {
+  target_seconds = target_rate > 0.0 ? 1.0 / target_rate : 0.0;
+  history_count = 0;
+  history_index = 0;
+}
+
+f64 frame_pacer::end_frame(bool limit) {
+  f64 now = clock.now(clock.user_data);
+
+  if (limit && target_seconds > 0.0) {
+    // Coarse wait: the OS sleep overshoots, so only sleep while the remaining
+    // time is larger than the observed duration of a 1ms sleep.
+    while (deadline - now > sleep_estimate) {
+      f64 before = now;
+      clock.sleep(clock.user_data, 1);
+      now = clock.now(clock.user_data);
+
+      // Welford's online mean/variance of the sleep duration.
+      f64 observed = now - before;
+      sleep_count++;
+      f64 delta = observed - sleep_mean;
+      sleep_mean += delta / static_cast<f64>(sleep_count);
+      sleep_m2 += delta * (observed - sleep_mean);
+      f64 stddev = sleep_count > 1
+                       ? ns::sqrt(sleep_m2 / static_cast<f64>(sleep_count - 1))
+                       : 0.0;
+      sleep_estimate = sleep_mean + stddev;
+    }
+
+    // Fine wait
+    while (now < deadline) {
+      cpu_relax();
+      now = clock.now(clock.user_data);
+    }
+
+    // Keep a fixed schedule, but don't try to catch up after a long stall.
+    deadline += target_seconds;
+    if (now > deadline) {
+      deadline = now + target_seconds;
+    }
+  }
+
+  f64 frame_time = now - last_frame_end;
+  last_frame_end = now;
+
+  history[history_index] = frame_time;
+  history_index = (history_index + 1) % FRAME_PACER_HISTORY_SIZE;
+  if (history_count < FRAME_PACER_HISTORY_SIZE) {
+    history_count++;
+  }
+  return frame_time;
+}
+
+void frame_pacer::get_stats(frame_pacer_stats *out_stats) const {
+  mem_zero(out_stats, sizeof(frame_pacer_stats));
+  out_stats->target = target_seconds;
+  out_stats->frame_count = history_count;
+  if (history_count == 0) {
+    return;
+  }
+
+  f64 sum = 0.0;
+  out_stats->min = history[0];
+  out_stats->max = history[0];
+  for (u32 i = 0; i < history_count; i++) {
+    f64 t = history[i];
+    sum += t;
+    out_stats->min = t < out_stats->min ? t : out_stats->min;
+    out_stats->max = t > out_stats->max ? t : out_stats->max;
+    if (target_seconds > 0.0) {
+      f64 error = ns::abs(t - target_seconds);
+      out_stats->max_error =
+          error > out_stats->max_error ? error : out_stats->max_error;
+      if (t > target_seconds + FRAME_PACER_MISS_TOLERANCE) {
+        out_stats->missed_frames++;
+      }
+    }
+  }
+  out_stats->avg = sum / static_cast<f64>(history_count);
+
+  f64 variance = 0.0;
+  for (u32 i = 0; i < history_count; i++) {
+    f64 d = history[i] - out_stats->avg;
+    variance += d * d;
+  }
+  out_stats->jitter = ns::sqrt(variance / static_cast<f64>(history_count));
+}
+
+} // namespace ns
@@ -0,0 +1,91 @@
+#ifndef FRAME_PACER_HEADER_INCLUDED
+#define FRAME_PACER_HEADER_INCLUDED
+
+#include "../defines.h"
+
+namespace ns {
+
+#define FRAME_PACER_HISTORY_SIZE 128
+
+/**
+ * Frame time statistics over the last FRAME_PACER_HISTORY_SIZE frames, in
+ * seconds.
+ */
+struct frame_pacer_stats {
+  f64 target;
+  f64 min;
+  f64 avg;
+  f64 max;
+  /** Standard deviation of the frame time. */
+  f64 jitter;
+  /** Largest distance between a frame time and the target. */
+  f64 max_error;
+  /** Number of frames longer than the target (by more than 0.5ms). */
+  u32 missed_frames;
+  u32 frame_count;
+};
+
+/**
+ * The time source of a pacer: the platform clock, or a fake one in tests.
+ * @field now gets the current time, in seconds
+ * @field sleep sleeps for about ms milliseconds
+ * @field user_data passed to now and sleep
+ */
+struct frame_pacer_clock {
+  f64 (*now)(ptr user_data);
+  void (*sleep)(ptr user_data, u64 ms);
+  ptr user_data;
+};
+
+/**
+ * Paces frames at a fixed rate. The wait first sleeps with the OS timer while
+ * the remaining time is larger than the (measured) sleep accuracy, then spins
+ * until the deadline.
+ */
+struct frame_pacer {
+  frame_pacer_clock clock;
+  f64 target_seconds;
+  f64 deadline;
+  f64 last_frame_end;
+
+  // Running estimate of the duration of platform::sleep(1)
+  f64 sleep_estimate;
+  f64 sleep_mean;
+  f64 sleep_m2;
+  u64 sleep_count;
+
+  f64 history[FRAME_PACER_HISTORY_SIZE];
+  u32 history_count;
+  u32 history_index;
+
+  /**
+   * Starts pacing
+   * @param target_rate the target frame rate (0 for unlimited)
+   * @param clock the time source, nullptr for the platform clock
+   */
+  void start(f64 target_rate, frame_pacer_clock const *clock = nullptr);
+
+  /**
+   * Changes the target frame rate
+   * @param target_rate the target frame rate (0 for unlimited)
+   */
+  void set_target_rate(f64 target_rate);
+
+  /**
+   * Ends the current frame: waits for the next deadline if limit is set,
+   * then records the frame time.
+   * @param limit whether to wait for the deadline
+   * @returns the duration of the frame that just ended
+   */
+  f64 end_frame(bool limit);
+
+  /**
+   * Gets the frame time statistics
+   * @param out_stats the statistics
+   */
+  void get_stats(frame_pacer_stats *out_stats) const;
+};
+
+} // namespace ns
+
+#endif // FRAME_PACER_HEADER_INCLUDED
@@ -1,4 +1,5 @@
 #include "./input.h"
+#include "../platform/platform.h"
 #include "./event.h"
 #include "./memory.h"
 
@@ -23,6 +24,20 @@ void InputManager::update(f64 /* delta_time */) {
   mem_copy(instance->prev_mouse, instance->mouse, sizeof(instance->mouse));
   instance->prev_mouse_x = instance->mouse_x;
   instance->prev_mouse_y = instance->mouse_y;
+  instance->wheel = 0;
+  instance->frame_event_start = instance->event_head;
+}
+
+void InputManager::push_event(input_event_type type, u16 code, i16 x, i16 y,
+                              i8 wheel) {
+  input_event &e = events[event_head & (INPUT_EVENT_CAPACITY - 1)];
+  e.timestamp = platform::get_ticks();
+  e.type = type;
+  e.code = code;
+  e.x = x;
+  e.y = y;
+  e.wheel = wheel;
+  event_head++;
 }
 
 void InputManager::process_key(ns_key key, bool pressed) {
@@ -30,6 +45,9 @@ void InputManager::process_key(ns_key key, bool pressed) {
     return;
   if (instance->keyboard[key] != pressed) {
     instance->keyboard[key] = pressed;
+    instance->push_event(pressed ? input_event_type::KEY_PRESSED
+                                 : input_event_type::KEY_RELEASED,
+                         static_cast<u16>(key), 0, 0, 0);
 
     event_context context;
     context.data.U16[0] = key;
@@ -43,6 +61,9 @@ void InputManager::process_button(ns_btn button, bool pressed) {
     return;
   if (instance->mouse[button] != pressed) {
     instance->mouse[button] = pressed;
+    instance->push_event(pressed ? input_event_type::BUTTON_PRESSED
+                                 : input_event_type::BUTTON_RELEASED,
+                         static_cast<u16>(button), 0, 0, 0);
 
     event_context context;
     context.data.U16[0] = button;
@@ -55,24 +76,35 @@ void InputManager::process_mouse_move(i16 x, i16 y) {
   if (!instance)
     return;
   if (instance->mouse_x != x || instance->mouse_y != y) {
-    // NS_DEBUG("Mouse pos: %d, %d", x, y);
-
     instance->mouse_x = x;
     instance->mouse_y = y;
-
-    event_context context;
-    context.data.U16[0] = x;
-    context.data.U16[1] = y;
-    event_fire(EVENT_CODE_MOUSE_MOVED, nullptr, context);
+    instance->push_event(input_event_type::MOUSE_MOVED, 0, x, y, 0);
+    // EVENT_CODE_MOUSE_MOVED is fired once per pump, in flush_events.
+    instance->mouse_moved = true;
   }
 }
 
 void InputManager::process_mouse_wheel(i8 z_delta) {
+  if (instance) {
+    instance->wheel += z_delta;
+    instance->push_event(input_event_type::MOUSE_WHEEL, 0, 0, 0, z_delta);
+  }
   event_context context;
   context.data.U8[0] = z_delta;
   event_fire(EVENT_CODE_MOUSE_WHEEL, nullptr, context);
 }
 
+void InputManager::flush_events() {
+  if (!instance || !instance->mouse_moved)
+    return;
+  instance->mouse_moved = false;
+
+  event_context context;
+  context.data.U16[0] = static_cast<u16>(instance->mouse_x);
+  context.data.U16[1] = static_cast<u16>(instance->mouse_y);
+  event_fire(EVENT_CODE_MOUSE_MOVED, nullptr, context);
+}
+
 inline bool InputManager::_k(usize i) { return keyboard[i]; }
 inline bool InputManager::_pk(usize i) { return prev_keyboard[i]; }
 inline bool InputManager::_m(usize i) { return mouse[i]; }
@@ -89,6 +121,36 @@ inline void InputManager::_mm(i32 *x, i32 *y) {
   *x = mouse_x - prev_mouse_x;
   *y = mouse_y - prev_mouse_y;
 }
+inline i32 InputManager::_w() { return wheel; }
+inline u32 InputManager::_ec() {
+  // Events older than the ring capacity were overwritten.
+  u64 count = event_head - frame_event_start;
+  return static_cast<u32>(count < INPUT_EVENT_CAPACITY ? count
+                                                       : INPUT_EVENT_CAPACITY);
+}
+inline input_event const *InputManager::_e(u32 i) {
+  if (i >= _ec())
+    return nullptr;
+  u64 first = event_head - _ec();
+  return &events[(first + i) & (INPUT_EVENT_CAPACITY - 1)];
+}
+
+static u32 count_events(input_event_type type, u16 code) {
+  u32 count = 0;
+  u32 event_count = instance->_ec();
+  for (u32 i = 0; i < event_count; i++) {
+    input_event const *e = instance->_e(i);
+    if (e->type == type && e->code == code) {
+      count++;
+    }
+  }
+  return count;
+}
+
+NS_API u32 input_event_count() { return instance ? instance->_ec() : 0; }
+NS_API input_event const *input_get_event(u32 index) {
+  return instance ? instance->_e(index) : nullptr;
+}
 
 namespace keyboard {
 
@@ -102,6 +164,9 @@ NS_API bool down(ns_key key) { return instance->_k(key); }
 NS_API bool up(ns_key key) { return !instance->_k(key); }
 NS_API bool was_down(ns_key key) { return instance->_pk(key); }
 NS_API bool was_up(ns_key key) { return !instance->_pk(key); }
+NS_API u32 press_count(ns_key key) {
+  return count_events(input_event_type::KEY_PRESSED, static_cast<u16>(key));
+}
 
 } // namespace keyboard
 
@@ -121,6 +186,11 @@ NS_API bool was_up(ns_btn button) { return !instance->_pm(button); }
 NS_API void position(i32 *x, i32 *y) { instance->_mp(x, y); }
 NS_API void prev_position(i32 *x, i32 *y) { instance->_pmp(x, y); }
 NS_API void motion(i32 *x, i32 *y) { instance->_mm(x, y); }
+NS_API u32 press_count(ns_btn button) {
+  return count_events(input_event_type::BUTTON_PRESSED,
+                      static_cast<u16>(button));
+}
+NS_API i32 wheel() { return instance->_w(); }
 
 } // namespace mouse
 } // namespace ns
@@ -140,8 +140,39 @@ enum ns_key {
 
 #undef DEFINE_KEY
 
+// Capacity of the input event ring (must be a power of 2).
+#define INPUT_EVENT_CAPACITY 1024
+
 namespace ns {
 
+enum class input_event_type : u8 {
+  KEY_PRESSED,
+  KEY_RELEASED,
+  BUTTON_PRESSED,
+  BUTTON_RELEASED,
+  MOUSE_MOVED,
+  MOUSE_WHEEL,
+};
+
+/**
+ * An input event, as recorded when the platform messages are pumped
+ * @field timestamp the time at which the event was processed, in platform
+ *        ticks (see platform::get_ticks)
+ * @field type the type of the event
+ * @field code the key (ns_key) or button (ns_btn), for key/button events
+ * @field x the mouse x position, for motion events
+ * @field y the mouse y position, for motion events
+ * @field wheel the wheel delta, for wheel events
+ */
+struct input_event {
+  u64 timestamp;
+  input_event_type type;
+  i8 wheel;
+  u16 code;
+  i16 x;
+  i16 y;
+};
+
 class InputManager {
 public:
   static void initialize(usize *memory_requirement, ptr state);
@@ -151,6 +182,7 @@ public:
   static void process_button(ns_btn button, bool pressed);
   static void process_mouse_move(i16 x, i16 y);
   static void process_mouse_wheel(i8 z_delta);
+  static void flush_events();
 
   inline bool _k(usize);
   inline bool _pk(usize);
@@ -159,6 +191,9 @@ public:
   inline void _mp(i32 *, i32 *);
   inline void _pmp(i32 *, i32 *);
   inline void _mm(i32 *, i32 *);
+  inline i32 _w();
+  inline u32 _ec();
+  inline input_event const *_e(u32);
 
 private:
   bool keyboard[256];
@@ -169,8 +204,33 @@ private:
   i32 mouse_y;
   i32 prev_mouse_x;
   i32 prev_mouse_y;
+  i32 wheel;
+  bool mouse_moved;
+
+  // Ring of the recorded events. The counters are never wrapped: an event's
+  // slot is its counter modulo INPUT_EVENT_CAPACITY.
+  input_event events[INPUT_EVENT_CAPACITY];
+  u64 event_head;
+  u64 frame_event_start;
+
+  void push_event(input_event_type type, u16 code, i16 x, i16 y, i8 wheel);
 };
 
+/**
+ * Gets the number of input events recorded since the last input update
+ * (the previous frame, or the previous fixed update step)
+ * @returns the number of events
+ */
+NS_API u32 input_event_count();
+
+/**
+ * Gets an input event recorded since the last input update, in the order
+ * they were received
+ * @param index the index of the event, in [0, input_event_count())
+ * @returns the event, or nullptr if the index is out of range
+ */
+NS_API input_event const *input_get_event(u32 index);
+
 namespace keyboard {
 
 NS_API bool pressed(ns_key key);
@@ -180,6 +240,14 @@ NS_API bool up(ns_key key);
 NS_API bool was_down(ns_key key);
 NS_API bool was_up(ns_key key);
 
+/**
+ * Counts the presses of a key since the last input update. Unlike pressed,
+ * this sees a key pressed and released within the same frame.
+ * @param key the key
+ * @returns the number of presses
+ */
+NS_API u32 press_count(ns_key key);
+
 } // namespace keyboard
 
 namespace mouse {
@@ -195,6 +263,19 @@ NS_API void position(i32 *x, i32 *y);
 NS_API void prev_position(i32 *x, i32 *y);
 NS_API void motion(i32 *x, i32 *y);
 
+/**
+ * Counts the presses of a button since the last input update
+ * @param button the button
+ * @returns the number of presses
+ */
+NS_API u32 press_count(ns_btn button);
+
+/**
+ * Gets the wheel motion since the last input update
+ * @returns the accumulated wheel delta
+ */
+NS_API i32 wheel();
+
 } // namespace mouse
 
 } // namespace ns
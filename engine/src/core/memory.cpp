@@ -13,13 +13,13 @@ struct memory_stats {
   u64 tagged_allocations[static_cast<usize>(MemTag::MAX_TAGS)];
 };
 
-NS_STATIC_ASSERT(static_cast<usize>(MemTag::MAX_TAGS) == 18,
+NS_STATIC_ASSERT(static_cast<usize>(MemTag::MAX_TAGS) == 19,
                  "update memory tag strings");
 static cstr memory_tag_strings[static_cast<usize>(MemTag::MAX_TAGS)] = {
     "UNKNOWN    ", "LINEAR_ALLC", "ARRAY      ", "VECTOR     ", "DICT       ",
     "RING_QUEUE ", "BST        ", "STRING     ", "APPLICATION", "JOB        ",
     "TEXTURE    ", "MAT_INST   ", "RENDERER   ", "GAME       ", "TRANSFORM  ",
-    "ENTITY     ", "ENTITY_NODE", "SCENE      ",
+    "ENTITY     ", "ENTITY_NODE", "SCENE      ", "MESH       ",
 };
 
 struct memory_system_state {
@@ -24,6 +24,7 @@ enum class MemTag {
   ENTITY,
   ENTITY_NODE,
   SCENE,
+  MESH,
 
   MAX_TAGS
 };
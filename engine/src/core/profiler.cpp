@@ -0,0 +1,523 @@
+#include "./profiler.h"
+#include "../platform/filesystem.h"
+#include "../platform/platform.h"
+#include "./logger.h"
+#include "./memory.h"
+#include "./string.h"
+
+#include <atomic>
+#include <new>
+
+namespace ns {
+
+#define PROFILER_MAX_DEPTH 64
+
+struct profiler_event {
+  cstr name;
+  u64 start;
+  u64 end;
+  u32 depth;
+  u32 thread;
+};
+
+// Single producer (the owning thread) / single consumer (profiler_end_frame)
+// ring. head and tail are kept on separate cache lines.
+struct profiler_thread_buffer {
+  std::atomic<u32> head;
+  u8 pad0[60];
+  std::atomic<u32> tail;
+  u32 depth;
+  u32 index;
+  profiler_event *events;
+  u8 pad1[40];
+};
+
+struct profiler_node {
+  cstr name;
+  u32 parent;
+  u32 first_child;
+  u32 next_sibling;
+  u32 depth;
+  u32 frame_calls;
+  u64 frame_ticks;
+  f64 *history;
+};
+
+struct profiler_capture_state {
+  profiler_event *events;
+  u32 event_count;
+  u32 frames_remaining;
+  u64 start_ticks;
+  char path[512];
+};
+
+struct profiler_state {
+  profiler_config config;
+  u32 generation;
+  std::atomic<u32> thread_count;
+  std::atomic<u32> dropped_events;
+  profiler_thread_buffer *threads;
+
+  profiler_node *nodes;
+  u32 node_count;
+  u64 frame_index;
+  u64 frame_start;
+
+  bool capture_pending;
+  bool capturing;
+  profiler_capture_state capture;
+};
+
+static profiler_state *state_ptr;
+static u32 profiler_generation;
+
+static thread_local profiler_thread_buffer *tls_buffer;
+static thread_local u32 tls_generation;
+
+static profiler_thread_buffer *profiler_get_thread_buffer() {
+  if (tls_generation == state_ptr->generation) {
+    return tls_buffer;
+  }
+  tls_generation = state_ptr->generation;
+  tls_buffer = nullptr;
+  u32 index = state_ptr->thread_count.fetch_add(1, std::memory_order_acq_rel);
+  if (index >= state_ptr->config.max_threads) {
+    NS_WARN("profiler: too many threads (max %u), scopes of this thread will "
+            "be ignored.",
+            state_ptr->config.max_threads);
+    return nullptr;
+  }
+  tls_buffer = &state_ptr->threads[index];
+  return tls_buffer;
+}
+
+bool profiler_system_initialize(usize *memory_requirement, ptr state,
+                                profiler_config config) {
+  if (config.max_threads == 0 || config.events_per_thread == 0 ||
+      (config.events_per_thread & (config.events_per_thread - 1)) != 0 ||
+      config.max_nodes == 0 || config.stats_window == 0) {
+    NS_FATAL("profiler_system_initialize - invalid config.");
+    return false;
+  }
+
+  usize threads_size = sizeof(profiler_thread_buffer) * config.max_threads;
+  usize events_size = sizeof(profiler_event) * config.events_per_thread *
+                      config.max_threads;
+  usize nodes_size = sizeof(profiler_node) * config.max_nodes;
+  usize history_size = sizeof(f64) * config.stats_window * config.max_nodes;
+  usize capture_size = sizeof(profiler_event) * config.capture_capacity;
+  *memory_requirement = sizeof(profiler_state) + threads_size + events_size +
+                        nodes_size + history_size + capture_size;
+
+  if (state == nullptr) {
+    return true;
+  }
+
+  mem_zero(state, *memory_requirement);
+  state_ptr = new (state) profiler_state();
+  state_ptr->config = config;
+  state_ptr->generation = ++profiler_generation;
+
+  u8 *block = reinterpret_cast<u8 *>(state) + sizeof(profiler_state);
+  state_ptr->threads = reinterpret_cast<profiler_thread_buffer *>(block);
+  block += threads_size;
+  profiler_event *events = reinterpret_cast<profiler_event *>(block);
+  block += events_size;
+  state_ptr->nodes = reinterpret_cast<profiler_node *>(block);
+  block += nodes_size;
+  f64 *history = reinterpret_cast<f64 *>(block);
+  block += history_size;
+  state_ptr->capture.events = reinterpret_cast<profiler_event *>(block);
+
+  for (u32 i = 0; i < config.max_threads; i++) {
+    profiler_thread_buffer *buffer =
+        new (&state_ptr->threads[i]) profiler_thread_buffer();
+    buffer->index = i;
+    buffer->events = events + i * config.events_per_thread;
+  }
+  for (u32 i = 0; i < config.max_nodes; i++) {
+    state_ptr->nodes[i].history = history + i * config.stats_window;
+  }
+
+  // Node 0 is the root of the hierarchy (the whole frame).
+  state_ptr->nodes[0].name = "frame";
+  state_ptr->nodes[0].parent = INVALID_ID;
+  state_ptr->nodes[0].first_child = INVALID_ID;
+  state_ptr->nodes[0].next_sibling = INVALID_ID;
+  state_ptr->node_count = 1;
+
+  state_ptr->frame_start = platform::get_ticks();
+  return true;
+}
+
+void profiler_system_shutdown(ptr /*state*/) {
+  if (state_ptr) {
+    u32 dropped = state_ptr->dropped_events.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+      NS_WARN("profiler: %u events were dropped (buffers full).", dropped);
+    }
+    state_ptr->~profiler_state();
+  }
+  state_ptr = nullptr;
+}
+
+u64 profiler_scope_begin() {
+  if (!state_ptr) {
+    return 0;
+  }
+  profiler_thread_buffer *buffer = profiler_get_thread_buffer();
+  if (buffer) {
+    buffer->depth++;
+  }
+  return platform::get_ticks();
+}
+
+void profiler_scope_end(cstr name, u64 start) {
+  u64 end = platform::get_ticks();
+  if (!state_ptr) {
+    return;
+  }
+  profiler_thread_buffer *buffer = profiler_get_thread_buffer();
+  if (!buffer || buffer->depth == 0) {
+    return;
+  }
+  buffer->depth--;
+
+  u32 head = buffer->head.load(std::memory_order_relaxed);
+  u32 tail = buffer->tail.load(std::memory_order_acquire);
+  if (head - tail >= state_ptr->config.events_per_thread) {
+    state_ptr->dropped_events.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  profiler_event &ev =
+      buffer->events[head & (state_ptr->config.events_per_thread - 1)];
+  ev.name = name;
+  ev.start = start;
+  ev.end = end;
+  ev.depth = buffer->depth;
+  ev.thread = buffer->index;
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void profiler_begin_frame() {
+  if (!state_ptr) {
+    return;
+  }
+  state_ptr->frame_start = platform::get_ticks();
+  if (state_ptr->capture_pending) {
+    state_ptr->capture_pending = false;
+    state_ptr->capturing = true;
+    state_ptr->capture.start_ticks = state_ptr->frame_start;
+  }
+}
+
+static u32 profiler_find_or_add_child(u32 parent, cstr name) {
+  profiler_node *nodes = state_ptr->nodes;
+  for (u32 i = nodes[parent].first_child; i != INVALID_ID;
+       i = nodes[i].next_sibling) {
+    if (nodes[i].name == name || string_eq(nodes[i].name, name)) {
+      return i;
+    }
+  }
+  if (state_ptr->node_count >= state_ptr->config.max_nodes) {
+    return INVALID_ID;
+  }
+
+  u32 id = state_ptr->node_count++;
+  profiler_node &node = nodes[id];
+  node.name = name;
+  node.parent = parent;
+  node.first_child = INVALID_ID;
+  node.depth = nodes[parent].depth + 1;
+  node.frame_calls = 0;
+  node.frame_ticks = 0;
+  // Frames before this node existed did not contain it.
+  mem_zero(node.history, sizeof(f64) * state_ptr->config.stats_window);
+
+  // Events are visited last to first: prepending keeps siblings in call
+  // order.
+  node.next_sibling = nodes[parent].first_child;
+  nodes[parent].first_child = id;
+  return id;
+}
+
+static void profiler_capture_event(profiler_event const &ev) {
+  profiler_capture_state &capture = state_ptr->capture;
+  if (capture.event_count < state_ptr->config.capture_capacity) {
+    capture.events[capture.event_count++] = ev;
+  }
+}
+
+// Signed difference in microseconds (worker scopes may start before the
+// capture).
+static f64 profiler_ticks_since(u64 origin, u64 ticks) {
+  if (ticks >= origin) {
+    return platform::ticks_to_seconds(ticks - origin) * 1000000.0;
+  }
+  return -platform::ticks_to_seconds(origin - ticks) * 1000000.0;
+}
+
+// Writes name as the body of a JSON string. Names that do not fit are
+// truncated without splitting an escape sequence.
+static void profiler_escape_json(cstr name, char *out, usize out_size) {
+  static char const hex[] = "0123456789abcdef";
+  usize length = 0;
+  for (; *name; name++) {
+    u8 c = static_cast<u8>(*name);
+    char escaped[6];
+    usize count = 0;
+    if (c == '"' || c == '\\') {
+      escaped[count++] = '\\';
+      escaped[count++] = static_cast<char>(c);
+    } else if (c < 0x20) {
+      escaped[count++] = '\\';
+      escaped[count++] = 'u';
+      escaped[count++] = '0';
+      escaped[count++] = '0';
+      escaped[count++] = hex[c >> 4];
+      escaped[count++] = hex[c & 0xf];
+    } else {
+      escaped[count++] = static_cast<char>(c);
+    }
+    if (length + count >= out_size) {
+      break;
+    }
+    for (usize i = 0; i < count; i++) {
+      out[length++] = escaped[i];
+    }
+  }
+  out[length] = '\0';
+}
+
+static void profiler_write_capture() {
+  profiler_capture_state &capture = state_ptr->capture;
+  fs::File file;
+  if (!fs::open(capture.path, fs::Mode::WRITE, false, &file)) {
+    NS_ERROR("profiler: unable to open '%s' for writing.", capture.path);
+    return;
+  }
+
+  char name[256];
+  char line[512];
+  fs::write_line(&file, "{\"traceEvents\":[");
+  for (u32 i = 0; i < capture.event_count; i++) {
+    profiler_event const &ev = capture.events[i];
+    profiler_escape_json(ev.name, name, sizeof(name));
+    string_fmt(line, sizeof(line),
+               "{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%.3f,"
+               "\"dur\":%.3f,\"pid\":0,\"tid\":%u}%s",
+               name, profiler_ticks_since(capture.start_ticks, ev.start),
+               platform::ticks_to_seconds(ev.end - ev.start) * 1000000.0,
+               ev.thread,
+               i + 1 < capture.event_count ? "," : "");
+    fs::write_line(&file, line);
+  }
+  fs::write_line(&file, "],\"displayTimeUnit\":\"ms\"}");
+  fs::close(&file);
+
+  NS_INFO("profiler: wrote %u events to '%s'.", capture.event_count,
+          capture.path);
+}
+
+void profiler_end_frame() {
+  if (!state_ptr) {
+    return;
+  }
+  u64 frame_end = platform::get_ticks();
+  profiler_node *nodes = state_ptr->nodes;
+  u32 window = state_ptr->config.stats_window;
+  u32 mask = state_ptr->config.events_per_thread - 1;
+
+  for (u32 i = 0; i < state_ptr->node_count; i++) {
+    nodes[i].frame_calls = 0;
+    nodes[i].frame_ticks = 0;
+  }
+
+  u32 thread_count = state_ptr->thread_count.load(std::memory_order_acquire);
+  if (thread_count > state_ptr->config.max_threads) {
+    thread_count = state_ptr->config.max_threads;
+  }
+
+  // Events are pushed when scopes end (children before their parent), so
+  // walking a buffer backward visits every parent before its children.
+  u32 node_at_depth[PROFILER_MAX_DEPTH];
+  profiler_event const *event_at_depth[PROFILER_MAX_DEPTH];
+  for (u32 t = 0; t < thread_count; t++) {
+    profiler_thread_buffer &buffer = state_ptr->threads[t];
+    u32 tail = buffer.tail.load(std::memory_order_relaxed);
+    u32 head = buffer.head.load(std::memory_order_acquire);
+    for (u32 d = 0; d < PROFILER_MAX_DEPTH; d++) {
+      event_at_depth[d] = nullptr;
+    }
+
+    for (u32 i = head; i != tail; i--) {
+      profiler_event const &ev = buffer.events[(i - 1) & mask];
+      if (state_ptr->capturing) {
+        profiler_capture_event(ev);
+      }
+      if (ev.depth >= PROFILER_MAX_DEPTH) {
+        continue;
+      }
+
+      // The parent may still be open (e.g. a worker scope spanning frames):
+      // attach to the root in that case.
+      u32 parent = 0;
+      if (ev.depth > 0) {
+        profiler_event const *p = event_at_depth[ev.depth - 1];
+        if (p && p->start <= ev.start && ev.end <= p->end &&
+            node_at_depth[ev.depth - 1] != INVALID_ID) {
+          parent = node_at_depth[ev.depth - 1];
+        }
+      }
+
+      u32 id = profiler_find_or_add_child(parent, ev.name);
+      event_at_depth[ev.depth] = &ev;
+      node_at_depth[ev.depth] = id;
+      if (id == INVALID_ID) {
+        continue;
+      }
+      nodes[id].frame_calls++;
+      nodes[id].frame_ticks += ev.end - ev.start;
+    }
+
+    buffer.tail.store(head, std::memory_order_release);
+  }
+
+  nodes[0].frame_calls = 1;
+  nodes[0].frame_ticks = frame_end - state_ptr->frame_start;
+
+  u64 slot = state_ptr->frame_index % window;
+  for (u32 i = 0; i < state_ptr->node_count; i++) {
+    nodes[i].history[slot] = platform::ticks_to_seconds(nodes[i].frame_ticks);
+  }
+  state_ptr->frame_index++;
+
+  if (state_ptr->capturing) {
+    profiler_event frame_ev{"frame", state_ptr->frame_start, frame_end, 0, 0};
+    profiler_capture_event(frame_ev);
+    if (--state_ptr->capture.frames_remaining == 0) {
+      state_ptr->capturing = false;
+      profiler_write_capture();
+    }
+  }
+}
+
+static void profiler_compute_stats(profiler_node const &node,
+                                   profiler_stats *out_stats) {
+  u32 window = state_ptr->config.stats_window;
+  u64 count = state_ptr->frame_index < window ? state_ptr->frame_index : window;
+  out_stats->calls = node.frame_calls;
+  out_stats->last = platform::ticks_to_seconds(node.frame_ticks);
+  if (count == 0) {
+    out_stats->min = out_stats->avg = out_stats->max = 0.0;
+    return;
+  }
+  f64 min = node.history[0];
+  f64 max = node.history[0];
+  f64 sum = 0.0;
+  for (u64 i = 0; i < count; i++) {
+    f64 v = node.history[i];
+    min = v < min ? v : min;
+    max = v > max ? v : max;
+    sum += v;
+  }
+  out_stats->min = min;
+  out_stats->max = max;
+  out_stats->avg = sum / static_cast<f64>(count);
+}
+
+bool profiler_get_stats(cstr path, profiler_stats *out_stats) {
+  if (!state_ptr || !path || !out_stats) {
+    return false;
+  }
+  profiler_node const *nodes = state_ptr->nodes;
+  u32 current = 0;
+  cstr segment = path;
+  while (*segment) {
+    usize length = 0;
+    while (segment[length] && segment[length] != '/') {
+      length++;
+    }
+    u32 found = INVALID_ID;
+    for (u32 i = nodes[current].first_child; i != INVALID_ID;
+         i = nodes[i].next_sibling) {
+      cstr name = nodes[i].name;
+      usize j = 0;
+      while (j < length && name[j] == segment[j]) {
+        j++;
+      }
+      if (j == length && name[j] == '\0') {
+        found = i;
+        break;
+      }
+    }
+    if (found == INVALID_ID) {
+      return false;
+    }
+    current = found;
+    segment += length;
+    if (*segment == '/') {
+      segment++;
+    }
+  }
+  profiler_compute_stats(nodes[current], out_stats);
+  return true;
+}
+
+void profiler_get_frame_stats(profiler_stats *out_stats) {
+  if (!state_ptr || !out_stats) {
+    return;
+  }
+  profiler_compute_stats(state_ptr->nodes[0], out_stats);
+}
+
+static void profiler_log_node(u32 id) {
+  profiler_node const &node = state_ptr->nodes[id];
+  profiler_stats stats;
+  profiler_compute_stats(node, &stats);
+
+  char label[64];
+  usize indent = node.depth * 2;
+  if (indent > 32) {
+    indent = 32;
+  }
+  mem_set(label, ' ', indent);
+  string_ncpy(label + indent, node.name, sizeof(label) - indent - 1);
+  label[sizeof(label) - 1] = '\0';
+  NS_INFO("%-40s %9.3f %9.3f %9.3f %6u", label, stats.min * 1000.0,
+          stats.avg * 1000.0, stats.max * 1000.0, stats.calls);
+
+  for (u32 i = node.first_child; i != INVALID_ID;
+       i = state_ptr->nodes[i].next_sibling) {
+    profiler_log_node(i);
+  }
+}
+
+void profiler_log_stats() {
+  if (!state_ptr) {
+    return;
+  }
+  u32 window = state_ptr->config.stats_window;
+  u64 count = state_ptr->frame_index < window ? state_ptr->frame_index : window;
+  NS_INFO("Profiler (last %llu frames, ms):", count);
+  NS_INFO("%-40s %9s %9s %9s %6s", "scope", "min", "avg", "max", "calls");
+  profiler_log_node(0);
+}
+
+bool profiler_capture(u32 frame_count, cstr path) {
+  if (!state_ptr || frame_count == 0 || state_ptr->capturing ||
+      state_ptr->capture_pending || state_ptr->config.capture_capacity == 0) {
+    return false;
+  }
+  profiler_capture_state &capture = state_ptr->capture;
+  string_ncpy(capture.path, path, sizeof(capture.path) - 1);
+  capture.path[sizeof(capture.path) - 1] = '\0';
+  capture.event_count = 0;
+  capture.frames_remaining = frame_count;
+  // Recording starts with the next frame.
+  state_ptr->capture_pending = true;
+  NS_INFO("profiler: capturing %u frames to '%s'.", frame_count, path);
+  return true;
+}
+
+} // namespace ns
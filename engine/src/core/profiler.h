@@ -0,0 +1,124 @@
+#ifndef PROFILER_HEADER_INCLUDED
+#define PROFILER_HEADER_INCLUDED
+
+#include "../defines.h"
+
+namespace ns {
+
+struct profiler_config {
+  /** Maximum number of threads that can record scopes. */
+  u32 max_threads;
+  /** Capacity of each thread's event ring buffer (must be a power of 2). */
+  u32 events_per_thread;
+  /** Maximum number of distinct nodes in the scope hierarchy. */
+  u32 max_nodes;
+  /** Number of frames kept for the rolling min/avg/max statistics. */
+  u32 stats_window;
+  /** Maximum number of events kept while capturing a chrome trace. */
+  u32 capture_capacity;
+};
+
+/**
+ * Rolling statistics of a profiled scope, in seconds per frame.
+ */
+struct profiler_stats {
+  f64 min;
+  f64 avg;
+  f64 max;
+  f64 last;
+  u32 calls;
+};
+
+bool profiler_system_initialize(usize *memory_requirement, ptr state,
+                                profiler_config config);
+
+void profiler_system_shutdown(ptr state);
+
+/**
+ * Marks the beginning of a frame.
+ */
+NS_API void profiler_begin_frame();
+
+/**
+ * Marks the end of a frame: drains the per-thread event buffers and
+ * aggregates them into the scope hierarchy.
+ */
+NS_API void profiler_end_frame();
+
+/**
+ * Starts recording a scope on the calling thread.
+ * @returns the start timestamp of the scope, in platform ticks
+ */
+NS_API u64 profiler_scope_begin();
+
+/**
+ * Stops recording a scope on the calling thread.
+ * @param name the name of the scope (must outlive the profiler)
+ * @param start the timestamp returned by profiler_scope_begin
+ */
+NS_API void profiler_scope_end(cstr name, u64 start);
+
+/**
+ * Gets the rolling statistics of a scope
+ * @param path the '/'-separated path of the scope in the hierarchy
+ *        (e.g. "update" or "renderer_draw_frame/world_pass")
+ * @param out_stats the statistics of the scope
+ * @returns true if the scope exists
+ */
+NS_API bool profiler_get_stats(cstr path, profiler_stats *out_stats);
+
+/**
+ * Gets the rolling statistics of the whole frame
+ * @param out_stats the statistics of the frame
+ */
+NS_API void profiler_get_frame_stats(profiler_stats *out_stats);
+
+/**
+ * Logs the scope hierarchy with the rolling min/avg/max timings.
+ */
+NS_API void profiler_log_stats();
+
+/**
+ * Records the events of the next frames and writes them as a chrome
+ * trace_event JSON file once done (viewable in chrome://tracing or Perfetto).
+ * @param frame_count the number of frames to capture
+ * @param path the path of the JSON file to write
+ * @returns true if the capture was started
+ */
+NS_API bool profiler_capture(u32 frame_count, cstr path);
+
+/**
+ * Records a scope for the lifetime of the object.
+ * Use through the NS_PROFILE_SCOPE macro.
+ */
+struct profile_scope {
+  cstr name;
+  u64 start;
+
+  explicit profile_scope(cstr name)
+      : name(name), start(profiler_scope_begin()) {}
+  ~profile_scope() { profiler_scope_end(name, start); }
+
+  profile_scope(profile_scope const &) = delete;
+  profile_scope &operator=(profile_scope const &) = delete;
+};
+
+} // namespace ns
+
+#define NS_PROFILE_CONCAT_(a, b) a##b
+#define NS_PROFILE_CONCAT(a, b) NS_PROFILE_CONCAT_(a, b)
+
+#ifdef NS_PROFILER_ENABLED
+#define NS_PROFILE_SCOPE(name)                                                 \
+  ::ns::profile_scope NS_PROFILE_CONCAT(_ns_profile_scope_, __LINE__)(name)
+#define NS_PROFILE_FUNCTION() NS_PROFILE_SCOPE(__func__)
+#define NS_PROFILE_FRAME_BEGIN() ::ns::profiler_begin_frame()
+#define NS_PROFILE_FRAME_END() ::ns::profiler_end_frame()
+#else
+#define NS_PROFILE_SCOPE(name)
+#define NS_PROFILE_FUNCTION()
+#define NS_PROFILE_FRAME_BEGIN()
+#define NS_PROFILE_FRAME_END()
+#endif
+
+#endif // PROFILER_HEADER_INCLUDED
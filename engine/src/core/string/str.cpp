@@ -1,6 +1,47 @@
 #include "./str.h"
 #include "./cstring.h"
 
+#include <ctype.h>
+
 namespace ns {
 Str::Str(cstr s) : Slice<char>(Slice<char>::from_parts(s, string_length(s))) {}
+
+Str Str::trim() const {
+  usize start = 0;
+  usize end = m_count;
+  while (start < end && isspace(static_cast<u8>(m_data[start]))) {
+    start++;
+  }
+  while (end > start && isspace(static_cast<u8>(m_data[end - 1]))) {
+    end--;
+  }
+  return Str(Slice<char>::from_parts(m_data + start, end - start));
+}
+
+isize Str::indexof(char c) const {
+  for (usize i = 0; i < m_count; i++) {
+    if (m_data[i] == c) {
+      return static_cast<isize>(i);
+    }
+  }
+  return -1;
+}
+
+bool Str::eq(cstr s) const {
+  for (usize i = 0; i < m_count; i++) {
+    if (s[i] != m_data[i]) {
+      return false;
+    }
+  }
+  return s[m_count] == '\0';
+}
+
+bool Str::EQ(cstr s) const {
+  for (usize i = 0; i < m_count; i++) {
+    if (tolower(static_cast<u8>(s[i])) != tolower(static_cast<u8>(m_data[i]))) {
+      return false;
+    }
+  }
+  return s[m_count] == '\0';
+}
 } // namespace ns
@@ -29,6 +29,33 @@ public:
    * @param s the slice to convert.
    */
   NS_API Str(Slice<char> s) : Slice<char>(s) {}
+
+  /**
+   * @brief Removes the leading and trailing whitespaces.
+   * @return the trimmed view (does not modify the characters).
+   */
+  NS_API Str trim() const;
+
+  /**
+   * @brief Finds the first occurence of a character.
+   * @param c the character to look for.
+   * @return the index of the character or -1 if it is not found.
+   */
+  NS_API isize indexof(char c) const;
+
+  /**
+   * @brief Compares the slice with a C string.
+   * @param s the C string.
+   * @return true if they contain the same characters.
+   */
+  NS_API bool eq(cstr s) const;
+
+  /**
+   * @brief Compares the slice with a C string (case insensitive).
+   * @param s the C string.
+   * @return true if they contain the same characters, ignoring case.
+   */
+  NS_API bool EQ(cstr s) const;
 };
 
 } // namespace ns
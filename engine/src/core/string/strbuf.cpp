@@ -0,0 +1,94 @@
+#include "./strbuf.h"
+#include "../memory.h"
+#include "./cstring.h"
+
+namespace ns {
+
+StrBuf::StrBuf(pstr buffer, usize capacity)
+    : m_data(buffer), m_len(0), m_capacity(capacity), m_truncated(false) {
+  m_data[0] = '\0';
+}
+
+void StrBuf::clear() {
+  m_len = 0;
+  m_truncated = false;
+  m_data[0] = '\0';
+}
+
+void StrBuf::append(char const *s, usize n) {
+  usize available = capacity() - m_len;
+  if (n > available) {
+    n = available;
+    m_truncated = true;
+  }
+  mem_copy(m_data + m_len, s, n);
+  m_len += n;
+  m_data[m_len] = '\0';
+}
+
+StrBuf &StrBuf::push(char c) {
+  append(&c, 1);
+  return *this;
+}
+
+StrBuf &StrBuf::push(cstr s) {
+  if (s) {
+    append(s, string_length(s));
+  }
+  return *this;
+}
+
+StrBuf &StrBuf::push(Str s) {
+  append(s.begin(), s.len());
+  return *this;
+}
+
+StrBuf &StrBuf::push_fmt(cstr format, ...) {
+  usize available = capacity() - m_len;
+  __builtin_va_list va;
+  __builtin_va_start(va, format);
+  i32 n = string_fmt_v(m_data + m_len, available + 1, format, va);
+  __builtin_va_end(va);
+
+  if (n < 0) {
+    m_data[m_len] = '\0';
+    return *this;
+  }
+  if (static_cast<usize>(n) > available) {
+    n = static_cast<i32>(available);
+    m_truncated = true;
+  }
+  m_len += n;
+  return *this;
+}
+
+struct string_scratch {
+  char buffer[STRING_SCRATCH_SIZE];
+  usize offset;
+};
+
+static thread_local string_scratch scratch;
+
+Str string_scratch_fmt(cstr format, ...) {
+  if (STRING_SCRATCH_SIZE - scratch.offset < STRING_SCRATCH_MAX_LENGTH + 1) {
+    scratch.offset = 0;
+  }
+  pstr out = scratch.buffer + scratch.offset;
+
+  __builtin_va_list va;
+  __builtin_va_start(va, format);
+  i32 n = string_fmt_v(out, STRING_SCRATCH_MAX_LENGTH + 1, format, va);
+  __builtin_va_end(va);
+
+  usize length = 0;
+  if (n > 0) {
+    length = static_cast<usize>(n) > STRING_SCRATCH_MAX_LENGTH
+                 ? STRING_SCRATCH_MAX_LENGTH
+                 : static_cast<usize>(n);
+  }
+  out[length] = '\0';
+  scratch.offset += length + 1;
+  return Str(Slice<char>::from_parts(out, length));
+}
+
+} // namespace ns
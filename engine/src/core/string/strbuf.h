@@ -0,0 +1,128 @@
+/** @file strbuf.h
+ * @brief Part of NSEngine String library.
+ * @author Clement Chambard
+ * @date 2024
+ */
+
+#ifndef STRBUF_HEADER_INCLUDED
+#define STRBUF_HEADER_INCLUDED
+
+#include "../../defines.h"
+#include "./str.h"
+
+namespace ns {
+
+/** @class StrBuf
+ * @brief Appends text to a caller-provided buffer. Never allocates.
+ *
+ * The buffer is always null-terminated. Text that does not fit is dropped and
+ * the buffer is marked as truncated.
+ */
+class StrBuf {
+public:
+  /**
+   * @brief Creates an empty string buffer over a memory block.
+   * @param buffer the memory block (must not be null).
+   * @param capacity the size of the memory block in bytes
+   *        (counting the null terminator, must be at least 1).
+   */
+  NS_API StrBuf(pstr buffer, usize capacity);
+
+  /**
+   * @brief Creates an empty string buffer over a character array.
+   * @param buffer the character array.
+   */
+  template <usize N> NS_API StrBuf(char (&buffer)[N]) : StrBuf(buffer, N) {}
+
+  /**
+   * @brief Empties the buffer.
+   */
+  NS_API void clear();
+
+  /**
+   * @brief Appends a character to the buffer.
+   * @param c the character to append.
+   * @return the buffer.
+   */
+  NS_API StrBuf &push(char c);
+
+  /**
+   * @brief Appends a C string to the buffer.
+   * @param s the C string to append.
+   * @return the buffer.
+   */
+  NS_API StrBuf &push(cstr s);
+
+  /**
+   * @brief Appends a string slice to the buffer.
+   * @param s the string slice to append.
+   * @return the buffer.
+   */
+  NS_API StrBuf &push(Str s);
+
+  /**
+   * @brief Appends formatted text to the buffer (printf-like).
+   * @param format the format string.
+   * @return the buffer.
+   */
+  NS_API StrBuf &push_fmt(cstr format, ...);
+
+  /**
+   * @brief Get the number of characters in the buffer.
+   * @return the number of characters.
+   */
+  NS_API usize len() const { return m_len; }
+
+  /**
+   * @brief Get the number of characters the buffer can hold.
+   * @return the capacity (not counting the null terminator).
+   */
+  NS_API usize capacity() const { return m_capacity - 1; }
+
+  /**
+   * @brief Check if some text did not fit in the buffer.
+   * @return true if text was dropped since the last clear.
+   */
+  NS_API bool truncated() const { return m_truncated; }
+
+  /**
+   * @brief Get the content of the buffer as a C string.
+   * @return the null-terminated content.
+   */
+  NS_API cstr c_str() const { return m_data; }
+
+  /**
+   * @brief conversion operator for a string slice.
+   * @return the slice (valid until the buffer is modified).
+   */
+  NS_API operator Str() const {
+    return Str(Slice<char>::from_parts(m_data, m_len));
+  }
+
+private:
+  pstr m_data;
+  usize m_len;
+  usize m_capacity;
+  bool m_truncated;
+
+  void append(char const *s, usize n);
+};
+
+/**
+ * @brief Formats a string into the thread's scratch buffer (printf-like).
+ * @param format the format string.
+ * @return a view on the formatted string (null-terminated).
+ *
+ * The scratch buffer is a ring of STRING_SCRATCH_SIZE bytes per thread: the
+ * result stays valid until that much text was formatted after it, so it
+ * should only be used for short-lived strings (logging, paths, lookups).
+ * The result is truncated to STRING_SCRATCH_MAX_LENGTH characters.
+ */
+NS_API Str string_scratch_fmt(cstr format, ...);
+
+#define STRING_SCRATCH_SIZE 16384
+#define STRING_SCRATCH_MAX_LENGTH 1023
+
+} // namespace ns
+
+#endif // STRBUF_HEADER_INCLUDED
@@ -1,91 +1,165 @@
 #include "./string.h"
-
-#include "../logger.h"
-
-// #ifndef _MSC_VER
-// #include <strings.h>
-// #endif
+#include "./cstring.h"
 
 namespace ns {
 
+String::String() { reset(); }
+
 String::String(cstr s) {
+  reset();
   if (!s)
     return;
-  usize length = string_length(s);
-  m_data = ns::alloc_n<char>(length + 1, MemTag::STRING);
-  mem_copy(m_data, s, length);
-  m_data[length] = 0;
+  append(s, string_length(s));
 }
 
-void String::resize(usize, char) {
-  NS_WARN("called resize on String. Does nothing");
+String::String(Str s) {
+  reset();
+  append(s.begin(), s.len());
 }
 
-void String::push(char c) {
-  if (m_size >= m_capacity - 1) {
-    reserve(m_capacity == 0 ? FIRST_CAPACITY : m_capacity * CAPACITY_MUL);
+String::String(String const &other) {
+  if (other.is_inline()) {
+    mem_copy(m_inline, other.m_inline, sizeof(m_inline));
+  } else {
+    reset();
+    append(other.m_heap.data, other.m_heap.size);
   }
-  m_data[m_size++] = c;
-  m_data[m_size] = 0;
 }
 
-void String::push(cstr s) {
-  usize length = string_length(s);
-  if (length == 0)
+String::String(String &&other) {
+  mem_copy(m_inline, other.m_inline, sizeof(m_inline));
+  other.reset();
+}
+
+String::~String() { free(); }
+
+String &String::operator=(String const &other) {
+  if (this == &other)
+    return *this;
+  clear();
+  append(other.data(), other.len());
+  return *this;
+}
+
+String &String::operator=(String &&other) {
+  if (this == &other)
+    return *this;
+  free();
+  mem_copy(m_inline, other.m_inline, sizeof(m_inline));
+  other.reset();
+  return *this;
+}
+
+void String::free() {
+  if (!is_inline()) {
+    ns::free(m_heap.data, capacity() + 1, MemTag::STRING);
+  }
+  reset();
+}
+
+void String::set_len(usize n) {
+  if (is_inline()) {
+    m_inline[n] = '\0';
+    // For n == INLINE_CAPACITY this writes 0 over the terminator written
+    // above, which is still a valid terminator.
+    m_inline[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY - n);
+  } else {
+    m_heap.size = n;
+    m_heap.data[n] = '\0';
+  }
+}
+
+void String::grow(usize min_capacity) {
+  usize old_capacity = capacity();
+  if (min_capacity <= old_capacity)
     return;
-  if (m_size + length >= m_capacity - 1) {
-    usize new_capacity =
-        m_capacity == 0 ? FIRST_CAPACITY : m_capacity * CAPACITY_MUL;
-    usize actual_new = length > new_capacity ? length + 1 : new_capacity;
-    reserve(actual_new);
+  usize new_capacity = old_capacity * 2;
+  if (new_capacity < min_capacity)
+    new_capacity = min_capacity;
+
+  usize length = len();
+  char *new_data = ns::alloc_n<char>(new_capacity + 1, MemTag::STRING);
+  mem_copy(new_data, data(), length);
+  new_data[length] = '\0';
+
+  if (!is_inline()) {
+    ns::free(m_heap.data, old_capacity + 1, MemTag::STRING);
   }
-  mem_copy(m_data + m_size, s, length);
-  m_size += length;
-  m_data[m_size] = 0;
+  m_heap.data = new_data;
+  m_heap.size = length;
+  m_heap.capacity = new_capacity | HEAP_FLAG;
 }
 
-void String::push(Str s) {
-  usize length = s.len();
-  if (length == 0)
+void String::append(char const *s, usize n) {
+  if (n == 0)
     return;
-  if (m_size + length >= m_capacity - 1) {
-    usize new_capacity =
-        m_capacity == 0 ? FIRST_CAPACITY : m_capacity * CAPACITY_MUL;
-    usize actual_new = length > new_capacity ? length + 1 : new_capacity;
-    reserve(actual_new);
+  usize length = len();
+  grow(length + n);
+  mem_copy(data() + length, s, n);
+  set_len(length + n);
+}
+
+void String::reserve(usize n) { grow(n); }
+
+void String::resize(usize n, char c) {
+  usize length = len();
+  grow(n);
+  if (n > length) {
+    mem_set(data() + length, c, n - length);
   }
-  mem_copy(m_data + m_size, s, length);
-  m_size += length;
-  m_data[m_size] = 0;
+  set_len(n);
 }
 
-void String::push(String const &s) {
-  usize length = s.m_size;
-  if (length == 0)
+void String::push(char c) { append(&c, 1); }
+
+void String::push(cstr s) {
+  if (!s)
+    return;
+  append(s, string_length(s));
+}
+
+void String::push(Str s) { append(s.begin(), s.len()); }
+
+void String::push(String const &s) { append(s.data(), s.len()); }
+
+void String::push_fmt(cstr format, ...) {
+  usize length = len();
+  usize available = capacity() - length;
+
+  __builtin_va_list va;
+  __builtin_va_start(va, format);
+  __builtin_va_list va_retry;
+  __builtin_va_copy(va_retry, va);
+  i32 n = string_fmt_v(data() + length, available + 1, format, va);
+  __builtin_va_end(va);
+
+  if (n < 0) {
+    __builtin_va_end(va_retry);
+    set_len(length);
     return;
-  if (m_size + length >= m_capacity - 1) {
-    usize new_capacity =
-        m_capacity == 0 ? FIRST_CAPACITY : m_capacity * CAPACITY_MUL;
-    usize actual_new = length > new_capacity ? length + 1 : new_capacity;
-    reserve(actual_new);
   }
-  mem_copy(m_data + m_size, s.m_data, length);
-  m_size += length;
-  m_data[m_size] = 0;
+  if (static_cast<usize>(n) > available) {
+    grow(length + n);
+    string_fmt_v(data() + length, n + 1, format, va_retry);
+  }
+  __builtin_va_end(va_retry);
+  set_len(length + n);
 }
 
 char String::pop() {
-  char c = m_data[m_size - 1];
-  m_data[m_size - 1] = 0;
-  m_size--;
+  usize length = len();
+  char c = data()[length - 1];
+  set_len(length - 1);
   return c;
 }
 
 void String::erase(usize index) {
-  mem_copy(m_data + index, m_data + index + 1,
-           (m_size - index - 1) * sizeof(char));
-  m_size--;
-  m_data[m_size] = 0;
+  usize length = len();
+  char *d = data();
+  for (usize i = index; i + 1 < length; i++) {
+    d[i] = d[i + 1];
+  }
+  set_len(length - 1);
 }
 
 } // namespace ns
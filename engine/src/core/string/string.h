@@ -7,37 +7,132 @@
 #ifndef NS_STRING_HEADER_INCLUDED
 #define NS_STRING_HEADER_INCLUDED
 
-#include "../containers/vec.h"
-#include "../defines.h"
+#include "../../defines.h"
+#include "../memory.h"
 #include "./str.h"
 
 namespace ns {
 
 /** @class String
- * @brief String class created from Vec.
+ * @brief Growable, null-terminated string with small-string optimization.
  *
- * This class is a wrapper around the Vec class that adds functonalities
- * specific to strings.
+ * Strings of up to String::INLINE_CAPACITY characters are stored inside the
+ * object itself (24 bytes) and never allocate. Longer strings are allocated
+ * with MemTag::STRING.
+ *
+ * The last byte of the object holds the remaining inline capacity when the
+ * string is inline (so it is the null terminator of a full inline string),
+ * and the high bit of the heap capacity (little-endian) otherwise.
  */
-class String : public Vec<char, MemTag::STRING> {
+class String {
 public:
+  static constexpr usize INLINE_CAPACITY = 23;
+
+  /**
+   * @brief Creates an empty string (does not allocate).
+   */
+  NS_API String();
+
   /**
    * @brief Creates a String from a C string.
    * @param s the C string to convert.
    */
   NS_API String(cstr s);
 
+  /**
+   * @brief Creates a String from a string slice.
+   * @param s the string slice to copy.
+   */
+  NS_API explicit String(Str s);
+
+  /**
+   * @brief Copy constructor.
+   * @param other the string to copy.
+   */
+  NS_API String(String const &other);
+
+  /**
+   * @brief Move constructor.
+   * @param other the string to move.
+   */
+  NS_API String(String &&other);
+
+  /**
+   * @brief Destructor.
+   */
+  NS_API ~String();
+
+  /**
+   * @brief Copy assignment.
+   * @param other the string to copy.
+   */
+  NS_API String &operator=(String const &other);
+
+  /**
+   * @brief Move assignment.
+   * @param other the string to move.
+   */
+  NS_API String &operator=(String &&other);
+
+  /**
+   * @brief Frees the memory used by the string and makes it empty.
+   */
+  NS_API void free();
+
+  /**
+   * @brief Get the number of characters in the string.
+   * @return the number of characters in the string.
+   */
+  NS_API usize len() const {
+    return is_inline() ? INLINE_CAPACITY - static_cast<u8>(m_inline[INLINE_CAPACITY])
+                       : m_heap.size;
+  }
+
+  /**
+   * @brief Get the number of characters the string can hold without
+   * reallocating.
+   * @return the capacity of the string.
+   */
+  NS_API usize capacity() const {
+    return is_inline() ? INLINE_CAPACITY : m_heap.capacity & ~HEAP_FLAG;
+  }
+
+  /**
+   * @brief Check if the string is empty.
+   * @return true if the string is empty, false otherwise.
+   */
+  NS_API bool is_empty() const { return len() == 0; }
+
+  /**
+   * @brief Check if the string is stored inline (no allocation).
+   * @return true if the string is stored inline.
+   */
+  NS_API bool is_inline() const {
+    return (static_cast<u8>(m_inline[INLINE_CAPACITY]) & 0x80) == 0;
+  }
+
+  /**
+   * @brief Clears the string (keeps its capacity).
+   */
+  NS_API void clear() { set_len(0); }
+
+  /**
+   * @brief Reserves memory for the string.
+   * @param n the number of characters to reserve
+   *        (not counting the null terminator).
+   */
+  NS_API void reserve(usize n);
+
   /**
    * @brief Resizes the string.
-   * @warning Does nothing since resizing a String might not be possible.
+   * @param n the new length of the string.
+   * @param c the character to fill the new characters with.
    */
   NS_API void resize(usize n, char c = '\0');
 
   /**
    * @brief Pushes a character to the string.
    * @param c the character to push.
-   *
-   * Method overloaded from the Vec class.
    */
   NS_API void push(char c);
 
@@ -59,11 +154,18 @@ public:
    */
   NS_API void push(String const &s);
 
+  /**
+   * @brief Appends formatted text to the string (printf-like).
+   * @param format the format string.
+   *
+   * Only allocates if the result does not fit in the current capacity.
+   */
+  NS_API void push_fmt(cstr format, ...);
+
   /**
    * @brief Pops a character from the string.
    * @returns the popped character.
    *
-   * Method overloaded from the Vec class.
    * The string must not be empty.
    */
   NS_API char pop();
@@ -72,32 +174,95 @@ public:
    * @brief Erases a character from the string.
    * @param it an iterator to the character to erase
    *        (must be a valid iterator pointing to a character in the string).
-   *
-   * Method overloaded from the Vec class.
    */
-  NS_API void erase(char const *it) { erase(static_cast<usize>(it - m_data)); }
+  NS_API void erase(char const *it) { erase(static_cast<usize>(it - data())); }
 
   /**
    * @brief Erases a character from the string
    * @param index the index of the character to erase
    *        (must be a valid index from 0 to this->len() - 1).
-   *
-   * Method overloaded from the Vec class.
    */
   NS_API void erase(usize index);
 
   /** @fn cstr String::c_str() const
    * @brief Converts the string to a C string
    * @returns the C string corresponding to the string
-   *          (returns nullptr if the string is empty).
+   *          (returns nullptr if the string is empty, use data() for a
+   *          terminated buffer in every case).
    *          The returned pointer is valid until the string is modified or
    *          destroyed.
    */
-  NS_API cstr c_str() const { return m_data; }
+  NS_API cstr c_str() const { return is_empty() ? nullptr : data(); }
+
+  /**
+   * @brief Get the characters of the string.
+   * @return the characters (null-terminated).
+   */
+  NS_API char *data() { return is_inline() ? m_inline : m_heap.data; }
 
-  // TODO: operators
+  /**
+   * @brief Get the characters of the string.
+   * @return the characters (null-terminated).
+   */
+  NS_API char const *data() const {
+    return is_inline() ? m_inline : m_heap.data;
+  }
+
+  /**
+   * @brief conversion operator for a string slice.
+   * @return the slice.
+   *         (the slice is only valid as long as the string is not modified)
+   */
+  NS_API operator Str() const {
+    return Str(Slice<char>::from_parts(data(), len()));
+  }
+
+  /**
+   * @brief get a character from the string.
+   * @param index the index of the character.
+   *        There is no bound checking on this value.
+   * @return the character.
+   */
+  NS_API char const &operator[](usize index) const { return data()[index]; }
+
+  /**
+   * @brief get a character from the string.
+   * @param index the index of the character.
+   *        There is no bound checking on this value.
+   * @return the character.
+   */
+  NS_API char &operator[](usize index) { return data()[index]; }
+
+  NS_API char *begin() { return data(); }
+  NS_API char const *begin() const { return data(); }
+  NS_API char *end() { return data() + len(); }
+  NS_API char const *end() const { return data() + len(); }
+
+private:
+  static constexpr usize HEAP_FLAG = 1ull << 63;
+
+  struct heap_repr {
+    char *data;
+    usize size;
+    usize capacity; // | HEAP_FLAG
+  };
+
+  union {
+    heap_repr m_heap;
+    char m_inline[INLINE_CAPACITY + 1];
+  };
+
+  void reset() {
+    m_inline[0] = '\0';
+    m_inline[INLINE_CAPACITY] = INLINE_CAPACITY;
+  }
+  void set_len(usize n);
+  void grow(usize min_capacity);
+  void append(char const *s, usize n);
 };
 
+NS_STATIC_ASSERT(sizeof(String) == 24, "Expected String to be 24 bytes.");
+
 } // namespace ns
 
 #endif // NS_STRING_HEADER_INCLUDED
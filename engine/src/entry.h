@@ -8,7 +8,7 @@
 extern bool create_game(game *out_game);
 
 int main(void) {
-  game game_inst;
+  game game_inst{};
   if (!create_game(&game_inst)) {
     NS_FATAL("Could not create game!");
     return -1;
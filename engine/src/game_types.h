@@ -10,7 +10,7 @@ struct game {
 
   bool (*update)(game *game_inst, f32 delta_time);
 
-  bool (*render)(game *game_inst, f32 delta_time);
+  bool (*render)(game *game_inst, f32 delta_time, f32 interpolation);
 
   void (*on_resize)(game *game_inst, u32 width, u32 height);
 
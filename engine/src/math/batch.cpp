@@ -0,0 +1,197 @@
+#include "./batch.h"
+#include "./simd.h"
+
+namespace ns {
+
+// Shared by points (w = 1, translated) and directions (w = 0).
+template <bool TRANSLATE>
+static void transform(mat4 const &m, vec3_soa const &in, vec3_soa const &out,
+                      usize count) {
+  usize i = 0;
+
+#if defined(NS_USE_SIMD) && defined(__AVX2__)
+  {
+    __m256 m00 = _mm256_set1_ps(m.d[0][0]), m01 = _mm256_set1_ps(m.d[0][1]),
+           m02 = _mm256_set1_ps(m.d[0][2]);
+    __m256 m10 = _mm256_set1_ps(m.d[1][0]), m11 = _mm256_set1_ps(m.d[1][1]),
+           m12 = _mm256_set1_ps(m.d[1][2]);
+    __m256 m20 = _mm256_set1_ps(m.d[2][0]), m21 = _mm256_set1_ps(m.d[2][1]),
+           m22 = _mm256_set1_ps(m.d[2][2]);
+    __m256 m30 = _mm256_set1_ps(TRANSLATE ? m.d[3][0] : 0.0f),
+           m31 = _mm256_set1_ps(TRANSLATE ? m.d[3][1] : 0.0f),
+           m32 = _mm256_set1_ps(TRANSLATE ? m.d[3][2] : 0.0f);
+    for (; i + 8 <= count; i += 8) {
+      __m256 x = _mm256_loadu_ps(in.x + i);
+      __m256 y = _mm256_loadu_ps(in.y + i);
+      __m256 z = _mm256_loadu_ps(in.z + i);
+      __m256 ox = simd_madd8(z, m20, simd_madd8(y, m10, simd_madd8(x, m00, m30)));
+      __m256 oy = simd_madd8(z, m21, simd_madd8(y, m11, simd_madd8(x, m01, m31)));
+      __m256 oz = simd_madd8(z, m22, simd_madd8(y, m12, simd_madd8(x, m02, m32)));
+      _mm256_storeu_ps(out.x + i, ox);
+      _mm256_storeu_ps(out.y + i, oy);
+      _mm256_storeu_ps(out.z + i, oz);
+    }
+  }
+#endif
+
+#if defined(NS_USE_SIMD)
+  {
+    __m128 m00 = _mm_set1_ps(m.d[0][0]), m01 = _mm_set1_ps(m.d[0][1]),
+           m02 = _mm_set1_ps(m.d[0][2]);
+    __m128 m10 = _mm_set1_ps(m.d[1][0]), m11 = _mm_set1_ps(m.d[1][1]),
+           m12 = _mm_set1_ps(m.d[1][2]);
+    __m128 m20 = _mm_set1_ps(m.d[2][0]), m21 = _mm_set1_ps(m.d[2][1]),
+           m22 = _mm_set1_ps(m.d[2][2]);
+    __m128 m30 = _mm_set1_ps(TRANSLATE ? m.d[3][0] : 0.0f),
+           m31 = _mm_set1_ps(TRANSLATE ? m.d[3][1] : 0.0f),
+           m32 = _mm_set1_ps(TRANSLATE ? m.d[3][2] : 0.0f);
+    for (; i + 4 <= count; i += 4) {
+      __m128 x = _mm_loadu_ps(in.x + i);
+      __m128 y = _mm_loadu_ps(in.y + i);
+      __m128 z = _mm_loadu_ps(in.z + i);
+      __m128 ox = simd_madd(z, m20, simd_madd(y, m10, simd_madd(x, m00, m30)));
+      __m128 oy = simd_madd(z, m21, simd_madd(y, m11, simd_madd(x, m01, m31)));
+      __m128 oz = simd_madd(z, m22, simd_madd(y, m12, simd_madd(x, m02, m32)));
+      _mm_storeu_ps(out.x + i, ox);
+      _mm_storeu_ps(out.y + i, oy);
+      _mm_storeu_ps(out.z + i, oz);
+    }
+  }
+#endif
+
+  for (; i < count; i++) {
+    f32 x = in.x[i];
+    f32 y = in.y[i];
+    f32 z = in.z[i];
+    f32 tx = TRANSLATE ? m.d[3][0] : 0.0f;
+    f32 ty = TRANSLATE ? m.d[3][1] : 0.0f;
+    f32 tz = TRANSLATE ? m.d[3][2] : 0.0f;
+    out.x[i] = tx + x * m.d[0][0] + y * m.d[1][0] + z * m.d[2][0];
+    out.y[i] = ty + x * m.d[0][1] + y * m.d[1][1] + z * m.d[2][1];
+    out.z[i] = tz + x * m.d[0][2] + y * m.d[1][2] + z * m.d[2][2];
+  }
+}
+
+void batch_transform_points(mat4 const &m, vec3_soa const &in,
+                            vec3_soa const &out, usize count) {
+  transform<true>(m, in, out, count);
+}
+
+void batch_transform_directions(mat4 const &m, vec3_soa const &in,
+                                vec3_soa const &out, usize count) {
+  transform<false>(m, in, out, count);
+}
+
+void batch_model_matrices(vec3_soa const &positions, quat_soa const &rotations,
+                          vec3_soa const &scales, mat4 *out, usize count) {
+  usize i = 0;
+
+#if defined(NS_USE_SIMD)
+  // 4 matrices at a time: the rows are computed for 4 elements (one per
+  // lane), then transposed to get the row of each matrix.
+  __m128 one = _mm_set1_ps(1.0f);
+  __m128 two = _mm_set1_ps(2.0f);
+  __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    __m128 qx = _mm_loadu_ps(rotations.x + i);
+    __m128 qy = _mm_loadu_ps(rotations.y + i);
+    __m128 qz = _mm_loadu_ps(rotations.z + i);
+    __m128 qw = _mm_loadu_ps(rotations.w + i);
+
+    __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy),
+           zz = _mm_mul_ps(qz, qz);
+    __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz),
+           yz = _mm_mul_ps(qy, qz);
+    __m128 xw = _mm_mul_ps(qx, qw), yw = _mm_mul_ps(qy, qw),
+           zw = _mm_mul_ps(qz, qw);
+
+    __m128 sx = _mm_loadu_ps(scales.x + i);
+    __m128 sy = _mm_loadu_ps(scales.y + i);
+    __m128 sz = _mm_loadu_ps(scales.z + i);
+
+    __m128 r0x = _mm_mul_ps(
+        sx, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+    __m128 r0y = _mm_mul_ps(sx, _mm_mul_ps(two, _mm_sub_ps(xy, zw)));
+    __m128 r0z = _mm_mul_ps(sx, _mm_mul_ps(two, _mm_add_ps(xz, yw)));
+    __m128 r0w = zero;
+    __m128 r1x = _mm_mul_ps(sy, _mm_mul_ps(two, _mm_add_ps(xy, zw)));
+    __m128 r1y = _mm_mul_ps(
+        sy, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+    __m128 r1z = _mm_mul_ps(sy, _mm_mul_ps(two, _mm_sub_ps(yz, xw)));
+    __m128 r1w = zero;
+    __m128 r2x = _mm_mul_ps(sz, _mm_mul_ps(two, _mm_sub_ps(xz, yw)));
+    __m128 r2y = _mm_mul_ps(sz, _mm_mul_ps(two, _mm_add_ps(yz, xw)));
+    __m128 r2z = _mm_mul_ps(
+        sz, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+    __m128 r2w = zero;
+    __m128 r3x = _mm_loadu_ps(positions.x + i);
+    __m128 r3y = _mm_loadu_ps(positions.y + i);
+    __m128 r3z = _mm_loadu_ps(positions.z + i);
+    __m128 r3w = one;
+
+    _MM_TRANSPOSE4_PS(r0x, r0y, r0z, r0w);
+    _MM_TRANSPOSE4_PS(r1x, r1y, r1z, r1w);
+    _MM_TRANSPOSE4_PS(r2x, r2y, r2z, r2w);
+    _MM_TRANSPOSE4_PS(r3x, r3y, r3z, r3w);
+
+    // After the transposes, the k-th register holds the row of matrix i + k.
+    out[i + 0].rows[0].data = r0x;
+    out[i + 1].rows[0].data = r0y;
+    out[i + 2].rows[0].data = r0z;
+    out[i + 3].rows[0].data = r0w;
+    out[i + 0].rows[1].data = r1x;
+    out[i + 1].rows[1].data = r1y;
+    out[i + 2].rows[1].data = r1z;
+    out[i + 3].rows[1].data = r1w;
+    out[i + 0].rows[2].data = r2x;
+    out[i + 1].rows[2].data = r2y;
+    out[i + 2].rows[2].data = r2z;
+    out[i + 3].rows[2].data = r2w;
+    out[i + 0].rows[3].data = r3x;
+    out[i + 1].rows[3].data = r3y;
+    out[i + 2].rows[3].data = r3z;
+    out[i + 3].rows[3].data = r3w;
+  }
+#endif
+
+  for (; i < count; i++) {
+    f32 x = rotations.x[i], y = rotations.y[i], z = rotations.z[i],
+        w = rotations.w[i];
+    f32 sx = scales.x[i], sy = scales.y[i], sz = scales.z[i];
+    mat4 &o = out[i];
+    o.rows[0] = vec4(sx * (1.0f - 2.0f * (y * y + z * z)),
+                     sx * (2.0f * (x * y - z * w)),
+                     sx * (2.0f * (x * z + y * w)), 0.0f);
+    o.rows[1] = vec4(sy * (2.0f * (x * y + z * w)),
+                     sy * (1.0f - 2.0f * (x * x + z * z)),
+                     sy * (2.0f * (y * z - x * w)), 0.0f);
+    o.rows[2] = vec4(sz * (2.0f * (x * z - y * w)),
+                     sz * (2.0f * (y * z + x * w)),
+                     sz * (1.0f - 2.0f * (x * x + y * y)), 0.0f);
+    o.rows[3] = vec4(positions.x[i], positions.y[i], positions.z[i], 1.0f);
+  }
+}
+
+void batch_multiply(mat4 const *a, mat4 const *b, mat4 *out, usize count) {
+  for (usize i = 0; i < count; i++) {
+    out[i] = a[i] * b[i];
+  }
+}
+
+void batch_compose(mat4 const *local, mat4 const *parents,
+                   u32 const *parent_indices, mat4 *world, usize count) {
+  for (usize i = 0; i < count; i++) {
+    u32 parent = parent_indices[i];
+    world[i] = parent == INVALID_ID ? local[i] : local[i] * parents[parent];
+  }
+}
+
+void batch_compose_hierarchy(mat4 const *local, u32 const *parent_indices,
+                             mat4 *world, usize count) {
+  for (usize i = 0; i < count; i++) {
+    u32 parent = parent_indices[i];
+    world[i] = parent == INVALID_ID ? local[i] : local[i] * world[parent];
+  }
+}
+
+} // namespace ns
@@ -0,0 +1,158 @@
+#ifndef NS_BATCH_HEADER_INCLUDED
+#define NS_BATCH_HEADER_INCLUDED
+
+#include "../defines.h"
+#include "./types/types.h"
+
+// Bulk math on structure-of-arrays data.
+//
+// Points and directions are row vectors, as in the shaders: p' = p * m, so the
+// translation of m is its last row (see mat4::mk_translate).
+//
+// Every kernel processes independent elements, so an array can be split in
+// chunks (see batch_chunk) processed by different threads. Chunk boundaries
+// are multiples of BATCH_CHUNK_ALIGN so each chunk keeps the SIMD path.
+
+namespace ns {
+
+// Default number of elements per chunk
+#define BATCH_CHUNK_SIZE 16384
+// Chunk boundaries are rounded to this many elements (widest SIMD register)
+#define BATCH_CHUNK_ALIGN 8
+
+/**
+ * Arrays of 3d vectors, one array per component
+ */
+struct vec3_soa {
+  f32 *x;
+  f32 *y;
+  f32 *z;
+
+  vec3_soa offset(usize i) const { return {x + i, y + i, z + i}; }
+};
+
+/**
+ * Arrays of quaternions, one array per component
+ */
+struct quat_soa {
+  f32 *x;
+  f32 *y;
+  f32 *z;
+  f32 *w;
+
+  quat_soa offset(usize i) const { return {x + i, y + i, z + i, w + i}; }
+};
+
+/**
+ * A range of elements [begin, end)
+ */
+struct batch_range {
+  usize begin;
+  usize end;
+
+  usize count() const { return end - begin; }
+};
+
+/**
+ * Gets the number of chunks an array is split in
+ * @param count the number of elements
+ * @param chunk_size the number of elements per chunk
+ * @returns the number of chunks
+ */
+NS_INLINE usize batch_chunk_count(usize count,
+                                  usize chunk_size = BATCH_CHUNK_SIZE) {
+  chunk_size = (chunk_size + BATCH_CHUNK_ALIGN - 1) & ~(BATCH_CHUNK_ALIGN - 1);
+  return (count + chunk_size - 1) / chunk_size;
+}
+
+/**
+ * Gets the range of elements of a chunk
+ * @param index the index of the chunk, in [0, batch_chunk_count(count))
+ * @param count the number of elements
+ * @param chunk_size the number of elements per chunk
+ * @returns the range of the chunk
+ */
+NS_INLINE batch_range batch_chunk(usize index, usize count,
+                                  usize chunk_size = BATCH_CHUNK_SIZE) {
+  chunk_size = (chunk_size + BATCH_CHUNK_ALIGN - 1) & ~(BATCH_CHUNK_ALIGN - 1);
+  usize begin = index * chunk_size;
+  usize end = begin + chunk_size;
+  return {begin, end < count ? end : count};
+}
+
+/**
+ * Transforms points (w = 1) by a matrix. in and out may be the same arrays.
+ * @param m the transformation
+ * @param in the points
+ * @param out the transformed points
+ * @param count the number of points
+ */
+NS_API void batch_transform_points(mat4 const &m, vec3_soa const &in,
+                                   vec3_soa const &out, usize count);
+
+/**
+ * Transforms directions (w = 0, no translation) by a matrix. in and out may
+ * be the same arrays.
+ * @param m the transformation
+ * @param in the directions
+ * @param out the transformed directions
+ * @param count the number of directions
+ */
+NS_API void batch_transform_directions(mat4 const &m, vec3_soa const &in,
+                                       vec3_soa const &out, usize count);
+
+/**
+ * Computes model matrices: mk_scale(scale) * rotation.matrix() *
+ * mk_translate(position)
+ * @param positions the positions
+ * @param rotations the rotations (must be normalized)
+ * @param scales the scales
+ * @param out the model matrices
+ * @param count the number of matrices
+ */
+NS_API void batch_model_matrices(vec3_soa const &positions,
+                                 quat_soa const &rotations,
+                                 vec3_soa const &scales, mat4 *out,
+                                 usize count);
+
+/**
+ * Multiplies matrices pairwise: out[i] = a[i] * b[i]. out may be a or b.
+ * @param a the left matrices
+ * @param b the right matrices
+ * @param out the products
+ * @param count the number of matrices
+ */
+NS_API void batch_multiply(mat4 const *a, mat4 const *b, mat4 *out,
+                           usize count);
+
+/**
+ * Composes local matrices with their parent's world matrix:
+ * world[i] = local[i] * parents[parent_indices[i]], or local[i] when the
+ * parent index is INVALID_ID. The parents must not be written by this call,
+ * (e.g. the previous level of a hierarchy), so the chunks are independent.
+ * @param local the local matrices
+ * @param parents the world matrices of the parents
+ * @param parent_indices the index of each parent in parents
+ * @param world the world matrices
+ * @param count the number of matrices
+ */
+NS_API void batch_compose(mat4 const *local, mat4 const *parents,
+                          u32 const *parent_indices, mat4 *world, usize count);
+
+/**
+ * Computes the world matrices of a whole hierarchy in one pass. The nodes
+ * must be sorted so that parents come before their children (the chunks are
+ * not independent).
+ * @param local the local matrices
+ * @param parent_indices the index of each parent in the same arrays, or
+ *        INVALID_ID for the roots
+ * @param world the world matrices
+ * @param count the number of nodes
+ */
+NS_API void batch_compose_hierarchy(mat4 const *local,
+                                    u32 const *parent_indices, mat4 *world,
+                                    usize count);
+
+} // namespace ns
+
+#endif // NS_BATCH_HEADER_INCLUDED
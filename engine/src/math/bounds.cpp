@@ -0,0 +1,251 @@
+#include "./bounds.h"
+#include "./simd.h"
+
+#include <math.h>
+
+namespace ns {
+
+aabb aabb::from_points(vec3 const *points, usize count, usize stride) {
+  if (count == 0) {
+    return {};
+  }
+  u8 const *p = reinterpret_cast<u8 const *>(points);
+  aabb out(*points, *points);
+  for (usize i = 1; i < count; i++) {
+    vec3 const &v = *reinterpret_cast<vec3 const *>(p + i * stride);
+    out.min = {fminf(out.min.x, v.x), fminf(out.min.y, v.y),
+               fminf(out.min.z, v.z)};
+    out.max = {fmaxf(out.max.x, v.x), fmaxf(out.max.y, v.y),
+               fmaxf(out.max.z, v.z)};
+  }
+  return out;
+}
+
+aabb aabb::from_points(vec2 const *points, usize count, usize stride) {
+  if (count == 0) {
+    return {};
+  }
+  u8 const *p = reinterpret_cast<u8 const *>(points);
+  aabb out(vec3(*points, 0.0f), vec3(*points, 0.0f));
+  for (usize i = 1; i < count; i++) {
+    vec2 const &v = *reinterpret_cast<vec2 const *>(p + i * stride);
+    out.min = {fminf(out.min.x, v.x), fminf(out.min.y, v.y), 0.0f};
+    out.max = {fmaxf(out.max.x, v.x), fmaxf(out.max.y, v.y), 0.0f};
+  }
+  return out;
+}
+
+aabb aabb::transformed(mat4 const &m) const {
+  vec3 c = center();
+  vec3 e = extents();
+  vec3 out_center(m.d[3][0], m.d[3][1], m.d[3][2]);
+  vec3 out_extents;
+  for (u32 j = 0; j < 3; j++) {
+    for (u32 i = 0; i < 3; i++) {
+      out_center.elements[j] += c.elements[i] * m.d[i][j];
+      out_extents.elements[j] += e.elements[i] * fabsf(m.d[i][j]);
+    }
+  }
+  return {out_center - out_extents, out_center + out_extents};
+}
+
+frustum::frustum(mat4 const &m) {
+  // clip = p * m: the clip coordinates are the dot products of p with the
+  // columns of m.
+  auto column = [&m](u32 j) {
+    return vec4(m.d[0][j], m.d[1][j], m.d[2][j], m.d[3][j]);
+  };
+  vec4 x = column(0);
+  vec4 y = column(1);
+  vec4 z = column(2);
+  vec4 w = column(3);
+  vec4 sides[SIDE_COUNT] = {w + x, w - x, w + y, w - y, w + z, w - z};
+  for (u32 i = 0; i < SIDE_COUNT; i++) {
+    vec3 n(sides[i].x, sides[i].y, sides[i].z);
+    f32 inv_length = 1.0f / sqrtf(n.dot(n));
+    planes[i].normal = n * inv_length;
+    planes[i].d = sides[i].w * inv_length;
+  }
+}
+
+// The scalar tests use the evaluation order of the SIMD kernels so that both
+// agree, also on the boundary.
+
+NS_INLINE f32 plane_distance(plane const &p, f32 x, f32 y, f32 z) {
+  return p.normal.x * x + p.normal.y * y + p.normal.z * z + p.d;
+}
+
+NS_INLINE f32 plane_radius(plane const &p, f32 ex, f32 ey, f32 ez) {
+  return fabsf(p.normal.x) * ex + fabsf(p.normal.y) * ey +
+         fabsf(p.normal.z) * ez;
+}
+
+bool frustum::contains(vec3 const &p) const {
+  for (plane const &pl : planes) {
+    if (plane_distance(pl, p.x, p.y, p.z) < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool frustum::intersects(aabb const &box) const {
+  vec3 c = box.center();
+  vec3 e = box.extents();
+  for (plane const &pl : planes) {
+    if (plane_distance(pl, c.x, c.y, c.z) + plane_radius(pl, e.x, e.y, e.z) <
+        0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool frustum::intersects(sphere const &s) const {
+  for (plane const &pl : planes) {
+    if (plane_distance(pl, s.center.x, s.center.y, s.center.z) + s.radius <
+        0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+NS_INLINE u32 cull_popcount(u32 v) {
+  v = v - ((v >> 1) & 0x55555555u);
+  v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+  return (((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+#if defined(NS_USE_SIMD)
+// Plane coefficients, broadcast once per call: normal, |normal| and d.
+struct cull_planes {
+  f32 nx[frustum::SIDE_COUNT], ny[frustum::SIDE_COUNT],
+      nz[frustum::SIDE_COUNT];
+  f32 ax[frustum::SIDE_COUNT], ay[frustum::SIDE_COUNT],
+      az[frustum::SIDE_COUNT];
+  f32 d[frustum::SIDE_COUNT];
+};
+
+static cull_planes cull_planes_from(frustum const &f) {
+  cull_planes out;
+  for (u32 i = 0; i < frustum::SIDE_COUNT; i++) {
+    out.nx[i] = f.planes[i].normal.x;
+    out.ny[i] = f.planes[i].normal.y;
+    out.nz[i] = f.planes[i].normal.z;
+    out.ax[i] = fabsf(out.nx[i]);
+    out.ay[i] = fabsf(out.ny[i]);
+    out.az[i] = fabsf(out.nz[i]);
+    out.d[i] = f.planes[i].d;
+  }
+  return out;
+}
+#endif
+
+// Shared by boxes (radius per axis) and spheres (same radius on all planes).
+// Lanes are visible when distance + radius >= 0 for the 6 planes.
+template <bool SPHERE>
+static u32 frustum_cull(frustum const &f, f32 const *cx, f32 const *cy,
+                        f32 const *cz, f32 const *ex, f32 const *ey,
+                        f32 const *ez, usize count, u32 *visibility) {
+  for (usize w = 0; w < cull_mask_word_count(count); w++) {
+    visibility[w] = 0;
+  }
+  usize i = 0;
+
+#if defined(NS_USE_SIMD)
+  cull_planes pl = cull_planes_from(f);
+#endif
+
+#if defined(NS_USE_SIMD) && defined(__AVX2__)
+  for (; i + 8 <= count; i += 8) {
+    __m256 x = _mm256_loadu_ps(cx + i);
+    __m256 y = _mm256_loadu_ps(cy + i);
+    __m256 z = _mm256_loadu_ps(cz + i);
+    __m256 rx = _mm256_loadu_ps(ex + i);
+    __m256 ry = SPHERE ? rx : _mm256_loadu_ps(ey + i);
+    __m256 rz = SPHERE ? rx : _mm256_loadu_ps(ez + i);
+    __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (u32 p = 0; p < frustum::SIDE_COUNT; p++) {
+      __m256 dist = _mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(pl.nx[p]), x),
+                            _mm256_mul_ps(_mm256_set1_ps(pl.ny[p]), y)),
+              _mm256_mul_ps(_mm256_set1_ps(pl.nz[p]), z)),
+          _mm256_set1_ps(pl.d[p]));
+      __m256 r = rx;
+      if (!SPHERE) {
+        r = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(pl.ax[p]), rx),
+                          _mm256_mul_ps(_mm256_set1_ps(pl.ay[p]), ry)),
+            _mm256_mul_ps(_mm256_set1_ps(pl.az[p]), rz));
+      }
+      visible = _mm256_and_ps(visible,
+                              _mm256_cmp_ps(_mm256_add_ps(dist, r),
+                                            _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    u32 mask = static_cast<u32>(_mm256_movemask_ps(visible));
+    visibility[i / 32] |= mask << (i % 32);
+  }
+#endif
+
+#if defined(NS_USE_SIMD)
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(cx + i);
+    __m128 y = _mm_loadu_ps(cy + i);
+    __m128 z = _mm_loadu_ps(cz + i);
+    __m128 rx = _mm_loadu_ps(ex + i);
+    __m128 ry = SPHERE ? rx : _mm_loadu_ps(ey + i);
+    __m128 rz = SPHERE ? rx : _mm_loadu_ps(ez + i);
+    __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (u32 p = 0; p < frustum::SIDE_COUNT; p++) {
+      __m128 dist = _mm_add_ps(
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.nx[p]), x),
+                                _mm_mul_ps(_mm_set1_ps(pl.ny[p]), y)),
+                     _mm_mul_ps(_mm_set1_ps(pl.nz[p]), z)),
+          _mm_set1_ps(pl.d[p]));
+      __m128 r = rx;
+      if (!SPHERE) {
+        r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.ax[p]), rx),
+                                  _mm_mul_ps(_mm_set1_ps(pl.ay[p]), ry)),
+                       _mm_mul_ps(_mm_set1_ps(pl.az[p]), rz));
+      }
+      visible = _mm_and_ps(
+          visible, _mm_cmpge_ps(_mm_add_ps(dist, r), _mm_setzero_ps()));
+    }
+    u32 mask = static_cast<u32>(_mm_movemask_ps(visible));
+    visibility[i / 32] |= mask << (i % 32);
+  }
+#endif
+
+  for (; i < count; i++) {
+    bool visible = true;
+    for (u32 p = 0; p < frustum::SIDE_COUNT && visible; p++) {
+      f32 dist = plane_distance(f.planes[p], cx[i], cy[i], cz[i]);
+      f32 r = SPHERE ? ex[i] : plane_radius(f.planes[p], ex[i], ey[i], ez[i]);
+      visible = dist + r >= 0.0f;
+    }
+    visibility[i / 32] |= static_cast<u32>(visible) << (i % 32);
+  }
+
+  u32 visible_count = 0;
+  for (usize w = 0; w < cull_mask_word_count(count); w++) {
+    visible_count += cull_popcount(visibility[w]);
+  }
+  return visible_count;
+}
+
+u32 frustum_cull_aabbs(frustum const &f, aabb_soa const &boxes, usize count,
+                       u32 *visibility) {
+  return frustum_cull<false>(f, boxes.center_x, boxes.center_y, boxes.center_z,
+                             boxes.extent_x, boxes.extent_y, boxes.extent_z,
+                             count, visibility);
+}
+
+u32 frustum_cull_spheres(frustum const &f, sphere_soa const &spheres,
+                         usize count, u32 *visibility) {
+  return frustum_cull<true>(f, spheres.x, spheres.y, spheres.z, spheres.radius,
+                            nullptr, nullptr, count, visibility);
+}
+
+} // namespace ns
@@ -0,0 +1,172 @@
+#ifndef NS_BOUNDS_HEADER_INCLUDED
+#define NS_BOUNDS_HEADER_INCLUDED
+
+#include "../defines.h"
+#include "./types/types.h"
+
+// Bounding volumes and frustum culling.
+//
+// Points are row vectors (p' = p * m) as in the rest of the math library, so
+// the clip space position of a world point is p * (view * projection): the
+// shaders' projection * view.
+
+namespace ns {
+
+/**
+ * Axis aligned bounding box
+ */
+struct aabb {
+  vec3 min;
+  vec3 max;
+
+  constexpr aabb() : min(), max() {}
+  constexpr aabb(vec3 const &min, vec3 const &max) : min(min), max(max) {}
+
+  /**
+   * Box of an array of points
+   * @param points the first point
+   * @param count the number of points
+   * @param stride the number of bytes between two points (e.g. the vertex
+   *        size when the position is the first member of the vertex)
+   * @returns the box, or an empty box at the origin when count is 0
+   */
+  NS_API static aabb from_points(vec3 const *points, usize count,
+                                 usize stride = sizeof(vec3));
+
+  /**
+   * Box of an array of 2d points, flat in z
+   */
+  NS_API static aabb from_points(vec2 const *points, usize count,
+                                 usize stride = sizeof(vec2));
+
+  vec3 center() const { return (min + max) * 0.5f; }
+  vec3 extents() const { return (max - min) * 0.5f; }
+
+  bool contains(vec3 const &p) const {
+    return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y &&
+           p.z >= min.z && p.z <= max.z;
+  }
+
+  /**
+   * Box of the transformed box (Arvo's method: the corners are not
+   * transformed one by one)
+   * @param m the transformation
+   * @returns the box containing the transformed box
+   */
+  NS_API aabb transformed(mat4 const &m) const;
+};
+
+/**
+ * Bounding sphere
+ */
+struct sphere {
+  vec3 center;
+  f32 radius;
+};
+
+/**
+ * Plane of the points p such that dot(normal, p) + d == 0. The normal points
+ * towards the positive half space.
+ */
+struct plane {
+  vec3 normal;
+  f32 d;
+
+  f32 distance(vec3 const &p) const { return normal.dot(p) + d; }
+};
+
+/**
+ * The 6 planes of a view volume, normals pointing inside
+ */
+struct frustum {
+  enum side {
+    SIDE_LEFT,
+    SIDE_RIGHT,
+    SIDE_BOTTOM,
+    SIDE_TOP,
+    SIDE_NEAR,
+    SIDE_FAR,
+    SIDE_COUNT
+  };
+
+  plane planes[SIDE_COUNT];
+
+  constexpr frustum() : planes{} {}
+
+  /**
+   * Extracts the planes of a view volume (Gribb & Hartmann). The clip volume
+   * is -w <= x, y, z <= w: with a 0 <= z <= w (Vulkan) depth range, the near
+   * plane is conservative.
+   * @param view_projection the view * projection matrix
+   */
+  NS_API explicit frustum(mat4 const &view_projection);
+
+  NS_API bool contains(vec3 const &p) const;
+  NS_API bool intersects(aabb const &box) const;
+  NS_API bool intersects(sphere const &s) const;
+};
+
+/**
+ * Boxes by center and extents (half sizes), one array per component
+ */
+struct aabb_soa {
+  f32 *center_x;
+  f32 *center_y;
+  f32 *center_z;
+  f32 *extent_x;
+  f32 *extent_y;
+  f32 *extent_z;
+};
+
+/**
+ * Spheres, one array per component
+ */
+struct sphere_soa {
+  f32 *x;
+  f32 *y;
+  f32 *z;
+  f32 *radius;
+};
+
+/**
+ * Gets the number of u32 words of a visibility mask
+ * @param count the number of objects
+ */
+NS_INLINE constexpr usize cull_mask_word_count(usize count) { return (count + 31) / 32; }
+
+/**
+ * Tests boxes against a frustum, 8 (AVX2) or 4 (SSE) at a time. Object i is
+ * visible when bit (i % 32) of visibility[i / 32] is set. Same result as
+ * frustum::intersects.
+ * @param f the frustum
+ * @param boxes the boxes
+ * @param count the number of boxes
+ * @param visibility the mask, of cull_mask_word_count(count) words
+ * @returns the number of visible boxes
+ */
+NS_API u32 frustum_cull_aabbs(frustum const &f, aabb_soa const &boxes,
+                              usize count, u32 *visibility);
+
+/**
+ * Tests spheres against a frustum. Same as frustum_cull_aabbs.
+ * @param f the frustum
+ * @param spheres the spheres
+ * @param count the number of spheres
+ * @param visibility the mask, of cull_mask_word_count(count) words
+ * @returns the number of visible spheres
+ */
+NS_API u32 frustum_cull_spheres(frustum const &f, sphere_soa const &spheres,
+                                usize count, u32 *visibility);
+
+/**
+ * Reads the visibility of an object in a mask
+ * @param visibility the mask
+ * @param i the index of the object
+ */
+NS_INLINE bool cull_mask_visible(u32 const *visibility, usize i) {
+  return (visibility[i / 32] >> (i % 32)) & 1;
+}
+
+} // namespace ns
+
+#endif // NS_BOUNDS_HEADER_INCLUDED
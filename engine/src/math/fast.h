@@ -0,0 +1,171 @@
+#ifndef NS_FAST_HEADER_INCLUDED
+#define NS_FAST_HEADER_INCLUDED
+
+#include "../defines.h"
+#include "./cstes.h"
+#include "./simd.h"
+
+#if defined(__SSE__) && !defined(NS_USE_SIMD)
+#include <xmmintrin.h>
+#endif
+
+// Inlined approximations of the libm functions, for hot loops where the
+// out-of-line ns::sin/cos/sqrt (math.h) are too slow. The maximum errors are
+// checked by tests/src/math/fast_tests.cpp:
+//
+//   fast_sin, fast_cos   absolute error <= 4e-7 for |x| <= 1e4 (the range
+//                        reduction loses precision beyond that)
+//   fast_rsqrt           relative error <= NS_FAST_RSQRT_MAX_ERROR: 5e-7
+//                        with SSE, 5e-6 without
+//   fast_sqrt            exact (hardware square root, inlined)
+//
+// The __m128 versions (NS_USE_SIMD) compute the same functions on 4 lanes
+// with the same bounds. The normalize_fast of vec3, vec4 and quat scale by
+// fast_rsqrt of the squared length: the length is 1 within
+// NS_FAST_RSQRT_MAX_ERROR, plus the rounding of the products.
+
+#if defined(__SSE__)
+#define NS_FAST_RSQRT_MAX_ERROR 5e-7
+#else
+#define NS_FAST_RSQRT_MAX_ERROR 5e-6
+#endif
+
+namespace ns {
+
+// 2 pi split in a part with few significant bits (k * hi is exact for
+// |k| < 2^16) and the rest (Cody & Waite).
+#define NS_FAST_2PI_HI 6.28125f
+#define NS_FAST_2PI_LO 1.9353071795864769253e-3f
+
+// Taylor coefficients of sin on [-pi/2, pi/2] (truncation error 6e-8)
+#define NS_FAST_SIN_C3 -1.6666666666666666e-1f
+#define NS_FAST_SIN_C5 8.3333333333333333e-3f
+#define NS_FAST_SIN_C7 -1.9841269841269841e-4f
+#define NS_FAST_SIN_C9 2.7557319223985891e-6f
+#define NS_FAST_SIN_C11 -2.5052108385441719e-8f
+
+/**
+ * sin on [-pi/2, pi/2]
+ */
+NS_INLINE f32 fast_sin_poly(f32 x) {
+  f32 x2 = x * x;
+  f32 p = NS_FAST_SIN_C9 + x2 * NS_FAST_SIN_C11;
+  p = NS_FAST_SIN_C7 + x2 * p;
+  p = NS_FAST_SIN_C5 + x2 * p;
+  p = NS_FAST_SIN_C3 + x2 * p;
+  return x + x * x2 * p;
+}
+
+/**
+ * Reduces an angle to [-pi, pi]
+ */
+NS_INLINE f32 fast_reduce_angle(f32 x) {
+  f32 q = x * PI_2_INV<f32>;
+  f32 k = static_cast<f32>(static_cast<i32>(q + (q >= 0.0f ? 0.5f : -0.5f)));
+  return (x - k * NS_FAST_2PI_HI) - k * NS_FAST_2PI_LO;
+}
+
+/**
+ * Approximation of sin (absolute error <= 4e-7 for |x| <= 1e4)
+ */
+NS_INLINE f32 fast_sin(f32 x) {
+  f32 r = fast_reduce_angle(x);
+  // sin(pi - r) == sin(r), written to compile to conditional moves
+  f32 pi = r < 0.0f ? -PI<f32> : PI<f32>;
+  f32 abs_r = r < 0.0f ? -r : r;
+  return fast_sin_poly(abs_r > PI_1_2<f32> ? pi - r : r);
+}
+
+/**
+ * Approximation of cos (absolute error <= 4e-7 for |x| <= 1e4)
+ */
+NS_INLINE f32 fast_cos(f32 x) {
+  f32 r = fast_reduce_angle(x);
+  // cos(r) == sin(pi/2 - |r|)
+  return fast_sin_poly(PI_1_2<f32> - (r < 0.0f ? -r : r));
+}
+
+/**
+ * Approximation of 1 / sqrt(x) for x > 0 (relative error <=
+ * NS_FAST_RSQRT_MAX_ERROR)
+ */
+NS_INLINE f32 fast_rsqrt(f32 x) {
+#if defined(__SSE__)
+  // 12 bit estimate, then one Newton step. The full width instruction on a
+  // broadcast avoids a dependency on the previous value of the register.
+  f32 y = _mm_cvtss_f32(_mm_rsqrt_ps(_mm_set1_ps(x)));
+  return y * (1.5f - 0.5f * x * y * y);
+#else
+  union {
+    f32 f;
+    u32 u;
+  } bits = {x};
+  bits.u = 0x5F375A86u - (bits.u >> 1);
+  f32 y = bits.f;
+  y = y * (1.5f - 0.5f * x * y * y);
+  return y * (1.5f - 0.5f * x * y * y);
+#endif
+}
+
+/**
+ * Square root, inlined (exact)
+ */
+NS_INLINE f32 fast_sqrt(f32 x) {
+#if defined(__SSE__)
+  return _mm_cvtss_f32(_mm_sqrt_ps(_mm_set1_ps(x)));
+#else
+  return __builtin_sqrtf(x);
+#endif
+}
+
+#if defined(NS_USE_SIMD)
+
+/**
+ * fast_sin on 4 lanes
+ */
+NS_INLINE __m128 simd_fast_sin_poly(__m128 x) {
+  __m128 x2 = _mm_mul_ps(x, x);
+  __m128 p = simd_madd(x2, _mm_set1_ps(NS_FAST_SIN_C11),
+                       _mm_set1_ps(NS_FAST_SIN_C9));
+  p = simd_madd(x2, p, _mm_set1_ps(NS_FAST_SIN_C7));
+  p = simd_madd(x2, p, _mm_set1_ps(NS_FAST_SIN_C5));
+  p = simd_madd(x2, p, _mm_set1_ps(NS_FAST_SIN_C3));
+  return simd_madd(_mm_mul_ps(x, x2), p, x);
+}
+
+NS_INLINE __m128 simd_fast_reduce_angle(__m128 x) {
+  __m128 k = _mm_round_ps(_mm_mul_ps(x, _mm_set1_ps(PI_2_INV<f32>)),
+                          _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(NS_FAST_2PI_HI)));
+  return _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(NS_FAST_2PI_LO)));
+}
+
+NS_INLINE __m128 simd_fast_sin(__m128 x) {
+  __m128 r = simd_fast_reduce_angle(x);
+  __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 abs_r = _mm_andnot_ps(sign, r);
+  // pi with the sign of r, minus r, where |r| > pi/2
+  __m128 folded =
+      _mm_sub_ps(_mm_or_ps(_mm_and_ps(sign, r), _mm_set1_ps(PI<f32>)), r);
+  __m128 outside = _mm_cmpgt_ps(abs_r, _mm_set1_ps(PI_1_2<f32>));
+  return simd_fast_sin_poly(_mm_blendv_ps(r, folded, outside));
+}
+
+NS_INLINE __m128 simd_fast_cos(__m128 x) {
+  __m128 r = simd_fast_reduce_angle(x);
+  __m128 abs_r = _mm_andnot_ps(_mm_set1_ps(-0.0f), r);
+  return simd_fast_sin_poly(_mm_sub_ps(_mm_set1_ps(PI_1_2<f32>), abs_r));
+}
+
+NS_INLINE __m128 simd_fast_rsqrt(__m128 x) {
+  __m128 y = _mm_rsqrt_ps(x);
+  __m128 xyy = _mm_mul_ps(_mm_mul_ps(x, y), y);
+  return _mm_mul_ps(
+      y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), xyy)));
+}
+
+#endif // NS_USE_SIMD
+
+} // namespace ns
+
+#endif // NS_FAST_HEADER_INCLUDED
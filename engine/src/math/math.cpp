@@ -1,10 +1,7 @@
 #include "./math.h"
-#include "../platform/platform.h"
+#include "./random.h"
 
 #include <math.h>
-#include <stdlib.h>
-
-static bool rand_seeded = false;
 
 namespace ns {
 f32 sin(f32 x) { return sinf(x); }
@@ -13,30 +10,15 @@ f32 tan(f32 x) { return tanf(x); }
 f32 acos(f32 x) { return acosf(x); }
 f32 sqrt(f32 x) { return sqrtf(x); }
 f32 abs(f32 x) { return fabsf(x); }
+f64 sqrt(f64 x) { return ::sqrt(x); }
+f64 abs(f64 x) { return fabs(x); }
 
-i32 rand() {
-  if (!rand_seeded) {
-    srand(static_cast<u32>(platform::get_absolute_time()));
-    rand_seeded = true;
-  }
-  return ::rand();
-}
+i32 rand() { return static_cast<i32>(thread_rng().next_u32() >> 1); }
 
-i32 randrange(i32 min, i32 max) {
-  if (!rand_seeded) {
-    srand(static_cast<u32>(platform::get_absolute_time()));
-    rand_seeded = true;
-  }
-  return (ns::rand() % (max - min + 1)) + min;
-}
+i32 randrange(i32 min, i32 max) { return thread_rng().range(min, max); }
 
-f32 frand() {
-  return static_cast<f32>(ns::rand()) / static_cast<f32>(RAND_MAX);
-}
+f32 frand() { return thread_rng().next_f32(); }
 
-f32 frandrange(f32 min, f32 max) {
-  return min + static_cast<f32>(ns::rand()) /
-                   (static_cast<float>(RAND_MAX) / (max - min));
-}
+f32 frandrange(f32 min, f32 max) { return thread_rng().range_f32(min, max); }
 
 } // namespace ns
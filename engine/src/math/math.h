@@ -13,15 +13,18 @@ NS_API f32 tan(f32 x);
 NS_API f32 acos(f32 x);
 NS_API f32 sqrt(f32 x);
 NS_API f32 abs(f32 x);
+NS_API f64 sqrt(f64 x);
+NS_API f64 abs(f64 x);
 
 NS_INLINE bool is_power_of_2(u64 value) {
   return (value != 0) && ((value & (value - 1)) == 0);
 }
 
-NS_API i32 rand();
-NS_API i32 randrange(i32 min, i32 max);
-NS_API f32 frand();
-NS_API f32 frandrange(f32 min, f32 max);
+// Shortcuts for the generator of the calling thread (see random.h)
+NS_API i32 rand();                       // [0, 2^31)
+NS_API i32 randrange(i32 min, i32 max);  // [min, max], unbiased
+NS_API f32 frand();                      // [0, 1)
+NS_API f32 frandrange(f32 min, f32 max); // [min, max)
 
 NS_INLINE f32 deg_2_rad(f32 degrees) { return degrees * DEG_2_RAD<f32>; }
 NS_INLINE f32 rad_2_deg(f32 degrees) { return degrees * RAD_2_DEG<f32>; }
@@ -0,0 +1,177 @@
+#include "./packing.h"
+
+#include <math.h>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace ns {
+
+union packing_f32_bits {
+  f32 f;
+  u32 u;
+};
+
+u16 half_encode(f32 v) {
+#if defined(__F16C__)
+  return static_cast<u16>(_cvtss_sh(v, _MM_FROUND_TO_NEAREST_INT));
+#else
+  // F. Giesen, "float_to_half_fast3_rtne"
+  packing_f32_bits bits = {v};
+  u32 sign = (bits.u >> 16) & 0x8000u;
+  bits.u &= 0x7FFFFFFFu;
+
+  if (bits.u >= 0x7F800000u) {
+    // infinity stays infinity, NaN becomes a quiet NaN
+    u32 payload = bits.u > 0x7F800000u ? 0x7E00u : 0x7C00u;
+    return static_cast<u16>(sign | payload);
+  }
+  if (bits.u >= 0x477FF000u) {
+    // 65520 and above round to infinity
+    return static_cast<u16>(sign | 0x7C00u);
+  }
+  if (bits.u < 0x38800000u) {
+    // Subnormal half: adding 0.5 aligns the mantissa, the addition rounds
+    packing_f32_bits magic = {0.5f};
+    bits.f += magic.f;
+    return static_cast<u16>(sign | (bits.u - magic.u));
+  }
+  u32 mantissa_odd = (bits.u >> 13) & 1u;
+  // Rebias the exponent (127 -> 15) and round to nearest even
+  bits.u += ((15u - 127u) << 23) + 0xFFFu + mantissa_odd;
+  return static_cast<u16>(sign | (bits.u >> 13));
+#endif
+}
+
+f32 half_decode(u16 h) {
+#if defined(__F16C__)
+  return _cvtsh_ss(h);
+#else
+  const u32 shifted_exponent = 0x7C00u << 13;
+  packing_f32_bits out = {0.0f};
+  out.u = (h & 0x7FFFu) << 13;
+  u32 exponent = out.u & shifted_exponent;
+  out.u += (127u - 15u) << 23;
+  if (exponent == shifted_exponent) {
+    // infinity or NaN
+    out.u += (128u - 16u) << 23;
+  } else if (exponent == 0) {
+    // zero or subnormal: renormalize
+    packing_f32_bits magic = {0.0f};
+    magic.u = 113u << 23;
+    out.u += 1u << 23;
+    out.f -= magic.f;
+  }
+  out.u |= static_cast<u32>(h & 0x8000u) << 16;
+  return out.f;
+#endif
+}
+
+NS_INLINE f32 packing_sign(f32 v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+vec2 oct_encode(vec3 const &n) {
+  f32 l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+  vec2 e(n.x / l1, n.y / l1);
+  if (n.z < 0.0f) {
+    e = vec2((1.0f - fabsf(e.y)) * packing_sign(e.x),
+             (1.0f - fabsf(e.x)) * packing_sign(e.y));
+  }
+  return e;
+}
+
+vec3 oct_decode(vec2 const &e) {
+  vec3 n(e.x, e.y, 1.0f - fabsf(e.x) - fabsf(e.y));
+  // Unfold the lower half
+  f32 t = n.z < 0.0f ? -n.z : 0.0f;
+  n.x += n.x >= 0.0f ? -t : t;
+  n.y += n.y >= 0.0f ? -t : t;
+  return n * (1.0f / sqrtf(n.dot(n)));
+}
+
+u32 normal_pack_oct16(vec3 const &n) {
+  vec2 e = oct_encode(n);
+  u32 x = static_cast<u16>(snorm16_encode(e.x));
+  u32 y = static_cast<u16>(snorm16_encode(e.y));
+  return x | (y << 16);
+}
+
+vec3 normal_unpack_oct16(u32 packed) {
+  return oct_decode(vec2(snorm16_decode(static_cast<i16>(packed & 0xFFFFu)),
+                         snorm16_decode(static_cast<i16>(packed >> 16))));
+}
+
+u32 vertex_format_size(VertexFormat format) {
+  switch (format) {
+  case VertexFormat::FLOAT:
+    return sizeof(vertex_3d);
+  case VertexFormat::PACKED_HALF_UV:
+  case VertexFormat::PACKED_UNORM_UV:
+    return sizeof(vertex_3d_packed);
+  }
+  return 0;
+}
+
+cstr vertex_format_name(VertexFormat format) {
+  switch (format) {
+  case VertexFormat::FLOAT:
+    return "float";
+  case VertexFormat::PACKED_HALF_UV:
+    return "packed (half uv)";
+  case VertexFormat::PACKED_UNORM_UV:
+    return "packed (unorm16 uv)";
+  }
+  return "unknown";
+}
+
+// 1 / size per axis, 0 on flat axes (all the positions are at min)
+static vec3 packing_inverse_size(aabb const &bounds) {
+  vec3 size = bounds.max - bounds.min;
+  return vec3(size.x > 0.0f ? 1.0f / size.x : 0.0f,
+              size.y > 0.0f ? 1.0f / size.y : 0.0f,
+              size.z > 0.0f ? 1.0f / size.z : 0.0f);
+}
+
+void vertices_pack(VertexFormat format, vertex_3d const *vertices,
+                   usize count, aabb const &bounds, vertex_3d_packed *out) {
+  vec3 inv_size = packing_inverse_size(bounds);
+  bool half_uv = format == VertexFormat::PACKED_HALF_UV;
+  for (usize i = 0; i < count; i++) {
+    vertex_3d const &v = vertices[i];
+    vec3 p = v.position - bounds.min;
+    out[i].position[0] = unorm16_encode(p.x * inv_size.x);
+    out[i].position[1] = unorm16_encode(p.y * inv_size.y);
+    out[i].position[2] = unorm16_encode(p.z * inv_size.z);
+    out[i].position[3] = 0;
+    if (half_uv) {
+      out[i].texcoord[0] = half_encode(v.texcoord.x);
+      out[i].texcoord[1] = half_encode(v.texcoord.y);
+    } else {
+      out[i].texcoord[0] = unorm16_encode(v.texcoord.x);
+      out[i].texcoord[1] = unorm16_encode(v.texcoord.y);
+    }
+  }
+}
+
+vertex_3d vertex_unpack(VertexFormat format, vertex_3d_packed const &v,
+                        aabb const &bounds) {
+  vec3 size = bounds.max - bounds.min;
+  vertex_3d out;
+  out.position = bounds.min + vec3(unorm16_decode(v.position[0]) * size.x,
+                                   unorm16_decode(v.position[1]) * size.y,
+                                   unorm16_decode(v.position[2]) * size.z);
+  if (format == VertexFormat::PACKED_HALF_UV) {
+    out.texcoord = vec2(half_decode(v.texcoord[0]), half_decode(v.texcoord[1]));
+  } else {
+    out.texcoord =
+        vec2(unorm16_decode(v.texcoord[0]), unorm16_decode(v.texcoord[1]));
+  }
+  return out;
+}
+
+mat4 vertex_dequantize_transform(aabb const &bounds) {
+  // p = min + q * size, as a row vector transformation
+  return mat4::mk_translate(bounds.min).pre_scale(bounds.max - bounds.min);
+}
+
+} // namespace ns
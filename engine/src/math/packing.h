@@ -0,0 +1,120 @@
+#ifndef NS_PACKING_HEADER_INCLUDED
+#define NS_PACKING_HEADER_INCLUDED
+
+#include "../defines.h"
+#include "./bounds.h"
+#include "./types/types.h"
+
+// Quantized encodings of vertex attributes, and the packed vertex layouts
+// made of them. The GPU decodes them when it fetches the attributes (UNORM,
+// SNORM and SFLOAT vertex formats): the decode functions here are the CPU
+// reference. The maximum errors are checked by
+// tests/src/math/packing_tests.cpp:
+//
+//   unorm16              0.5 / 65535 of the encoded range
+//   snorm16              0.5 / 32767
+//   half                 relative 2^-11 (absolute 2^-25 below 2^-14)
+//   octahedral normals   1e-4 radians (2 x snorm16)
+
+namespace ns {
+
+/**
+ * Encodes a value of [0, 1] (clamped) on 16 bits, rounded to nearest
+ */
+NS_INLINE u16 unorm16_encode(f32 v) {
+  v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+  return static_cast<u16>(v * 65535.0f + 0.5f);
+}
+
+NS_INLINE f32 unorm16_decode(u16 v) {
+  return static_cast<f32>(v) * (1.0f / 65535.0f);
+}
+
+/**
+ * Encodes a value of [-1, 1] (clamped) on 16 bits, rounded to nearest
+ */
+NS_INLINE i16 snorm16_encode(f32 v) {
+  v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+  v *= 32767.0f;
+  return static_cast<i16>(v < 0.0f ? v - 0.5f : v + 0.5f);
+}
+
+NS_INLINE f32 snorm16_decode(i16 v) {
+  f32 f = static_cast<f32>(v) * (1.0f / 32767.0f);
+  return f < -1.0f ? -1.0f : f;
+}
+
+/**
+ * Converts a float to a half float (IEEE 754 binary16), rounded to nearest
+ * even. Values too large for a half become infinities.
+ */
+NS_API u16 half_encode(f32 v);
+
+/**
+ * Converts a half float to a float (exact)
+ */
+NS_API f32 half_decode(u16 h);
+
+/**
+ * Octahedral encoding of a unit vector: the octahedron |x| + |y| + |z| = 1,
+ * with the lower half folded over the upper half, maps the sphere to the
+ * [-1, 1] square.
+ * @param n the unit vector
+ * @returns the coordinates in the square
+ */
+NS_API vec2 oct_encode(vec3 const &n);
+
+/**
+ * Unit vector of octahedral coordinates
+ */
+NS_API vec3 oct_decode(vec2 const &e);
+
+/**
+ * Packs a unit vector in 2 x snorm16 (octahedral), x in the low bits, which
+ * is the R16G16_SNORM vertex format
+ */
+NS_API u32 normal_pack_oct16(vec3 const &n);
+
+NS_API vec3 normal_unpack_oct16(u32 packed);
+
+/**
+ * Gets the size of a vertex of a format
+ */
+NS_API u32 vertex_format_size(VertexFormat format);
+
+/**
+ * Gets the name of a format, for reports
+ */
+NS_API cstr vertex_format_name(VertexFormat format);
+
+/**
+ * Packs vertices. The positions are stored relative to bounds, which must
+ * contain them (see aabb::from_points).
+ * @param format a packed format
+ * @param vertices the vertices
+ * @param count the number of vertices
+ * @param bounds the bounds of the vertices
+ * @param out the packed vertices
+ */
+NS_API void vertices_pack(VertexFormat format, vertex_3d const *vertices,
+                          usize count, aabb const &bounds,
+                          vertex_3d_packed *out);
+
+/**
+ * Decodes a packed vertex, as the GPU does
+ * @param format the format of the vertex
+ * @param v the vertex
+ * @param bounds the bounds it was packed with
+ */
+NS_API vertex_3d vertex_unpack(VertexFormat format, vertex_3d_packed const &v,
+                               aabb const &bounds);
+
+/**
+ * Maps the decoded unorm positions ([0, 1]^3) back to the bounds: the model
+ * matrix of a packed geometry is vertex_dequantize_transform(bounds) * model.
+ */
+NS_API mat4 vertex_dequantize_transform(aabb const &bounds);
+
+} // namespace ns
+
+#endif // NS_PACKING_HEADER_INCLUDED
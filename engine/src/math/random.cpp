@@ -0,0 +1,215 @@
+#include "./random.h"
+#include "../platform/platform.h"
+#include "./simd.h"
+
+#include <atomic>
+
+namespace ns {
+
+void rng::jump() {
+  static const u64 JUMP[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                             0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+  u64 t[4] = {0, 0, 0, 0};
+  for (u64 j : JUMP) {
+    for (u32 b = 0; b < 64; b++) {
+      if (j & (1ull << b)) {
+        t[0] ^= s[0];
+        t[1] ^= s[1];
+        t[2] ^= s[2];
+        t[3] ^= s[3];
+      }
+      next_u64();
+    }
+  }
+  s[0] = t[0];
+  s[1] = t[1];
+  s[2] = t[2];
+  s[3] = t[3];
+}
+
+// 4 xoshiro256** streams stored by state word, so that one step of the 4
+// streams is one step of 4 lanes. Each step gives 8 u32: the low then high
+// half of the output of each stream.
+struct rng_streams {
+  alignas(32) u64 s0[4];
+  alignas(32) u64 s1[4];
+  alignas(32) u64 s2[4];
+  alignas(32) u64 s3[4];
+};
+
+static void rng_streams_init(rng *g, rng_streams *st) {
+  for (u32 l = 0; l < 4; l++) {
+    u64 sm = g->next_u64();
+    st->s0[l] = splitmix64(&sm);
+    st->s1[l] = splitmix64(&sm);
+    st->s2[l] = splitmix64(&sm);
+    st->s3[l] = splitmix64(&sm);
+  }
+}
+
+NS_INLINE u64 rng_rotl(u64 x, u32 k) { return (x << k) | (x >> (64 - k)); }
+
+static void rng_streams_step(rng_streams *st, u32 out[8]) {
+  for (u32 l = 0; l < 4; l++) {
+    u64 result = rng_rotl(st->s1[l] * 5, 7) * 9;
+    u64 t = st->s1[l] << 17;
+    st->s2[l] ^= st->s0[l];
+    st->s3[l] ^= st->s1[l];
+    st->s1[l] ^= st->s2[l];
+    st->s0[l] ^= st->s3[l];
+    st->s2[l] ^= t;
+    st->s3[l] = rng_rotl(st->s3[l], 45);
+    out[2 * l] = static_cast<u32>(result);
+    out[2 * l + 1] = static_cast<u32>(result >> 32);
+  }
+}
+
+// Bits to [1, 2), then to [min, max)
+NS_INLINE f32 rng_bits_to_f32(u32 bits, f32 min, f32 scale) {
+  union {
+    u32 u;
+    f32 f;
+  } one_two = {(bits >> 9) | 0x3F800000u};
+  return min + (one_two.f - 1.0f) * scale;
+}
+
+#if defined(NS_USE_SIMD) && defined(__AVX2__)
+struct rng_streams_avx2 {
+  __m256i s0, s1, s2, s3;
+};
+
+NS_INLINE __m256i rng_rotl_avx2(__m256i x, i32 k) {
+  return _mm256_or_si256(_mm256_slli_epi64(x, k),
+                         _mm256_srli_epi64(x, 64 - k));
+}
+
+NS_INLINE __m256i rng_streams_step_avx2(rng_streams_avx2 *st) {
+  // x * 5 and x * 9 as shifts and adds (no 64 bit multiply in AVX2)
+  __m256i x5 = _mm256_add_epi64(_mm256_slli_epi64(st->s1, 2), st->s1);
+  __m256i rot = rng_rotl_avx2(x5, 7);
+  __m256i result = _mm256_add_epi64(_mm256_slli_epi64(rot, 3), rot);
+  __m256i t = _mm256_slli_epi64(st->s1, 17);
+  st->s2 = _mm256_xor_si256(st->s2, st->s0);
+  st->s3 = _mm256_xor_si256(st->s3, st->s1);
+  st->s1 = _mm256_xor_si256(st->s1, st->s2);
+  st->s0 = _mm256_xor_si256(st->s0, st->s3);
+  st->s2 = _mm256_xor_si256(st->s2, t);
+  st->s3 = rng_rotl_avx2(st->s3, 45);
+  return result;
+}
+
+NS_INLINE rng_streams_avx2 rng_streams_load_avx2(rng_streams const &st) {
+  return {_mm256_load_si256(reinterpret_cast<__m256i const *>(st.s0)),
+          _mm256_load_si256(reinterpret_cast<__m256i const *>(st.s1)),
+          _mm256_load_si256(reinterpret_cast<__m256i const *>(st.s2)),
+          _mm256_load_si256(reinterpret_cast<__m256i const *>(st.s3))};
+}
+
+NS_INLINE void rng_streams_store_avx2(rng_streams_avx2 const &v,
+                                      rng_streams *st) {
+  _mm256_store_si256(reinterpret_cast<__m256i *>(st->s0), v.s0);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(st->s1), v.s1);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(st->s2), v.s2);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(st->s3), v.s3);
+}
+#endif
+
+void rng::fill_u32(u32 *out, usize count) {
+  rng_streams st;
+  rng_streams_init(this, &st);
+  usize i = 0;
+
+#if defined(NS_USE_SIMD) && defined(__AVX2__)
+  rng_streams_avx2 v = rng_streams_load_avx2(st);
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        rng_streams_step_avx2(&v));
+  }
+  rng_streams_store_avx2(v, &st);
+#else
+  for (; i + 8 <= count; i += 8) {
+    rng_streams_step(&st, out + i);
+  }
+#endif
+
+  if (i < count) {
+    u32 last[8];
+    rng_streams_step(&st, last);
+    for (u32 j = 0; i < count; i++, j++) {
+      out[i] = last[j];
+    }
+  }
+}
+
+void rng::fill_f32(f32 *out, usize count, f32 min, f32 max) {
+  rng_streams st;
+  rng_streams_init(this, &st);
+  f32 scale = max - min;
+  usize i = 0;
+
+#if defined(NS_USE_SIMD) && defined(__AVX2__)
+  rng_streams_avx2 v = rng_streams_load_avx2(st);
+  __m256i exponent = _mm256_set1_epi32(0x3F800000);
+  __m256 one = _mm256_set1_ps(1.0f);
+  __m256 vmin = _mm256_set1_ps(min);
+  __m256 vscale = _mm256_set1_ps(scale);
+  for (; i + 8 <= count; i += 8) {
+    __m256i bits = rng_streams_step_avx2(&v);
+    __m256 f = _mm256_castsi256_ps(
+        _mm256_or_si256(_mm256_srli_epi32(bits, 9), exponent));
+    f = _mm256_add_ps(vmin, _mm256_mul_ps(_mm256_sub_ps(f, one), vscale));
+    _mm256_storeu_ps(out + i, f);
+  }
+  rng_streams_store_avx2(v, &st);
+#else
+  u32 bits[8];
+  for (; i + 8 <= count; i += 8) {
+    rng_streams_step(&st, bits);
+    for (u32 j = 0; j < 8; j++) {
+      out[i + j] = rng_bits_to_f32(bits[j], min, scale);
+    }
+  }
+#endif
+
+  if (i < count) {
+    u32 last[8];
+    rng_streams_step(&st, last);
+    for (u32 j = 0; i < count; i++, j++) {
+      out[i] = rng_bits_to_f32(last[j], min, scale);
+    }
+  }
+}
+
+// The thread generators are reseeded when the generation changes.
+static std::atomic<u64> random_base_seed;
+static std::atomic<u32> random_generation;
+static std::atomic<u32> random_thread_count;
+
+static thread_local rng tls_rng;
+static thread_local u32 tls_generation = INVALID_ID;
+
+rng &thread_rng() {
+  u32 generation = random_generation.load(std::memory_order_acquire);
+  if (tls_generation == generation) {
+    return tls_rng;
+  }
+  tls_generation = generation;
+  u32 index = random_thread_count.fetch_add(1, std::memory_order_relaxed);
+  u64 seed = generation == 0
+                 ? static_cast<u64>(platform::get_absolute_time() * 1e9)
+                 : random_base_seed.load(std::memory_order_relaxed);
+  // Same seed, then one jump per thread: the sequences never overlap.
+  tls_rng.seed(seed);
+  for (u32 i = 0; i < index; i++) {
+    tls_rng.jump();
+  }
+  return tls_rng;
+}
+
+void random_seed(u64 seed) {
+  random_base_seed.store(seed, std::memory_order_relaxed);
+  random_thread_count.store(0, std::memory_order_relaxed);
+  random_generation.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace ns
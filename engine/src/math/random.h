@@ -0,0 +1,160 @@
+#ifndef NS_RANDOM_HEADER_INCLUDED
+#define NS_RANDOM_HEADER_INCLUDED
+
+#include "../defines.h"
+
+// Pseudo random numbers: xoshiro256** (https://prng.di.unimi.it/), seeded
+// with splitmix64. A generator is a plain value: it is not thread-safe, but
+// each thread has its own (see thread_rng), so there is no shared state.
+
+namespace ns {
+
+/**
+ * splitmix64 step: mixes the state into a well distributed value. Used to
+ * expand seeds.
+ * @param state the state, advanced by the call
+ * @returns the next value
+ */
+NS_INLINE constexpr u64 splitmix64(u64 *state) {
+  u64 z = (*state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+/**
+ * xoshiro256** generator. The same seed always produces the same sequence.
+ */
+struct rng {
+  u64 s[4];
+
+  // constexpr, so that thread_local generators need no initialization guard
+  constexpr rng() : s{} { seed(0); }
+  explicit constexpr rng(u64 seed_value) : s{} { seed(seed_value); }
+
+  /**
+   * Resets the generator
+   * @param seed_value any value (0 included)
+   */
+  constexpr void seed(u64 seed_value) {
+    u64 sm = seed_value;
+    s[0] = splitmix64(&sm);
+    s[1] = splitmix64(&sm);
+    s[2] = splitmix64(&sm);
+    s[3] = splitmix64(&sm);
+  }
+
+  /**
+   * @returns 64 uniformly distributed bits
+   */
+  u64 next_u64() {
+    u64 result = rotl(s[1] * 5, 7) * 9;
+    u64 t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+  }
+
+  /**
+   * @returns 32 uniformly distributed bits
+   */
+  u32 next_u32() { return static_cast<u32>(next_u64() >> 32); }
+
+  /**
+   * Unbiased integer in [0, bound) (Lemire's multiply and reject)
+   * @param bound the exclusive upper bound, not 0
+   */
+  u32 below(u32 bound) {
+    u64 m = static_cast<u64>(next_u32()) * bound;
+    u32 low = static_cast<u32>(m);
+    if (low < bound) {
+      u32 threshold = (0u - bound) % bound;
+      while (low < threshold) {
+        m = static_cast<u64>(next_u32()) * bound;
+        low = static_cast<u32>(m);
+      }
+    }
+    return static_cast<u32>(m >> 32);
+  }
+
+  /**
+   * Unbiased integer in [min, max] (both inclusive)
+   */
+  i32 range(i32 min, i32 max) {
+    u32 span = static_cast<u32>(max) - static_cast<u32>(min) + 1;
+    if (span == 0) {
+      return static_cast<i32>(next_u32());
+    }
+    return static_cast<i32>(static_cast<u32>(min) + below(span));
+  }
+
+  /**
+   * @returns a float in [0, 1), with 24 random bits
+   */
+  f32 next_f32() {
+    return static_cast<f32>(next_u64() >> 40) * (1.0f / 16777216.0f);
+  }
+
+  /**
+   * @returns a float in [min, max)
+   */
+  f32 range_f32(f32 min, f32 max) { return min + next_f32() * (max - min); }
+
+  /**
+   * @returns a double in [0, 1), with 53 random bits
+   */
+  f64 next_f64() {
+    return static_cast<f64>(next_u64() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  /**
+   * Advances the generator by 2^128 steps: calling it n times on copies of a
+   * generator gives n non-overlapping sequences.
+   */
+  NS_API void jump();
+
+  /**
+   * Fills an array with random bits. The array is generated on 4 streams
+   * derived from the generator (vectorized with AVX2); the result only
+   * depends on the state of the generator and on count.
+   * @param out the array
+   * @param count the number of values
+   */
+  NS_API void fill_u32(u32 *out, usize count);
+
+  /**
+   * Fills an array with floats in [min, max), with 23 random bits. Same
+   * streams as fill_u32.
+   * @param out the array
+   * @param count the number of values
+   * @param min the lower bound
+   * @param max the upper bound
+   */
+  NS_API void fill_f32(f32 *out, usize count, f32 min = 0.0f,
+                       f32 max = 1.0f);
+
+private:
+  static u64 rotl(u64 x, u32 k) { return (x << k) | (x >> (64 - k)); }
+};
+
+/**
+ * Gets the generator of the calling thread. Each thread is seeded from the
+ * global seed and from the order in which threads first use it.
+ * @returns the generator
+ */
+NS_API rng &thread_rng();
+
+/**
+ * Sets the global seed and reseeds every thread generator on its next use,
+ * for reproducible runs. Without it, the seed comes from the clock.
+ * @param seed the seed
+ */
+NS_API void random_seed(u64 seed);
+
+} // namespace ns
+
+#endif // NS_RANDOM_HEADER_INCLUDED
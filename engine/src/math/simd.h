@@ -0,0 +1,103 @@
+#ifndef NS_SIMD_HEADER_INCLUDED
+#define NS_SIMD_HEADER_INCLUDED
+
+// SIMD helpers for the math types. Enabled by NS_USE_SIMD (see the
+// NS_USE_SIMD / NS_SIMD_LEVEL options in engine/CMakeLists.txt), which
+// requires at least SSE4.1. AVX2 and FMA are used when the compiler targets
+// them (__AVX2__, __FMA__).
+
+#if defined(NS_USE_SIMD)
+
+#if !defined(__SSE4_1__)
+#error "NS_USE_SIMD requires SSE4.1 (compile with -msse4.1 or higher)"
+#endif
+
+#include <immintrin.h>
+
+#define NS_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+
+// Lanes (a.x, a.y, b.z, b.w) chosen by index
+#define NS_SHUFFLE(a, b, x, y, z, w)                                           \
+  _mm_shuffle_ps(a, b, NS_SHUFFLE_MASK(x, y, z, w))
+
+#define NS_SWIZZLE(v, x, y, z, w)                                              \
+  _mm_castsi128_ps(                                                            \
+      _mm_shuffle_epi32(_mm_castps_si128(v), NS_SHUFFLE_MASK(x, y, z, w)))
+
+#define NS_SWIZZLE1(v, i) NS_SWIZZLE(v, i, i, i, i)
+
+namespace ns {
+
+/**
+ * a * b + c (fused when FMA is available, so the rounding differs)
+ */
+NS_INLINE __m128 simd_madd(__m128 a, __m128 b, __m128 c) {
+#if defined(__FMA__)
+  return _mm_fmadd_ps(a, b, c);
+#else
+  return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+#if defined(__AVX2__)
+/**
+ * a * b + c on 8 lanes (fused when FMA is available)
+ */
+NS_INLINE __m256 simd_madd8(__m256 a, __m256 b, __m256 c) {
+#if defined(__FMA__)
+  return _mm256_fmadd_ps(a, b, c);
+#else
+  return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+/**
+ * Flips the sign of the lanes whose mask lane is -0.0f
+ */
+NS_INLINE __m128 simd_flip_sign(__m128 v, __m128 sign_mask) {
+  return _mm_xor_ps(v, sign_mask);
+}
+
+/**
+ * Dot product of two 4 lane vectors, broadcast to every lane
+ */
+NS_INLINE __m128 simd_dot4(__m128 a, __m128 b) {
+  return _mm_dp_ps(a, b, 0xFF);
+}
+
+/**
+ * Cross product of the xyz lanes (w of the result is 0 when a.w == b.w == 0)
+ */
+NS_INLINE __m128 simd_cross3(__m128 a, __m128 b) {
+  __m128 a_yzx = NS_SWIZZLE(a, 1, 2, 0, 3);
+  __m128 b_yzx = NS_SWIZZLE(b, 1, 2, 0, 3);
+  __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+  return NS_SWIZZLE(c, 1, 2, 0, 3);
+}
+
+/**
+ * Divides a vector by its length (exact sqrt and division, no estimates)
+ */
+NS_INLINE __m128 simd_normalize4(__m128 v) {
+  return _mm_div_ps(v, _mm_sqrt_ps(simd_dot4(v, v)));
+}
+
+/**
+ * Linear combination of the 4 rows of a row-major 4x4 matrix:
+ * v.x * r0 + v.y * r1 + v.z * r2 + v.w * r3
+ */
+NS_INLINE __m128 simd_combine_rows(__m128 v, __m128 r0, __m128 r1, __m128 r2,
+                                   __m128 r3) {
+  __m128 out = _mm_mul_ps(NS_SWIZZLE1(v, 0), r0);
+  out = simd_madd(NS_SWIZZLE1(v, 1), r1, out);
+  out = simd_madd(NS_SWIZZLE1(v, 2), r2, out);
+  out = simd_madd(NS_SWIZZLE1(v, 3), r3, out);
+  return out;
+}
+
+} // namespace ns
+
+#endif // NS_USE_SIMD
+
+#endif // NS_SIMD_HEADER_INCLUDED
@@ -0,0 +1,28 @@
+#include "./transform.h"
+
+namespace ns {
+
+void transform::update() {
+  // rotation.matrix() normalizes: the rotation may drift after many rotate()
+  mat4 m = m_rotation.matrix().pre_scale(m_scale);
+  m.rows[3] = vec4(m_position, 1.0f);
+  m_local = m;
+  m_dirty = false;
+}
+
+mat4 transform::inverse_matrix() {
+  mat4 const &local = local_matrix();
+  if (is_rigid()) {
+    return local.inverse_rigid();
+  }
+  return local.inverse();
+}
+
+transform transform::interpolate(transform const &a, transform const &b,
+                                 f32 t) {
+  return transform(a.m_position * (1.0f - t) + b.m_position * t,
+                   quat(a.m_rotation, b.m_rotation, t),
+                   a.m_scale * (1.0f - t) + b.m_scale * t);
+}
+
+} // namespace ns
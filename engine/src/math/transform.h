@@ -0,0 +1,107 @@
+#ifndef NS_TRANSFORM_HEADER_INCLUDED
+#define NS_TRANSFORM_HEADER_INCLUDED
+
+#include "../defines.h"
+#include "./types/types.h"
+
+namespace ns {
+
+/**
+ * Position, rotation and scale of an object. The local matrix,
+ * mk_scale(scale) * rotation.matrix() * mk_translate(position) (the order of
+ * batch_model_matrices), is cached and only recomputed after a change.
+ */
+struct transform {
+  transform()
+      : m_position(), m_rotation(), m_scale(1.0f), m_local(1.0f),
+        m_dirty(false) {}
+  explicit transform(vec3 const &position,
+                     quat const &rotation = quat::identity(),
+                     vec3 const &scale = vec3(1.0f))
+      : m_position(position), m_rotation(rotation), m_scale(scale),
+        m_local(), m_dirty(true) {}
+
+  vec3 const &position() const { return m_position; }
+  quat const &rotation() const { return m_rotation; }
+  vec3 const &scale() const { return m_scale; }
+
+  void set_position(vec3 const &position) {
+    m_position = position;
+    m_dirty = true;
+  }
+  void set_rotation(quat const &rotation) {
+    m_rotation = rotation;
+    m_dirty = true;
+  }
+  void set_scale(vec3 const &scale) {
+    m_scale = scale;
+    m_dirty = true;
+  }
+
+  void translate(vec3 const &offset) {
+    m_position += offset;
+    m_dirty = true;
+  }
+
+  /**
+   * Applies a rotation after the current one
+   */
+  void rotate(quat const &rotation) {
+    m_rotation = m_rotation * rotation;
+    m_dirty = true;
+  }
+
+  /**
+   * @returns whether the cached matrix is out of date
+   */
+  bool is_dirty() const { return m_dirty; }
+
+  /**
+   * @returns whether the scale is exactly 1: the local matrix is then a
+   *          rotation and a translation, inverted by mat4::inverse_rigid
+   */
+  bool is_rigid() const {
+    return m_scale.x == 1.0f && m_scale.y == 1.0f && m_scale.z == 1.0f;
+  }
+
+  /**
+   * Gets the local matrix, recomputed if the transform changed since the
+   * last call
+   */
+  mat4 const &local_matrix() {
+    if (m_dirty) {
+      update();
+    }
+    return m_local;
+  }
+
+  /**
+   * Gets the inverse of the local matrix (e.g. the view matrix of a camera).
+   * Rigid transforms take the transpose/negate path instead of the general
+   * inverse.
+   */
+  NS_API mat4 inverse_matrix();
+
+  /**
+   * Interpolates between two transforms: linear for the position and the
+   * scale, slerp for the rotation
+   * @param a the transform at t = 0
+   * @param b the transform at t = 1
+   * @param t the interpolation factor
+   */
+  NS_API static transform interpolate(transform const &a, transform const &b,
+                                      f32 t);
+
+private:
+  vec3 m_position;
+  quat m_rotation;
+  vec3 m_scale;
+  mat4 m_local;
+  bool m_dirty;
+
+  NS_API void update();
+};
+
+} // namespace ns
+
+#endif // NS_TRANSFORM_HEADER_INCLUDED
@@ -2,10 +2,10 @@
 #define NS_MAT4_HEADER_INCLUDED
 
 #include "../../../core/logger.h"
-#include "../../../core/memory.h"
 #include "../../../defines.h"
 #include "../vec/vec3.h"
 #include "../vec/vec4.h"
+#include "../../simd.h"
 
 namespace ns {
 
@@ -19,25 +19,45 @@ struct mat4 {
     vec4 rows[4];
     f32 d[4][4];
   };
-  mat4() { mem_zero(data, 16 * sizeof(f32)); }
-  mat4(mat4 const &other) { mem_copy(data, other.data, 16 * sizeof(f32)); }
-  mat4(mat4 &&other) { mem_copy(data, other.data, 16 * sizeof(f32)); }
-  mat4 &operator=(mat4 const &other) {
-    mem_copy(data, other.data, 16 * sizeof(f32));
-    return *this;
-  }
-  mat4 &operator=(mat4 &&other) {
-    mem_copy(data, other.data, 16 * sizeof(f32));
-    return *this;
-  }
-  explicit mat4(f32 f) {
-    mem_zero(data, 16 * sizeof(f32));
-    d[0][0] = d[1][1] = d[2][2] = f;
-    d[3][3] = 1.0f;
-  }
-
-  mat4 operator*(mat4 const &other) {
+  constexpr mat4() : data{} {}
+  explicit constexpr mat4(f32 f)
+      : data{f, 0.0f, 0.0f, 0.0f, 0.0f, f,    0.0f, 0.0f,
+             0.0f, 0.0f, f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f} {}
+  constexpr mat4(vec4 const &r0, vec4 const &r1, vec4 const &r2,
+                 vec4 const &r3)
+      : rows{r0, r1, r2, r3} {}
+
+  mat4 operator*(mat4 const &other) const {
     mat4 out_matrix{};
+#if defined(NS_USE_SIMD) && defined(__AVX2__)
+    // Two rows of the result per 256 bit register.
+    __m256 b0 = _mm256_broadcast_ps(&other.rows[0].data);
+    __m256 b1 = _mm256_broadcast_ps(&other.rows[1].data);
+    __m256 b2 = _mm256_broadcast_ps(&other.rows[2].data);
+    __m256 b3 = _mm256_broadcast_ps(&other.rows[3].data);
+    for (i32 i = 0; i < 16; i += 8) {
+      __m256 a = _mm256_loadu_ps(&data[i]);
+      __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), b0);
+#if defined(__FMA__)
+      r = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0x55), b1, r);
+      r = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xAA), b2, r);
+      r = _mm256_fmadd_ps(_mm256_shuffle_ps(a, a, 0xFF), b3, r);
+#else
+      r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x55), b1), r);
+      r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xAA), b2), r);
+      r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xFF), b3), r);
+#endif
+      _mm256_storeu_ps(&out_matrix.data[i], r);
+    }
+#elif defined(NS_USE_SIMD)
+    // Row i of the result is the combination of the rows of other by row i.
+    for (i32 i = 0; i < 4; i++) {
+      out_matrix.rows[i].data =
+          simd_combine_rows(rows[i].data, other.rows[0].data,
+                            other.rows[1].data, other.rows[2].data,
+                            other.rows[3].data);
+    }
+#else
     const f32 *m1_ptr = data;
     const f32 *m2_ptr = other.data;
     f32 *dst_ptr = out_matrix.data;
@@ -49,22 +69,32 @@ struct mat4 {
       }
       m1_ptr += 4;
     }
+#endif
     return out_matrix;
   }
 
-  vec4 operator*(vec4 const &v) {
+  vec4 operator*(vec4 const &v) const {
+#if defined(NS_USE_SIMD)
+    __m128 c0 = rows[0].data;
+    __m128 c1 = rows[1].data;
+    __m128 c2 = rows[2].data;
+    __m128 c3 = rows[3].data;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    return vec4(simd_combine_rows(v.data, c0, c1, c2, c3));
+#else
     vec4 out_vec{};
     for (i32 i = 0; i < 4; i++) {
       out_vec[i] =
           v.x * d[i][0] + v.y * d[i][1] + v.z * d[i][2] + v.w * d[i][3];
     }
     return out_vec;
+#endif
   }
 
   f32 *operator[](usize i) { return d[i]; }
   const f32 *operator[](usize i) const { return d[i]; }
 
-  static mat4 identity() { return mat4(1.0f); }
+  static constexpr mat4 identity() { return mat4(1.0f); }
 
   static mat4 orthographic(f32 left, f32 right, f32 bottom, f32 top,
                            f32 near_clip, f32 far_clip) {
@@ -88,7 +118,6 @@ struct mat4 {
     f32 half_tan_fov = tan(fov_rad * 0.5f);
     mat4 out_matrix;
     f32 fn = 1.0f / (far_clip - near_clip);
-    mem_zero(out_matrix.data, 16 * sizeof(f32));
     out_matrix[0][0] = 1.0f / (aspect_ratio * half_tan_fov);
     out_matrix[1][1] = 1.0f / half_tan_fov;
     out_matrix[2][2] = -(far_clip + near_clip) * fn;
@@ -124,6 +153,9 @@ struct mat4 {
   }
 
   mat4 inverse() const {
+#if defined(NS_USE_SIMD)
+    return inverse_simd();
+#else
     const f32 *m = data;
 
     f32 t0 = m[10] * m[15];
@@ -171,7 +203,7 @@ struct mat4 {
                 (t0 * m[4] + t3 * m[8] + t4 * m[12]));
     o[5] = d * ((t0 * m[0] + t7 * m[8] + t8 * m[12]) -
                 (t1 * m[0] + t6 * m[8] + t9 * m[12]));
-    o[6] = d * ((t3 * m[0] + t8 * m[4] + t11 * m[12]) -
+    o[6] = d * ((t3 * m[0] + t6 * m[4] + t11 * m[12]) -
                 (t2 * m[0] + t7 * m[4] + t10 * m[12]));
     o[7] = d * ((t4 * m[0] + t9 * m[4] + t10 * m[8]) -
                 (t5 * m[0] + t8 * m[4] + t11 * m[8]));
@@ -193,7 +225,116 @@ struct mat4 {
                  (t20 * m[6] + t23 * m[10] + t17 * m[2]));
 
     return out_matrix;
+#endif
+  }
+
+  /**
+   * Inverse of a rigid transformation (a rotation then a translation, no
+   * scale or projection): the transposed rotation, and the translation
+   * negated and rotated back. Much cheaper than inverse(), but only valid for
+   * these matrices.
+   */
+  mat4 inverse_rigid() const {
+    mat4 out_matrix;
+#if defined(NS_USE_SIMD)
+    // The last column of a rigid matrix is (0, 0, 0, 1): after the
+    // transpose, r3 is zero and r0..r2 are the rows of the inverse rotation.
+    __m128 r0 = rows[0].data;
+    __m128 r1 = rows[1].data;
+    __m128 r2 = rows[2].data;
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    __m128 t = simd_combine_rows(rows[3].data, r0, r1, r2, r3);
+    out_matrix.rows[0].data = r0;
+    out_matrix.rows[1].data = r1;
+    out_matrix.rows[2].data = r2;
+    out_matrix.rows[3].data =
+        _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), t);
+#else
+    for (u32 i = 0; i < 3; i++) {
+      for (u32 j = 0; j < 3; j++) {
+        out_matrix.d[i][j] = d[j][i];
+      }
+    }
+    for (u32 j = 0; j < 3; j++) {
+      out_matrix.d[3][j] =
+          -(d[3][0] * d[j][0] + d[3][1] * d[j][1] + d[3][2] * d[j][2]);
+    }
+    out_matrix.d[3][3] = 1.0f;
+#endif
+    return out_matrix;
+  }
+
+#if defined(NS_USE_SIMD)
+  // 2x2 matrices packed in a register (row-major): a * b, adj(a) * b and
+  // a * adj(b)
+  static __m128 mat2_mul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, NS_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(NS_SWIZZLE(a, 1, 0, 3, 2),
+                                 NS_SWIZZLE(b, 2, 1, 2, 1)));
+  }
+  static __m128 mat2_adj_mul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(NS_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(NS_SWIZZLE(a, 1, 1, 2, 2),
+                                 NS_SWIZZLE(b, 2, 3, 0, 1)));
+  }
+  static __m128 mat2_mul_adj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, NS_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(NS_SWIZZLE(a, 1, 0, 3, 2),
+                                 NS_SWIZZLE(b, 2, 1, 2, 1)));
+  }
+
+  // Blockwise inversion on the four 2x2 sub-matrices
+  // | A B |
+  // | C D |
+  mat4 inverse_simd() const {
+    __m128 r0 = rows[0].data;
+    __m128 r1 = rows[1].data;
+    __m128 r2 = rows[2].data;
+    __m128 r3 = rows[3].data;
+    __m128 a = _mm_movelh_ps(r0, r1);
+    __m128 b = _mm_movehl_ps(r1, r0);
+    __m128 c = _mm_movelh_ps(r2, r3);
+    __m128 dd = _mm_movehl_ps(r3, r2);
+
+    // Determinants of A, B, C and D
+    __m128 det_sub =
+        _mm_sub_ps(_mm_mul_ps(NS_SHUFFLE(r0, r2, 0, 2, 0, 2),
+                              NS_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+                   _mm_mul_ps(NS_SHUFFLE(r0, r2, 1, 3, 1, 3),
+                              NS_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+    __m128 det_a = NS_SWIZZLE1(det_sub, 0);
+    __m128 det_b = NS_SWIZZLE1(det_sub, 1);
+    __m128 det_c = NS_SWIZZLE1(det_sub, 2);
+    __m128 det_d = NS_SWIZZLE1(det_sub, 3);
+
+    __m128 d_c = mat2_adj_mul(dd, c);
+    __m128 a_b = mat2_adj_mul(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_mul(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, dd), mat2_mul(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_mul_adj(dd, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_mul_adj(a, d_c));
+
+    __m128 det = _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c));
+    __m128 tr = _mm_mul_ps(a_b, NS_SWIZZLE(d_c, 0, 2, 1, 3));
+    tr = _mm_hadd_ps(tr, tr);
+    tr = _mm_hadd_ps(tr, tr);
+    det = _mm_sub_ps(det, tr);
+
+    __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, inv_det);
+    y = _mm_mul_ps(y, inv_det);
+    z = _mm_mul_ps(z, inv_det);
+    w = _mm_mul_ps(w, inv_det);
+
+    mat4 out_matrix;
+    out_matrix.rows[0].data = NS_SHUFFLE(x, y, 3, 1, 3, 1);
+    out_matrix.rows[1].data = NS_SHUFFLE(x, y, 2, 0, 2, 0);
+    out_matrix.rows[2].data = NS_SHUFFLE(z, w, 3, 1, 3, 1);
+    out_matrix.rows[3].data = NS_SHUFFLE(z, w, 2, 0, 2, 0);
+    return out_matrix;
   }
+#endif
 
   static mat4 mk_translate(vec3 const &pos) {
     mat4 out_matrix(1.0f);
@@ -325,6 +466,17 @@ struct mat4 {
 
   mat4 transposed() const {
     mat4 out_matrix;
+#if defined(NS_USE_SIMD)
+    __m128 r0 = rows[0].data;
+    __m128 r1 = rows[1].data;
+    __m128 r2 = rows[2].data;
+    __m128 r3 = rows[3].data;
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    out_matrix.rows[0].data = r0;
+    out_matrix.rows[1].data = r1;
+    out_matrix.rows[2].data = r2;
+    out_matrix.rows[3].data = r3;
+#else
     out_matrix[0][0] = d[0][0];
     out_matrix[0][1] = d[1][0];
     out_matrix[0][2] = d[2][0];
@@ -341,6 +493,7 @@ struct mat4 {
     out_matrix[3][1] = d[1][3];
     out_matrix[3][2] = d[2][3];
     out_matrix[3][3] = d[3][3];
+#endif
     return out_matrix;
   }
 
@@ -3,6 +3,8 @@
 
 #include "../../defines.h"
 #include "../cstes.h"
+#include "../fast.h"
+#include "../simd.h"
 #include "./mat/mat4.h"
 
 namespace ns {
@@ -35,14 +37,15 @@ struct quat {
     };
   };
 
-  quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
-  quat(quat const &other) : x(other.x), y(other.y), z(other.z), w(other.w) {}
-  quat(quat &&other) : x(other.x), y(other.y), z(other.z), w(other.w) {}
-  quat(f32 x, f32 y, f32 z, f32 w) : x(x), y(y), z(z), w(w) {}
+  constexpr quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+  constexpr quat(f32 x, f32 y, f32 z, f32 w) : x(x), y(y), z(z), w(w) {}
+#if defined(NS_USE_SIMD)
+  explicit constexpr quat(__m128 v) : data(v) {}
+#endif
   quat(vec3 axis, f32 angle, bool bnormalize) {
     const f32 half_angle = 0.5f * angle;
     f32 s = sin(half_angle);
-    f32 c = sin(half_angle);
+    f32 c = cos(half_angle);
 
     x = s * axis.x;
     y = s * axis.y;
@@ -57,19 +60,21 @@ struct quat {
     q_1.normalize();
     f32 dot = q_0.dot(q_1);
     if (dot < 0.0f) {
-      q_1.x = -q_1.x;
-      q_1.y = -q_1.y;
-      q_1.z = -q_1.z;
-      q_1.w = -q_1.w;
+      q_1 = -q_1;
       dot = -dot;
     }
 
     const f32 DOT_TRESHOLD = 0.9995f;
     if (dot > DOT_TRESHOLD) {
+#if defined(NS_USE_SIMD)
+      data = simd_madd(_mm_sub_ps(q_1.data, q_0.data),
+                       _mm_set1_ps(percentage), q_0.data);
+#else
       x = q_0.x + (q_1.x - q_0.x) * percentage;
       y = q_0.y + (q_1.y - q_0.y) * percentage;
       z = q_0.z + (q_1.z - q_0.z) * percentage;
       w = q_0.w + (q_1.w - q_0.w) * percentage;
+#endif
       normalize();
       return;
     }
@@ -81,26 +86,17 @@ struct quat {
     f32 s1 = sin_theta / sin_theta_0;
     f32 s0 = cos(theta) - dot * s1;
 
+#if defined(NS_USE_SIMD)
+    data = simd_madd(q_1.data, _mm_set1_ps(s1),
+                     _mm_mul_ps(q_0.data, _mm_set1_ps(s0)));
+#else
     x = q_0.x * s0 + q_1.x * s1;
     y = q_0.y * s0 + q_1.y * s1;
     z = q_0.z * s0 + q_1.z * s1;
     w = q_0.w * s0 + q_1.w * s1;
+#endif
   }
 
-  quat &operator=(quat const &other) {
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    w = other.w;
-    return *this;
-  }
-  quat &operator=(quat &&other) {
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    w = other.w;
-    return *this;
-  }
   quat operator+(quat const &other) const {
     return {x + other.x, y + other.y, z + other.z, w + other.w};
   }
@@ -108,7 +104,13 @@ struct quat {
   quat operator-(quat const &other) const {
     return {x - other.x, y - other.y, z - other.z, w - other.w};
   }
-  quat operator-() const { return {-x, -y, -z, -w}; }
+  quat operator-() const {
+#if defined(NS_USE_SIMD)
+    return quat(simd_flip_sign(data, _mm_set1_ps(-0.0f)));
+#else
+    return {-x, -y, -z, -w};
+#endif
+  }
   quat operator*(f32 f) const { return {x * f, y * f, z * f, w * f}; }
   quat operator/(quat const &other) const {
     return {x / other.x, y / other.y, z / other.z, w / other.w};
@@ -130,36 +132,91 @@ struct quat {
   }
   bool operator!=(quat const &other) const { return !(*this == other); }
 
-  static quat identity() { return {0.0f, 0.0f, 0.0f, 1.0f}; }
-  f32 normal() const { return sqrt(x * x + y * y + z * z + w * w); }
+  static constexpr quat identity() { return {0.0f, 0.0f, 0.0f, 1.0f}; }
+
+  /**
+   * Rotation of mat4::mk_euler_xyz: around x, then y, then z. The product of
+   * quaternions applies the left one first, like the product of matrices.
+   */
+  static quat from_euler_xyz(vec3 const &angles) {
+    // matrix() is the transpose of mat4::mk_rotate_*: the angles are negated
+    return quat(vec3(1.0f, 0.0f, 0.0f), -angles.x, false) *
+           quat(vec3(0.0f, 1.0f, 0.0f), -angles.y, false) *
+           quat(vec3(0.0f, 0.0f, 1.0f), -angles.z, false);
+  }
+  f32 normal() const { return sqrt(dot(*this)); }
   void normalize() {
+#if defined(NS_USE_SIMD)
+    data = simd_normalize4(data);
+#else
     f32 n = normal();
     x /= n;
     y /= n;
     z /= n;
     w /= n;
+#endif
   }
   quat normalized() const {
     quat o = *this;
     o.normalize();
     return o;
   }
+  // Inlined approximation, see math/fast.h for the error
+  void normalize_fast() {
+#if defined(NS_USE_SIMD)
+    data = _mm_mul_ps(data, simd_fast_rsqrt(simd_dot4(data, data)));
+#else
+    f32 inv = fast_rsqrt(dot(*this));
+    x *= inv;
+    y *= inv;
+    z *= inv;
+    w *= inv;
+#endif
+  }
+  quat normalized_fast() const {
+    quat o = *this;
+    o.normalize_fast();
+    return o;
+  }
 
   quat conjugate() const { return {-x, -y, -z, w}; }
 
   quat inverse() const { return conjugate().normalized(); }
 
   quat operator*(quat const &other) const {
+#if defined(NS_USE_SIMD)
+    // Each component of this scales a permutation of other, with signs.
+    __m128 b = other.data;
+    __m128 out = _mm_mul_ps(NS_SWIZZLE1(data, 3), b);
+    out = simd_madd(NS_SWIZZLE1(data, 0),
+                    simd_flip_sign(NS_SWIZZLE(b, 3, 2, 1, 0),
+                                   _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f)),
+                    out);
+    out = simd_madd(NS_SWIZZLE1(data, 1),
+                    simd_flip_sign(NS_SWIZZLE(b, 2, 3, 0, 1),
+                                   _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f)),
+                    out);
+    out = simd_madd(NS_SWIZZLE1(data, 2),
+                    simd_flip_sign(NS_SWIZZLE(b, 1, 0, 3, 2),
+                                   _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f)),
+                    out);
+    return quat(out);
+#else
     quat out;
     out.x = x * other.w + y * other.z - z * other.y + w * other.x;
     out.y = -x * other.z + y * other.w + z * other.x + w * other.y;
     out.z = x * other.y - y * other.x + z * other.w + w * other.z;
     out.w = -x * other.x - y * other.y - z * other.z + w * other.w;
     return out;
+#endif
   }
 
   f32 dot(quat const &other) const {
+#if defined(NS_USE_SIMD)
+    return _mm_cvtss_f32(simd_dot4(data, other.data));
+#else
     return x * other.x + y * other.y + z * other.z + w * other.w;
+#endif
   }
 
   mat4 matrix() const {
@@ -12,11 +12,62 @@ struct vertex_3d {
   vec2 texcoord;
 };
 
+/**
+ * Tangent frame of a vertex_3d, in a separate stream (see MeshResourceData)
+ */
+struct vertex_3d_frame {
+  vec3 normal;
+  vec3 tangent;
+  // Sign of the bitangent: cross(normal, tangent) * handedness
+  f32 handedness;
+};
+
 struct vertex_2d {
   vec2 position;
   vec2 texcoord;
 };
 
+/**
+ * Quantized vertex_3d (12 bytes instead of 20), see math/packing.h
+ */
+struct vertex_3d_packed {
+  // unorm16 within the bounds of the geometry. The 4th value pads to a 4
+  // component format: 3 x 16 bit vertex formats are not widely supported.
+  u16 position[4];
+  // half floats or unorm16, depending on the vertex format
+  u16 texcoord[2];
+};
+
+/**
+ * Layout of the vertices of a 3d geometry
+ */
+enum class VertexFormat : u8 {
+  // vertex_3d
+  FLOAT,
+  // vertex_3d_packed, half float texcoords (any range, 11 significant bits)
+  PACKED_HALF_UV,
+  // vertex_3d_packed, unorm16 texcoords (clamped to [0, 1])
+  PACKED_UNORM_UV,
+};
+
+// The math types are copied with plain moves/memcpy and can be passed in
+// registers: keep them free of user-provided copy members.
+NS_STATIC_ASSERT(__is_trivially_copyable(vec2),
+                 "Expected vec2 to be trivially copyable.");
+NS_STATIC_ASSERT(__is_trivially_copyable(vec3),
+                 "Expected vec3 to be trivially copyable.");
+NS_STATIC_ASSERT(__is_trivially_copyable(vec4),
+                 "Expected vec4 to be trivially copyable.");
+NS_STATIC_ASSERT(__is_trivially_copyable(quat),
+                 "Expected quat to be trivially copyable.");
+NS_STATIC_ASSERT(__is_trivially_copyable(mat4),
+                 "Expected mat4 to be trivially copyable.");
+NS_STATIC_ASSERT(sizeof(mat4) == 64, "Expected mat4 to be 64 bytes.");
+NS_STATIC_ASSERT(sizeof(vertex_3d_frame) == 28,
+                 "Expected vertex_3d_frame to be 28 bytes.");
+NS_STATIC_ASSERT(sizeof(vertex_3d_packed) == 12,
+                 "Expected vertex_3d_packed to be 12 bytes.");
+
 } // namespace ns
 
 #endif // MATH_TYPES_HEADER_INCLUDED
@@ -26,26 +26,12 @@ struct vec2 {
     };
   };
 
-  vec2() : x(0.0f), y(0.0f) {}
-  vec2(vec2 const &other) : x(other.x), y(other.y) {}
-  vec2(vec2 &&other) : x(other.x), y(other.y) {}
-  explicit vec2(vec3 const &other);
-  explicit vec2(vec3 &&other);
-  explicit vec2(vec4 const &other);
-  explicit vec2(vec4 &&other);
-  vec2(f32 x, f32 y) : x(x), y(y) {}
-  explicit vec2(f32 v) : x(v), y(v) {}
+  constexpr vec2() : x(0.0f), y(0.0f) {}
+  explicit constexpr vec2(vec3 const &other);
+  explicit constexpr vec2(vec4 const &other);
+  constexpr vec2(f32 x, f32 y) : x(x), y(y) {}
+  explicit constexpr vec2(f32 v) : x(v), y(v) {}
 
-  vec2 &operator=(vec2 const &other) {
-    x = other.x;
-    y = other.y;
-    return *this;
-  }
-  vec2 &operator=(vec2 &&other) {
-    x = other.x;
-    y = other.y;
-    return *this;
-  }
   vec2 operator+(vec2 const &other) const { return {x + other.x, y + other.y}; }
   vec2 operator+() const { return *this; }
   vec2 operator-(vec2 const &other) const { return {x - other.x, y - other.y}; }
@@ -112,8 +98,8 @@ struct vec2 {
   f32 dist(vec2 const &other) const { return (*this - other).length(); }
   f32 dot(vec2 const &other) const { return x * other.x + y * other.y; }
 
-  static vec2 zero() { return {0.0f, 0.0f}; }
-  static vec2 one() { return {1.0f, 1.0f}; }
+  static constexpr vec2 zero() { return {0.0f, 0.0f}; }
+  static constexpr vec2 one() { return {1.0f, 1.0f}; }
   static vec2 up() { return {0.0f, 1.0f}; }
   static vec2 down() { return {0.0f, -1.0f}; }
   static vec2 left() { return {-1.0f, 0.0f}; }
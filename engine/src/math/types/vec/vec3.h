@@ -4,6 +4,7 @@
 #include "../../../core/string/cstring.h"
 #include "../../../defines.h"
 #include "../../cstes.h"
+#include "../../fast.h"
 #include "./vec2.h"
 
 namespace ns {
@@ -24,30 +25,13 @@ struct vec3 {
     };
   };
 
-  vec3() : x(0.0f), y(0.0f), z(0.0f) {}
-  vec3(vec3 const &other) : x(other.x), y(other.y), z(other.z) {}
-  vec3(vec3 &&other) : x(other.x), y(other.y), z(other.z) {}
-  explicit vec3(vec2 const &other);
-  explicit vec3(vec2 &&other);
-  explicit vec3(vec4 const &other);
-  explicit vec3(vec4 &&other);
-  vec3(f32 x, f32 y, f32 z) : x(x), y(y), z(z) {}
-  vec3(vec2 const &v, f32 z) : x(v.x), y(v.y), z(z) {}
-  vec3(vec2 &&v, f32 z) : x(v.x), y(v.y), z(z) {}
-  explicit vec3(f32 v) : x(v), y(v), z(v) {}
+  constexpr vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+  explicit constexpr vec3(vec2 const &other);
+  explicit constexpr vec3(vec4 const &other);
+  constexpr vec3(f32 x, f32 y, f32 z) : x(x), y(y), z(z) {}
+  constexpr vec3(vec2 const &v, f32 z) : x(v.x), y(v.y), z(z) {}
+  explicit constexpr vec3(f32 v) : x(v), y(v), z(v) {}
 
-  vec3 &operator=(vec3 const &other) {
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    return *this;
-  }
-  vec3 &operator=(vec3 &&other) {
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    return *this;
-  }
   vec3 operator+(vec3 const &other) const {
     return {x + other.x, y + other.y, z + other.z};
   }
@@ -127,6 +111,9 @@ struct vec3 {
     o.normalize();
     return o;
   }
+  // Inlined approximation, see math/fast.h for the error
+  void normalize_fast() { *this *= fast_rsqrt(length_sq()); }
+  vec3 normalized_fast() const { return *this * fast_rsqrt(length_sq()); }
   f32 dist_sq(vec3 const &other) const { return (*this - other).length_sq(); }
   f32 dist(vec3 const &other) const { return (*this - other).length(); }
   f32 dot(vec3 const &other) const {
@@ -140,8 +127,8 @@ struct vec3 {
     };
   }
 
-  static vec3 zero() { return {0.0f, 0.0f, 0.0f}; }
-  static vec3 one() { return {1.0f, 1.0f, 1.0f}; }
+  static constexpr vec3 zero() { return {0.0f, 0.0f, 0.0f}; }
+  static constexpr vec3 one() { return {1.0f, 1.0f, 1.0f}; }
   static vec3 up() { return {0.0f, 1.0f, 0.0f}; }
   static vec3 down() { return {0.0f, -1.0f, 0.0f}; }
   static vec3 left() { return {-1.0f, 0.0f, 0.0f}; }
@@ -4,6 +4,8 @@
 #include "../../../core/string.h"
 #include "../../../defines.h"
 #include "../../cstes.h"
+#include "../../fast.h"
+#include "../../simd.h"
 #include "./vec2.h"
 #include "./vec3.h"
 
@@ -31,90 +33,132 @@ struct vec4 {
     };
   };
 
-  vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
-  vec4(vec4 const &other) : x(other.x), y(other.y), z(other.z), w(other.w) {}
-  vec4(vec4 &&other) : x(other.x), y(other.y), z(other.z), w(other.w) {}
-  explicit vec4(vec2 const &other);
-  explicit vec4(vec2 &&other);
-  explicit vec4(vec3 const &other);
-  explicit vec4(vec3 &&other);
-  vec4(f32 x, f32 y, f32 z, f32 w) : x(x), y(y), z(z), w(w) {}
-  vec4(vec3 const &v, f32 w) : x(v.x), y(v.y), z(v.z), w(w) {}
-  vec4(vec3 &&v, f32 w) : x(v.x), y(v.y), z(v.z), w(w) {}
-  vec4(vec2 const &v, f32 z, f32 w) : x(v.x), y(v.y), z(z), w(w) {}
-  vec4(vec2 &&v, f32 z, f32 w) : x(v.x), y(v.y), z(z), w(w) {}
-  explicit vec4(f32 v) : x(v), y(v), z(v), w(v) {}
+  constexpr vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+  explicit constexpr vec4(vec2 const &other);
+  explicit constexpr vec4(vec3 const &other);
+  constexpr vec4(f32 x, f32 y, f32 z, f32 w) : x(x), y(y), z(z), w(w) {}
+  constexpr vec4(vec3 const &v, f32 w) : x(v.x), y(v.y), z(v.z), w(w) {}
+  constexpr vec4(vec2 const &v, f32 z, f32 w)
+      : x(v.x), y(v.y), z(z), w(w) {}
+  explicit constexpr vec4(f32 v) : x(v), y(v), z(v), w(v) {}
+#if defined(NS_USE_SIMD)
+  explicit constexpr vec4(__m128 v) : data(v) {}
+#endif
 
-  vec4 &operator=(vec4 const &other) {
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    w = other.w;
-    return *this;
-  }
-  vec4 &operator=(vec4 &&other) {
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    w = other.w;
-    return *this;
-  }
   vec4 operator+(vec4 const &other) const {
+#if defined(NS_USE_SIMD)
+    return vec4(_mm_add_ps(data, other.data));
+#else
     return {x + other.x, y + other.y, z + other.z, w + other.w};
+#endif
   }
   vec4 operator+() const { return *this; }
   vec4 operator-(vec4 const &other) const {
+#if defined(NS_USE_SIMD)
+    return vec4(_mm_sub_ps(data, other.data));
+#else
     return {x - other.x, y - other.y, z - other.z, w - other.w};
+#endif
+  }
+  vec4 operator-() const {
+#if defined(NS_USE_SIMD)
+    return vec4(simd_flip_sign(data, _mm_set1_ps(-0.0f)));
+#else
+    return {-x, -y, -z, -w};
+#endif
   }
-  vec4 operator-() const { return {-x, -y, -z, -w}; }
   vec4 operator*(vec4 const &other) const {
+#if defined(NS_USE_SIMD)
+    return vec4(_mm_mul_ps(data, other.data));
+#else
     return {x * other.x, y * other.y, z * other.z, w * other.w};
+#endif
+  }
+  vec4 operator*(f32 f) const {
+#if defined(NS_USE_SIMD)
+    return vec4(_mm_mul_ps(data, _mm_set1_ps(f)));
+#else
+    return {x * f, y * f, z * f, w * f};
+#endif
   }
-  vec4 operator*(f32 f) const { return {x * f, y * f, z * f, w * f}; }
   vec4 operator/(vec4 const &other) const {
+#if defined(NS_USE_SIMD)
+    return vec4(_mm_div_ps(data, other.data));
+#else
     return {x / other.x, y / other.y, z / other.z, w / other.w};
+#endif
+  }
+  vec4 operator/(f32 f) const {
+#if defined(NS_USE_SIMD)
+    return vec4(_mm_div_ps(data, _mm_set1_ps(f)));
+#else
+    return {x / f, y / f, z / f, w / f};
+#endif
   }
-  vec4 operator/(f32 f) const { return {x / f, y / f, z / f, w / f}; }
   vec4 &operator+=(vec4 const &other) {
+#if defined(NS_USE_SIMD)
+    data = _mm_add_ps(data, other.data);
+#else
     x += other.x;
     y += other.y;
     z += other.z;
     w += other.w;
+#endif
     return *this;
   }
   vec4 &operator-=(vec4 const &other) {
+#if defined(NS_USE_SIMD)
+    data = _mm_sub_ps(data, other.data);
+#else
     x -= other.x;
     y -= other.y;
     z -= other.z;
     w -= other.w;
+#endif
     return *this;
   }
   vec4 &operator*=(vec4 const &other) {
+#if defined(NS_USE_SIMD)
+    data = _mm_mul_ps(data, other.data);
+#else
     x *= other.x;
     y *= other.y;
     z *= other.z;
     w *= other.w;
+#endif
     return *this;
   }
   vec4 &operator/=(vec4 const &other) {
+#if defined(NS_USE_SIMD)
+    data = _mm_div_ps(data, other.data);
+#else
     x /= other.x;
     y /= other.y;
     z /= other.z;
     w /= other.w;
+#endif
     return *this;
   }
   vec4 &operator*=(f32 f) {
+#if defined(NS_USE_SIMD)
+    data = _mm_mul_ps(data, _mm_set1_ps(f));
+#else
     x *= f;
     y *= f;
     z *= f;
     w *= f;
+#endif
     return *this;
   }
   vec4 &operator/=(f32 f) {
+#if defined(NS_USE_SIMD)
+    data = _mm_div_ps(data, _mm_set1_ps(f));
+#else
     x /= f;
     y /= f;
     z /= f;
     w /= f;
+#endif
     return *this;
   }
   f32 operator[](usize i) const { return elements[i]; }
@@ -133,28 +177,59 @@ struct vec4 {
   }
   bool operator!=(vec4 const &other) const { return !(*this == other); }
 
-  f32 length_sq() const { return x * x + y * y + z * z + w * w; }
+  f32 length_sq() const { return dot(*this); }
   f32 length() const { return sqrt(length_sq()); }
   void normalize() {
+#if defined(NS_USE_SIMD)
+    data = simd_normalize4(data);
+#else
     const f32 len = length();
     x /= len;
     y /= len;
     z /= len;
     w /= len;
+#endif
   }
   vec4 normalized() const {
     vec4 o = *this;
     o.normalize();
     return o;
   }
+  // Inlined approximation, see math/fast.h for the error
+  void normalize_fast() {
+#if defined(NS_USE_SIMD)
+    data = _mm_mul_ps(data, simd_fast_rsqrt(simd_dot4(data, data)));
+#else
+    *this *= fast_rsqrt(length_sq());
+#endif
+  }
+  vec4 normalized_fast() const {
+    vec4 o = *this;
+    o.normalize_fast();
+    return o;
+  }
   f32 dist_sq(vec4 const &other) const { return (*this - other).length_sq(); }
   f32 dist(vec4 const &other) const { return (*this - other).length(); }
   f32 dot(vec4 const &other) const {
+#if defined(NS_USE_SIMD)
+    return _mm_cvtss_f32(simd_dot4(data, other.data));
+#else
     return x * other.x + y * other.y + z * other.z + w * other.w;
+#endif
+  }
+  // Cross product of the xyz components (w is set to 0)
+  vec4 cross(vec4 const &other) const {
+#if defined(NS_USE_SIMD)
+    __m128 mask_xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    return vec4(_mm_and_ps(simd_cross3(data, other.data), mask_xyz));
+#else
+    return {y * other.z - z * other.y, z * other.x - x * other.z,
+            x * other.y - y * other.x, 0.0f};
+#endif
   }
 
-  static vec4 one() { return {1.0f, 1.0f, 1.0f, 1.0f}; }
-  static vec4 zero() { return {0.0f, 0.0f, 0.0f, 0.0f}; }
+  static constexpr vec4 one() { return {1.0f, 1.0f, 1.0f, 1.0f}; }
+  static constexpr vec4 zero() { return {0.0f, 0.0f, 0.0f, 0.0f}; }
 
   bool from(cstr s) {
     if (!s)
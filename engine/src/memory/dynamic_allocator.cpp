@@ -5,6 +5,16 @@
 #include "../core/memory.h"
 
 namespace ns {
+
+// Every block starts on this boundary: the SIMD math types are accessed with
+// aligned loads and stores.
+#define DYNAMIC_ALLOCATOR_ALIGNMENT 16
+
+NS_INLINE usize dynamic_allocator_align(usize size) {
+  return (size + DYNAMIC_ALLOCATOR_ALIGNMENT - 1) &
+         ~static_cast<usize>(DYNAMIC_ALLOCATOR_ALIGNMENT - 1);
+}
+
 struct dynamic_allocator_state {
   usize total_size;
   freelist list;
@@ -26,8 +36,9 @@ bool dynamic_allocator_create(usize total_size, usize *memory_requirement,
   }
   usize freelist_requirement = 0;
   freelist_create(total_size, &freelist_requirement, 0, 0);
-  *memory_requirement =
-      freelist_requirement + sizeof(dynamic_allocator_state) + total_size;
+  // The memory block is aligned in the given memory
+  *memory_requirement = freelist_requirement + sizeof(dynamic_allocator_state) +
+                        DYNAMIC_ALLOCATOR_ALIGNMENT + total_size;
 
   if (!memory) {
     return true;
@@ -39,8 +50,8 @@ bool dynamic_allocator_create(usize total_size, usize *memory_requirement,
   state->total_size = total_size;
   state->freelist_block =
       reinterpret_cast<u8 *>(memory) + sizeof(dynamic_allocator_state);
-  state->memory_block =
-      reinterpret_cast<u8 *>(state->freelist_block) + freelist_requirement;
+  state->memory_block = reinterpret_cast<ptr>(dynamic_allocator_align(
+      reinterpret_cast<usize>(state->freelist_block) + freelist_requirement));
 
   freelist_create(total_size, &freelist_requirement, state->freelist_block,
                   &state->list);
@@ -68,7 +79,8 @@ ptr dynamic_allocator_allocate(dynamic_allocator *allocator, usize size) {
     dynamic_allocator_state *state =
         reinterpret_cast<dynamic_allocator_state *>(allocator->memory);
     u64 offset = 0;
-    if (freelist_allocate_block(state->list, size, &offset)) {
+    if (freelist_allocate_block(state->list, dynamic_allocator_align(size),
+                                &offset)) {
       return reinterpret_cast<u8 *>(state->memory_block) + offset;
     } else {
       NS_ERROR("dynamic_allocator_allocate - Could not allocate %lluB. (total "
@@ -88,6 +100,8 @@ ptr dynamic_allocator_reallocate(dynamic_allocator *allocator, ptr memory,
   if (!allocator || !memory) {
     return nullptr;
   }
+  old_size = dynamic_allocator_align(old_size);
+  new_size = dynamic_allocator_align(new_size);
   if (old_size >= new_size) {
     return memory;
   }
@@ -108,7 +122,7 @@ ptr dynamic_allocator_reallocate(dynamic_allocator *allocator, ptr memory,
   ptr new_memory = reinterpret_cast<u8 *>(state->memory_block) + new_offset;
   mem_copy(new_memory, memory, old_size);
   freelist_free_block(state->list, old_size, offset);
-  return nullptr;
+  return new_memory;
 }
 
 bool dynamic_allocator_free(dynamic_allocator *allocator, ptr block,
@@ -124,7 +138,8 @@ bool dynamic_allocator_free(dynamic_allocator *allocator, ptr block,
   }
   u64 offset = reinterpret_cast<u8 *>(block) -
                reinterpret_cast<u8 *>(state->memory_block);
-  if (freelist_free_block(state->list, size, offset)) {
+  if (freelist_free_block(state->list, dynamic_allocator_align(size),
+                          offset)) {
     return true;
   }
   return false;
@@ -30,7 +30,9 @@ ptr linear_allocator::allocate(usize size) {
     NS_ERROR("linear_allocator::allocate - Allocator not initialized.");
     return nullptr;
   }
-  if (allocated + size > total_size) {
+  usize offset = (allocated + LINEAR_ALLOCATOR_ALIGNMENT - 1) &
+                 ~static_cast<usize>(LINEAR_ALLOCATOR_ALIGNMENT - 1);
+  if (offset > total_size || size > total_size - offset) {
     u64 remaining = total_size - allocated;
     NS_ERROR("linear_allocator::allocate - Tried to allocate %lluB, only "
              "%lluB remaining.",
@@ -38,8 +40,8 @@ ptr linear_allocator::allocate(usize size) {
     return nullptr;
   }
 
-  ptr block = reinterpret_cast<u8 *>(memory) + allocated;
-  allocated += size;
+  ptr block = reinterpret_cast<u8 *>(memory) + offset;
+  allocated = offset + size;
   return block;
 }
 
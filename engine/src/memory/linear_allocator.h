@@ -5,6 +5,10 @@
 
 namespace ns {
 
+// Every block starts on this boundary (relative to the memory given to the
+// allocator): the SIMD math types are accessed with aligned loads and stores.
+#define LINEAR_ALLOCATOR_ALIGNMENT 16
+
 struct linear_allocator {
   usize total_size;
   usize allocated;
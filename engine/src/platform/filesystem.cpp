@@ -7,6 +7,17 @@
 #include <cstring>
 #include <sys/stat.h>
 
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#include <direct.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace ns::fs {
 
 #define HANDLE(handle) reinterpret_cast<FILE *>(handle->handle)
@@ -19,8 +30,95 @@ bool exists(cstr path) {
   return _stat(path, &buffer);
 #else
   struct stat buffer;
-  return stat(path, &buffer) == 0;
+  return ::stat(path, &buffer) == 0;
+#endif
+}
+
+bool stat(cstr path, FileStat *out_stat) {
+#ifdef _MSC_VER
+  struct _stat64 buffer;
+  if (_stat64(path, &buffer) != 0) {
+    return false;
+  }
+  out_stat->modified_time = static_cast<i64>(buffer.st_mtime);
+#else
+  struct stat buffer;
+  if (::stat(path, &buffer) != 0) {
+    return false;
+  }
+  out_stat->modified_time =
+      static_cast<i64>(buffer.st_mtim.tv_sec) * 1000000000 +
+      buffer.st_mtim.tv_nsec;
 #endif
+  out_stat->size = static_cast<u64>(buffer.st_size);
+  return true;
+}
+
+bool remove(cstr path) { return std::remove(path) == 0; }
+
+bool rename(cstr from, cstr to) {
+#ifdef _MSC_VER
+  return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return std::rename(from, to) == 0;
+#endif
+}
+
+bool create_directory(cstr path) {
+#ifdef _MSC_VER
+  if (_mkdir(path) == 0) {
+    return true;
+  }
+  DWORD attributes = GetFileAttributesA(path);
+  return attributes != INVALID_FILE_ATTRIBUTES &&
+         (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+  if (mkdir(path, 0755) == 0) {
+    return true;
+  }
+  struct stat buffer;
+  return ::stat(path, &buffer) == 0 && S_ISDIR(buffer.st_mode);
+#endif
+}
+
+bool list_directory(cstr path, void (*on_file)(cstr name, ptr user_data),
+                    ptr user_data) {
+#ifdef _MSC_VER
+  char pattern[MAX_PATH];
+  std::snprintf(pattern, sizeof(pattern), "%s\\*", path);
+  WIN32_FIND_DATAA data;
+  HANDLE find = FindFirstFileA(pattern, &data);
+  if (find == INVALID_HANDLE_VALUE) {
+    return GetLastError() == ERROR_FILE_NOT_FOUND;
+  }
+  do {
+    if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+      on_file(data.cFileName, user_data);
+    }
+  } while (FindNextFileA(find, &data));
+  FindClose(find);
+#else
+  DIR *dir = opendir(path);
+  if (!dir) {
+    return false;
+  }
+  while (dirent *entry = readdir(dir)) {
+    bool is_file = entry->d_type == DT_REG;
+    if (entry->d_type == DT_UNKNOWN) {
+      // Some filesystems don't fill the type
+      char file_path[4096];
+      std::snprintf(file_path, sizeof(file_path), "%s/%s", path,
+                    entry->d_name);
+      struct stat buffer;
+      is_file = ::stat(file_path, &buffer) == 0 && S_ISREG(buffer.st_mode);
+    }
+    if (is_file) {
+      on_file(entry->d_name, user_data);
+    }
+  }
+  closedir(dir);
+#endif
+  return true;
 }
 
 bool open(cstr path, Mode mode, bool binary, File *out_handle) {
@@ -139,4 +237,100 @@ bool write(File *handle, usize data_size, roptr data,
   return true;
 }
 
+bool map(cstr path, MappedFile *out_file, MapHint hint) {
+  out_file->data = nullptr;
+  out_file->size = 0;
+  out_file->handle = nullptr;
+#ifdef _MSC_VER
+  DWORD flags = hint == MapHint::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN
+                                            : FILE_ATTRIBUTE_NORMAL;
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, flags, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    NS_ERROR("Error opening file: '%s'", path);
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    NS_ERROR("Error getting the size of file: '%s'", path);
+    CloseHandle(file);
+    return false;
+  }
+  if (size.QuadPart == 0) {
+    CloseHandle(file);
+    return true;
+  }
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // The view keeps the file open
+  CloseHandle(file);
+  if (!mapping) {
+    NS_ERROR("Error mapping file: '%s'", path);
+    return false;
+  }
+  ptr data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data) {
+    NS_ERROR("Error mapping file: '%s'", path);
+    CloseHandle(mapping);
+    return false;
+  }
+  out_file->data = reinterpret_cast<u8 const *>(data);
+  out_file->size = static_cast<usize>(size.QuadPart);
+  out_file->handle = mapping;
+#if _WIN32_WINNT >= 0x0602
+  if (hint == MapHint::WILL_NEED) {
+    WIN32_MEMORY_RANGE_ENTRY range = {data, out_file->size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+  }
+#endif
+#else
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    NS_ERROR("Error opening file: '%s'", path);
+    return false;
+  }
+  struct stat buffer;
+  if (fstat(fd, &buffer) != 0) {
+    NS_ERROR("Error getting the size of file: '%s'", path);
+    ::close(fd);
+    return false;
+  }
+  if (buffer.st_size == 0) {
+    ::close(fd);
+    return true;
+  }
+  ptr data = mmap(nullptr, static_cast<usize>(buffer.st_size), PROT_READ,
+                  MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file open
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    NS_ERROR("Error mapping file: '%s'", path);
+    return false;
+  }
+  out_file->data = reinterpret_cast<u8 const *>(data);
+  out_file->size = static_cast<usize>(buffer.st_size);
+  // Only a hint: the mapping works without it
+  if (hint == MapHint::SEQUENTIAL) {
+    madvise(data, out_file->size, MADV_SEQUENTIAL);
+  } else if (hint == MapHint::WILL_NEED) {
+    madvise(data, out_file->size, MADV_WILLNEED);
+  }
+#endif
+  return true;
+}
+
+void unmap(MappedFile *file) {
+  if (file->data) {
+#ifdef _MSC_VER
+    UnmapViewOfFile(file->data);
+    CloseHandle(reinterpret_cast<HANDLE>(file->handle));
+#else
+    munmap(const_cast<u8 *>(file->data), file->size);
+#endif
+  }
+  file->data = nullptr;
+  file->size = 0;
+  file->handle = nullptr;
+}
+
 } // namespace ns::fs
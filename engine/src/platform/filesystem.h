@@ -16,6 +16,31 @@ struct File {
   bool is_valid;
 };
 
+/**
+ * A file mapped in memory, read-only
+ * @struct MappedFile
+ * @field data The content of the file (nullptr for an empty file)
+ * @field size The size of the file
+ * @field handle The handle of the mapping
+ */
+struct MappedFile {
+  u8 const *data;
+  usize size;
+  ptr handle;
+};
+
+/**
+ * The information of a file
+ * @struct FileStat
+ * @field size The size of the file
+ * @field modified_time The time of the last modification, in nanoseconds on
+ *        linux and seconds on windows: only to compare with another one
+ */
+struct FileStat {
+  u64 size;
+  i64 modified_time;
+};
+
 /**
  * The mode of a file
  * @enum Mode
@@ -27,6 +52,20 @@ enum class Mode {
   WRITE = 0x2,
 };
 
+/**
+ * How a mapped file is read, a hint for the paging
+ * @enum MapHint
+ * @field NORMAL Any order (the default read-ahead)
+ * @field SEQUENTIAL Once from start to end: more read-ahead, and the pages
+ *        read can be dropped early
+ * @field WILL_NEED As a whole, soon: all the pages are read ahead now
+ */
+enum class MapHint {
+  NORMAL,
+  SEQUENTIAL,
+  WILL_NEED,
+};
+
 /**
  * Checks if a file exists
  * @param path The path of the file
@@ -34,6 +73,46 @@ enum class Mode {
  */
 NS_API bool exists(cstr path);
 
+/**
+ * Gets the information of a file, without opening it
+ * @param path The path of the file
+ * @param out_stat The information of the file
+ * @returns True if the file exists
+ */
+NS_API bool stat(cstr path, FileStat *out_stat);
+
+/**
+ * Deletes a file
+ * @param path The path of the file
+ * @returns True if the file was deleted
+ */
+NS_API bool remove(cstr path);
+
+/**
+ * Renames a file, replacing the destination atomically if it exists
+ * @param from The path of the file
+ * @param to The new path of the file
+ * @returns True if the file was renamed
+ */
+NS_API bool rename(cstr from, cstr to);
+
+/**
+ * Creates a directory. Its parent must exist.
+ * @param path The path of the directory
+ * @returns True if the directory was created or already exists
+ */
+NS_API bool create_directory(cstr path);
+
+/**
+ * Lists the files of a directory, not recursively
+ * @param path The path of the directory
+ * @param on_file Called with the name of each file (not its path)
+ * @param user_data Passed to on_file
+ * @returns True if the directory could be read
+ */
+NS_API bool list_directory(cstr path, void (*on_file)(cstr name, ptr user_data),
+                           ptr user_data);
+
 /**
  * Opens a file
  * @param path The path of the file
@@ -118,6 +197,23 @@ NS_API bool read_all_text(File *handle, pstr out_text, usize *out_bytes_read);
 NS_API bool write(File *handle, usize data_size, roptr data,
                   usize *out_bytes_written);
 
+/**
+ * Maps a whole file in memory, read-only. The pages are loaded when they are
+ * first accessed, and stay valid until the file is unmapped.
+ * @param path The path of the file
+ * @param out_file The mapped file
+ * @param hint How the file will be read
+ * @returns True if the file was mapped successfully
+ */
+NS_API bool map(cstr path, MappedFile *out_file,
+                MapHint hint = MapHint::NORMAL);
+
+/**
+ * Unmaps a file mapped with map
+ * @param file The mapped file
+ */
+NS_API void unmap(MappedFile *file);
+
 } // namespace ns::fs
 
 #endif // FILESYSTEM_HEADER_INCLUDED
@@ -26,6 +26,33 @@ f64 get_absolute_time();
 
 void sleep(u64 ms);
 
+/**
+ * Gets the current value of the high resolution tick counter. This is the
+ * CPU timestamp counter when it is invariant (constant rate, not stopped in
+ * deep C-states), and the monotonic OS clock in nanoseconds otherwise.
+ * @returns the current tick count
+ */
+NS_API u64 get_ticks();
+
+/**
+ * Gets the frequency of the tick counter
+ * @returns the number of ticks per second
+ */
+NS_API u64 get_tick_frequency();
+
+/**
+ * Converts a tick count to seconds
+ * @param ticks the tick count (usually a difference of get_ticks values)
+ * @returns the duration in seconds
+ */
+NS_API f64 ticks_to_seconds(u64 ticks);
+
+/**
+ * Checks if get_ticks is backed by the CPU timestamp counter
+ * @returns true if the timestamp counter is invariant and used
+ */
+NS_API bool ticks_use_tsc();
+
 } // namespace ns::platform
 
 #endif // PLATFORM_HEADER_INCLUDED
@@ -207,6 +207,7 @@ bool pump_messages() {
 
     std::free(event);
   }
+  InputManager::flush_events();
   return !quit_flagged;
 }
 
@@ -133,6 +133,7 @@ bool pump_messages() {
     TranslateMessage(&message);
     DispatchMessageA(&message);
   }
+  InputManager::flush_events();
   return true;
 }
 
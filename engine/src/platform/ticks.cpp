@@ -0,0 +1,140 @@
+#include "./platform.h"
+
+// The tick counter only depends on the CPU and on the OS monotonic clock, so
+// it is shared by all platforms.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||             \
+    defined(_M_IX86)
+#define NS_TICKS_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#endif
+
+#if NS_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace ns::platform {
+
+// Duration of the TSC calibration against the OS clock, in nanoseconds.
+#define TSC_CALIBRATION_NS 10000000ull
+
+struct tick_source {
+  bool use_tsc;
+  u64 frequency;
+  f64 seconds_per_tick;
+};
+
+NS_INLINE u64 monotonic_ticks() {
+#if NS_PLATFORM_WINDOWS
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return static_cast<u64>(now.QuadPart);
+#else
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<u64>(now.tv_sec) * 1000000000ull +
+         static_cast<u64>(now.tv_nsec);
+#endif
+}
+
+NS_INLINE u64 monotonic_frequency() {
+#if NS_PLATFORM_WINDOWS
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  return static_cast<u64>(frequency.QuadPart);
+#else
+  return 1000000000ull;
+#endif
+}
+
+#if NS_TICKS_X86
+NS_INLINE u64 read_tsc() { return __rdtsc(); }
+
+/**
+ * Checks the invariant TSC bit (CPUID.80000007H:EDX[8]).
+ */
+static bool cpu_has_invariant_tsc() {
+  u32 regs[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER)
+  i32 info[4];
+  __cpuid(info, 0x80000000);
+  if (static_cast<u32>(info[0]) < 0x80000007) {
+    return false;
+  }
+  __cpuid(info, 0x80000007);
+  regs[3] = static_cast<u32>(info[3]);
+#else
+  if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+  return (regs[3] & (1u << 8)) != 0;
+}
+
+/**
+ * Measures the TSC frequency against the OS monotonic clock.
+ */
+static u64 calibrate_tsc() {
+  u64 os_frequency = monotonic_frequency();
+  u64 os_duration = TSC_CALIBRATION_NS * os_frequency / 1000000000ull;
+
+  u64 os_start = monotonic_ticks();
+  u64 tsc_start = read_tsc();
+  u64 os_end;
+  do {
+    os_end = monotonic_ticks();
+  } while (os_end - os_start < os_duration);
+  u64 tsc_end = read_tsc();
+
+  f64 seconds = static_cast<f64>(os_end - os_start) /
+                static_cast<f64>(os_frequency);
+  return static_cast<u64>(static_cast<f64>(tsc_end - tsc_start) / seconds);
+}
+#endif
+
+static tick_source tick_source_create() {
+  tick_source source{};
+#if NS_TICKS_X86
+  if (cpu_has_invariant_tsc()) {
+    source.frequency = calibrate_tsc();
+    source.use_tsc = source.frequency != 0;
+  }
+#endif
+  if (!source.use_tsc) {
+    source.frequency = monotonic_frequency();
+  }
+  source.seconds_per_tick = 1.0 / static_cast<f64>(source.frequency);
+  return source;
+}
+
+static tick_source const &get_tick_source() {
+  static tick_source source = tick_source_create();
+  return source;
+}
+
+u64 get_ticks() {
+#if NS_TICKS_X86
+  if (get_tick_source().use_tsc) {
+    return read_tsc();
+  }
+#endif
+  return monotonic_ticks();
+}
+
+u64 get_tick_frequency() { return get_tick_source().frequency; }
+
+f64 ticks_to_seconds(u64 ticks) {
+  return static_cast<f64>(ticks) * get_tick_source().seconds_per_tick;
+}
+
+bool ticks_use_tsc() { return get_tick_source().use_tsc; }
+
+} // namespace ns::platform
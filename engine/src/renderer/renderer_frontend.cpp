@@ -2,8 +2,10 @@
 #include "./renderer_backend.h"
 
 #include "../core/logger.h"
+#include "../core/profiler.h"
 
 #include "../math/math.h"
+#include "../math/packing.h"
 
 #include "../resources/resource_types.h"
 
@@ -17,6 +19,9 @@ struct renderer_system_state {
   mat4 ui_view;
   f32 near_clip;
   f32 far_clip;
+  // Planes of view * projection, updated every frame
+  frustum world_frustum;
+  u32 culled_geometry_count;
 };
 
 static renderer_system_state *state_ptr = nullptr;
@@ -32,6 +37,7 @@ bool renderer_system_initialize(usize *memory_requirement, ptr state,
   // TODO(ClementChambard): make it configurable
   renderer_backend_create(RENDERER_BACKEND_TYPE_VULKAN, &state_ptr->backend);
   state_ptr->backend.frame_number = 0;
+  state_ptr->backend.supports_texture_compression = false;
 
   if (!state_ptr->backend.initialize(&state_ptr->backend, application_name)) {
     NS_FATAL("Renderer backend failed to initialize. Shutting down.");
@@ -77,7 +83,15 @@ void renderer_on_resized(u16 width, u16 height) {
 }
 
 bool renderer_draw_frame(render_packet *packet) {
-  if (state_ptr->backend.begin_frame(&state_ptr->backend, packet->delta_time)) {
+  NS_PROFILE_SCOPE("renderer_draw_frame");
+  bool frame_begun;
+  {
+    NS_PROFILE_SCOPE("begin_frame");
+    frame_begun =
+        state_ptr->backend.begin_frame(&state_ptr->backend, packet->delta_time);
+  }
+  if (frame_begun) {
+    NS_PROFILE_SCOPE("world_pass");
     if (!state_ptr->backend.begin_renderpass(
             &state_ptr->backend, static_cast<u8>(builtin_renderpass::WORLD))) {
       NS_ERROR(
@@ -88,9 +102,23 @@ bool renderer_draw_frame(render_packet *packet) {
     state_ptr->backend.update_global_world_state(
         state_ptr->projection, state_ptr->view, vec3::zero(), vec4::one(), 0);
 
+    state_ptr->world_frustum =
+        frustum(state_ptr->view * state_ptr->projection);
+    state_ptr->culled_geometry_count = 0;
     u32 count = packet->geometry_count;
     for (u32 i = 0; i < count; i++) {
-      state_ptr->backend.draw_geometry(packet->geometries[i]);
+      geometry_render_data data = packet->geometries[i];
+      if (!state_ptr->world_frustum.intersects(
+              data.geometry->bounds.transformed(data.model))) {
+        state_ptr->culled_geometry_count++;
+        continue;
+      }
+      if (data.geometry->vertex_format != VertexFormat::FLOAT) {
+        // The vertex fetch decodes packed positions to [0, 1]
+        data.model =
+            vertex_dequantize_transform(data.geometry->bounds) * data.model;
+      }
+      state_ptr->backend.draw_geometry(data);
     }
 
     if (!state_ptr->backend.end_renderpass(
@@ -98,7 +126,9 @@ bool renderer_draw_frame(render_packet *packet) {
       NS_ERROR("renderer_end_renderpass failed. Application shutting down...");
       return false;
     }
-
+  }
+  if (frame_begun) {
+    NS_PROFILE_SCOPE("ui_pass");
     if (!state_ptr->backend.begin_renderpass(
             &state_ptr->backend, static_cast<u8>(builtin_renderpass::UI))) {
       NS_ERROR(
@@ -109,7 +139,7 @@ bool renderer_draw_frame(render_packet *packet) {
     state_ptr->backend.update_global_ui_state(state_ptr->ui_projection,
                                               state_ptr->ui_view, 0);
 
-    count = packet->ui_geometry_count;
+    u32 count = packet->ui_geometry_count;
     for (u32 i = 0; i < count; i++) {
       state_ptr->backend.draw_geometry(packet->ui_geometries[i]);
     }
@@ -119,7 +149,9 @@ bool renderer_draw_frame(render_packet *packet) {
       NS_ERROR("renderer_end_renderpass failed. Application shutting down...");
       return false;
     }
-
+  }
+  if (frame_begun) {
+    NS_PROFILE_SCOPE("end_frame");
     bool result =
         state_ptr->backend.end_frame(&state_ptr->backend, packet->delta_time);
     state_ptr->backend.frame_number++;
@@ -134,6 +166,16 @@ bool renderer_draw_frame(render_packet *packet) {
 
 void renderer_set_view(mat4 view) { state_ptr->view = view; }
 
+frustum renderer_get_world_frustum() { return state_ptr->world_frustum; }
+
+u32 renderer_get_culled_geometry_count() {
+  return state_ptr->culled_geometry_count;
+}
+
+bool renderer_supports_texture_compression() {
+  return state_ptr && state_ptr->backend.supports_texture_compression;
+}
+
 void renderer_create_texture(robytes pixels, Texture *texture) {
   state_ptr->backend.create_texture(pixels, texture);
 }
@@ -150,12 +192,14 @@ void renderer_destroy_material(Material *material) {
   state_ptr->backend.destroy_material(material);
 }
 
-bool renderer_create_geometry(Geometry *geometry, u32 vertex_size,
-                              u32 vertex_count, roptr vertices, u32 index_size,
-                              u32 index_count, roptr indices) {
-  return state_ptr->backend.create_geometry(geometry, vertex_size, vertex_count,
-                                            vertices, index_size, index_count,
-                                            indices);
+bool renderer_create_geometry(Geometry *geometry, VertexFormat vertex_format,
+                              u32 vertex_size, u32 vertex_count,
+                              roptr vertices, u32 index_size, u32 index_count,
+                              roptr indices) {
+  geometry->vertex_format = vertex_format;
+  return state_ptr->backend.create_geometry(geometry, vertex_format,
+                                            vertex_size, vertex_count, vertices,
+                                            index_size, index_count, indices);
 }
 
 void renderer_destroy_geometry(Geometry *geometry) {
@@ -18,6 +18,21 @@ bool renderer_draw_frame(render_packet *packet);
 // HACK: remove NS_API when possible
 NS_API void renderer_set_view(mat4 view);
 
+/**
+ * Gets the frustum of the world pass of the last frame
+ */
+NS_API frustum renderer_get_world_frustum();
+
+/**
+ * Gets the number of geometries skipped by frustum culling in the last frame
+ */
+NS_API u32 renderer_get_culled_geometry_count();
+
+/**
+ * Checks if the device samples the block compressed textures (BC1 and BC3)
+ */
+bool renderer_supports_texture_compression();
+
 void renderer_create_texture(robytes pixels, Texture *texture);
 
 void renderer_destroy_texture(Texture *texture);
@@ -26,9 +41,18 @@ bool renderer_create_material(Material *material);
 
 void renderer_destroy_material(Material *material);
 
-bool renderer_create_geometry(Geometry *geometry, u32 vertex_size,
-                              u32 vertex_count, roptr vertices, u32 index_size,
-                              u32 index_count, roptr indices);
+/**
+ * Uploads the vertices and indices of a geometry
+ * @param geometry the geometry
+ * @param vertex_format the layout of the vertices (FLOAT for the vertex_2d
+ *        vertices of the UI). Packed vertices are relative to
+ *        geometry->bounds.
+ * @param vertex_size the size of a vertex
+ */
+bool renderer_create_geometry(Geometry *geometry, VertexFormat vertex_format,
+                              u32 vertex_size, u32 vertex_count,
+                              roptr vertices, u32 index_size, u32 index_count,
+                              roptr indices);
 
 void renderer_destroy_geometry(Geometry *geometry);
 
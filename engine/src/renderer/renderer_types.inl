@@ -25,6 +25,8 @@ enum class builtin_renderpass : u8 {
 
 struct renderer_backend {
   u64 frame_number;
+  // Whether the textures can be block compressed, set by initialize
+  bool supports_texture_compression;
 
   bool (*initialize)(renderer_backend *backend, cstr application_name);
 
@@ -50,9 +52,9 @@ struct renderer_backend {
   bool (*create_material)(Material *material);
   void (*destroy_material)(Material *material);
 
-  bool (*create_geometry)(Geometry *geometry, u32 vertex_size, u32 vertex_count,
-                          roptr vertices, u32 index_size, u32 index_count,
-                          roptr indices);
+  bool (*create_geometry)(Geometry *geometry, VertexFormat vertex_format,
+                          u32 vertex_size, u32 vertex_count, roptr vertices,
+                          u32 index_size, u32 index_count, roptr indices);
   void (*destroy_geometry)(Geometry *geometry);
 };
 
@@ -1,7 +1,9 @@
 #include "./vulkan_material_shader.h"
 
 #include "../../../core/logger.h"
+#include "../../../core/memory.h"
 #include "../../../math/math.h"
+#include "../../../math/packing.h"
 #include "../vulkan_buffer.h"
 #include "../vulkan_pipeline.h"
 #include "../vulkan_shader_utils.h"
@@ -13,6 +15,10 @@
 
 namespace ns::vulkan {
 
+static Pipeline *material_shader_pipeline(MaterialShader *shader) {
+  return &shader->pipelines[static_cast<u8>(shader->bound_format)];
+}
+
 bool material_shader_create(Context *context, MaterialShader *out_shader) {
   char stage_type_strs[MaterialShader::STAGE_COUNT][5] = {"vert", "frag"};
   VkShaderStageFlagBits stage_types[MaterialShader::STAGE_COUNT] = {
@@ -119,20 +125,24 @@ bool material_shader_create(Context *context, MaterialShader *out_shader) {
   scissor.extent.width = framebuffer_width;
   scissor.extent.height = framebuffer_height;
 
+  // The shader reads a vec3 position and a vec2 texcoord in every format:
+  // the vertex fetch decodes the packed ones (the 4th position component is
+  // dropped).
   static constexpr i32 attribute_count = 2;
-  VkVertexInputAttributeDescription attribute_descs[attribute_count] = {
-      {
-          .location = 0,
-          .binding = 0,
-          .format = VK_FORMAT_R32G32B32_SFLOAT,
-          .offset = 0,
-      },
-      {
-          .location = 1,
-          .binding = 0,
-          .format = VK_FORMAT_R32G32_SFLOAT,
-          .offset = sizeof(vec3),
-      },
+  VkFormat position_formats[MaterialShader::VERTEX_FORMAT_COUNT] = {
+      VK_FORMAT_R32G32B32_SFLOAT,
+      VK_FORMAT_R16G16B16A16_UNORM,
+      VK_FORMAT_R16G16B16A16_UNORM,
+  };
+  VkFormat texcoord_formats[MaterialShader::VERTEX_FORMAT_COUNT] = {
+      VK_FORMAT_R32G32_SFLOAT,
+      VK_FORMAT_R16G16_SFLOAT,
+      VK_FORMAT_R16G16_UNORM,
+  };
+  u32 texcoord_offsets[MaterialShader::VERTEX_FORMAT_COUNT] = {
+      offsetof(vertex_3d, texcoord),
+      offsetof(vertex_3d_packed, texcoord),
+      offsetof(vertex_3d_packed, texcoord),
   };
 
   const i32 descriptor_set_layout_count = 2;
@@ -150,14 +160,34 @@ bool material_shader_create(Context *context, MaterialShader *out_shader) {
     stage_create_infos[i] = out_shader->stages[i].shader_stage_create_info;
   }
 
-  if (!graphics_pipeline_create(
-          context, &context->main_renderpass, sizeof(vertex_3d),
-          attribute_count, attribute_descs, descriptor_set_layout_count,
-          layouts, MaterialShader::STAGE_COUNT, stage_create_infos, viewport,
-          scissor, false, true, &out_shader->pipeline)) {
-    NS_ERROR("Failed to load graphics pipeline for object shader.");
-    return false;
+  for (usize f = 0; f < MaterialShader::VERTEX_FORMAT_COUNT; f++) {
+    VkVertexInputAttributeDescription attribute_descs[attribute_count] = {
+        {
+            .location = 0,
+            .binding = 0,
+            .format = position_formats[f],
+            .offset = 0,
+        },
+        {
+            .location = 1,
+            .binding = 0,
+            .format = texcoord_formats[f],
+            .offset = texcoord_offsets[f],
+        },
+    };
+    u32 stride = vertex_format_size(static_cast<VertexFormat>(f));
+    if (!graphics_pipeline_create(
+            context, &context->main_renderpass, stride, attribute_count,
+            attribute_descs, descriptor_set_layout_count, layouts,
+            MaterialShader::STAGE_COUNT, stage_create_infos, viewport, scissor,
+            false, true, &out_shader->pipelines[f])) {
+      NS_ERROR("Failed to load graphics pipeline for object shader (%s "
+               "vertices).",
+               vertex_format_name(static_cast<VertexFormat>(f)));
+      return false;
+    }
   }
+  out_shader->bound_format = VertexFormat::FLOAT;
 
   u32 device_local_bit = context->device.supports_device_local_host_visible
                              ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
@@ -207,7 +237,9 @@ void material_shader_destroy(Context *context, MaterialShader *shader) {
 
   buffer_destroy(context, &shader->object_uniform_buffer);
 
-  pipeline_destroy(context, &shader->pipeline);
+  for (usize f = 0; f < MaterialShader::VERTEX_FORMAT_COUNT; f++) {
+    pipeline_destroy(context, &shader->pipelines[f]);
+  }
 
   vkDestroyDescriptorPool(context->device, shader->global_descriptor_pool,
                           context->allocator);
@@ -232,8 +264,21 @@ void material_shader_destroy(Context *context, MaterialShader *shader) {
 
 void material_shader_use(Context *context, MaterialShader *shader) {
   u32 image_index = context->image_index;
+  shader->bound_format = VertexFormat::FLOAT;
   pipeline_bind(&context->graphics_command_buffers[image_index],
-                VK_PIPELINE_BIND_POINT_GRAPHICS, &shader->pipeline);
+                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                material_shader_pipeline(shader));
+}
+
+void material_shader_use_format(Context *context, MaterialShader *shader,
+                                VertexFormat format) {
+  if (shader->bound_format == format) {
+    return;
+  }
+  shader->bound_format = format;
+  pipeline_bind(&context->graphics_command_buffers[context->image_index],
+                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                material_shader_pipeline(shader));
 }
 
 void material_shader_update_global_state(Context *context,
@@ -267,16 +312,16 @@ void material_shader_update_global_state(Context *context,
 
   vkCmdBindDescriptorSets(context->graphics_command_buffers[image_index],
                           VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          shader->pipeline.layout, 0, 1, &global_descriptor, 0,
-                          nullptr);
+                          material_shader_pipeline(shader)->layout, 0, 1,
+                          &global_descriptor, 0, nullptr);
 }
 
 void material_shader_set_model(Context *context, MaterialShader *shader,
                                mat4 model) {
   if (context && shader) {
     vkCmdPushConstants(context->graphics_command_buffers[context->image_index],
-                       shader->pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0,
-                       sizeof(mat4), &model);
+                       material_shader_pipeline(shader)->layout,
+                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4), &model);
   }
 }
 
@@ -392,8 +437,8 @@ void material_shader_apply_material(Context *context, MaterialShader *shader,
 
   vkCmdBindDescriptorSets(context->graphics_command_buffers[image_index],
                           VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          shader->pipeline.layout, 1, 1, &object_descriptor, 0,
-                          nullptr);
+                          material_shader_pipeline(shader)->layout, 1, 1,
+                          &object_descriptor, 0, nullptr);
 }
 
 bool material_shader_acquire_resources(Context *context, MaterialShader *shader,
@@ -11,6 +11,10 @@ void material_shader_destroy(Context *context, MaterialShader *shader);
 
 void material_shader_use(Context *context, MaterialShader *shader);
 
+// Binds the pipeline of a vertex format, if it is not bound
+void material_shader_use_format(Context *context, MaterialShader *shader,
+                                VertexFormat format);
+
 void material_shader_update_global_state(Context *context,
                                          MaterialShader *shader,
                                          f32 delta_time);
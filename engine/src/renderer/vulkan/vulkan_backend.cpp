@@ -5,6 +5,7 @@
 #include "../../core/logger.h"
 #include "../../core/string.h"
 #include "../../math/math.h"
+#include "../../resources/block_compression.h"
 #include "./shaders/vulkan_material_shader.h"
 #include "./shaders/vulkan_ui_shader.h"
 #include "./vulkan_buffer.h"
@@ -37,10 +38,15 @@ void create_command_buffers(renderer_backend *backend);
 void regenerate_framebuffers();
 bool recreate_swapchain(renderer_backend *backend);
 
+// Ranges are allocated in multiples of 4 bytes, so that all the offsets in a
+// buffer stay 4-aligned: 16 and 32 bit index ranges can share the index
+// buffer (vkCmdBindIndexBuffer needs offsets aligned to the index size).
+NS_INLINE u64 data_range_size(u64 size) { return (size + 3) & ~u64(3); }
+
 bool upload_data_range(Context *context, VkCommandPool pool, VkFence fence,
                        VkQueue queue, Buffer *buffer, usize *out_offset,
                        usize size, roptr data) {
-  if (!buffer_allocate(buffer, size, out_offset)) {
+  if (!buffer_allocate(buffer, data_range_size(size), out_offset)) {
     NS_ERROR("upload_data_range - failed to allocate from given buffer");
     return false;
   }
@@ -58,7 +64,7 @@ bool upload_data_range(Context *context, VkCommandPool pool, VkFence fence,
 
 void free_data_range(Buffer *buffer, u64 offset, u64 size) {
   if (buffer) {
-    buffer_free(buffer, size, offset);
+    buffer_free(buffer, data_range_size(size), offset);
   }
 }
 
@@ -180,6 +186,12 @@ bool backend_initialize(renderer_backend *backend, cstr application_name) {
     NS_ERROR("Failed to create device");
     return false;
   }
+  backend->supports_texture_compression =
+      context.device.features.textureCompressionBC;
+  if (!backend->supports_texture_compression) {
+    NS_INFO("Device does not support textureCompressionBC, the textures are "
+            "not compressed.");
+  }
 
   swapchain_create(&context, framebuffer_width, framebuffer_height,
                    &context.swapchain);
@@ -667,9 +679,21 @@ void backend_create_texture(robytes pixels, Texture *texture) {
   TextureData *texture_data =
       reinterpret_cast<TextureData *>(texture->internal_data);
 
-  VkDeviceSize image_size =
-      texture->width * texture->height * texture->channel_count;
+  // The pixels are RGBA (whatever the channel count of the source) or blocks
+  VkDeviceSize image_size = texture_format_chain_size(
+      texture->format, texture->width, texture->height, texture->mip_count);
   VkFormat image_format = VK_FORMAT_R8G8B8A8_UNORM;
+  VkImageUsageFlags image_usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                  VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                                  VK_IMAGE_USAGE_SAMPLED_BIT;
+  if (texture->format == TextureFormat::BC1) {
+    image_format = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+  } else if (texture->format == TextureFormat::BC3) {
+    image_format = VK_FORMAT_BC3_UNORM_BLOCK;
+  } else {
+    // Compressed formats can't be rendered to
+    image_usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  }
   VkBufferUsageFlagBits usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
   VkMemoryPropertyFlags memory_prop_flags =
       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
@@ -678,13 +702,10 @@ void backend_create_texture(robytes pixels, Texture *texture) {
   buffer_create(&context, image_size, usage, memory_prop_flags, true, &staging);
   buffer_load_data(&context, &staging, 0, image_size, 0, pixels);
 
-  image_create(
-      &context, VK_IMAGE_TYPE_2D, texture->width, texture->height, image_format,
-      VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-          VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, VK_IMAGE_ASPECT_COLOR_BIT,
-      &texture_data->image);
+  image_create(&context, VK_IMAGE_TYPE_2D, texture->width, texture->height,
+               texture->mip_count, image_format, VK_IMAGE_TILING_OPTIMAL,
+               image_usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true,
+               VK_IMAGE_ASPECT_COLOR_BIT, &texture_data->image);
 
   CommandBuffer tmp_buf;
   VkCommandPool pool = context.device.graphics_command_pool;
@@ -721,7 +742,7 @@ void backend_create_texture(robytes pixels, Texture *texture) {
   info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
   info.mipLodBias = 0.0f;
   info.minLod = 0.0f;
-  info.maxLod = 0.0f;
+  info.maxLod = static_cast<f32>(texture->mip_count);
   VkResult result = vkCreateSampler(context.device, &info, context.allocator,
                                     &texture_data->sampler);
 
@@ -806,9 +827,9 @@ void backend_destroy_material(Material *material) {
   }
 }
 
-bool backend_create_geometry(Geometry *geometry, u32 vertex_size,
-                             u32 vertex_count, roptr vertices, u32 index_size,
-                             u32 index_count, roptr indices) {
+bool backend_create_geometry(Geometry *geometry, VertexFormat vertex_format,
+                             u32 vertex_size, u32 vertex_count, roptr vertices,
+                             u32 index_size, u32 index_count, roptr indices) {
   if (!vertex_count || !vertices) {
     NS_ERROR("vulkan::renderer_create_geometry - vertex_count or vertices "
              "is null");
@@ -849,6 +870,7 @@ bool backend_create_geometry(Geometry *geometry, u32 vertex_size,
 
   internal_data->vertex_count = vertex_count;
   internal_data->vertex_element_size = vertex_size;
+  internal_data->vertex_format = vertex_format;
   u32 total_size = vertex_size * vertex_count;
   if (!upload_data_range(
           &context, pool, 0, queue, &context.object_vertex_buffer,
@@ -929,6 +951,8 @@ void backend_draw_geometry(geometry_render_data data) {
 
   switch (m->type) {
   case MaterialType::WORLD:
+    material_shader_use_format(&context, &context.material_shader,
+                               buffer_data->vertex_format);
     material_shader_set_model(&context, &context.material_shader, data.model);
     material_shader_apply_material(&context, &context.material_shader, m);
     break;
@@ -948,7 +972,9 @@ void backend_draw_geometry(geometry_render_data data) {
   if (buffer_data->index_count > 0) {
     vkCmdBindIndexBuffer(command_buffer, context.object_index_buffer.handle,
                          buffer_data->index_buffer_offset,
-                         VK_INDEX_TYPE_UINT32);
+                         buffer_data->index_element_size == sizeof(u16)
+                             ? VK_INDEX_TYPE_UINT16
+                             : VK_INDEX_TYPE_UINT32);
     vkCmdDrawIndexed(command_buffer, buffer_data->index_count, 1, 0, 0, 0);
   } else {
     vkCmdDraw(command_buffer, buffer_data->vertex_count, 1, 0, 0);
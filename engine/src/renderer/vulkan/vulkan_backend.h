@@ -34,9 +34,9 @@ bool backend_create_material(Material *material);
 
 void backend_destroy_material(Material *material);
 
-bool backend_create_geometry(Geometry *geometry, u32 vertex_size,
-                             u32 vertex_count, roptr vertices, u32 index_size,
-                             u32 index_count, roptr indices);
+bool backend_create_geometry(Geometry *geometry, VertexFormat vertex_format,
+                             u32 vertex_size, u32 vertex_count, roptr vertices,
+                             u32 index_size, u32 index_count, roptr indices);
 
 void backend_destroy_geometry(Geometry *geometry);
 
@@ -14,6 +14,7 @@ struct PhysicalDeviceRequirements {
   bool transfer;
   Vec<cstr> device_extension_names;
   bool sampler_anisotropy;
+  bool texture_compression_bc;
   bool discrete_gpu;
 };
 
@@ -78,6 +79,10 @@ bool device_create(Context *context) {
 
   VkPhysicalDeviceFeatures device_features{};
   device_features.samplerAnisotropy = VK_TRUE;
+  // Optional: the image loader compresses the textures to BC1 and BC3 when
+  // the device samples them (see backend_initialize)
+  device_features.textureCompressionBC =
+      context->device.features.textureCompressionBC;
 
   VkDeviceCreateInfo device_create_info{};
   device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -264,6 +269,7 @@ static bool select_physical_device(Context *context) {
         .transfer = true,
         .device_extension_names = {VK_KHR_SWAPCHAIN_EXTENSION_NAME},
         .sampler_anisotropy = true,
+        .texture_compression_bc = false,
         .discrete_gpu = true,
     };
 
@@ -472,6 +478,12 @@ static bool physical_device_meets_requirements(
     return false;
   }
 
+  if (requirements->texture_compression_bc &&
+      !features->textureCompressionBC) {
+    NS_INFO("Device does not support textureCompressionBC, skipping.");
+    return false;
+  }
+
   return true;
 }
 
@@ -1,16 +1,20 @@
 #include "./vulkan_image.h"
 
 #include "../../core/logger.h"
+#include "../../core/memory.h"
+#include "../../resources/mipmap.h"
 
 namespace ns::vulkan {
 
 void image_create(Context *context, VkImageType /*image_type*/, u32 width,
-                  u32 height, VkFormat format, VkImageTiling tiling,
-                  VkImageUsageFlags usage, VkMemoryPropertyFlags memory_flags,
-                  bool create_view, VkImageAspectFlags view_aspect_flags,
-                  Image *out_image) {
+                  u32 height, u32 mip_levels, VkFormat format,
+                  VkImageTiling tiling, VkImageUsageFlags usage,
+                  VkMemoryPropertyFlags memory_flags, bool create_view,
+                  VkImageAspectFlags view_aspect_flags, Image *out_image) {
   out_image->width = width;
   out_image->height = height;
+  out_image->mip_levels = mip_levels;
+  out_image->format = format;
 
   VkImageCreateInfo create_info{};
   create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -18,7 +22,7 @@ void image_create(Context *context, VkImageType /*image_type*/, u32 width,
   create_info.extent.width = width;
   create_info.extent.height = height;
   create_info.extent.depth = 1;
-  create_info.mipLevels = 4;
+  create_info.mipLevels = mip_levels;
   create_info.arrayLayers = 1;
   create_info.format = format;
   create_info.tiling = tiling;
@@ -65,7 +69,7 @@ void image_view_create(Context *context, VkFormat format, Image *image,
   create_info.format = format;
   create_info.subresourceRange.aspectMask = aspect_flags;
   create_info.subresourceRange.baseMipLevel = 0;
-  create_info.subresourceRange.levelCount = 1;
+  create_info.subresourceRange.levelCount = image->mip_levels;
   create_info.subresourceRange.baseArrayLayer = 0;
   create_info.subresourceRange.layerCount = 1;
 
@@ -86,7 +90,7 @@ void image_transition_layout(Context *context, CommandBuffer *command_buffer,
   barrier.image = *image;
   barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
   barrier.subresourceRange.baseMipLevel = 0;
-  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.levelCount = image->mip_levels;
   barrier.subresourceRange.baseArrayLayer = 0;
   barrier.subresourceRange.layerCount = 1;
 
@@ -114,22 +118,49 @@ void image_transition_layout(Context *context, CommandBuffer *command_buffer,
                        0, nullptr, 1, &barrier);
 }
 
+// Size of a level in a buffer, tightly packed
+static VkDeviceSize image_level_size(VkFormat format, u32 width, u32 height) {
+  VkDeviceSize blocks = static_cast<VkDeviceSize>((width + 3) / 4) *
+                        ((height + 3) / 4);
+  switch (format) {
+  case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+  case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    return blocks * 8;
+  case VK_FORMAT_BC3_UNORM_BLOCK:
+    return blocks * 16;
+  default:
+    // RGBA8
+    return static_cast<VkDeviceSize>(width) * height * 4;
+  }
+}
+
 void image_copy_from_buffer(Context * /*context*/, Image *image,
                             VkBuffer buffer, CommandBuffer *command_buffer) {
-  VkBufferImageCopy region{};
-  mem_zero(&region, sizeof(VkBufferImageCopy));
-  region.bufferOffset = 0;
-  region.bufferRowLength = 0;
-  region.bufferImageHeight = 0;
-  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = 1;
-  region.imageOffset = {0, 0, 0};
-  region.imageExtent = {image->width, image->height, 1};
+  VkBufferImageCopy regions[MIP_MAX_LEVEL_COUNT];
+  mem_zero(regions, sizeof(regions));
+  u32 level_count = image->mip_levels < MIP_MAX_LEVEL_COUNT
+                        ? image->mip_levels
+                        : MIP_MAX_LEVEL_COUNT;
+  VkDeviceSize offset = 0;
+  for (u32 i = 0; i < level_count; i++) {
+    u32 width = image->width >> i > 0 ? image->width >> i : 1;
+    u32 height = image->height >> i > 0 ? image->height >> i : 1;
+    VkBufferImageCopy *region = &regions[i];
+    region->bufferOffset = offset;
+    region->bufferRowLength = 0;
+    region->bufferImageHeight = 0;
+    region->imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region->imageSubresource.mipLevel = i;
+    region->imageSubresource.baseArrayLayer = 0;
+    region->imageSubresource.layerCount = 1;
+    region->imageOffset = {0, 0, 0};
+    region->imageExtent = {width, height, 1};
+    offset += image_level_size(image->format, width, height);
+  }
 
   vkCmdCopyBufferToImage(*command_buffer, buffer, *image,
-                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, level_count,
+                         regions);
 }
 
 void image_destroy(Context *context, Image *image) {
@@ -11,6 +11,7 @@ namespace ns::vulkan {
  * @param image_type Image type.
  * @param width Image width.
  * @param height Image height.
+ * @param mip_levels Number of mip levels.
  * @param format Image format.
  * @param tiling Image tiling.
  * @param usage Image usage.
@@ -20,13 +21,13 @@ namespace ns::vulkan {
  * @param out_image The created image.
  */
 void image_create(Context *context, VkImageType image_type, u32 width,
-                  u32 height, VkFormat format, VkImageTiling tiling,
-                  VkImageUsageFlags usage, VkMemoryPropertyFlags memory_flags,
-                  bool create_view, VkImageAspectFlags view_aspect_flags,
-                  Image *out_image);
+                  u32 height, u32 mip_levels, VkFormat format,
+                  VkImageTiling tiling, VkImageUsageFlags usage,
+                  VkMemoryPropertyFlags memory_flags, bool create_view,
+                  VkImageAspectFlags view_aspect_flags, Image *out_image);
 
 /**
- * Create an image view
+ * Create an image view of all the mip levels
  * @param context The Vulkan context.
  * @param format The format of the image.
  * @param image Image to create the view for.
@@ -37,7 +38,7 @@ void image_view_create(Context *context, VkFormat format, Image *image,
                        VkImageAspectFlags aspect_flags);
 
 /**
- * Transition an image from old_layout to new_layout
+ * Transition all the mip levels of an image from old_layout to new_layout
  * @param context The Vulkan context.
  * @param command_buffer Command buffer to use.
  * @param image Image to transition.
@@ -51,7 +52,8 @@ void image_transition_layout(Context *context, CommandBuffer *command_buffer,
                              VkImageLayout new_layout);
 
 /**
- * Copy data in buffer to provided image.
+ * Copy data in buffer to provided image: its mip levels, one after the
+ * other (RGBA8 texels or compressed blocks, depending on its format).
  * @param context The Vulkan context.
  * @param image Image to copy the buffer's data to.
  * @param buffer Buffer whose data will be copied.
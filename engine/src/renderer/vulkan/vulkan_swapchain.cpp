@@ -218,7 +218,7 @@ static void create(Context *context, u32 width, u32 height,
   }
 
   image_create(context, VK_IMAGE_TYPE_2D, swapchain_extent.width,
-               swapchain_extent.height, context->device.depth_format,
+               swapchain_extent.height, 1, context->device.depth_format,
                VK_IMAGE_TILING_OPTIMAL,
                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true,
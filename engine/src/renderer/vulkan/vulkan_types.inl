@@ -75,6 +75,8 @@ struct Image {
   VkImageView view;
   u32 width;
   u32 height;
+  u32 mip_levels;
+  VkFormat format;
 
   operator VkImage() const { return handle; }
 };
@@ -181,6 +183,7 @@ struct GeometryData {
   u32 index_count;
   u64 index_buffer_offset;
   u32 index_element_size;
+  VertexFormat vertex_format;
 };
 
 struct MaterialShader {
@@ -230,7 +233,11 @@ struct MaterialShader {
 
   InstanceState instance_states[MAX_MATERIAL_COUNT];
 
-  Pipeline pipeline;
+  // One pipeline per VertexFormat. Their layouts are identical: the bound
+  // descriptor sets and push constants stay valid across a switch.
+  static constexpr usize VERTEX_FORMAT_COUNT = 3;
+  Pipeline pipelines[VERTEX_FORMAT_COUNT];
+  VertexFormat bound_format;
 };
 
 struct UiShader {
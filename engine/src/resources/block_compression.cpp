@@ -0,0 +1,458 @@
+#include "./block_compression.h"
+
+#include "../core/profiler.h"
+#include "./row_bands.h"
+
+namespace ns {
+
+#define BC_TEXEL_COUNT (BC_BLOCK_EXTENT * BC_BLOCK_EXTENT)
+// Smaller bands are not worth a thread
+#define BC_BAND_MIN_BLOCK_COUNT 1024
+#define BC_POWER_ITERATION_COUNT 4
+#define BC_REFINE_ITERATION_COUNT 2
+
+// Rows of blocks [row_begin, row_end) of a level
+struct bc_band {
+  TextureFormat format;
+  u8 const *rgba;
+  u32 width;
+  u32 height;
+  u8 *out;
+  u32 row_begin;
+  u32 row_end;
+};
+
+NS_INLINE u32 bc_block_size(TextureFormat format) {
+  return format == TextureFormat::BC1 ? 8 : 16;
+}
+
+NS_INLINE u32 bc_block_count(u32 size) {
+  return (size + BC_BLOCK_EXTENT - 1) / BC_BLOCK_EXTENT;
+}
+
+// Rounds a channel in [0, 255] to [0, max]
+NS_INLINE u32 bc_quantize(f32 v, f32 max) {
+  v = v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v);
+  return static_cast<u32>(v * max / 255.0f + 0.5f);
+}
+
+NS_INLINE void bc_write_u16(u8 *out, u16 value) {
+  out[0] = static_cast<u8>(value);
+  out[1] = static_cast<u8>(value >> 8);
+}
+
+NS_INLINE u16 bc_read_u16(u8 const *in) {
+  return static_cast<u16>(in[0] | (in[1] << 8));
+}
+
+// Rounds a color to 5:6:5 bits
+static u16 bc_pack_565(f32 const *color) {
+  u32 r = bc_quantize(color[0], 31.0f);
+  u32 g = bc_quantize(color[1], 63.0f);
+  u32 b = bc_quantize(color[2], 31.0f);
+  return static_cast<u16>((r << 11) | (g << 5) | b);
+}
+
+static void bc_unpack_565(u16 color, u8 *out) {
+  u32 r = (color >> 11) & 31;
+  u32 g = (color >> 5) & 63;
+  u32 b = color & 31;
+  out[0] = static_cast<u8>((r << 3) | (r >> 2));
+  out[1] = static_cast<u8>((g << 2) | (g >> 4));
+  out[2] = static_cast<u8>((b << 3) | (b >> 2));
+  out[3] = 255;
+}
+
+// The 4 colors of a block. Without four_colors (BC1 with c0 <= c1), the
+// third is the middle one and the last is transparent black.
+static void bc_color_palette(u16 c0, u16 c1, bool four_colors,
+                             u8 palette[4][4]) {
+  bc_unpack_565(c0, palette[0]);
+  bc_unpack_565(c1, palette[1]);
+  for (u32 i = 0; i < 3; i++) {
+    u32 p0 = palette[0][i];
+    u32 p1 = palette[1][i];
+    if (four_colors) {
+      palette[2][i] = static_cast<u8>((2 * p0 + p1) / 3);
+      palette[3][i] = static_cast<u8>((p0 + 2 * p1) / 3);
+    } else {
+      palette[2][i] = static_cast<u8>((p0 + p1) / 2);
+      palette[3][i] = 0;
+    }
+  }
+  palette[2][3] = 255;
+  palette[3][3] = four_colors ? 255 : 0;
+}
+
+// Chooses the color of each texel by its projection on the axis of the
+// endpoints (the 4 colors lie on it, up to rounding), rather than by its
+// distance to each of them. Returns the squared error of the block.
+static u32 bc_color_indices(u8 const *texels, u16 c0, u16 c1,
+                            u32 *out_indices) {
+  u8 palette[4][4];
+  bc_color_palette(c0, c1, true, palette);
+  i32 axis[3];
+  i32 stops[4];
+  for (u32 i = 0; i < 3; i++) {
+    axis[i] = palette[0][i] - palette[1][i];
+  }
+  for (u32 i = 0; i < 4; i++) {
+    stops[i] = palette[i][0] * axis[0] + palette[i][1] * axis[1] +
+               palette[i][2] * axis[2];
+  }
+  // Along the axis: 1, 3, 2, 0. Doubled midpoints between them.
+  i32 half_02 = stops[0] + stops[2];
+  i32 half_23 = stops[2] + stops[3];
+  i32 half_31 = stops[3] + stops[1];
+  u32 indices = 0;
+  u32 error = 0;
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    u8 const *texel = texels + t * 4;
+    i32 d = 2 * (texel[0] * axis[0] + texel[1] * axis[1] +
+                 texel[2] * axis[2]);
+    u32 index = d > half_02 ? 0 : (d > half_23 ? 2 : (d > half_31 ? 3 : 1));
+    i32 dr = texel[0] - palette[index][0];
+    i32 dg = texel[1] - palette[index][1];
+    i32 db = texel[2] - palette[index][2];
+    indices |= index << (t * 2);
+    error += static_cast<u32>(dr * dr + dg * dg + db * db);
+  }
+  *out_indices = indices;
+  return error;
+}
+
+// Endpoints minimizing the squared error for these indices. Returns false if
+// the system is singular (one index for all the texels).
+static bool bc_refine_colors(u8 const *texels, u32 indices, f32 *out_e0,
+                             f32 *out_e1) {
+  static const f32 weights[4][2] = {
+      {1.0f, 0.0f}, {0.0f, 1.0f}, {2.0f / 3.0f, 1.0f / 3.0f},
+      {1.0f / 3.0f, 2.0f / 3.0f}};
+  f32 aa = 0.0f;
+  f32 bb = 0.0f;
+  f32 ab = 0.0f;
+  f32 ax[3] = {};
+  f32 bx[3] = {};
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    u32 index = (indices >> (t * 2)) & 3;
+    f32 a = weights[index][0];
+    f32 b = weights[index][1];
+    aa += a * a;
+    bb += b * b;
+    ab += a * b;
+    for (u32 i = 0; i < 3; i++) {
+      ax[i] += a * texels[t * 4 + i];
+      bx[i] += b * texels[t * 4 + i];
+    }
+  }
+  f32 det = aa * bb - ab * ab;
+  if (det < 1e-6f) {
+    return false;
+  }
+  for (u32 i = 0; i < 3; i++) {
+    out_e0[i] = (ax[i] * bb - bx[i] * ab) / det;
+    out_e1[i] = (bx[i] * aa - ax[i] * ab) / det;
+  }
+  return true;
+}
+
+// The endpoints are the extreme texels along the principal axis of the
+// colors, improved by least squares while the error decreases
+static void bc_encode_colors(u8 const *texels, u8 *out) {
+  f32 mean[3] = {};
+  u8 min[3] = {255, 255, 255};
+  u8 max[3] = {0, 0, 0};
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    for (u32 i = 0; i < 3; i++) {
+      u8 v = texels[t * 4 + i];
+      mean[i] += v;
+      min[i] = v < min[i] ? v : min[i];
+      max[i] = v > max[i] ? v : max[i];
+    }
+  }
+  if (min[0] == max[0] && min[1] == max[1] && min[2] == max[2]) {
+    // Solid block
+    f32 color[3] = {static_cast<f32>(min[0]), static_cast<f32>(min[1]),
+                    static_cast<f32>(min[2])};
+    u16 c = bc_pack_565(color);
+    bc_write_u16(out, c);
+    bc_write_u16(out + 2, c);
+    out[4] = out[5] = out[6] = out[7] = 0;
+    return;
+  }
+  for (u32 i = 0; i < 3; i++) {
+    mean[i] /= BC_TEXEL_COUNT;
+  }
+
+  // Covariance: xx, xy, xz, yy, yz, zz
+  f32 cov[6] = {};
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    f32 r = texels[t * 4 + 0] - mean[0];
+    f32 g = texels[t * 4 + 1] - mean[1];
+    f32 b = texels[t * 4 + 2] - mean[2];
+    cov[0] += r * r;
+    cov[1] += r * g;
+    cov[2] += r * b;
+    cov[3] += g * g;
+    cov[4] += g * b;
+    cov[5] += b * b;
+  }
+  // Power iteration, from the diagonal of the bounding box
+  f32 axis[3] = {static_cast<f32>(max[0] - min[0]),
+                 static_cast<f32>(max[1] - min[1]),
+                 static_cast<f32>(max[2] - min[2])};
+  for (u32 k = 0; k < BC_POWER_ITERATION_COUNT; k++) {
+    f32 x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+    f32 y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+    f32 z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+    f32 m = x * x > y * y ? x : y;
+    m = m * m > z * z ? m : z;
+    if (m * m < 1e-12f) {
+      break;
+    }
+    axis[0] = x / m;
+    axis[1] = y / m;
+    axis[2] = z / m;
+  }
+
+  u32 min_texel = 0;
+  u32 max_texel = 0;
+  f32 min_projection = 1e30f;
+  f32 max_projection = -1e30f;
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    u8 const *texel = texels + t * 4;
+    f32 p = texel[0] * axis[0] + texel[1] * axis[1] + texel[2] * axis[2];
+    if (p < min_projection) {
+      min_projection = p;
+      min_texel = t;
+    }
+    if (p > max_projection) {
+      max_projection = p;
+      max_texel = t;
+    }
+  }
+  f32 e0[3];
+  f32 e1[3];
+  for (u32 i = 0; i < 3; i++) {
+    e0[i] = texels[max_texel * 4 + i];
+    e1[i] = texels[min_texel * 4 + i];
+  }
+  u16 c0 = bc_pack_565(e0);
+  u16 c1 = bc_pack_565(e1);
+  u32 indices;
+  u32 error = bc_color_indices(texels, c0, c1, &indices);
+
+  for (u32 k = 0; k < BC_REFINE_ITERATION_COUNT && error > 0; k++) {
+    if (!bc_refine_colors(texels, indices, e0, e1)) {
+      break;
+    }
+    u16 r0 = bc_pack_565(e0);
+    u16 r1 = bc_pack_565(e1);
+    u32 refined_indices;
+    u32 refined_error = bc_color_indices(texels, r0, r1, &refined_indices);
+    if (refined_error >= error) {
+      break;
+    }
+    c0 = r0;
+    c1 = r1;
+    indices = refined_indices;
+    error = refined_error;
+  }
+
+  // The four color mode needs c0 > c1: swapping the endpoints swaps the
+  // indices 0 and 1, 2 and 3
+  if (c0 < c1) {
+    u16 c = c0;
+    c0 = c1;
+    c1 = c;
+    indices ^= 0x55555555u;
+  } else if (c0 == c1) {
+    indices = 0;
+  }
+  bc_write_u16(out, c0);
+  bc_write_u16(out + 2, c1);
+  for (u32 i = 0; i < 4; i++) {
+    out[4 + i] = static_cast<u8>(indices >> (i * 8));
+  }
+}
+
+// The 8 alpha values of a block. The 6 value mode (a0 <= a1) adds 0 and 255.
+static void bc_alpha_palette(u8 a0, u8 a1, u8 palette[8]) {
+  palette[0] = a0;
+  palette[1] = a1;
+  if (a0 > a1) {
+    for (u32 i = 2; i < 8; i++) {
+      palette[i] = static_cast<u8>(((8 - i) * a0 + (i - 1) * a1) / 7);
+    }
+  } else {
+    for (u32 i = 2; i < 6; i++) {
+      palette[i] = static_cast<u8>(((6 - i) * a0 + (i - 1) * a1) / 5);
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+static void bc_encode_alpha(u8 const *texels, u8 *out) {
+  u8 a0 = 0;
+  u8 a1 = 255;
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    u8 a = texels[t * 4 + 3];
+    a0 = a > a0 ? a : a0;
+    a1 = a < a1 ? a : a1;
+  }
+  u8 palette[8];
+  bc_alpha_palette(a0, a1, palette);
+  u64 indices = 0;
+  // Equal endpoints: every index gives a0
+  for (u32 t = 0; a0 != a1 && t < BC_TEXEL_COUNT; t++) {
+    i32 a = texels[t * 4 + 3];
+    u32 best = 0;
+    i32 best_distance = 256;
+    for (u32 i = 0; i < 8; i++) {
+      i32 distance = a > palette[i] ? a - palette[i] : palette[i] - a;
+      if (distance < best_distance) {
+        best_distance = distance;
+        best = i;
+      }
+    }
+    indices |= static_cast<u64>(best) << (t * 3);
+  }
+  out[0] = a0;
+  out[1] = a1;
+  for (u32 i = 0; i < 6; i++) {
+    out[2 + i] = static_cast<u8>(indices >> (i * 8));
+  }
+}
+
+static void bc_decode_colors(u8 const *block, bool allow_three_colors,
+                             u8 *texels) {
+  u16 c0 = bc_read_u16(block);
+  u16 c1 = bc_read_u16(block + 2);
+  u8 palette[4][4];
+  bc_color_palette(c0, c1, !allow_three_colors || c0 > c1, palette);
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    u32 index = (block[4 + t / 4] >> ((t % 4) * 2)) & 3;
+    for (u32 i = 0; i < 4; i++) {
+      texels[t * 4 + i] = palette[index][i];
+    }
+  }
+}
+
+static void bc_decode_alpha(u8 const *block, u8 *texels) {
+  u8 palette[8];
+  bc_alpha_palette(block[0], block[1], palette);
+  u64 indices = 0;
+  for (u32 i = 0; i < 6; i++) {
+    indices |= static_cast<u64>(block[2 + i]) << (i * 8);
+  }
+  for (u32 t = 0; t < BC_TEXEL_COUNT; t++) {
+    texels[t * 4 + 3] = palette[(indices >> (t * 3)) & 7];
+  }
+}
+
+// The texels of a block, repeating the last column and row over the edges
+static void bc_fetch_block(u8 const *rgba, u32 width, u32 height, u32 bx,
+                           u32 by, u8 *texels) {
+  for (u32 y = 0; y < BC_BLOCK_EXTENT; y++) {
+    u32 sy = by * BC_BLOCK_EXTENT + y;
+    sy = sy < height ? sy : height - 1;
+    for (u32 x = 0; x < BC_BLOCK_EXTENT; x++) {
+      u32 sx = bx * BC_BLOCK_EXTENT + x;
+      sx = sx < width ? sx : width - 1;
+      u8 const *texel = rgba + (static_cast<usize>(sy) * width + sx) * 4;
+      u8 *dst = texels + (y * BC_BLOCK_EXTENT + x) * 4;
+      dst[0] = texel[0];
+      dst[1] = texel[1];
+      dst[2] = texel[2];
+      dst[3] = texel[3];
+    }
+  }
+}
+
+static void bc_compress_band(bc_band const *band) {
+  u32 block_size = bc_block_size(band->format);
+  u32 blocks_x = bc_block_count(band->width);
+  u8 texels[BC_TEXEL_COUNT * 4];
+  for (u32 by = band->row_begin; by < band->row_end; by++) {
+    u8 *out = band->out + static_cast<usize>(by) * blocks_x * block_size;
+    for (u32 bx = 0; bx < blocks_x; bx++, out += block_size) {
+      bc_fetch_block(band->rgba, band->width, band->height, bx, by, texels);
+      if (band->format == TextureFormat::BC3) {
+        bc_encode_alpha(texels, out);
+        bc_encode_colors(texels, out + 8);
+      } else {
+        bc_encode_colors(texels, out);
+      }
+    }
+  }
+}
+
+// user_data is the band of the whole level
+static void bc_compress_rows(ptr user_data, u32 row_begin, u32 row_end) {
+  bc_band band = *reinterpret_cast<bc_band const *>(user_data);
+  band.row_begin = row_begin;
+  band.row_end = row_end;
+  bc_compress_band(&band);
+}
+
+u64 texture_format_level_size(TextureFormat format, u32 width, u32 height) {
+  if (format == TextureFormat::RGBA8) {
+    return static_cast<u64>(width) * height * 4;
+  }
+  return static_cast<u64>(bc_block_count(width)) * bc_block_count(height) *
+         bc_block_size(format);
+}
+
+u64 texture_format_chain_size(TextureFormat format, u32 width, u32 height,
+                              u32 count) {
+  u64 size = 0;
+  for (u32 i = 0; i < count; i++) {
+    u32 w = width >> i > 0 ? width >> i : 1;
+    u32 h = height >> i > 0 ? height >> i : 1;
+    size += texture_format_level_size(format, w, h);
+  }
+  return size;
+}
+
+void bc_compress(TextureFormat format, u8 const *rgba, u32 width, u32 height,
+                 u8 *out, u32 thread_count) {
+  NS_PROFILE_FUNCTION();
+  u32 rows = bc_block_count(height);
+  bc_band level_band = {format, rgba, width, height, out, 0, rows};
+  row_bands_run(rows, bc_block_count(width), BC_BAND_MIN_BLOCK_COUNT,
+                thread_count, bc_compress_rows, &level_band);
+}
+
+void bc_decompress(TextureFormat format, u8 const *blocks, u32 width,
+                   u32 height, u8 *out) {
+  u32 block_size = bc_block_size(format);
+  u8 texels[BC_TEXEL_COUNT * 4];
+  for (u32 by = 0; by < bc_block_count(height); by++) {
+    for (u32 bx = 0; bx < bc_block_count(width); bx++, blocks += block_size) {
+      if (format == TextureFormat::BC3) {
+        bc_decode_colors(blocks + 8, false, texels);
+        bc_decode_alpha(blocks, texels);
+      } else {
+        bc_decode_colors(blocks, true, texels);
+      }
+      for (u32 y = 0; y < BC_BLOCK_EXTENT; y++) {
+        for (u32 x = 0; x < BC_BLOCK_EXTENT; x++) {
+          u32 dx = bx * BC_BLOCK_EXTENT + x;
+          u32 dy = by * BC_BLOCK_EXTENT + y;
+          if (dx >= width || dy >= height) {
+            continue;
+          }
+          u8 const *texel = texels + (y * BC_BLOCK_EXTENT + x) * 4;
+          u8 *dst = out + (static_cast<usize>(dy) * width + dx) * 4;
+          dst[0] = texel[0];
+          dst[1] = texel[1];
+          dst[2] = texel[2];
+          dst[3] = texel[3];
+        }
+      }
+    }
+  }
+}
+
+} // namespace ns
@@ -0,0 +1,67 @@
+#ifndef BLOCK_COMPRESSION_HEADER_INCLUDED
+#define BLOCK_COMPRESSION_HEADER_INCLUDED
+
+#include "./resource_types.h"
+
+// CPU encoder (and decoder) of the block compressed texture formats, for the
+// images of the image loader. The GPU samples the blocks directly, so a
+// texture takes 1/8 (BC1) or 1/4 (BC3) of its RGBA8 size in VRAM and in the
+// uploads.
+//
+// A level is split in blocks of 4x4 texels, row by row. The blocks over the
+// right or bottom edge repeat the last column or row. The colors are fitted
+// along their principal axis, then refined by least squares; the alpha of
+// BC3 uses its 8 value mode.
+
+namespace ns {
+
+#define BC_BLOCK_EXTENT 4
+
+/**
+ * Gets the size of a level
+ * @param format the format of the level
+ * @param width the width of the level
+ * @param height the height of the level
+ * @returns the size of the level, in bytes
+ */
+NS_API u64 texture_format_level_size(TextureFormat format, u32 width,
+                                     u32 height);
+
+/**
+ * Gets the size of the first levels of a mip chain (see mipmap.h)
+ * @param format the format of the levels
+ * @param width the width of level 0
+ * @param height the height of level 0
+ * @param count the number of levels
+ * @returns the size of the levels, in bytes
+ */
+NS_API u64 texture_format_chain_size(TextureFormat format, u32 width,
+                                     u32 height, u32 count);
+
+/**
+ * Compresses a level
+ * @param format BC1 (alpha is dropped) or BC3
+ * @param rgba the texels of the level
+ * @param width the width of the level
+ * @param height the height of the level
+ * @param out the blocks, texture_format_level_size(format, width, height)
+ *            bytes
+ * @param thread_count the number of threads, 0 for one per core
+ */
+NS_API void bc_compress(TextureFormat format, u8 const *rgba, u32 width,
+                        u32 height, u8 *out, u32 thread_count);
+
+/**
+ * Decompresses a level, as the GPU samples it
+ * @param format BC1 or BC3
+ * @param blocks the blocks of the level
+ * @param width the width of the level
+ * @param height the height of the level
+ * @param out the texels of the level, RGBA
+ */
+NS_API void bc_decompress(TextureFormat format, u8 const *blocks, u32 width,
+                          u32 height, u8 *out);
+
+} // namespace ns
+
+#endif // BLOCK_COMPRESSION_HEADER_INCLUDED
@@ -0,0 +1,295 @@
+#include "./image_decoder.h"
+
+#include "../core/logger.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
+#include "../core/string.h"
+#include "../systems/resource_system.h"
+#include "./loaders/image_loader.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace ns {
+
+enum class DecodeStatus : u8 { FREE, QUEUED, DECODING, CANCELLED, DECODED };
+
+struct image_decode_job {
+  u32 id;
+  DecodeStatus status;
+  bool succeeded;
+  // Decoded by a worker: the pixels of image_loader_decode, until polled
+  ImageResourceData image;
+  // From the resource cache, or decoded and polled: the image resource
+  // (loader_id is INVALID_ID before)
+  Resource resource;
+  char name[Texture::NAME_MAX_LENGTH];
+};
+
+// FIFO of job indices
+struct image_decode_ring {
+  u32 *indices;
+  u32 head;
+  u32 count;
+};
+
+// Everything but the worker threads is guarded by mutex.
+struct image_decoder_state {
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool quit;
+  u32 worker_count;
+  u32 capacity;
+  std::thread *workers;
+  image_decode_job *jobs;
+  image_decode_ring pending;
+  image_decode_ring decoded;
+  // stack of the free jobs
+  u32 *free_jobs;
+  u32 free_count;
+};
+
+static void ring_push(image_decode_ring *ring, u32 capacity, u32 index) {
+  ring->indices[(ring->head + ring->count) % capacity] = index;
+  ring->count++;
+}
+
+static u32 ring_pop(image_decode_ring *ring, u32 capacity) {
+  u32 index = ring->indices[ring->head];
+  ring->head = (ring->head + 1) % capacity;
+  ring->count--;
+  return index;
+}
+
+static void ring_remove(image_decode_ring *ring, u32 capacity, u32 index) {
+  u32 kept = 0;
+  for (u32 i = 0; i < ring->count; i++) {
+    u32 value = ring->indices[(ring->head + i) % capacity];
+    if (value != index) {
+      ring->indices[(ring->head + kept) % capacity] = value;
+      kept++;
+    }
+  }
+  ring->count = kept;
+}
+
+// Frees the image of a job that was not polled
+static void image_decode_job_free(image_decode_job *job) {
+  if (job->resource.loader_id != INVALID_ID) {
+    resource_system_unload(&job->resource);
+  } else if (job->succeeded) {
+    image_loader_free_pixels(&job->image);
+  }
+}
+
+// Caches the image a worker decoded. Returns false if it can't be.
+static bool image_decode_job_adopt(image_decode_job *job) {
+  auto data = reinterpret_cast<ImageResourceData *>(
+      ns::alloc(sizeof(ImageResourceData), MemTag::TEXTURE));
+  *data = job->image;
+  if (!resource_system_adopt(job->name, ResourceType::IMAGE, data,
+                             sizeof(ImageResourceData), &job->resource)) {
+    ns::free(data, sizeof(ImageResourceData), MemTag::TEXTURE);
+    image_loader_free_pixels(&job->image);
+    return false;
+  }
+  return true;
+}
+
+static void image_decoder_worker(image_decoder_state *state) {
+  std::unique_lock<std::mutex> lock(state->mutex);
+  while (true) {
+    state->wake.wait(
+        lock, [state] { return state->quit || state->pending.count > 0; });
+    if (state->quit) {
+      return;
+    }
+    u32 index = ring_pop(&state->pending, state->capacity);
+    image_decode_job *job = &state->jobs[index];
+    job->status = DecodeStatus::DECODING;
+
+    // The name is not modified while the job is being decoded
+    lock.unlock();
+    ImageResourceData image{};
+    bool succeeded;
+    {
+      NS_PROFILE_SCOPE("image_decode");
+      // The workers decode side by side: a single thread per image
+      succeeded = image_loader_decode(job->name, &image, 1);
+    }
+    lock.lock();
+
+    if (job->status == DecodeStatus::CANCELLED) {
+      if (succeeded) {
+        image_loader_free_pixels(&image);
+      }
+      job->status = DecodeStatus::FREE;
+      state->free_jobs[state->free_count++] = index;
+      continue;
+    }
+    job->succeeded = succeeded;
+    job->image = image;
+    job->status = DecodeStatus::DECODED;
+    ring_push(&state->decoded, state->capacity, index);
+  }
+}
+
+void image_decoder_create(u32 worker_count, u32 capacity,
+                          usize *memory_requirement, void *memory,
+                          image_decoder *out_decoder) {
+  if (worker_count == 0) {
+    worker_count = 1;
+  }
+  usize workers_size = sizeof(std::thread) * worker_count;
+  usize jobs_size = sizeof(image_decode_job) * capacity;
+  usize indices_size = sizeof(u32) * capacity;
+  *memory_requirement = sizeof(image_decoder_state) + workers_size +
+                        jobs_size + indices_size * 3;
+  if (memory == nullptr) {
+    return;
+  }
+
+  out_decoder->memory = memory;
+  image_decoder_state *state = new (memory) image_decoder_state();
+  state->quit = false;
+  state->worker_count = worker_count;
+  state->capacity = capacity;
+
+  u8 *block = AS_BYTES(state + 1);
+  state->workers = reinterpret_cast<std::thread *>(block);
+  block += workers_size;
+  state->jobs = reinterpret_cast<image_decode_job *>(block);
+  block += jobs_size;
+  state->pending = {reinterpret_cast<u32 *>(block), 0, 0};
+  block += indices_size;
+  state->decoded = {reinterpret_cast<u32 *>(block), 0, 0};
+  block += indices_size;
+  state->free_jobs = reinterpret_cast<u32 *>(block);
+
+  mem_zero(state->jobs, jobs_size);
+  state->free_count = capacity;
+  for (u32 i = 0; i < capacity; i++) {
+    // Popped from the end: the first jobs are used first
+    state->free_jobs[i] = capacity - 1 - i;
+  }
+
+  for (u32 i = 0; i < worker_count; i++) {
+    new (&state->workers[i]) std::thread(image_decoder_worker, state);
+  }
+}
+
+void image_decoder_destroy(image_decoder *decoder) {
+  if (!decoder || !decoder->memory) {
+    return;
+  }
+  image_decoder_state *state =
+      reinterpret_cast<image_decoder_state *>(decoder->memory);
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->quit = true;
+  }
+  state->wake.notify_all();
+  for (u32 i = 0; i < state->worker_count; i++) {
+    state->workers[i].join();
+    state->workers[i].~thread();
+  }
+
+  for (u32 i = 0; i < state->capacity; i++) {
+    image_decode_job *job = &state->jobs[i];
+    if (job->status == DecodeStatus::DECODED) {
+      image_decode_job_free(job);
+    }
+  }
+  state->~image_decoder_state();
+  decoder->memory = nullptr;
+}
+
+bool image_decoder_submit(image_decoder decoder, u32 id, cstr name) {
+  image_decoder_state *state =
+      reinterpret_cast<image_decoder_state *>(decoder.memory);
+  Resource cached;
+  bool hit = resource_system_load_cached(name, ResourceType::IMAGE, &cached);
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->free_count == 0) {
+      if (hit) {
+        resource_system_unload(&cached);
+      }
+      return false;
+    }
+    u32 index = state->free_jobs[--state->free_count];
+    image_decode_job *job = &state->jobs[index];
+    job->id = id;
+    job->succeeded = hit;
+    job->resource.loader_id = INVALID_ID;
+    string_ncpy(job->name, name, Texture::NAME_MAX_LENGTH);
+    if (hit) {
+      job->resource = cached;
+      job->image = *reinterpret_cast<ImageResourceData *>(cached.data);
+      job->status = DecodeStatus::DECODED;
+      ring_push(&state->decoded, state->capacity, index);
+      return true;
+    }
+    job->status = DecodeStatus::QUEUED;
+    ring_push(&state->pending, state->capacity, index);
+  }
+  state->wake.notify_one();
+  return true;
+}
+
+void image_decoder_cancel(image_decoder decoder, u32 id) {
+  image_decoder_state *state =
+      reinterpret_cast<image_decoder_state *>(decoder.memory);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  for (u32 i = 0; i < state->capacity; i++) {
+    image_decode_job *job = &state->jobs[i];
+    if (job->id != id) {
+      continue;
+    }
+    switch (job->status) {
+    case DecodeStatus::QUEUED:
+      ring_remove(&state->pending, state->capacity, i);
+      break;
+    case DecodeStatus::DECODED:
+      ring_remove(&state->decoded, state->capacity, i);
+      image_decode_job_free(job);
+      break;
+    case DecodeStatus::DECODING:
+      // The worker frees the job when it is done
+      job->status = DecodeStatus::CANCELLED;
+      continue;
+    case DecodeStatus::FREE:
+    case DecodeStatus::CANCELLED:
+      continue;
+    }
+    job->status = DecodeStatus::FREE;
+    state->free_jobs[state->free_count++] = i;
+  }
+}
+
+u32 image_decoder_poll(image_decoder decoder, image_decode_result *out,
+                       u32 max_count) {
+  image_decoder_state *state =
+      reinterpret_cast<image_decoder_state *>(decoder.memory);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  u32 count = 0;
+  while (count < max_count && state->decoded.count > 0) {
+    u32 index = ring_pop(&state->decoded, state->capacity);
+    image_decode_job *job = &state->jobs[index];
+    if (job->succeeded && job->resource.loader_id == INVALID_ID) {
+      job->succeeded = image_decode_job_adopt(job);
+    }
+    out[count].id = job->id;
+    out[count].succeeded = job->succeeded;
+    out[count].resource = job->resource;
+    out[count].image = job->image;
+    count++;
+    job->status = DecodeStatus::FREE;
+    state->free_jobs[state->free_count++] = index;
+  }
+  return count;
+}
+
+} // namespace ns
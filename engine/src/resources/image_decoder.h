@@ -0,0 +1,80 @@
+#ifndef IMAGE_DECODER_HEADER_INCLUDED
+#define IMAGE_DECODER_HEADER_INCLUDED
+
+#include "./resource_types.h"
+
+// Worker threads decoding images (image_loader_decode), so that loading a
+// texture does not stall the frame: the main thread submits names and polls
+// the decoded images, then uploads them.
+//
+// The images go through the resource cache (see resource_cache.h), as those
+// of resource_system_load: a cached image is not decoded again (a texture
+// swapped back), and the decoded ones are cached when polled. The decoder is
+// used from the main thread only, as the cache.
+
+namespace ns {
+
+struct image_decoder {
+  void *memory;
+};
+
+struct image_decode_result {
+  // id given to image_decoder_submit
+  u32 id;
+  bool succeeded;
+  // The image resource, unloaded with resource_system_unload (nothing to
+  // unload when the image was not decoded)
+  Resource resource;
+  // Its data
+  ImageResourceData image;
+};
+
+/**
+ * Creates a decoder. Call once with memory = nullptr to get the memory
+ * requirement, then with a block of that size.
+ * @param worker_count the number of worker threads (at least 1)
+ * @param capacity the maximum number of images submitted and not polled yet
+ * @param memory_requirement the size of the memory block
+ * @param memory the memory block
+ * @param out_decoder the decoder
+ */
+NS_API void image_decoder_create(u32 worker_count, u32 capacity,
+                                 usize *memory_requirement, void *memory,
+                                 image_decoder *out_decoder);
+
+/**
+ * Stops the workers (the images being decoded are finished, the others are
+ * dropped) and frees the decoded images that were not polled
+ */
+NS_API void image_decoder_destroy(image_decoder *decoder);
+
+/**
+ * Queues the decoding of an image, or takes it from the resource cache: it is
+ * then returned by the next image_decoder_poll
+ * @param decoder the decoder
+ * @param id the id of the request, unique among the pending requests
+ * @param name the name of the image (see image_loader_decode)
+ * @returns false when the decoder is full
+ */
+NS_API bool image_decoder_submit(image_decoder decoder, u32 id, cstr name);
+
+/**
+ * Cancels a request: its image will not be returned by image_decoder_poll.
+ * Does nothing when there is no pending request with this id.
+ */
+NS_API void image_decoder_cancel(image_decoder decoder, u32 id);
+
+/**
+ * Takes the decoded images, in the order they finished decoding. Never
+ * waits for the workers.
+ * @param decoder the decoder
+ * @param out the results
+ * @param max_count the maximum number of results
+ * @returns the number of results
+ */
+NS_API u32 image_decoder_poll(image_decoder decoder, image_decode_result *out,
+                              u32 max_count);
+
+} // namespace ns
+
+#endif // IMAGE_DECODER_HEADER_INCLUDED
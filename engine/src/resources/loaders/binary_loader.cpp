@@ -17,42 +17,21 @@ bool binary_loader_load(resource_loader *self, cstr name,
     return false;
   }
 
-  cstr format_str = "%s/%s/%s%s";
-  char full_file_path[512];
+  pstr full_file_path = out_resource->full_path;
+  resource_file_path(self->type_path, name, "", full_file_path);
 
-  string_fmt(full_file_path, sizeof(full_file_path), format_str,
-             resource_system_base_path(), self->type_path, name, "");
-
-  fs::File f;
-  if (!fs::open(full_file_path, fs::Mode::READ, true, &f)) {
-    NS_ERROR("binary_loader_load - Failed to open binary file '%s'",
-             full_file_path);
-    return false;
-  }
-
-  out_resource->full_path = string_dup(full_file_path);
-
-  usize file_size = 0;
-  if (!fs::fsize(&f, &file_size)) {
-    NS_ERROR("binary_loader_load - Failed to get size of binary file '%s'",
-             full_file_path);
-    return false;
+  pack const *assets = resource_system_pack();
+  if (assets) {
+    out_resource->name = name;
+    return resource_load_packed(assets, out_resource, MemTag::ARRAY);
   }
 
-  bytes resource_data =
-      reinterpret_cast<bytes>(ns::alloc(file_size, MemTag::ARRAY));
-  usize read_size = 0;
-  if (!fs::read_all_bytes(&f, resource_data, &read_size)) {
-    NS_ERROR("binary_loader_load - Failed to read binary file '%s'",
+  // Copied as a whole (the SPIR-V to vkCreateShaderModule): read ahead now
+  if (!resource_load_mapped(out_resource, fs::MapHint::WILL_NEED)) {
+    NS_ERROR("binary_loader_load - Failed to map binary file '%s'",
              full_file_path);
-    fs::close(&f);
     return false;
   }
-
-  fs::close(&f);
-
-  out_resource->data = resource_data;
-  out_resource->data_size = file_size;
   out_resource->name = name;
 
   return true;
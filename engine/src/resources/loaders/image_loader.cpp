@@ -3,8 +3,12 @@
 #include "../../core/logger.h"
 #include "../../core/memory.h"
 #include "../../core/string.h"
+#include "../../platform/platform.h"
 #include "../../systems/resource_system.h"
+#include "../block_compression.h"
+#include "../mipmap.h"
 #include "../resource_types.h"
+#include "../texture_cache.h"
 #include "./loader_utils.h"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -12,27 +16,170 @@
 
 namespace ns {
 
-bool image_loader_load(resource_loader *self, cstr name,
-                       Resource *out_resource) {
-  if (!self || !name || !out_resource) {
-    return false;
+#define IMAGE_LOADER_TYPE_PATH "textures"
+#define IMAGE_LOADER_EXTENSION ".png"
+// Normal maps hold vectors, not sRGB colors. They are not compressed: BC1
+// would quantize the vectors too much, it takes BC5 and the shaders
+// rebuilding z.
+#define IMAGE_LOADER_NORMAL_MAP_SUFFIX "_Nrm.png"
+
+// The texture cache keeps the levels: a new filter needs a new
+// TEXTURE_CACHE_VERSION
+static const MipFilter IMAGE_LOADER_MIP_FILTER = MipFilter::KAISER;
+
+static bool image_is_normal_map(cstr full_file_path) {
+  usize length = string_length(full_file_path);
+  usize suffix_length = string_length(IMAGE_LOADER_NORMAL_MAP_SUFFIX);
+  return length >= suffix_length &&
+         string_eq(full_file_path + length - suffix_length,
+                   IMAGE_LOADER_NORMAL_MAP_SUFFIX);
+}
+
+static bool image_is_opaque(u8 const *rgba, u32 width, u32 height) {
+  for (usize i = 3; i < static_cast<usize>(width) * height * 4; i += 4) {
+    if (rgba[i] < 255) {
+      return false;
+    }
   }
+  return true;
+}
 
-  cstr format_str = "%s/%s/%s%s";
-  const i32 required_channel_count = 4;
-  stbi_set_flip_vertically_on_load(true);
-  char full_file_path[512];
+// Replaces the RGBA levels by BC1 (opaque) or BC3 blocks
+static void image_compress(ImageResourceData *image, u32 thread_count) {
+  TextureFormat format = image_is_opaque(image->pixels, image->width,
+                                         image->height)
+                             ? TextureFormat::BC1
+                             : TextureFormat::BC3;
+  u8 *blocks = reinterpret_cast<u8 *>(platform::allocate_memory(
+      texture_format_chain_size(format, image->width, image->height,
+                                image->mip_count),
+      false));
+  u8 const *level = image->pixels;
+  u8 *out = blocks;
+  for (u32 i = 0; i < image->mip_count; i++) {
+    u32 width = image->width >> i > 0 ? image->width >> i : 1;
+    u32 height = image->height >> i > 0 ? image->height >> i : 1;
+    bc_compress(format, level, width, height, out, thread_count);
+    level += texture_format_level_size(TextureFormat::RGBA8, width, height);
+    out += texture_format_level_size(format, width, height);
+  }
+  platform::free_memory(image->pixels, false);
+  image->pixels = blocks;
+  image->format = format;
+}
 
-  string_fmt(full_file_path, sizeof(full_file_path), format_str,
-             resource_system_base_path(), self->type_path, name, ".png");
+// Decompresses the block levels of an image to RGBA, for a device without
+// BC support
+static void image_decompress(ImageResourceData *image) {
+  u8 *rgba = reinterpret_cast<u8 *>(platform::allocate_memory(
+      mip_chain_size(image->width, image->height, image->mip_count), false));
+  u8 const *level = image->pixels;
+  u8 *out = rgba;
+  for (u32 i = 0; i < image->mip_count; i++) {
+    u32 width = image->width >> i > 0 ? image->width >> i : 1;
+    u32 height = image->height >> i > 0 ? image->height >> i : 1;
+    bc_decompress(image->format, level, width, height, out);
+    level += texture_format_level_size(image->format, width, height);
+    out += texture_format_level_size(TextureFormat::RGBA8, width, height);
+  }
+  image->pixels = rgba;
+  image->format = TextureFormat::RGBA8;
+}
 
-  i32 width;
-  i32 height;
-  i32 channel_count;
+// Views an entry of the asset pack: in place when it is stored uncompressed,
+// else in a copy (*out_copy) to free with platform::free_memory. Can run on
+// the decoder threads, so not with the engine allocator.
+static bool image_view_packed(pack const *assets, pack_entry const *entry,
+                              Slice<u8> *out_view, u8 **out_copy) {
+  *out_copy = nullptr;
+  if (pack_view(assets, entry, out_view)) {
+    return true;
+  }
+  u8 *copy =
+      reinterpret_cast<u8 *>(platform::allocate_memory(entry->size, false));
+  if (!pack_read(assets, entry, copy)) {
+    platform::free_memory(copy, false);
+    return false;
+  }
+  *out_view = Slice<u8>::from_parts(copy, entry->size);
+  *out_copy = copy;
+  return true;
+}
+
+// The image cooked by nspak (see image_cook), or nullptr if the asset pack
+// holds the PNG file instead (packed by pack_write without cooking)
+static pack_entry const *image_find_cooked(pack const *assets,
+                                           cstr full_file_path) {
+  char cooked_path[Resource::PATH_MAX_LENGTH];
+  usize length = string_length(full_file_path) -
+                 string_length(IMAGE_LOADER_EXTENSION);
+  string_fmt(cooked_path, Resource::PATH_MAX_LENGTH, "%.*s%s",
+             static_cast<i32>(length), full_file_path,
+             TEXTURE_CACHE_EXTENSION);
+  return pack_find(assets, cooked_path);
+}
+
+// Loads a cooked image: its levels are copied from the asset pack, or
+// decompressed for a device without BC support, but neither generated nor
+// compressed again
+static bool image_load_cooked(pack const *assets, pack_entry const *entry,
+                              cstr full_file_path, bool compress,
+                              ImageResourceData *out) {
+  Slice<u8> view = Slice<u8>::from_parts(nullptr, 0);
+  u8 *copy = nullptr;
+  if (!image_view_packed(assets, entry, &view, &copy)) {
+    return false;
+  }
+  bool valid = texture_cache_view(view.begin(), view.len(), 0, out);
+  if (!valid) {
+    NS_ERROR("image_loader_load - Cooked image of '%s' is corrupted",
+             full_file_path);
+  } else if (compress || out->format == TextureFormat::RGBA8) {
+    u64 size = texture_format_chain_size(out->format, out->width,
+                                         out->height, out->mip_count);
+    u8 *pixels =
+        reinterpret_cast<u8 *>(platform::allocate_memory(size, false));
+    mem_copy(pixels, out->pixels, size);
+    out->pixels = pixels;
+  } else {
+    image_decompress(out);
+  }
+  if (copy) {
+    platform::free_memory(copy, false);
+  }
+  return valid;
+}
 
-  u8 *data = stbi_load(full_file_path, &width, &height, &channel_count,
-                       required_channel_count);
+// Decodes the PNG file from the asset pack. Returns false (logged) if the
+// file is missing or corrupted.
+static bool image_decode_packed(pack const *assets, cstr full_file_path,
+                                i32 *width, i32 *height, i32 *channel_count,
+                                i32 required_channel_count, u8 **out_data) {
+  pack_entry const *entry = pack_find(assets, full_file_path);
+  if (!entry) {
+    NS_ERROR("image_loader_load - Image '%s' is not in the asset pack",
+             full_file_path);
+    return false;
+  }
+  Slice<u8> view = Slice<u8>::from_parts(nullptr, 0);
+  u8 *copy = nullptr;
+  if (!image_view_packed(assets, entry, &view, &copy)) {
+    return false;
+  }
+  *out_data = stbi_load_from_memory(view.begin(),
+                                    static_cast<i32>(view.len()), width, height,
+                                    channel_count, required_channel_count);
+  if (copy) {
+    platform::free_memory(copy, false);
+  }
+  return true;
+}
 
+// Checks the pixels stb_image decoded, then generates their mip chain (in the
+// same malloc block) and compresses them if asked to
+static bool image_build(cstr full_file_path, u8 *data, i32 width, i32 height,
+                        i32 channel_count, bool compress, u32 thread_count,
+                        ImageResourceData *out) {
   cstr fail_reason = stbi_failure_reason();
   if (fail_reason) {
     NS_ERROR("image_loader_load - Failed to load image '%s': %s",
@@ -50,14 +197,107 @@ bool image_loader_load(resource_loader *self, cstr name,
     return false;
   }
 
-  out_resource->full_path = string_dup(full_file_path);
+  // The other levels after level 0, in the same malloc block
+  u32 levels = mip_count(width, height);
+  data = reinterpret_cast<u8 *>(platform::reallocate_memory(
+      data, mip_chain_size(width, height, levels), false));
+  mip_config mips = {IMAGE_LOADER_MIP_FILTER,
+                     !image_is_normal_map(full_file_path), thread_count};
+  mip_generate(data, width, height, levels, &mips);
+
+  out->width = width;
+  out->height = height;
+  out->channel_count = channel_count;
+  out->format = TextureFormat::RGBA8;
+  out->mip_count = levels;
+  out->pixels = data;
+  out->cached = {};
+  if (compress) {
+    image_compress(out, thread_count);
+  }
+  return true;
+}
+
+// Maps the image from the texture cache, loads it cooked from the asset pack,
+// or decodes it with stb_image, which allocates with malloc, generates its
+// mip chain, compresses it if the resource system is configured so, and
+// caches it. The flip flag and the failure reason are thread-local
+// (STBI_THREAD_LOCAL).
+static bool image_decode_file(cstr full_file_path, ImageResourceData *out,
+                              u32 thread_count) {
+  const i32 required_channel_count = 4;
+  stbi_set_flip_vertically_on_load_thread(true);
+
+  i32 width;
+  i32 height;
+  i32 channel_count;
+
+  u8 *data = nullptr;
+  pack const *assets = resource_system_pack();
+  texture_cache cache = resource_system_texture_cache();
+  bool compress = resource_system_compress_textures() &&
+                  !image_is_normal_map(full_file_path);
+  if (cache.memory && texture_cache_find(cache, full_file_path, out)) {
+    if ((out->format != TextureFormat::RGBA8) == compress) {
+      return true;
+    }
+    // Cached with the other setting: replaced
+    image_loader_free_pixels(out);
+  }
+  if (assets) {
+    pack_entry const *cooked = image_find_cooked(assets, full_file_path);
+    if (cooked) {
+      return image_load_cooked(assets, cooked, full_file_path, compress, out);
+    }
+    if (!image_decode_packed(assets, full_file_path, &width, &height,
+                             &channel_count, required_channel_count, &data)) {
+      return false;
+    }
+  } else {
+    data = stbi_load(full_file_path, &width, &height, &channel_count,
+                     required_channel_count);
+  }
+
+  if (!image_build(full_file_path, data, width, height, channel_count,
+                   compress, thread_count, out)) {
+    return false;
+  }
+  if (cache.memory) {
+    texture_cache_store(cache, full_file_path, out);
+  }
+  return true;
+}
+
+bool image_cook(cstr full_file_path, u8 const *data, usize size,
+                ImageResourceData *out) {
+  i32 width;
+  i32 height;
+  i32 channel_count;
+  stbi_set_flip_vertically_on_load_thread(true);
+  u8 *pixels = stbi_load_from_memory(data, static_cast<i32>(size), &width,
+                                     &height, &channel_count, 4);
+  return image_build(full_file_path, pixels, width, height, channel_count,
+                     !image_is_normal_map(full_file_path), 0, out);
+}
+
+bool image_loader_load(resource_loader *self, cstr name,
+                       Resource *out_resource) {
+  if (!self || !name || !out_resource) {
+    return false;
+  }
+
+  pstr full_file_path = out_resource->full_path;
+  resource_file_path(self->type_path, name, IMAGE_LOADER_EXTENSION,
+                     full_file_path);
+
+  ImageResourceData image;
+  if (!image_decode_file(full_file_path, &image, 0)) {
+    return false;
+  }
 
   ImageResourceData *resource_data = reinterpret_cast<ImageResourceData *>(
       ns::alloc(sizeof(ImageResourceData), MemTag::TEXTURE));
-  resource_data->width = width;
-  resource_data->height = height;
-  resource_data->channel_count = channel_count;
-  resource_data->pixels = data;
+  *resource_data = image;
 
   out_resource->data = resource_data;
   out_resource->data_size = sizeof(ImageResourceData);
@@ -66,21 +306,34 @@ bool image_loader_load(resource_loader *self, cstr name,
   return true;
 }
 
+bool image_loader_decode(cstr name, ImageResourceData *out,
+                         u32 thread_count) {
+  char full_file_path[Resource::PATH_MAX_LENGTH];
+  resource_file_path(IMAGE_LOADER_TYPE_PATH, name, IMAGE_LOADER_EXTENSION,
+                     full_file_path);
+  return image_decode_file(full_file_path, out, thread_count);
+}
+
+void image_loader_free_pixels(ImageResourceData *image) {
+  if (image->cached.data) {
+    fs::unmap(&image->cached);
+  } else {
+    platform::free_memory(image->pixels, false);
+  }
+  image->pixels = nullptr;
+}
+
 void image_loader_unload(resource_loader *self, Resource *resource) {
   if (!self || !resource) {
     NS_WARN("image_loader_unload - Loader or resource is null");
     return;
   }
 
-  i32 path_length = string_length(resource->full_path);
-  if (path_length) {
-    ns::free(resource->full_path, sizeof(char) * path_length + 1,
-             MemTag::STRING);
-  }
+  resource->full_path[0] = '\0';
 
   if (resource->data) {
-    stbi_image_free(
-        reinterpret_cast<ImageResourceData *>(resource->data)->pixels);
+    image_loader_free_pixels(
+        reinterpret_cast<ImageResourceData *>(resource->data));
     ns::free(resource->data, resource->data_size, MemTag::TEXTURE);
     resource->data = nullptr;
     resource->data_size = 0;
@@ -91,7 +344,7 @@ void image_loader_unload(resource_loader *self, Resource *resource) {
 resource_loader image_resource_loader_create() {
   resource_loader loader;
   loader.type = ResourceType::IMAGE;
-  loader.type_path = "textures";
+  loader.type_path = IMAGE_LOADER_TYPE_PATH;
   loader.custom_type = nullptr;
   loader.load = image_loader_load;
   loader.unload = image_loader_unload;
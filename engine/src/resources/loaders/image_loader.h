@@ -7,6 +7,41 @@ namespace ns {
 
 resource_loader image_resource_loader_create();
 
+/**
+ * Decodes an image as the image loader does (RGBA or block compressed,
+ * flipped vertically, with its mip chain, from the texture cache when
+ * possible), but without the engine allocator, which is not thread-safe: this
+ * can be called from any thread.
+ * @param name the name of the image, in the textures directory
+ * @param out the image. Its pixels are freed with image_loader_free_pixels.
+ * @param thread_count the threads generating the mips and compressing, 0 for
+ *        one per core. 1 from the image decoder, whose workers already run
+ *        side by side.
+ * @returns whether the image was decoded
+ */
+NS_API bool image_loader_decode(cstr name, ImageResourceData *out,
+                                u32 thread_count = 0);
+
+/**
+ * Cooks an image for an asset pack, as the image loader decodes it with
+ * compress_textures. nspak packs "textures/x.png" as "textures/x.nstc", a
+ * texture cache file (see texture_cache.h) of source key 0, which the loader
+ * reads instead of decoding the PNG file again.
+ * @param full_file_path the path of the image, e.g. "textures/x.png"
+ * @param data the PNG file
+ * @param size its size
+ * @param out the image. Its pixels are freed with image_loader_free_pixels.
+ * @returns false (logged) if the file can't be decoded
+ */
+NS_API bool image_cook(cstr full_file_path, u8 const *data, usize size,
+                       ImageResourceData *out);
+
+/**
+ * Frees the pixels of an image of image_loader_decode or image_cook, or
+ * unmaps them when they come from the texture cache
+ */
+NS_API void image_loader_free_pixels(ImageResourceData *image);
+
 } // namespace ns
 
 #endif // IMAGE_LOADER_HEADER_INCLUDED
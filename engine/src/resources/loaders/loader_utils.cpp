@@ -1,23 +1,123 @@
 #include "./loader_utils.h"
 
+#include "../../core/logger.h"
+#include "../../core/string.h"
+#include "../../systems/resource_system.h"
+
+#include <atomic>
+
 namespace ns {
 
+// Suffix of the temporary files of resource_write_file
+static std::atomic<u32> resource_next_temp_id{0};
+
+static u64 resource_mix(u64 hash, u64 value) {
+  // FNV-1a, continuing pack_hash
+  for (u32 i = 0; i < 8; i++) {
+    hash ^= (value >> (i * 8)) & 0xFF;
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
 void resource_unload(resource_loader *self, Resource *resource, MemTag tag) {
   if (!self || !resource) {
     NS_WARN("resource_unload - Loader or resource is null");
     return;
   }
-  u32 path_len = string_length(resource->full_path);
-  if (path_len) {
-    ns::free(resource->full_path, sizeof(char) * path_len + 1, MemTag::STRING);
-  }
+  resource->full_path[0] = '\0';
 
   if (resource->data) {
-    ns::free(resource->data, resource->data_size, tag);
+    if (resource->mapped.data) {
+      fs::unmap(&resource->mapped);
+    } else if (!resource->data_is_view) {
+      ns::free(resource->data, resource->data_size, tag);
+    }
     resource->data = nullptr;
     resource->data_size = 0;
     resource->loader_id = INVALID_ID;
   }
 }
 
+void resource_file_path(cstr type_path, cstr name, cstr extension,
+                        pstr out_path) {
+  if (resource_system_pack()) {
+    if (string_length(type_path) > 0) {
+      string_fmt(out_path, Resource::PATH_MAX_LENGTH, "%s/%s%s", type_path,
+                 name, extension);
+    } else {
+      string_fmt(out_path, Resource::PATH_MAX_LENGTH, "%s%s", name, extension);
+    }
+    return;
+  }
+  string_fmt(out_path, Resource::PATH_MAX_LENGTH, "%s/%s/%s%s",
+             resource_system_base_path(), type_path, name, extension);
+}
+
+bool resource_load_packed(pack const *assets, Resource *out_resource,
+                          MemTag tag) {
+  pack_entry const *entry = pack_find(assets, out_resource->full_path);
+  if (!entry) {
+    NS_ERROR("resource_load_packed - '%s' is not in the asset pack",
+             out_resource->full_path);
+    return false;
+  }
+  Slice<u8> view = Slice<u8>::from_parts(nullptr, 0);
+  if (pack_view(assets, entry, &view)) {
+    out_resource->data = const_cast<u8 *>(view.begin());
+    out_resource->data_size = view.len();
+    out_resource->data_is_view = true;
+    return true;
+  }
+  u8 *copy = reinterpret_cast<u8 *>(ns::alloc(entry->size, tag));
+  if (!pack_read(assets, entry, copy)) {
+    ns::free(copy, entry->size, tag);
+    return false;
+  }
+  out_resource->data = copy;
+  out_resource->data_size = entry->size;
+  out_resource->data_is_view = false;
+  return true;
+}
+
+bool resource_load_mapped(Resource *out_resource, fs::MapHint hint) {
+  if (!fs::map(out_resource->full_path, &out_resource->mapped, hint)) {
+    return false;
+  }
+  // Empty files have no data
+  out_resource->data = const_cast<u8 *>(out_resource->mapped.data);
+  out_resource->data_size = out_resource->mapped.size;
+  return true;
+}
+
+u64 resource_source_key(cstr source_path, fs::FileStat const &source) {
+  return resource_mix(resource_mix(pack_hash(source_path), source.size),
+                      static_cast<u64>(source.modified_time));
+}
+
+bool resource_write_file(cstr path, resource_file_part const *parts,
+                         u32 part_count) {
+  char temp_path[Resource::PATH_MAX_LENGTH];
+  string_fmt(temp_path, Resource::PATH_MAX_LENGTH, "%s.%u.tmp", path,
+             resource_next_temp_id.fetch_add(1));
+  fs::File f;
+  usize written = 0;
+  bool ok = fs::open(temp_path, fs::Mode::WRITE, true, &f);
+  for (u32 i = 0; ok && i < part_count; i++) {
+    ok = fs::write(&f, parts[i].size, parts[i].data, &written);
+  }
+  fs::close(&f);
+  ok = ok && fs::rename(temp_path, path);
+  if (!ok) {
+    fs::remove(temp_path);
+  }
+  return ok;
+}
+
+bool resource_map_existing(cstr path, fs::MapHint hint,
+                           fs::MappedFile *out_file) {
+  fs::FileStat stat;
+  return fs::stat(path, &stat) && fs::map(path, out_file, hint);
+}
+
 } // namespace ns
@@ -1,6 +1,8 @@
 #ifndef LOADER_UTILS_HEADER_INCLUDED
 #define LOADER_UTILS_HEADER_INCLUDED
 
+#include "../../core/memory.h"
+#include "../pack.h"
 #include "../resource_types.h"
 
 namespace ns {
@@ -9,6 +11,80 @@ struct resource_loader;
 
 void resource_unload(resource_loader *self, Resource *resource, MemTag tag);
 
+/**
+ * Builds the path of the file of a resource: "<base>/<type_path>/<name><ext>"
+ * for the loose files, the name of its entry when the assets are packed
+ * @param type_path the directory of the resource type
+ * @param name the name of the resource
+ * @param extension the extension of the file
+ * @param out_path a buffer of Resource::PATH_MAX_LENGTH characters
+ */
+void resource_file_path(cstr type_path, cstr name, cstr extension,
+                        pstr out_path);
+
+/**
+ * Loads the file out_resource->full_path from the asset pack: the data is a
+ * view into the pack when the entry is stored uncompressed, a copy allocated
+ * with tag otherwise
+ * @param assets the asset pack
+ * @param out_resource the resource
+ * @param tag the tag of the copy
+ * @returns false if the pack has no such file
+ */
+bool resource_load_packed(pack const *assets, Resource *out_resource,
+                          MemTag tag);
+
+/**
+ * Maps the file out_resource->full_path: the data points into the mapping,
+ * read-only, unmapped by resource_unload
+ * @param out_resource the resource
+ * @param hint how the data will be read
+ * @returns false (logged) if the file can't be mapped
+ */
+bool resource_load_mapped(Resource *out_resource, fs::MapHint hint);
+
+/**
+ * Gets the key of a source file, stored in the header of the files derived
+ * from it (the texture cache, the cooked meshes and materials): a hash of its
+ * path, size and modification time. An edited source changes the key, so the
+ * derived file is known to be stale.
+ * @param source_path the path of the source file
+ * @param source its fs::stat
+ */
+NS_API u64 resource_source_key(cstr source_path,
+                               fs::FileStat const &source);
+
+/**
+ * A part of a file written by resource_write_file
+ */
+struct resource_file_part {
+  void const *data;
+  usize size;
+};
+
+/**
+ * Writes a derived file under a temporary name, then renames it, so that a
+ * concurrent load never maps a partial file. Thread-safe.
+ * @param path the path of the file, replaced
+ * @param parts the content of the file, one part after the other
+ * @param part_count the number of parts
+ * @returns false (not logged) if the file can't be written: nothing is left
+ *          behind
+ */
+bool resource_write_file(cstr path, resource_file_part const *parts,
+                         u32 part_count);
+
+/**
+ * Maps a derived file if it exists. fs::map logs the missing files, which
+ * are expected here: the existence is checked first.
+ * @param path the path of the file
+ * @param hint how the data will be read
+ * @param out_file the mapping
+ * @returns false if the file does not exist or can't be mapped
+ */
+bool resource_map_existing(cstr path, fs::MapHint hint,
+                           fs::MappedFile *out_file);
+
 } // namespace ns
 
 #endif // LOADER_UTILS_HEADER_INCLUDED
@@ -3,6 +3,7 @@
 #include "../../core/logger.h"
 #include "../../core/memory.h"
 #include "../../core/string.h"
+#include "../../core/string/str.h"
 #include "../../math/math.h"
 #include "../../systems/resource_system.h"
 #include "../resource_types.h"
@@ -12,91 +13,284 @@
 
 namespace ns {
 
-bool material_loader_load(resource_loader *self, cstr name,
-                          Resource *out_resource) {
-  if (!self || !name || !out_resource) {
-    return false;
+#define MATERIAL_LINE_MAX_LENGTH 512
+
+static void material_parse_line(MaterialConfig *resource_data, pstr p,
+                                cstr full_file_path, u32 linenum) {
+  pstr line = string_trim(p);
+  usize linelen = string_length(line);
+
+  if (linelen < 1 || line[0] == '#') {
+    return;
   }
 
-  cstr format_str = "%s/%s/%s%s";
-  char full_file_path[512];
+  Str line_view = Str(Slice<char>::from_parts(line, linelen));
+  isize equal_index = line_view.indexof('=');
+  if (equal_index == -1) {
+    NS_WARN("Potential formatting issue found in '%s:%d': '=' not found.",
+            full_file_path, linenum);
+    return;
+  }
 
-  string_fmt(full_file_path, sizeof(full_file_path), format_str,
-             resource_system_base_path(), self->type_path, name, ".nsmt");
+  // Views in the line buffer: no copies of the name and value.
+  Str var_name = Str(line_view.sub(0, static_cast<usize>(equal_index))).trim();
+  Str var_value = Str(line_view.sub(static_cast<usize>(equal_index) + 1)).trim();
+  // The value ends the line, so it can be terminated in place.
+  line[var_value.end() - line] = '\0';
+  cstr value = var_value.begin();
 
-  fs::File f;
-  if (!fs::open(full_file_path, fs::Mode::READ, false, &f)) {
-    NS_ERROR("material_loader_load - Failed to open material file '%s'",
-             full_file_path);
-    return false;
+  if (var_name.EQ("version")) {
+    // TODO(ClementChambard)
+  } else if (var_name.EQ("name")) {
+    string_ncpy(resource_data->name, value, Material::NAME_MAX_LENGTH);
+  } else if (var_name.EQ("diffuse_color")) {
+    if (!resource_data->diffuse_color.from(value)) {
+      NS_WARN("Error parsing diffuse_color in file '%s'. Using white instead.",
+              full_file_path);
+    }
+  } else if (var_name.EQ("diffuse_map_name")) {
+    string_ncpy(resource_data->diffuse_map_name, value,
+                Texture::NAME_MAX_LENGTH);
+  } else if (var_name.EQ("type")) {
+    if (var_value.EQ("ui")) {
+      resource_data->type = MaterialType::UI;
+    }
   }
+  // TODO(ClementChambard): more
+}
 
-  out_resource->full_path = string_dup(full_file_path);
+// Same lines as fs::read_line: the longer lines are split
+static void material_parse_text(MaterialConfig *resource_data, cstr text,
+                                usize size, cstr full_file_path) {
+  char linebuf[MATERIAL_LINE_MAX_LENGTH];
+  u32 linenum = 1;
+  usize i = 0;
+  while (i < size) {
+    usize length = 0;
+    while (i < size && length < MATERIAL_LINE_MAX_LENGTH - 2) {
+      char c = text[i++];
+      linebuf[length++] = c;
+      if (c == '\n') {
+        break;
+      }
+    }
+    linebuf[length] = '\0';
+    material_parse_line(resource_data, linebuf, full_file_path, linenum);
+    linenum++;
+  }
+}
 
-  MaterialConfig *resource_data = reinterpret_cast<MaterialConfig *>(
-      ns::alloc(sizeof(MaterialConfig), MemTag::MATERIAL_INSTANCE));
+static void material_config_defaults(MaterialConfig *config, cstr name) {
+  mem_zero(config, sizeof(MaterialConfig));
+  config->auto_release = true;
+  config->type = MaterialType::WORLD;
+  config->diffuse_color = vec4(1.0f);
+  string_ncpy(config->name, name, Material::NAME_MAX_LENGTH);
+}
 
-  resource_data->auto_release = true;
-  resource_data->diffuse_color = vec4(1.0f);
-  resource_data->diffuse_map_name[0] = '\0';
-  string_ncpy(resource_data->name, name, Material::NAME_MAX_LENGTH);
+static bool material_parse_packed(MaterialConfig *resource_data,
+                                  pack const *assets, cstr full_file_path) {
+  Resource file = {};
+  string_ncpy(file.full_path, full_file_path, Resource::PATH_MAX_LENGTH);
+  if (!resource_load_packed(assets, &file, MemTag::ARRAY)) {
+    return false;
+  }
+  material_parse_text(resource_data, reinterpret_cast<cstr>(file.data),
+                      file.data_size, full_file_path);
+  if (!file.data_is_view) {
+    ns::free(file.data, file.data_size, MemTag::ARRAY);
+  }
+  return true;
+}
 
-  char linebuf[512] = "";
-  pstr p = &linebuf[0];
-  usize linelen = 0;
-  u32 linenum = 1;
-  while (fs::read_line(&f, 511, &p, &linelen)) {
-    pstr line = string_trim(p);
-    linelen = string_length(line);
+static bool material_from_binary(material_binary const *binary,
+                                 MaterialConfig *out, cstr full_file_path) {
+  if (binary->magic != MATERIAL_BINARY_MAGIC) {
+    NS_ERROR("material_loader_load - '%s' is not a cooked material",
+             full_file_path);
+    return false;
+  }
+  if (binary->version != MATERIAL_BINARY_VERSION) {
+    NS_ERROR("material_loader_load - '%s' has version %u, expected %u. Cook "
+             "it again.",
+             full_file_path, binary->version, MATERIAL_BINARY_VERSION);
+    return false;
+  }
+  if (binary->type > static_cast<u32>(MaterialType::UI)) {
+    NS_ERROR("material_loader_load - '%s' has an invalid type",
+             full_file_path);
+    return false;
+  }
+  out->type = static_cast<MaterialType>(binary->type);
+  out->diffuse_color =
+      vec4(binary->diffuse_color[0], binary->diffuse_color[1],
+           binary->diffuse_color[2], binary->diffuse_color[3]);
+  // The cooker terminates the strings, a corrupted file might not
+  string_ncpy(out->name, binary->name, Material::NAME_MAX_LENGTH);
+  out->name[Material::NAME_MAX_LENGTH - 1] = '\0';
+  string_ncpy(out->diffuse_map_name, binary->diffuse_map_name,
+              Texture::NAME_MAX_LENGTH);
+  out->diffuse_map_name[Texture::NAME_MAX_LENGTH - 1] = '\0';
+  return true;
+}
 
-    if (linelen < 1 || line[0] == '#') {
-      linenum++;
-      continue;
+// Reads a cooked material with a single read. out_found is false when there
+// is no such file.
+static bool material_read_binary(pack const *assets, cstr full_file_path,
+                                 material_binary *out, bool *out_found) {
+  *out_found = false;
+  if (assets) {
+    pack_entry const *entry = pack_find(assets, full_file_path);
+    if (!entry) {
+      return false;
+    }
+    *out_found = true;
+    if (entry->size != sizeof(material_binary)) {
+      NS_ERROR("material_loader_load - '%s' has an invalid size",
+               full_file_path);
+      return false;
     }
+    if (!pack_read(assets, entry, AS_BYTES(out))) {
+      return false;
+    }
+  } else {
+    if (!fs::exists(full_file_path)) {
+      return false;
+    }
+    *out_found = true;
+    fs::File f;
+    if (!fs::open(full_file_path, fs::Mode::READ, true, &f)) {
+      return false;
+    }
+    usize read_size = 0;
+    bool read = fs::read(&f, sizeof(material_binary), out, &read_size);
+    fs::close(&f);
+    if (!read) {
+      NS_ERROR("material_loader_load - '%s' has an invalid size",
+               full_file_path);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool material_cook(cstr name, cstr text, usize size, material_binary *out) {
+  MaterialConfig config;
+  material_config_defaults(&config, name);
+  material_parse_text(&config, text, size, name);
 
-    isize equal_index = string_indexof(line, '=');
-    if (equal_index == -1) {
-      NS_WARN("Potential formatting issue found in '%s:%d': '=' not found.",
-              full_file_path, linenum);
-      linenum++;
-      continue;
+  mem_zero(out, sizeof(material_binary));
+  out->magic = MATERIAL_BINARY_MAGIC;
+  out->version = MATERIAL_BINARY_VERSION;
+  out->source_key = 0;
+  out->type = static_cast<u32>(config.type);
+  out->diffuse_color[0] = config.diffuse_color.x;
+  out->diffuse_color[1] = config.diffuse_color.y;
+  out->diffuse_color[2] = config.diffuse_color.z;
+  out->diffuse_color[3] = config.diffuse_color.w;
+  string_ncpy(out->name, config.name, Material::NAME_MAX_LENGTH);
+  out->name[Material::NAME_MAX_LENGTH - 1] = '\0';
+  string_ncpy(out->diffuse_map_name, config.diffuse_map_name,
+              Texture::NAME_MAX_LENGTH);
+  out->diffuse_map_name[Texture::NAME_MAX_LENGTH - 1] = '\0';
+  return true;
+}
+
+// Development: the .nsmb file is read while it matches the .nsmt file, which
+// is cooked into it again otherwise. The pack is not written: its .nsmt
+// files are parsed when it has no .nsmb file.
+static bool material_load_source(MaterialConfig *resource_data,
+                                 pack const *assets, cstr type_path,
+                                 cstr name, pstr full_file_path) {
+  material_binary binary;
+  bool found = false;
+  if (assets) {
+    if (material_read_binary(assets, full_file_path, &binary, &found)) {
+      return material_from_binary(&binary, resource_data, full_file_path);
+    }
+    if (found) {
+      return false;
     }
+    resource_file_path(type_path, name, MATERIAL_TEXT_EXTENSION,
+                       full_file_path);
+    return material_parse_packed(resource_data, assets, full_file_path);
+  }
 
-    char raw_var_name[64];
-    mem_zero(raw_var_name, sizeof(raw_var_name));
-    string_sub(raw_var_name, line, 0, equal_index);
-    pstr var_name = string_trim(raw_var_name);
-
-    char raw_var_value[446];
-    mem_zero(raw_var_value, sizeof(raw_var_value));
-    string_sub(raw_var_value, line, equal_index + 1, -1);
-    pstr var_value = string_trim(raw_var_value);
-
-    if (string_EQ(var_name, "version")) {
-      // TODO(ClementChambard)
-    } else if (string_EQ(var_name, "name")) {
-      string_ncpy(resource_data->name, var_value, Material::NAME_MAX_LENGTH);
-    } else if (string_EQ(var_name, "diffuse_color")) {
-      if (!resource_data->diffuse_color.from(var_value)) {
-        NS_WARN(
-            "Error parsing diffuse_color in file '%s'. Using white instead.",
-            full_file_path);
-      }
-    } else if (string_EQ(var_name, "diffuse_map_name")) {
-      string_ncpy(resource_data->diffuse_map_name, var_value,
-                  Texture::NAME_MAX_LENGTH);
-    } else if (string_EQ(var_name, "type")) {
-      if (string_EQ(var_value, "ui")) {
-        resource_data->type = MaterialType::UI;
-      }
+  char text_path[Resource::PATH_MAX_LENGTH];
+  resource_file_path(type_path, name, MATERIAL_TEXT_EXTENSION, text_path);
+  fs::FileStat source;
+  if (!fs::stat(text_path, &source)) {
+    // Cooked only
+    if (material_read_binary(nullptr, full_file_path, &binary, &found)) {
+      return material_from_binary(&binary, resource_data, full_file_path);
     }
-    // TODO(ClementChambard): more
+    if (!found) {
+      NS_ERROR("material_loader_load - Material '%s' not found (no '%s')",
+               name, text_path);
+    }
+    return false;
+  }
+  u64 source_key = resource_source_key(text_path, source);
+  fs::FileStat cooked;
+  if (fs::stat(full_file_path, &cooked) &&
+      cooked.size == sizeof(material_binary) &&
+      material_read_binary(nullptr, full_file_path, &binary, &found) &&
+      binary.magic == MATERIAL_BINARY_MAGIC &&
+      binary.version == MATERIAL_BINARY_VERSION &&
+      binary.source_key == source_key) {
+    return material_from_binary(&binary, resource_data, full_file_path);
+  }
 
-    mem_zero(linebuf, sizeof(linebuf));
-    linenum++;
+  fs::MappedFile text;
+  if (!fs::map(text_path, &text, fs::MapHint::SEQUENTIAL)) {
+    return false;
+  }
+  material_cook(name, reinterpret_cast<cstr>(text.data), text.size, &binary);
+  fs::unmap(&text);
+  binary.source_key = source_key;
+  // Not fatal: the material is cooked again next time
+  resource_file_part part = {&binary, sizeof(binary)};
+  if (!resource_write_file(full_file_path, &part, 1)) {
+    NS_WARN("material_loader_load - Failed to write '%s'", full_file_path);
+  }
+  string_ncpy(full_file_path, text_path, Resource::PATH_MAX_LENGTH);
+  return material_from_binary(&binary, resource_data, full_file_path);
+}
+
+bool material_loader_load(resource_loader *self, cstr name,
+                          Resource *out_resource) {
+  if (!self || !name || !out_resource) {
+    return false;
   }
 
-  fs::close(&f);
+  MaterialConfig *resource_data = reinterpret_cast<MaterialConfig *>(
+      ns::alloc(sizeof(MaterialConfig), MemTag::MATERIAL_INSTANCE));
+  material_config_defaults(resource_data, name);
+
+  pstr full_file_path = out_resource->full_path;
+  pack const *assets = resource_system_pack();
+  resource_file_path(self->type_path, name, MATERIAL_BINARY_EXTENSION,
+                     full_file_path);
+  bool loaded = false;
+  if (resource_system_cook_materials()) {
+    loaded = material_load_source(resource_data, assets, self->type_path,
+                                  name, full_file_path);
+  } else {
+    material_binary binary;
+    bool found = false;
+    loaded =
+        material_read_binary(assets, full_file_path, &binary, &found) &&
+        material_from_binary(&binary, resource_data, full_file_path);
+    if (!found) {
+      NS_ERROR("material_loader_load - Cooked material '%s' not found",
+               full_file_path);
+    }
+  }
+
+  if (!loaded) {
+    ns::free(resource_data, sizeof(MaterialConfig), MemTag::MATERIAL_INSTANCE);
+    return false;
+  }
 
   out_resource->data = resource_data;
   out_resource->data_size = sizeof(MaterialConfig);
@@ -5,8 +5,46 @@
 
 namespace ns {
 
+#define MATERIAL_TEXT_EXTENSION ".nsmt"
+#define MATERIAL_BINARY_EXTENSION ".nsmb"
+#define MATERIAL_BINARY_MAGIC 0x424D534Eu // "NSMB"
+#define MATERIAL_BINARY_VERSION 2
+
+/**
+ * Cooked material (.nsmb): the MaterialConfig of a .nsmt file with a fixed
+ * layout (little endian), loaded with a single read. The loader only reads
+ * the text file with resource_system_config::cook_materials: it then cooks
+ * it into the .nsmb file next to it when that one is missing, or when the
+ * text file changed since (another source_key).
+ */
+struct material_binary {
+  u32 magic;
+  u32 version;
+  // hash of the path, size and modification time of the .nsmt file
+  u64 source_key;
+  u32 type;
+  u32 reserved;
+  f32 diffuse_color[4];
+  char name[Material::NAME_MAX_LENGTH];
+  char diffuse_map_name[Texture::NAME_MAX_LENGTH];
+};
+
+NS_STATIC_ASSERT(sizeof(material_binary) == 808,
+                 "material_binary is a file format");
+
 resource_loader material_resource_loader_create();
 
+/**
+ * Cooks the text of a .nsmt file
+ * @param name the name of the material when the file does not set one
+ * @param text the content of the file
+ * @param size the size of the content
+ * @param out the cooked material, with a null source_key
+ * @returns true
+ */
+NS_API bool material_cook(cstr name, cstr text, usize size,
+                          material_binary *out);
+
 } // namespace ns
 
 #endif // MATERIAL_LOADER_HEADER_INCLUDED
@@ -0,0 +1,238 @@
+#include "./mesh_loader.h"
+
+#include "../../core/logger.h"
+#include "../../core/memory.h"
+#include "../../core/profiler.h"
+#include "../../core/string.h"
+#include "../../platform/platform.h"
+#include "../obj_importer.h"
+#include "../pack.h"
+#include "./loader_utils.h"
+
+namespace ns {
+
+#define MESH_LOADER_TYPE_PATH "models"
+
+u64 mesh_binary_size(u32 vertex_count, u32 index_count, u32 index_size) {
+  u64 size = sizeof(mesh_binary_header) +
+             (sizeof(vertex_3d) + sizeof(vertex_3d_frame)) *
+                 static_cast<u64>(vertex_count) +
+             static_cast<u64>(index_count) * index_size;
+  // The next file of the pack starts aligned anyway, but the size stays a
+  // multiple of 4 for the u16 indices
+  return (size + 3) & ~3ull;
+}
+
+// A max reduction, which vectorizes, rather than a branch per index
+template <typename T>
+static bool mesh_indices_below(T const *indices, u32 index_count,
+                               u32 vertex_count) {
+  T max = 0;
+  for (u32 i = 0; i < index_count; i++) {
+    max = indices[i] > max ? indices[i] : max;
+  }
+  return index_count == 0 || max < vertex_count;
+}
+
+bool mesh_binary_view(u8 const *data, usize size, MeshResourceData *out) {
+  if (size < sizeof(mesh_binary_header)) {
+    return false;
+  }
+  auto header = reinterpret_cast<mesh_binary_header const *>(data);
+  if (header->magic != MESH_BINARY_MAGIC ||
+      header->version != MESH_BINARY_VERSION ||
+      (header->index_size != sizeof(u16) &&
+       header->index_size != sizeof(u32)) ||
+      header->index_count % 3 != 0 ||
+      size != mesh_binary_size(header->vertex_count, header->index_count,
+                               header->index_size)) {
+    return false;
+  }
+  out->vertex_count = header->vertex_count;
+  out->index_count = header->index_count;
+  out->index_size = header->index_size;
+  out->bounds = aabb(vec3{header->bounds_min[0], header->bounds_min[1],
+                          header->bounds_min[2]},
+                     vec3{header->bounds_max[0], header->bounds_max[1],
+                          header->bounds_max[2]});
+  out->vertices = reinterpret_cast<vertex_3d const *>(header + 1);
+  out->frames =
+      reinterpret_cast<vertex_3d_frame const *>(out->vertices +
+                                                header->vertex_count);
+  out->indices = out->frames + header->vertex_count;
+  // Checked once, at load: the renderer draws them as they are
+  bool indices_valid =
+      header->index_size == sizeof(u16)
+          ? mesh_indices_below(reinterpret_cast<u16 const *>(out->indices),
+                               header->index_count, header->vertex_count)
+          : mesh_indices_below(reinterpret_cast<u32 const *>(out->indices),
+                               header->index_count, header->vertex_count);
+  if (!indices_valid) {
+    return false;
+  }
+  out->data = data;
+  out->data_size = size;
+  out->cached = {};
+  out->data_is_view = false;
+  return true;
+}
+
+// Reads the .nsmesh file from the asset pack: in place when it is stored
+// uncompressed, in a platform allocation otherwise
+static bool mesh_decode_packed(pack const *assets, cstr binary_path,
+                               MeshResourceData *out) {
+  pack_entry const *entry = pack_find(assets, binary_path);
+  if (!entry) {
+    NS_ERROR("mesh_loader_load - Mesh '%s' is not in the asset pack",
+             binary_path);
+    return false;
+  }
+  Slice<u8> view = Slice<u8>::from_parts(nullptr, 0);
+  if (pack_view(assets, entry, &view)) {
+    if (!mesh_binary_view(view.begin(), view.len(), out)) {
+      NS_ERROR("mesh_loader_load - '%s' is not a valid mesh", binary_path);
+      return false;
+    }
+    out->data_is_view = true;
+    return true;
+  }
+  u8 *copy =
+      reinterpret_cast<u8 *>(platform::allocate_memory(entry->size, false));
+  if (!pack_read(assets, entry, copy) ||
+      !mesh_binary_view(copy, entry->size, out)) {
+    NS_ERROR("mesh_loader_load - '%s' is not a valid mesh", binary_path);
+    platform::free_memory(copy, false);
+    return false;
+  }
+  return true;
+}
+
+// Maps the .nsmesh file when it is up to date, or imports the .obj file and
+// writes the .nsmesh file
+static bool mesh_decode_file(cstr name, MeshResourceData *out) {
+  NS_PROFILE_FUNCTION();
+  char source_path[Resource::PATH_MAX_LENGTH];
+  char binary_path[Resource::PATH_MAX_LENGTH];
+  resource_file_path(MESH_LOADER_TYPE_PATH, name, MESH_BINARY_EXTENSION,
+                     binary_path);
+  pack const *assets = resource_system_pack();
+  if (assets) {
+    return mesh_decode_packed(assets, binary_path, out);
+  }
+  resource_file_path(MESH_LOADER_TYPE_PATH, name, MESH_SOURCE_EXTENSION,
+                     source_path);
+
+  fs::FileStat source;
+  bool has_source = fs::stat(source_path, &source);
+  u64 source_key = has_source ? resource_source_key(source_path, source) : 0;
+  fs::MappedFile file;
+  // The arrays are uploaded as a whole
+  if (resource_map_existing(binary_path, fs::MapHint::WILL_NEED, &file)) {
+    if (mesh_binary_view(file.data, file.size, out) &&
+        (!has_source ||
+         reinterpret_cast<mesh_binary_header const *>(file.data)
+                 ->source_key == source_key)) {
+      out->cached = file;
+      return true;
+    }
+    fs::unmap(&file);
+    if (!has_source) {
+      NS_ERROR("mesh_loader_load - '%s' is not a valid mesh", binary_path);
+      return false;
+    }
+  }
+  if (!has_source) {
+    NS_ERROR("mesh_loader_load - Mesh '%s' not found (no '%s')", name,
+             source_path);
+    return false;
+  }
+
+  fs::MappedFile text;
+  if (!fs::map(source_path, &text, fs::MapHint::SEQUENTIAL)) {
+    return false;
+  }
+  bool imported = obj_import(reinterpret_cast<cstr>(text.data), text.size,
+                             source_path, out);
+  fs::unmap(&text);
+  if (!imported) {
+    return false;
+  }
+  // The importer's allocation, writable
+  reinterpret_cast<mesh_binary_header *>(const_cast<u8 *>(out->data))
+      ->source_key = source_key;
+  // Not fatal: the mesh is imported again next time
+  resource_file_part part = {out->data, out->data_size};
+  if (!resource_write_file(binary_path, &part, 1)) {
+    NS_WARN("mesh_loader_load - Failed to write '%s'", binary_path);
+  }
+  return true;
+}
+
+bool mesh_loader_load(resource_loader *self, cstr name,
+                      Resource *out_resource) {
+  if (!self || !name || !out_resource) {
+    return false;
+  }
+
+  resource_file_path(self->type_path, name, MESH_SOURCE_EXTENSION,
+                     out_resource->full_path);
+  MeshResourceData mesh;
+  if (!mesh_decode_file(name, &mesh)) {
+    return false;
+  }
+
+  MeshResourceData *resource_data = reinterpret_cast<MeshResourceData *>(
+      ns::alloc(sizeof(MeshResourceData), MemTag::MESH));
+  *resource_data = mesh;
+
+  out_resource->data = resource_data;
+  out_resource->data_size = sizeof(MeshResourceData);
+  out_resource->name = name;
+
+  return true;
+}
+
+bool mesh_loader_decode(cstr name, MeshResourceData *out) {
+  return mesh_decode_file(name, out);
+}
+
+void mesh_loader_free(MeshResourceData *mesh) {
+  if (mesh->cached.data) {
+    fs::unmap(&mesh->cached);
+  } else if (!mesh->data_is_view) {
+    platform::free_memory(const_cast<u8 *>(mesh->data), false);
+  }
+  mesh->data = nullptr;
+  mesh->vertices = nullptr;
+  mesh->frames = nullptr;
+  mesh->indices = nullptr;
+}
+
+void mesh_loader_unload(resource_loader *self, Resource *resource) {
+  if (!self || !resource) {
+    NS_WARN("mesh_loader_unload - Loader or resource is null");
+    return;
+  }
+
+  resource->full_path[0] = '\0';
+
+  if (resource->data) {
+    mesh_loader_free(reinterpret_cast<MeshResourceData *>(resource->data));
+    ns::free(resource->data, resource->data_size, MemTag::MESH);
+    resource->data = nullptr;
+    resource->data_size = 0;
+    resource->loader_id = INVALID_ID;
+  }
+}
+
+resource_loader mesh_resource_loader_create() {
+  resource_loader loader;
+  loader.type = ResourceType::STATIC_MESH;
+  loader.type_path = MESH_LOADER_TYPE_PATH;
+  loader.custom_type = nullptr;
+  loader.load = mesh_loader_load;
+  loader.unload = mesh_loader_unload;
+  return loader;
+}
+
+} // namespace ns
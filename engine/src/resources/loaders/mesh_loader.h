@@ -0,0 +1,79 @@
+#ifndef MESH_LOADER_HEADER_INCLUDED
+#define MESH_LOADER_HEADER_INCLUDED
+
+#include "../../systems/resource_system.h"
+
+namespace ns {
+
+#define MESH_SOURCE_EXTENSION ".obj"
+#define MESH_BINARY_EXTENSION ".nsmesh"
+#define MESH_BINARY_MAGIC 0x534D534Eu // "NSMS"
+#define MESH_BINARY_VERSION 1
+
+/**
+ * Cooked static mesh (.nsmesh), the arrays of MeshResourceData one after the
+ * other (little endian), loaded with a single mapped read:
+ *   mesh_binary_header
+ *   vertex_3d vertices[vertex_count]
+ *   vertex_3d_frame frames[vertex_count]
+ *   indices[index_count]                   of index_size bytes
+ *
+ * The loader imports the .obj file and writes the .nsmesh file next to it,
+ * then maps the .nsmesh file as long as the .obj file is not modified. A
+ * .nsmesh file without its .obj file is used as is (e.g. in the asset pack).
+ */
+struct mesh_binary_header {
+  u32 magic;
+  u32 version;
+  // hash of the path, size and modification time of the .obj file
+  u64 source_key;
+  u32 vertex_count;
+  u32 index_count;
+  u32 index_size;
+  u32 reserved;
+  f32 bounds_min[3];
+  f32 bounds_max[3];
+};
+
+NS_STATIC_ASSERT(sizeof(mesh_binary_header) == 56,
+                 "mesh_binary_header is a file format");
+
+resource_loader mesh_resource_loader_create();
+
+/**
+ * Gets the size of a .nsmesh file
+ */
+NS_API u64 mesh_binary_size(u32 vertex_count, u32 index_count, u32 index_size);
+
+/**
+ * Points a mesh into a .nsmesh image, without copying it
+ * @param data the image
+ * @param size the size of the image
+ * @param out the mesh. Its data is not owned: the ownership fields are
+ *            cleared.
+ * @returns false if the image is not a valid .nsmesh file, or an index is
+ *          out of the vertices
+ */
+NS_API bool mesh_binary_view(u8 const *data, usize size,
+                             MeshResourceData *out);
+
+/**
+ * Loads a mesh as the mesh loader does (from its .nsmesh file when it is up
+ * to date, importing and cooking the .obj file otherwise), but without the
+ * engine allocator, which is not thread-safe: this can be called from any
+ * thread.
+ * @param name the name of the mesh, in the models directory
+ * @param out the mesh, freed with mesh_loader_free
+ * @returns whether the mesh was loaded
+ */
+NS_API bool mesh_loader_decode(cstr name, MeshResourceData *out);
+
+/**
+ * Frees the data of a mesh of mesh_loader_decode, or unmaps it when it comes
+ * from the .nsmesh file
+ */
+NS_API void mesh_loader_free(MeshResourceData *mesh);
+
+} // namespace ns
+
+#endif // MESH_LOADER_HEADER_INCLUDED
@@ -0,0 +1,180 @@
+#include "./lz4.h"
+
+#include <cstring>
+
+namespace ns {
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_HASH_BITS 12
+// The block ends with at least 5 literals, and the last match starts at least
+// 12 bytes before the end
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MF_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+// Short literal runs are copied by this many bytes when there is room
+#define LZ4_WILD_COPY 16
+
+NS_INLINE u32 lz4_read32(u8 const *p) {
+  u32 v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+NS_INLINE u32 lz4_hash(u32 sequence) {
+  return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+static u8 *lz4_write_length(u8 *op, usize length) {
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = static_cast<u8>(length);
+  return op;
+}
+
+static u8 *lz4_write_literals(u8 *op, u8 *token, u8 const *literals,
+                              usize count) {
+  *token = static_cast<u8>((count >= 15 ? 15 : count) << 4);
+  if (count >= 15) {
+    op = lz4_write_length(op, count - 15);
+  }
+  std::memcpy(op, literals, count);
+  return op + count;
+}
+
+usize lz4_compress(u8 const *src, usize size, u8 *dst, usize capacity) {
+  if (capacity < lz4_compress_bound(size) || size > 0xFFFFFFFFu) {
+    return 0;
+  }
+  // Last position where each hashed 4-byte sequence was seen
+  u32 table[1 << LZ4_HASH_BITS];
+  std::memset(table, 0, sizeof(table));
+
+  u8 *op = dst;
+  usize anchor = 0;
+  if (size > LZ4_MF_LIMIT) {
+    usize match_limit = size - LZ4_MF_LIMIT;
+    usize match_end_limit = size - LZ4_LAST_LITERALS;
+    usize ip = 0;
+    while (ip < match_limit) {
+      u32 sequence = lz4_read32(src + ip);
+      u32 h = lz4_hash(sequence);
+      usize candidate = table[h];
+      table[h] = static_cast<u32>(ip);
+      if (candidate >= ip || ip - candidate > LZ4_MAX_OFFSET ||
+          lz4_read32(src + candidate) != sequence) {
+        ip++;
+        continue;
+      }
+
+      usize length = LZ4_MIN_MATCH;
+      while (ip + length < match_end_limit &&
+             src[candidate + length] == src[ip + length]) {
+        length++;
+      }
+      while (ip > anchor && candidate > 0 &&
+             src[ip - 1] == src[candidate - 1]) {
+        ip--;
+        candidate--;
+        length++;
+      }
+
+      u8 *token = op++;
+      op = lz4_write_literals(op, token, src + anchor, ip - anchor);
+      usize offset = ip - candidate;
+      *op++ = static_cast<u8>(offset & 0xFF);
+      *op++ = static_cast<u8>(offset >> 8);
+      usize match_length = length - LZ4_MIN_MATCH;
+      *token |= static_cast<u8>(match_length >= 15 ? 15 : match_length);
+      if (match_length >= 15) {
+        op = lz4_write_length(op, match_length - 15);
+      }
+      ip += length;
+      anchor = ip;
+    }
+  }
+
+  u8 *token = op++;
+  op = lz4_write_literals(op, token, src + anchor, size - anchor);
+  return static_cast<usize>(op - dst);
+}
+
+// Reads the extension bytes of a length whose 4-bit field was 15
+static bool lz4_read_length(u8 const *src, usize size, usize *ip,
+                            usize *length) {
+  u8 b;
+  do {
+    if (*ip >= size) {
+      return false;
+    }
+    b = src[(*ip)++];
+    *length += b;
+  } while (b == 255);
+  return true;
+}
+
+bool lz4_decompress(u8 const *src, usize size, u8 *dst, usize dst_size) {
+  usize ip = 0;
+  usize op = 0;
+  while (ip < size) {
+    u8 token = src[ip++];
+    usize literal_count = token >> 4;
+    if (literal_count == 15 &&
+        !lz4_read_length(src, size, &ip, &literal_count)) {
+      return false;
+    }
+    if (literal_count > size - ip || literal_count > dst_size - op) {
+      return false;
+    }
+    if (literal_count <= LZ4_WILD_COPY && size - ip >= LZ4_WILD_COPY &&
+        dst_size - op >= LZ4_WILD_COPY) {
+      // Fixed size copy, the bytes after the literals are overwritten later
+      std::memcpy(dst + op, src + ip, LZ4_WILD_COPY);
+    } else {
+      std::memcpy(dst + op, src + ip, literal_count);
+    }
+    ip += literal_count;
+    op += literal_count;
+    if (ip == size) {
+      // The last sequence has no match
+      break;
+    }
+
+    if (size - ip < 2) {
+      return false;
+    }
+    usize offset = src[ip] | (static_cast<usize>(src[ip + 1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > op) {
+      return false;
+    }
+    usize length = token & 15;
+    if (length == 15 && !lz4_read_length(src, size, &ip, &length)) {
+      return false;
+    }
+    length += LZ4_MIN_MATCH;
+    if (length > dst_size - op) {
+      return false;
+    }
+    u8 *d = dst + op;
+    u8 const *s = d - offset;
+    if (offset >= 8 && dst_size - op >= length + 8) {
+      // By 8 bytes, which never read bytes of the same chunk
+      for (usize i = 0; i < length; i += 8) {
+        std::memcpy(d + i, s + i, 8);
+      }
+    } else if (offset >= length) {
+      std::memcpy(d, s, length);
+    } else {
+      // Overlapping match: repeats the last offset bytes
+      for (usize i = 0; i < length; i++) {
+        d[i] = s[i];
+      }
+    }
+    op += length;
+  }
+  return op == dst_size;
+}
+
+} // namespace ns
@@ -0,0 +1,44 @@
+#ifndef LZ4_HEADER_INCLUDED
+#define LZ4_HEADER_INCLUDED
+
+#include "../defines.h"
+
+// LZ4 block format (no frame): the compressor is a greedy single-pass one,
+// the output can be decoded by any LZ4 block decoder.
+
+namespace ns {
+
+/**
+ * Gets the size of the buffer lz4_compress needs
+ * @param size the size of the data to compress
+ * @returns the worst-case size of the compressed data
+ */
+NS_INLINE usize lz4_compress_bound(usize size) {
+  return size + size / 255 + 16;
+}
+
+/**
+ * Compresses a block
+ * @param src the data to compress (less than 4GB)
+ * @param size the size of the data
+ * @param dst the output buffer
+ * @param capacity the size of the output buffer, at least
+ *        lz4_compress_bound(size)
+ * @returns the size of the compressed data, 0 on failure
+ */
+NS_API usize lz4_compress(u8 const *src, usize size, u8 *dst, usize capacity);
+
+/**
+ * Decompresses a block
+ * @param src the compressed data
+ * @param size the size of the compressed data
+ * @param dst the output buffer
+ * @param dst_size the size of the decompressed data
+ * @returns false if the data is corrupted or does not decompress to exactly
+ *          dst_size bytes
+ */
+NS_API bool lz4_decompress(u8 const *src, usize size, u8 *dst, usize dst_size);
+
+} // namespace ns
+
+#endif // LZ4_HEADER_INCLUDED
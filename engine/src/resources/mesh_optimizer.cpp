@@ -0,0 +1,315 @@
+#include "./mesh_optimizer.h"
+
+#include "../core/profiler.h"
+#include "../platform/platform.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns {
+
+template <typename T> static T *mesh_allocate(usize count) {
+  return reinterpret_cast<T *>(
+      platform::allocate_memory(sizeof(T) * count, false));
+}
+
+NS_INLINE void mesh_release(ptr block) { platform::free_memory(block, false); }
+
+mesh_cache_stats mesh_analyze_vertex_cache(u32 const *indices,
+                                           u32 index_count, u32 vertex_count,
+                                           u32 cache_size) {
+  mesh_cache_stats stats = {};
+  stats.triangle_count = index_count / 3;
+  if (index_count == 0) {
+    return stats;
+  }
+  // A vertex is in the FIFO while less than cache_size vertices were pushed
+  // after it. 0 is older than the cache, so the first use misses.
+  u32 *pushed_at = mesh_allocate<u32>(vertex_count);
+  platform::zero_memory(pushed_at, sizeof(u32) * vertex_count);
+  u32 time = cache_size;
+  for (u32 i = 0; i < index_count; i++) {
+    u32 v = indices[i];
+    if (time - pushed_at[v] >= cache_size) {
+      stats.vertex_count += pushed_at[v] == 0;
+      pushed_at[v] = ++time;
+      stats.transformed_count++;
+    }
+  }
+  mesh_release(pushed_at);
+  stats.acmr = static_cast<f32>(stats.transformed_count) /
+               static_cast<f32>(stats.triangle_count);
+  stats.atvr = static_cast<f32>(stats.transformed_count) /
+               static_cast<f32>(stats.vertex_count);
+  return stats;
+}
+
+void mesh_optimize_vertex_cache(u32 *indices, u32 index_count,
+                                u32 vertex_count) {
+  NS_PROFILE_FUNCTION();
+  u32 triangle_count = index_count / 3;
+  if (triangle_count < 2) {
+    return;
+  }
+
+  // The triangles of each vertex, triangles[offsets[v]...offsets[v + 1]),
+  // and how many of them are left to emit
+  u32 *offsets = mesh_allocate<u32>(vertex_count + 1);
+  u32 *remaining = mesh_allocate<u32>(vertex_count);
+  u32 *triangles = mesh_allocate<u32>(index_count);
+  platform::zero_memory(remaining, sizeof(u32) * vertex_count);
+  for (u32 i = 0; i < index_count; i++) {
+    remaining[indices[i]]++;
+  }
+  offsets[0] = 0;
+  for (u32 v = 0; v < vertex_count; v++) {
+    offsets[v + 1] = offsets[v] + remaining[v];
+  }
+  // The time each vertex entered the cache, 0 for never. Used first to fill
+  // the triangle lists.
+  u32 *pushed_at = mesh_allocate<u32>(vertex_count);
+  std::memcpy(pushed_at, offsets, sizeof(u32) * vertex_count);
+  for (u32 i = 0; i < index_count; i++) {
+    triangles[pushed_at[indices[i]]++] = i / 3;
+  }
+  platform::zero_memory(pushed_at, sizeof(u32) * vertex_count);
+  u8 *emitted = mesh_allocate<u8>(triangle_count);
+  platform::zero_memory(emitted, triangle_count);
+  // The vertices of the emitted triangles, most recent last: the next fan
+  // is looked for among the ones of the last fan, then back along the stack
+  u32 *dead_ends = mesh_allocate<u32>(index_count);
+  u32 dead_end_count = 0;
+
+  u32 *out = mesh_allocate<u32>(index_count);
+  u32 written = 0;
+  u32 time = MESH_CACHE_SIMULATION_SIZE + 1;
+  // The vertices are taken in order when the stack has none left, starting
+  // with the first one
+  u32 cursor = 0;
+  u32 fan = 0;
+  while (fan != INVALID_ID) {
+    // Every triangle left around the vertex, in their order
+    u32 fan_start = dead_end_count;
+    for (u32 j = offsets[fan]; j < offsets[fan + 1]; j++) {
+      u32 t = triangles[j];
+      if (emitted[t]) {
+        continue;
+      }
+      emitted[t] = 1;
+      for (u32 k = 0; k < 3; k++) {
+        u32 v = indices[t * 3 + k];
+        out[written++] = v;
+        dead_ends[dead_end_count++] = v;
+        remaining[v]--;
+        if (time - pushed_at[v] > MESH_CACHE_SIMULATION_SIZE) {
+          pushed_at[v] = time++;
+        }
+      }
+    }
+
+    // The next fan is the vertex of the last one that entered the cache
+    // first, if its triangles will still find it there, else one of the
+    // others with triangles left
+    fan = INVALID_ID;
+    i32 best_priority = -1;
+    for (u32 i = fan_start; i < dead_end_count; i++) {
+      u32 v = dead_ends[i];
+      if (remaining[v] == 0) {
+        continue;
+      }
+      u32 age = time - pushed_at[v];
+      i32 priority =
+          age + 2 * remaining[v] <= MESH_CACHE_SIMULATION_SIZE ? age : 0;
+      if (priority > best_priority) {
+        best_priority = priority;
+        fan = v;
+      }
+    }
+    while (fan == INVALID_ID && dead_end_count > 0) {
+      u32 v = dead_ends[--dead_end_count];
+      fan = remaining[v] > 0 ? v : INVALID_ID;
+    }
+    for (; fan == INVALID_ID && cursor < vertex_count; cursor++) {
+      fan = remaining[cursor] > 0 ? cursor : INVALID_ID;
+    }
+  }
+  std::memcpy(indices, out, sizeof(u32) * index_count);
+
+  mesh_release(out);
+  mesh_release(dead_ends);
+  mesh_release(emitted);
+  mesh_release(pushed_at);
+  mesh_release(triangles);
+  mesh_release(remaining);
+  mesh_release(offsets);
+}
+
+// Triangles [begin, end) of the vertex cache order
+struct mesh_cluster {
+  u32 begin;
+  u32 end;
+  f32 sort_key;
+};
+
+// Writes the triangles of the clusters, those facing outwards of the mesh
+// first, and returns the ACMR of the order
+static f32 mesh_sort_clusters(u32 const *indices, u32 index_count,
+                              vec3 const *positions, usize vertex_stride,
+                              u32 vertex_count, mesh_cluster *clusters,
+                              u32 cluster_count, u32 *out) {
+  auto position = [&](u32 v) -> vec3 const & {
+    return *reinterpret_cast<vec3 const *>(
+        reinterpret_cast<u8 const *>(positions) + v * vertex_stride);
+  };
+  // The area-weighted centroid and normal of each cluster, then how far it
+  // is in front of the centroid of the mesh
+  vec3 *centroids = mesh_allocate<vec3>(cluster_count);
+  vec3 *normals = mesh_allocate<vec3>(cluster_count);
+  vec3 mesh_centroid = vec3::zero();
+  f32 mesh_area = 0.0f;
+  for (u32 c = 0; c < cluster_count; c++) {
+    vec3 centroid = vec3::zero();
+    vec3 normal = vec3::zero();
+    f32 area = 0.0f;
+    for (u32 t = clusters[c].begin; t < clusters[c].end; t++) {
+      vec3 const &p0 = position(indices[t * 3]);
+      vec3 const &p1 = position(indices[t * 3 + 1]);
+      vec3 const &p2 = position(indices[t * 3 + 2]);
+      // Twice the area, as a vector
+      vec3 n = (p1 - p0).cross(p2 - p0);
+      f32 a = n.length();
+      centroid += (p0 + p1 + p2) * (a / 3.0f);
+      normal += n;
+      area += a;
+    }
+    mesh_centroid += centroid;
+    mesh_area += area;
+    centroids[c] = area > 0.0f ? centroid / area : centroid;
+    f32 length = normal.length();
+    normals[c] = length > 0.0f ? normal / length : normal;
+  }
+  if (mesh_area > 0.0f) {
+    mesh_centroid /= mesh_area;
+  }
+  u32 *order = mesh_allocate<u32>(cluster_count);
+  for (u32 c = 0; c < cluster_count; c++) {
+    clusters[c].sort_key = (centroids[c] - mesh_centroid).dot(normals[c]);
+    order[c] = c;
+  }
+  // Stable: the clusters at the same depth keep the vertex cache order
+  std::stable_sort(order, order + cluster_count, [&](u32 a, u32 b) {
+    return clusters[a].sort_key > clusters[b].sort_key;
+  });
+
+  u32 written = 0;
+  for (u32 i = 0; i < cluster_count; i++) {
+    mesh_cluster const &c = clusters[order[i]];
+    u32 count = (c.end - c.begin) * 3;
+    std::memcpy(out + written, indices + c.begin * 3, sizeof(u32) * count);
+    written += count;
+  }
+  mesh_release(order);
+  mesh_release(normals);
+  mesh_release(centroids);
+  return mesh_analyze_vertex_cache(out, index_count, vertex_count,
+                                   MESH_CACHE_SIMULATION_SIZE)
+      .acmr;
+}
+
+void mesh_optimize_overdraw(u32 *indices, u32 index_count,
+                            vec3 const *positions, usize vertex_stride,
+                            u32 vertex_count, f32 threshold) {
+  NS_PROFILE_FUNCTION();
+  u32 triangle_count = index_count / 3;
+  if (triangle_count < 2) {
+    return;
+  }
+
+  // Hard boundaries: the triangles whose 3 vertices miss the cache. The
+  // cache starts over there, so cutting costs nothing.
+  u32 *starts = mesh_allocate<u32>(triangle_count + 1);
+  u32 start_count = 0;
+  u32 *pushed_at = mesh_allocate<u32>(vertex_count);
+  platform::zero_memory(pushed_at, sizeof(u32) * vertex_count);
+  u32 time = MESH_CACHE_SIMULATION_SIZE;
+  u32 misses = 0;
+  for (u32 t = 0; t < triangle_count; t++) {
+    u32 triangle_misses = 0;
+    for (u32 k = 0; k < 3; k++) {
+      u32 v = indices[t * 3 + k];
+      if (time - pushed_at[v] >= MESH_CACHE_SIMULATION_SIZE) {
+        pushed_at[v] = ++time;
+        triangle_misses++;
+      }
+    }
+    misses += triangle_misses;
+    if (triangle_misses == 3) {
+      starts[start_count++] = t;
+    }
+  }
+  starts[start_count] = triangle_count;
+  mesh_release(pushed_at);
+  f32 limit = static_cast<f32>(misses) / triangle_count * threshold;
+
+  // The clusters are merged until the order stays within the threshold:
+  // each try doubles their minimum size
+  mesh_cluster *clusters = mesh_allocate<mesh_cluster>(start_count);
+  u32 *out = mesh_allocate<u32>(index_count);
+  for (u32 min_size = 1;; min_size *= 2) {
+    u32 cluster_count = 0;
+    for (u32 i = 0; i < start_count;) {
+      mesh_cluster &c = clusters[cluster_count++];
+      c.begin = starts[i];
+      while (++i < start_count && starts[i] - c.begin < min_size) {
+      }
+      c.end = starts[i];
+    }
+    if (cluster_count < 2) {
+      break;
+    }
+    f32 acmr = mesh_sort_clusters(indices, index_count, positions,
+                                  vertex_stride, vertex_count, clusters,
+                                  cluster_count, out);
+    if (acmr <= limit) {
+      std::memcpy(indices, out, sizeof(u32) * index_count);
+      break;
+    }
+  }
+  mesh_release(out);
+  mesh_release(clusters);
+  mesh_release(starts);
+}
+
+u32 mesh_optimize_vertex_fetch(u32 *indices, u32 index_count,
+                               u32 vertex_count, u32 *out_remap) {
+  for (u32 v = 0; v < vertex_count; v++) {
+    out_remap[v] = INVALID_ID;
+  }
+  u32 next = 0;
+  for (u32 i = 0; i < index_count; i++) {
+    u32 &remap = out_remap[indices[i]];
+    if (remap == INVALID_ID) {
+      remap = next++;
+    }
+    indices[i] = remap;
+  }
+  u32 used = next;
+  for (u32 v = 0; v < vertex_count; v++) {
+    if (out_remap[v] == INVALID_ID) {
+      out_remap[v] = next++;
+    }
+  }
+  return used;
+}
+
+void mesh_remap_vertices(roptr vertices, u32 vertex_count, u32 vertex_size,
+                         u32 const *remap, ptr out) {
+  u8 const *in = reinterpret_cast<u8 const *>(vertices);
+  u8 *to = reinterpret_cast<u8 *>(out);
+  for (u32 v = 0; v < vertex_count; v++) {
+    std::memcpy(to + static_cast<usize>(remap[v]) * vertex_size,
+                in + static_cast<usize>(v) * vertex_size, vertex_size);
+  }
+}
+
+} // namespace ns
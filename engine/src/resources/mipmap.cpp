@@ -0,0 +1,406 @@
+#include "./mipmap.h"
+
+#include "../core/profiler.h"
+#include "../math/cstes.h"
+#include "../math/simd.h"
+#include "../platform/platform.h"
+#include "./row_bands.h"
+
+#include <cmath>
+
+namespace ns {
+
+#define MIP_PIXEL_SIZE 4
+// Entries of the linear to sRGB table: fine enough to round as the exact
+// conversion does, but for a few values at the dark end
+#define MIP_SRGB_TABLE_SIZE 16384
+// The Kaiser filter covers 3 texels on each side of a destination pixel
+#define MIP_KAISER_TAP_COUNT 6
+#define MIP_KAISER_ALPHA 4.0
+// Smaller bands are not worth a thread
+#define MIP_BAND_MIN_PIXEL_COUNT 16384
+
+struct mip_tables {
+  f32 srgb_to_linear[256];
+  f32 unorm_to_float[256];
+  u8 linear_to_srgb[MIP_SRGB_TABLE_SIZE];
+  // Weights of the texels 2x - 2 to 2x + 3 for the destination pixel x
+  f32 kaiser[MIP_KAISER_TAP_COUNT];
+};
+
+// Rows [row_begin, row_end) of a level, filtered from the previous level
+struct mip_band {
+  u8 const *src;
+  u8 *dst;
+  u32 src_width;
+  u32 src_height;
+  u32 width;
+  u32 height;
+  u32 row_begin;
+  u32 row_end;
+  mip_config const *config;
+  bool simd;
+};
+
+// Modified Bessel function of the first kind, of order 0
+static f64 mip_bessel_i0(f64 x) {
+  f64 sum = 1.0;
+  f64 term = 1.0;
+  for (u32 k = 1; k < 32; k++) {
+    f64 t = x / (2.0 * k);
+    term *= t * t;
+    sum += term;
+  }
+  return sum;
+}
+
+static mip_tables mip_tables_build() {
+  mip_tables t;
+  for (u32 i = 0; i < 256; i++) {
+    f64 s = i / 255.0;
+    f64 l = s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+    t.srgb_to_linear[i] = static_cast<f32>(l);
+    t.unorm_to_float[i] = static_cast<f32>(s);
+  }
+  for (u32 i = 0; i < MIP_SRGB_TABLE_SIZE; i++) {
+    f64 l = static_cast<f64>(i) / (MIP_SRGB_TABLE_SIZE - 1);
+    f64 s = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+    t.linear_to_srgb[i] = static_cast<u8>(s * 255.0 + 0.5);
+  }
+
+  // sinc(d / 2) halves the frequencies, the window fades it out at 3 texels
+  f64 weights[MIP_KAISER_TAP_COUNT];
+  f64 sum = 0.0;
+  for (u32 k = 0; k < MIP_KAISER_TAP_COUNT; k++) {
+    f64 d = k - 2.5;
+    f64 x = PI<f64> * d / 2.0;
+    f64 r = d / 3.0;
+    weights[k] = std::sin(x) / x *
+                 mip_bessel_i0(MIP_KAISER_ALPHA * std::sqrt(1.0 - r * r)) /
+                 mip_bessel_i0(MIP_KAISER_ALPHA);
+    sum += weights[k];
+  }
+  for (u32 k = 0; k < MIP_KAISER_TAP_COUNT; k++) {
+    t.kaiser[k] = static_cast<f32>(weights[k] / sum);
+  }
+  return t;
+}
+
+static mip_tables const &mip_get_tables() {
+  // Built by the first thread that needs them
+  static mip_tables const tables = mip_tables_build();
+  return tables;
+}
+
+NS_INLINE u32 mip_clamp_index(i64 i, u32 size) {
+  return i < 0 ? 0 : (i >= size ? size - 1 : static_cast<u32>(i));
+}
+
+NS_INLINE f32 mip_saturate(f32 v) {
+  return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+NS_INLINE u8 mip_encode_unorm(f32 v) {
+  return static_cast<u8>(mip_saturate(v) * 255.0f + 0.5f);
+}
+
+NS_INLINE u8 mip_encode_srgb(mip_tables const &t, f32 v) {
+  return t.linear_to_srgb[static_cast<u32>(
+      mip_saturate(v) * (MIP_SRGB_TABLE_SIZE - 1) + 0.5f)];
+}
+
+static void mip_encode_pixel(mip_tables const &t, bool srgb, f32 const *v,
+                             u8 *out) {
+  for (u32 i = 0; i < 3; i++) {
+    out[i] = srgb ? mip_encode_srgb(t, v[i]) : mip_encode_unorm(v[i]);
+  }
+  out[3] = mip_encode_unorm(v[3]);
+}
+
+static void mip_box_pixel(mip_tables const &t, bool srgb, u8 const *a,
+                          u8 const *b, u8 const *c, u8 const *d, u8 *out) {
+  u32 first = 0;
+  if (srgb) {
+    f32 const *l = t.srgb_to_linear;
+    for (u32 i = 0; i < 3; i++) {
+      f32 sum = (l[a[i]] + l[b[i]]) + (l[c[i]] + l[d[i]]);
+      out[i] = mip_encode_srgb(t, sum * 0.25f);
+    }
+    first = 3;
+  }
+  for (u32 i = first; i < MIP_PIXEL_SIZE; i++) {
+    out[i] = static_cast<u8>((a[i] + b[i] + c[i] + d[i] + 2) >> 2);
+  }
+}
+
+#if defined(NS_USE_SIMD)
+NS_INLINE __m128 mip_load_linear(mip_tables const &t, u8 const *p) {
+  f32 const *l = t.srgb_to_linear;
+  return _mm_set_ps(0.0f, l[p[2]], l[p[1]], l[p[0]]);
+}
+
+NS_INLINE __m128 mip_saturate4(__m128 v) {
+  return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+static void mip_encode_pixel_simd(mip_tables const &t, bool srgb, __m128 v,
+                                  u8 *out) {
+  v = mip_saturate4(v);
+  __m128 half = _mm_set1_ps(0.5f);
+  __m128i unorm =
+      _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), half));
+  if (!srgb) {
+    __m128i packed = _mm_packus_epi16(_mm_packus_epi32(unorm, unorm),
+                                      _mm_setzero_si128());
+    u32 pixel = static_cast<u32>(_mm_cvtsi128_si32(packed));
+    out[0] = static_cast<u8>(pixel);
+    out[1] = static_cast<u8>(pixel >> 8);
+    out[2] = static_cast<u8>(pixel >> 16);
+    out[3] = static_cast<u8>(pixel >> 24);
+    return;
+  }
+  __m128i index = _mm_cvttps_epi32(_mm_add_ps(
+      _mm_mul_ps(v, _mm_set1_ps(MIP_SRGB_TABLE_SIZE - 1)), half));
+  out[0] = t.linear_to_srgb[_mm_extract_epi32(index, 0)];
+  out[1] = t.linear_to_srgb[_mm_extract_epi32(index, 1)];
+  out[2] = t.linear_to_srgb[_mm_extract_epi32(index, 2)];
+  out[3] = static_cast<u8>(_mm_extract_epi32(unorm, 3));
+}
+
+// Filters the start of a row, returns the first pixel it did not filter
+static u32 mip_box_row_simd(mip_tables const &t, bool srgb, u8 const *row0,
+                            u8 const *row1, u8 *out, u32 width,
+                            u32 src_width) {
+  u32 x = 0;
+  if (!srgb) {
+    // Two pixels from four texels of each row, in 16 bit lanes
+    __m128i zero = _mm_setzero_si128();
+    __m128i two = _mm_set1_epi16(2);
+    for (; x + 2 <= width && 2 * x + 4 <= src_width; x += 2) {
+      __m128i a =
+          _mm_loadu_si128(reinterpret_cast<__m128i const *>(row0 + x * 8));
+      __m128i b =
+          _mm_loadu_si128(reinterpret_cast<__m128i const *>(row1 + x * 8));
+      __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                 _mm_unpacklo_epi8(b, zero));
+      __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                 _mm_unpackhi_epi8(b, zero));
+      __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi),
+                                  _mm_unpackhi_epi64(lo, hi));
+      sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(out + x * 4),
+                       _mm_packus_epi16(sum, sum));
+    }
+    return x;
+  }
+
+  // The color of a pixel in the lanes, alpha apart
+  __m128 quarter = _mm_set1_ps(0.25f);
+  __m128 scale = _mm_set1_ps(MIP_SRGB_TABLE_SIZE - 1);
+  __m128 half = _mm_set1_ps(0.5f);
+  for (; x < width && 2 * x + 2 <= src_width; x++) {
+    u8 const *a = row0 + x * 8;
+    u8 const *c = row1 + x * 8;
+    __m128 top = _mm_add_ps(mip_load_linear(t, a), mip_load_linear(t, a + 4));
+    __m128 bottom =
+        _mm_add_ps(mip_load_linear(t, c), mip_load_linear(t, c + 4));
+    __m128 sum = _mm_add_ps(top, bottom);
+    __m128 v = mip_saturate4(_mm_mul_ps(sum, quarter));
+    __m128i index = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+    u8 *p = out + x * 4;
+    p[0] = t.linear_to_srgb[_mm_extract_epi32(index, 0)];
+    p[1] = t.linear_to_srgb[_mm_extract_epi32(index, 1)];
+    p[2] = t.linear_to_srgb[_mm_extract_epi32(index, 2)];
+    p[3] = static_cast<u8>((a[3] + a[7] + c[3] + c[7] + 2) >> 2);
+  }
+  return x;
+}
+#endif
+
+static void mip_box_band(mip_tables const &t, mip_band const *b) {
+  bool srgb = b->config->srgb;
+  usize src_stride = static_cast<usize>(b->src_width) * MIP_PIXEL_SIZE;
+  for (u32 y = b->row_begin; y < b->row_end; y++) {
+    u8 const *row0 =
+        b->src + mip_clamp_index(2 * y, b->src_height) * src_stride;
+    u8 const *row1 =
+        b->src + mip_clamp_index(2 * y + 1, b->src_height) * src_stride;
+    u8 *out = b->dst + static_cast<usize>(y) * b->width * MIP_PIXEL_SIZE;
+    u32 x = 0;
+#if defined(NS_USE_SIMD)
+    if (b->simd) {
+      x = mip_box_row_simd(t, srgb, row0, row1, out, b->width, b->src_width);
+    }
+#endif
+    for (; x < b->width; x++) {
+      usize c0 = mip_clamp_index(2 * x, b->src_width) * MIP_PIXEL_SIZE;
+      usize c1 = mip_clamp_index(2 * x + 1, b->src_width) * MIP_PIXEL_SIZE;
+      mip_box_pixel(t, srgb, row0 + c0, row0 + c1, row1 + c0, row1 + c1,
+                    out + x * MIP_PIXEL_SIZE);
+    }
+  }
+}
+
+// Sums 6 pixels of 4 floats, the i-th at in + index(i) * stride
+template <typename F>
+NS_INLINE void mip_kaiser_sum(mip_tables const &t, f32 const *in, F index,
+                              bool simd, f32 *out) {
+#if defined(NS_USE_SIMD)
+  if (simd) {
+    __m128 sum = _mm_setzero_ps();
+    for (u32 k = 0; k < MIP_KAISER_TAP_COUNT; k++) {
+      sum = simd_madd(_mm_loadu_ps(in + index(k)), _mm_set1_ps(t.kaiser[k]),
+                      sum);
+    }
+    _mm_storeu_ps(out, sum);
+    return;
+  }
+#else
+  (void)simd;
+#endif
+  for (u32 c = 0; c < MIP_PIXEL_SIZE; c++) {
+    f32 sum = 0.0f;
+    for (u32 k = 0; k < MIP_KAISER_TAP_COUNT; k++) {
+      sum += in[index(k) + c] * t.kaiser[k];
+    }
+    out[c] = sum;
+  }
+}
+
+// Separable: the source rows of the band are filtered horizontally, then the
+// columns of the result
+static void mip_kaiser_band(mip_tables const &t, mip_band const *b) {
+  bool srgb = b->config->srgb;
+  u32 src_width = b->src_width;
+  u32 width = b->width;
+  u32 first_row = mip_clamp_index(2 * static_cast<i64>(b->row_begin) - 2,
+                                  b->src_height);
+  u32 last_row = mip_clamp_index(2 * static_cast<i64>(b->row_end - 1) + 3,
+                                 b->src_height);
+  u32 row_count = last_row - first_row + 1;
+  usize row_size = static_cast<usize>(width) * MIP_PIXEL_SIZE;
+
+  // Not the engine allocator: the bands run on several threads
+  f32 *decoded = reinterpret_cast<f32 *>(platform::allocate_memory(
+      sizeof(f32) * src_width * MIP_PIXEL_SIZE, false));
+  f32 *filtered = reinterpret_cast<f32 *>(
+      platform::allocate_memory(sizeof(f32) * row_size * row_count, false));
+  f32 const *color = srgb ? t.srgb_to_linear : t.unorm_to_float;
+
+  for (u32 r = 0; r < row_count; r++) {
+    u8 const *in = b->src + static_cast<usize>(first_row + r) * src_width *
+                                MIP_PIXEL_SIZE;
+    for (usize i = 0; i < static_cast<usize>(src_width) * MIP_PIXEL_SIZE;
+         i += MIP_PIXEL_SIZE) {
+      decoded[i + 0] = color[in[i + 0]];
+      decoded[i + 1] = color[in[i + 1]];
+      decoded[i + 2] = color[in[i + 2]];
+      decoded[i + 3] = t.unorm_to_float[in[i + 3]];
+    }
+    f32 *out = filtered + r * row_size;
+    for (u32 x = 0; x < width; x++) {
+      auto column = [x, src_width](u32 k) {
+        return mip_clamp_index(2 * static_cast<i64>(x) - 2 + k, src_width) *
+               MIP_PIXEL_SIZE;
+      };
+      mip_kaiser_sum(t, decoded, column, b->simd, out + x * MIP_PIXEL_SIZE);
+    }
+  }
+
+  for (u32 y = b->row_begin; y < b->row_end; y++) {
+    u8 *out = b->dst + static_cast<usize>(y) * row_size;
+    auto row = [y, first_row, b, row_size](u32 k) {
+      return (mip_clamp_index(2 * static_cast<i64>(y) - 2 + k,
+                              b->src_height) -
+              first_row) *
+             row_size;
+    };
+    for (u32 x = 0; x < width; x++) {
+      f32 pixel[MIP_PIXEL_SIZE];
+      mip_kaiser_sum(t, filtered + x * MIP_PIXEL_SIZE, row, b->simd, pixel);
+#if defined(NS_USE_SIMD)
+      if (b->simd) {
+        mip_encode_pixel_simd(t, srgb, _mm_loadu_ps(pixel),
+                              out + x * MIP_PIXEL_SIZE);
+        continue;
+      }
+#endif
+      mip_encode_pixel(t, srgb, pixel, out + x * MIP_PIXEL_SIZE);
+    }
+  }
+
+  platform::free_memory(filtered, false);
+  platform::free_memory(decoded, false);
+}
+
+static void mip_filter_band(mip_band const *band) {
+  mip_tables const &t = mip_get_tables();
+  if (band->config->filter == MipFilter::KAISER) {
+    mip_kaiser_band(t, band);
+  } else {
+    mip_box_band(t, band);
+  }
+}
+
+// user_data is the band of the whole level
+static void mip_filter_rows(ptr user_data, u32 row_begin, u32 row_end) {
+  mip_band band = *reinterpret_cast<mip_band const *>(user_data);
+  band.row_begin = row_begin;
+  band.row_end = row_end;
+  mip_filter_band(&band);
+}
+
+static void mip_run(u8 *levels, u32 width, u32 height, u32 count,
+                    mip_config const *config, u32 thread_count, bool simd) {
+  u32 max_count = mip_count(width, height);
+  count = count < max_count ? count : max_count;
+  u8 const *src = levels;
+  u32 src_width = width;
+  u32 src_height = height;
+  for (u32 level = 1; level < count; level++) {
+    u32 w = src_width / 2 > 0 ? src_width / 2 : 1;
+    u32 h = src_height / 2 > 0 ? src_height / 2 : 1;
+    u8 *dst = levels + mip_chain_size(width, height, level);
+    mip_band level_band = {src, dst, src_width, src_height, w, h, 0, h,
+                           config, simd};
+    row_bands_run(h, w, MIP_BAND_MIN_PIXEL_COUNT, thread_count,
+                  mip_filter_rows, &level_band);
+
+    src = dst;
+    src_width = w;
+    src_height = h;
+  }
+}
+
+u32 mip_count(u32 width, u32 height) {
+  u32 size = width > height ? width : height;
+  u32 count = 1;
+  while (size > 1) {
+    size >>= 1;
+    count++;
+  }
+  return count;
+}
+
+u64 mip_chain_size(u32 width, u32 height, u32 count) {
+  u64 size = 0;
+  for (u32 i = 0; i < count; i++) {
+    u64 w = width >> i > 0 ? width >> i : 1;
+    u64 h = height >> i > 0 ? height >> i : 1;
+    size += w * h * MIP_PIXEL_SIZE;
+  }
+  return size;
+}
+
+void mip_generate(u8 *levels, u32 width, u32 height, u32 count,
+                  mip_config const *config) {
+  NS_PROFILE_FUNCTION();
+  mip_run(levels, width, height, count, config, config->thread_count, true);
+}
+
+void mip_generate_reference(u8 *levels, u32 width, u32 height, u32 count,
+                            mip_config const *config) {
+  mip_run(levels, width, height, count, config, 1, false);
+}
+
+} // namespace ns
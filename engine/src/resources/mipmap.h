@@ -0,0 +1,79 @@
+#ifndef MIPMAP_HEADER_INCLUDED
+#define MIPMAP_HEADER_INCLUDED
+
+#include "../defines.h"
+
+// CPU generation of the mip chains of the images, at import time.
+//
+// The levels of an image are RGBA, stored one after the other. Each one is
+// half the size of the previous one (rounded down, at least 1), down to 1x1:
+//   level 0    width x height
+//   level 1    max(width / 2, 1) x max(height / 2, 1)
+//   ...
+// A level is filtered from the previous one. The color of sRGB images is
+// filtered in linear space, alpha is always linear. The box filter drops the
+// last column (row) of an odd width (height); the Kaiser filter reads past
+// the edges by clamping.
+//
+// A level is split in bands of rows filtered by different threads (see
+// row_bands.h).
+
+namespace ns {
+
+#define MIP_MAX_LEVEL_COUNT 32
+
+enum class MipFilter {
+  // 2x2 average: fast, blurs a bit and aliases a bit
+  BOX,
+  // Kaiser-windowed sinc over 6x6 texels: sharper, for a few times the cost
+  KAISER,
+};
+
+struct mip_config {
+  MipFilter filter;
+  // Whether the color channels are sRGB encoded
+  bool srgb;
+  // 0 for one per core
+  u32 thread_count;
+};
+
+/**
+ * Gets the number of levels of a full chain
+ * @param width the width of level 0
+ * @param height the height of level 0
+ * @returns the number of levels, down to 1x1
+ */
+NS_API u32 mip_count(u32 width, u32 height);
+
+/**
+ * Gets the size of the first levels of a chain
+ * @param width the width of level 0
+ * @param height the height of level 0
+ * @param count the number of levels
+ * @returns the size of the levels, in bytes
+ */
+NS_API u64 mip_chain_size(u32 width, u32 height, u32 count);
+
+/**
+ * Generates the levels of a chain from its level 0
+ * @param levels the levels, mip_chain_size(width, height, count) bytes.
+ *               Level 0 is read, the others are written.
+ * @param width the width of level 0
+ * @param height the height of level 0
+ * @param count the number of levels, at most mip_count(width, height)
+ * @param config the filter
+ */
+NS_API void mip_generate(u8 *levels, u32 width, u32 height, u32 count,
+                         mip_config const *config);
+
+/**
+ * Generates the levels of a chain as mip_generate does, with the scalar code
+ * on the calling thread. The results differ by at most 1 per channel (the
+ * SIMD code may fuse the multiply-adds).
+ */
+NS_API void mip_generate_reference(u8 *levels, u32 width, u32 height,
+                                   u32 count, mip_config const *config);
+
+} // namespace ns
+
+#endif // MIPMAP_HEADER_INCLUDED
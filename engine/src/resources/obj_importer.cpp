@@ -0,0 +1,495 @@
+#include "./obj_importer.h"
+
+#include "../core/logger.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
+#include "../platform/platform.h"
+#include "../systems/geometry_system.h"
+#include "./loaders/mesh_loader.h"
+#include "./mesh_optimizer.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace ns {
+
+// Texcoord or normal of a corner that has none
+#define OBJ_NO_INDEX 0xFFFFFFFFu
+#define OBJ_MIN_SLOT_COUNT (1u << 12)
+// Digits of a u64 that cannot overflow
+#define OBJ_MAX_MANTISSA_DIGITS 19
+
+struct obj_corner {
+  u32 position;
+  u32 texcoord;
+  u32 normal;
+};
+
+// Growable array of the importer. Not the engine allocator: the importer
+// runs on any thread.
+template <typename T> struct obj_array {
+  T *data;
+  u32 count;
+  u32 capacity;
+
+  void push(T const &value) {
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 1024;
+      data = reinterpret_cast<T *>(
+          platform::reallocate_memory(data, sizeof(T) * capacity, false));
+    }
+    data[count++] = value;
+  }
+
+  void release() {
+    platform::free_memory(data, false);
+    data = nullptr;
+    count = capacity = 0;
+  }
+};
+
+// The distinct corners: corners[i] is the corner of vertex i. The slots are
+// an open addressing table of vertex index + 1 (0 when empty), hashed
+// corner, linear probing, at most half full.
+struct obj_vertex_map {
+  obj_array<obj_corner> corners;
+  u32 *slots;
+  u32 slot_count;
+};
+
+struct obj_state {
+  cstr path;
+  u32 line;
+  obj_array<vec3> positions;
+  obj_array<vec2> texcoords;
+  obj_array<vec3> normals;
+  obj_vertex_map vertices;
+  obj_array<u32> indices;
+};
+
+static const f64 obj_powers_of_10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+NS_INLINE bool obj_is_digit(char c) { return c >= '0' && c <= '9'; }
+
+NS_INLINE cstr obj_skip_spaces(cstr p, cstr end) {
+  while (p < end && (*p == ' ' || *p == '\t')) {
+    p++;
+  }
+  return p;
+}
+
+// Parses a decimal number: the mantissa is read as an integer and scaled
+// once, much faster than strtof and independent of the locale. Returns the
+// end of the number, nullptr if there is none.
+static cstr obj_parse_f32(cstr p, cstr end, f32 *out) {
+  p = obj_skip_spaces(p, end);
+  bool negative = p < end && *p == '-';
+  if (p < end && (*p == '-' || *p == '+')) {
+    p++;
+  }
+  u64 mantissa = 0;
+  i32 exponent = 0;
+  u32 digit_count = 0;
+  bool has_digits = false;
+  for (; p < end && obj_is_digit(*p); p++) {
+    has_digits = true;
+    if (digit_count < OBJ_MAX_MANTISSA_DIGITS) {
+      mantissa = mantissa * 10 + static_cast<u64>(*p - '0');
+      digit_count += mantissa > 0;
+    } else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && obj_is_digit(*p); p++) {
+      has_digits = true;
+      if (digit_count < OBJ_MAX_MANTISSA_DIGITS) {
+        mantissa = mantissa * 10 + static_cast<u64>(*p - '0');
+        digit_count += mantissa > 0;
+        exponent--;
+      }
+    }
+  }
+  if (!has_digits) {
+    return nullptr;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    p++;
+    bool negative_exponent = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+      p++;
+    }
+    if (p == end || !obj_is_digit(*p)) {
+      return nullptr;
+    }
+    i32 e = 0;
+    for (; p < end && obj_is_digit(*p); p++) {
+      e = e < 1000 ? e * 10 + (*p - '0') : e;
+    }
+    exponent += negative_exponent ? -e : e;
+  }
+  f64 value = static_cast<f64>(mantissa);
+  if (exponent < -22 || exponent > 22) {
+    value *= std::pow(10.0, exponent);
+  } else if (exponent < 0) {
+    value /= obj_powers_of_10[-exponent];
+  } else {
+    value *= obj_powers_of_10[exponent];
+  }
+  *out = static_cast<f32>(negative ? -value : value);
+  return p;
+}
+
+// Parses an index of a face and makes it 0-based: negative ones count from
+// the end of the count elements read so far. Returns nullptr if there is no
+// index or it is out of range.
+static cstr obj_parse_index(cstr p, cstr end, u32 count, u32 *out) {
+  bool negative = p < end && *p == '-';
+  if (negative) {
+    p++;
+  }
+  if (p == end || !obj_is_digit(*p)) {
+    return nullptr;
+  }
+  u64 value = 0;
+  for (; p < end && obj_is_digit(*p); p++) {
+    value = value <= 0xFFFFFFFFull ? value * 10 + (*p - '0') : value;
+  }
+  if (value == 0 || value > count) {
+    return nullptr;
+  }
+  *out = static_cast<u32>(negative ? count - value : value - 1);
+  return p;
+}
+
+NS_INLINE u32 obj_corner_hash(obj_corner const &c) {
+  u32 h = c.position * 0x9E3779B1u ^ c.texcoord * 0x85EBCA77u ^
+          c.normal * 0xC2B2AE3Du;
+  return h ^ (h >> 15);
+}
+
+NS_INLINE bool obj_corner_eq(obj_corner const &a, obj_corner const &b) {
+  return a.position == b.position && a.texcoord == b.texcoord &&
+         a.normal == b.normal;
+}
+
+static void obj_vertex_map_grow(obj_vertex_map *map) {
+  platform::free_memory(map->slots, false);
+  map->slot_count =
+      map->slot_count ? map->slot_count * 2 : OBJ_MIN_SLOT_COUNT;
+  map->slots = reinterpret_cast<u32 *>(
+      platform::allocate_memory(sizeof(u32) * map->slot_count, false));
+  platform::zero_memory(map->slots, sizeof(u32) * map->slot_count);
+  u32 mask = map->slot_count - 1;
+  for (u32 i = 0; i < map->corners.count; i++) {
+    u32 slot = obj_corner_hash(map->corners.data[i]) & mask;
+    while (map->slots[slot]) {
+      slot = (slot + 1) & mask;
+    }
+    map->slots[slot] = i + 1;
+  }
+}
+
+// Gets the vertex of a corner, adding it if it is new
+static u32 obj_vertex_map_insert(obj_vertex_map *map, obj_corner const &c) {
+  if ((map->corners.count + 1) * 2 > map->slot_count) {
+    obj_vertex_map_grow(map);
+  }
+  u32 mask = map->slot_count - 1;
+  u32 slot = obj_corner_hash(c) & mask;
+  while (map->slots[slot]) {
+    u32 vertex = map->slots[slot] - 1;
+    if (obj_corner_eq(map->corners.data[vertex], c)) {
+      return vertex;
+    }
+    slot = (slot + 1) & mask;
+  }
+  map->corners.push(c);
+  map->slots[slot] = map->corners.count;
+  return map->corners.count - 1;
+}
+
+static bool obj_parse_vec(obj_state *state, cstr p, cstr end, u32 count,
+                          f32 *out) {
+  for (u32 i = 0; i < count; i++) {
+    p = obj_parse_f32(p, end, &out[i]);
+    if (!p) {
+      NS_ERROR("obj_import - Invalid number in '%s:%u'", state->path,
+               state->line);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Parses the corners of a face, triangulated as a fan around the first one
+static bool obj_parse_face(obj_state *state, cstr p, cstr end) {
+  u32 first = 0;
+  u32 previous = 0;
+  u32 corner_count = 0;
+  for (;;) {
+    p = obj_skip_spaces(p, end);
+    if (p == end || *p == '\r' || *p == '#') {
+      break;
+    }
+    obj_corner c = {0, OBJ_NO_INDEX, OBJ_NO_INDEX};
+    p = obj_parse_index(p, end, state->positions.count, &c.position);
+    if (p && p < end && *p == '/') {
+      p++;
+      if (p < end && *p != '/') {
+        p = obj_parse_index(p, end, state->texcoords.count, &c.texcoord);
+      }
+      if (p && p < end && *p == '/') {
+        p = obj_parse_index(p + 1, end, state->normals.count, &c.normal);
+      }
+    }
+    if (!p || (p < end && *p != ' ' && *p != '\t' && *p != '\r')) {
+      NS_ERROR("obj_import - Invalid face corner in '%s:%u'", state->path,
+               state->line);
+      return false;
+    }
+    u32 vertex = obj_vertex_map_insert(&state->vertices, c);
+    if (corner_count == 0) {
+      first = vertex;
+    } else if (corner_count >= 2) {
+      state->indices.push(first);
+      state->indices.push(previous);
+      state->indices.push(vertex);
+    }
+    previous = vertex;
+    corner_count++;
+  }
+  if (corner_count < 3) {
+    NS_ERROR("obj_import - Face with less than 3 corners in '%s:%u'",
+             state->path, state->line);
+    return false;
+  }
+  return true;
+}
+
+static bool obj_parse(obj_state *state, cstr text, usize size) {
+  cstr p = text;
+  cstr end = text + size;
+  state->line = 1;
+  while (p < end) {
+    cstr eol = reinterpret_cast<cstr>(std::memchr(p, '\n', end - p));
+    eol = eol ? eol : end;
+    p = obj_skip_spaces(p, eol);
+    bool ok = true;
+    if (eol - p >= 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+      vec3 v;
+      ok = obj_parse_vec(state, p + 1, eol, 3, v.elements);
+      state->positions.push(v);
+    } else if (eol - p >= 3 && p[0] == 'v' && p[1] == 't' &&
+               (p[2] == ' ' || p[2] == '\t')) {
+      vec2 t;
+      ok = obj_parse_vec(state, p + 2, eol, 2, t.elements);
+      state->texcoords.push(t);
+    } else if (eol - p >= 3 && p[0] == 'v' && p[1] == 'n' &&
+               (p[2] == ' ' || p[2] == '\t')) {
+      vec3 n;
+      ok = obj_parse_vec(state, p + 2, eol, 3, n.elements);
+      state->normals.push(n);
+    } else if (eol - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+      ok = obj_parse_face(state, p + 1, eol);
+    }
+    if (!ok) {
+      return false;
+    }
+    p = eol + 1;
+    state->line++;
+  }
+  return true;
+}
+
+NS_INLINE vec3 obj_normalized(vec3 v, vec3 fallback) {
+  f32 length_sq = v.length_sq();
+  return length_sq > 1e-20f ? v / std::sqrt(length_sq) : fallback;
+}
+
+// The normals of the corners without one: area-weighted sum of the faces
+// around their position, so that they are smooth across texcoord seams
+static vec3 *obj_position_normals(obj_state const *state,
+                                  vertex_3d const *vertices) {
+  usize size = sizeof(vec3) * state->positions.count;
+  vec3 *normals =
+      reinterpret_cast<vec3 *>(platform::allocate_memory(size, false));
+  platform::zero_memory(normals, size);
+  obj_corner const *corners = state->vertices.corners.data;
+  u32 const *indices = state->indices.data;
+  for (u32 i = 0; i < state->indices.count; i += 3) {
+    vec3 const &p0 = vertices[indices[i]].position;
+    vec3 const &p1 = vertices[indices[i + 1]].position;
+    vec3 const &p2 = vertices[indices[i + 2]].position;
+    // Twice the area long
+    vec3 n = (p1 - p0).cross(p2 - p0);
+    for (u32 k = 0; k < 3; k++) {
+      normals[corners[indices[i + k]].position] += n;
+    }
+  }
+  return normals;
+}
+
+// Tangent frames: the normal of the corner, and the directions of
+// increasing u (tangent) and v (bitangent) summed over the faces of the
+// vertex, made orthogonal to the normal
+static void obj_build_frames(obj_state const *state,
+                             vertex_3d const *vertices,
+                             vertex_3d_frame *frames) {
+  u32 vertex_count = state->vertices.corners.count;
+  obj_corner const *corners = state->vertices.corners.data;
+  bool missing_normals = false;
+  for (u32 i = 0; i < vertex_count; i++) {
+    missing_normals |= corners[i].normal == OBJ_NO_INDEX;
+  }
+  vec3 *position_normals =
+      missing_normals ? obj_position_normals(state, vertices) : nullptr;
+
+  usize directions_size = sizeof(vec3) * 2 * vertex_count;
+  vec3 *directions = reinterpret_cast<vec3 *>(
+      platform::allocate_memory(directions_size, false));
+  platform::zero_memory(directions, directions_size);
+  u32 const *indices = state->indices.data;
+  for (u32 i = 0; i < state->indices.count; i += 3) {
+    vertex_3d const &v0 = vertices[indices[i]];
+    vertex_3d const &v1 = vertices[indices[i + 1]];
+    vertex_3d const &v2 = vertices[indices[i + 2]];
+    vec3 e1 = v1.position - v0.position;
+    vec3 e2 = v2.position - v0.position;
+    f32 du1 = v1.texcoord.x - v0.texcoord.x;
+    f32 dv1 = v1.texcoord.y - v0.texcoord.y;
+    f32 du2 = v2.texcoord.x - v0.texcoord.x;
+    f32 dv2 = v2.texcoord.y - v0.texcoord.y;
+    f32 det = du1 * dv2 - du2 * dv1;
+    if (std::fabs(det) < 1e-20f) {
+      continue;
+    }
+    vec3 tangent = (e1 * dv2 - e2 * dv1) / det;
+    vec3 bitangent = (e2 * du1 - e1 * du2) / det;
+    for (u32 k = 0; k < 3; k++) {
+      directions[indices[i + k] * 2] += tangent;
+      directions[indices[i + k] * 2 + 1] += bitangent;
+    }
+  }
+
+  for (u32 i = 0; i < vertex_count; i++) {
+    vec3 n = corners[i].normal != OBJ_NO_INDEX
+                 ? state->normals.data[corners[i].normal]
+                 : position_normals[corners[i].position];
+    n = obj_normalized(n, {0.0f, 0.0f, 1.0f});
+    vec3 t = directions[i * 2];
+    t = t - n * n.dot(t);
+    // No texcoords: any direction of the tangent plane
+    vec3 axis = std::fabs(n.x) < 0.9f ? vec3{1.0f, 0.0f, 0.0f}
+                                      : vec3{0.0f, 1.0f, 0.0f};
+    t = obj_normalized(t, obj_normalized(axis - n * n.dot(axis), axis));
+    frames[i].normal = n;
+    frames[i].tangent = t;
+    frames[i].handedness =
+        n.cross(t).dot(directions[i * 2 + 1]) < 0.0f ? -1.0f : 1.0f;
+  }
+
+  platform::free_memory(directions, false);
+  if (position_normals) {
+    platform::free_memory(position_normals, false);
+  }
+}
+
+// Reorders the triangles for the vertex cache, then the vertices (their
+// corners) in order of first use
+static void obj_optimize(obj_state *state) {
+  u32 vertex_count = state->vertices.corners.count;
+  mesh_optimize_vertex_cache(state->indices.data, state->indices.count,
+                             vertex_count);
+  u32 *remap = reinterpret_cast<u32 *>(
+      platform::allocate_memory(sizeof(u32) * vertex_count, false));
+  mesh_optimize_vertex_fetch(state->indices.data, state->indices.count,
+                             vertex_count, remap);
+  obj_corner *corners = reinterpret_cast<obj_corner *>(
+      platform::allocate_memory(sizeof(obj_corner) * vertex_count, false));
+  mesh_remap_vertices(state->vertices.corners.data, vertex_count,
+                      sizeof(obj_corner), remap, corners);
+  std::memcpy(state->vertices.corners.data, corners,
+              sizeof(obj_corner) * vertex_count);
+  platform::free_memory(corners, false);
+  platform::free_memory(remap, false);
+}
+
+// Lays the mesh out as its .nsmesh file
+static u8 *obj_build_binary(obj_state const *state, u64 *out_size) {
+  u32 vertex_count = state->vertices.corners.count;
+  u32 index_count = state->indices.count;
+  u32 index_size = geometry_index_size(vertex_count);
+  u64 size = mesh_binary_size(vertex_count, index_count, index_size);
+  u8 *data =
+      reinterpret_cast<u8 *>(platform::allocate_memory(size, false));
+
+  auto header = reinterpret_cast<mesh_binary_header *>(data);
+  auto vertices =
+      reinterpret_cast<vertex_3d *>(data + sizeof(mesh_binary_header));
+  auto frames = reinterpret_cast<vertex_3d_frame *>(vertices + vertex_count);
+  u8 *indices = reinterpret_cast<u8 *>(frames + vertex_count);
+
+  obj_corner const *corners = state->vertices.corners.data;
+  for (u32 i = 0; i < vertex_count; i++) {
+    vertices[i].position = state->positions.data[corners[i].position];
+    vertices[i].texcoord = corners[i].texcoord != OBJ_NO_INDEX
+                               ? state->texcoords.data[corners[i].texcoord]
+                               : vec2();
+  }
+  obj_build_frames(state, vertices, frames);
+  if (index_size == sizeof(u16)) {
+    geometry_indices_to_u16(state->indices.data, index_count,
+                            reinterpret_cast<u16 *>(indices));
+  } else {
+    std::memcpy(indices, state->indices.data, sizeof(u32) * index_count);
+  }
+
+  aabb bounds =
+      aabb::from_points(&vertices->position, vertex_count, sizeof(vertex_3d));
+  *header = {};
+  header->magic = MESH_BINARY_MAGIC;
+  header->version = MESH_BINARY_VERSION;
+  header->vertex_count = vertex_count;
+  header->index_count = index_count;
+  header->index_size = index_size;
+  for (u32 i = 0; i < 3; i++) {
+    header->bounds_min[i] = bounds.min[i];
+    header->bounds_max[i] = bounds.max[i];
+  }
+  *out_size = size;
+  return data;
+}
+
+bool obj_import(cstr text, usize size, cstr path, MeshResourceData *out) {
+  NS_PROFILE_FUNCTION();
+  obj_state state = {};
+  state.path = path;
+  bool ok = obj_parse(&state, text, size);
+  if (ok && state.indices.count == 0) {
+    NS_ERROR("obj_import - '%s' has no triangle", path);
+    ok = false;
+  }
+  if (ok) {
+    obj_optimize(&state);
+    u64 binary_size = 0;
+    u8 *binary = obj_build_binary(&state, &binary_size);
+    ok = mesh_binary_view(binary, binary_size, out);
+    if (!ok) {
+      platform::free_memory(binary, false);
+    }
+  }
+
+  state.positions.release();
+  state.texcoords.release();
+  state.normals.release();
+  state.vertices.corners.release();
+  platform::free_memory(state.vertices.slots, false);
+  state.indices.release();
+  return ok;
+}
+
+} // namespace ns
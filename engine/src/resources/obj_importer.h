@@ -0,0 +1,37 @@
+#ifndef OBJ_IMPORTER_HEADER_INCLUDED
+#define OBJ_IMPORTER_HEADER_INCLUDED
+
+#include "./resource_types.h"
+
+// Import of Wavefront OBJ files as static meshes.
+//
+// Read: v (x y z), vt (u v), vn (x y z) and f (polygons, triangulated as
+// fans; p, p/t, p//n or p/t/n corners, negative indices relative to the end).
+// The other statements (o, g, s, usemtl, mtllib...) are ignored: a file is
+// one mesh with one material.
+//
+// A vertex is emitted for each distinct p/t/n corner, found with a hash map.
+// The corners without a normal get the area-weighted average of the normals
+// of the faces around their position; the tangents follow the texcoords
+// (orthogonalized against the normal). The triangles are then reordered for
+// the vertex cache, and the vertices in order of first use (see
+// mesh_optimizer.h).
+
+namespace ns {
+
+/**
+ * Imports an OBJ file. Can be called from any thread.
+ * @param text the content of the file
+ * @param size the size of the content
+ * @param path the path of the file, for the messages
+ * @param out the mesh. Its data is the image of its .nsmesh file (see
+ *            mesh_loader.h, with no source key), a platform allocation freed
+ *            with mesh_loader_free.
+ * @returns false (logged) if the file is invalid or has no triangle
+ */
+NS_API bool obj_import(cstr text, usize size, cstr path,
+                       MeshResourceData *out);
+
+} // namespace ns
+
+#endif // OBJ_IMPORTER_HEADER_INCLUDED
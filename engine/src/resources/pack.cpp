@@ -0,0 +1,285 @@
+#include "./pack.h"
+
+#include "../core/logger.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
+#include "../core/string.h"
+#include "./lz4.h"
+
+namespace ns {
+
+NS_INLINE u64 pack_align(u64 offset) {
+  return (offset + PACK_ALIGNMENT - 1) & ~static_cast<u64>(PACK_ALIGNMENT - 1);
+}
+
+u64 pack_hash(cstr name) {
+  u64 hash = 0xCBF29CE484222325ull;
+  for (u8 const *c = reinterpret_cast<u8 const *>(name); *c; c++) {
+    hash ^= *c;
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Everything the lookups read is checked here, so that a truncated or
+// corrupted pack is an error instead of a crash.
+static bool pack_validate(pack const *p, cstr path) {
+  usize size = p->file.size;
+  pack_header const *h = p->header;
+  if (size < sizeof(pack_header) || h->magic != PACK_MAGIC) {
+    NS_ERROR("pack_open - '%s' is not a pack", path);
+    return false;
+  }
+  if (h->version != PACK_VERSION) {
+    NS_ERROR("pack_open - '%s' has version %u, expected %u", path, h->version,
+             PACK_VERSION);
+    return false;
+  }
+  bool toc_valid =
+      h->file_size == size && h->slot_count > h->entry_count &&
+      (h->slot_count & (h->slot_count - 1)) == 0 && h->slots_offset % 4 == 0 &&
+      h->entries_offset % 8 == 0 && h->slots_offset <= size &&
+      (size - h->slots_offset) / sizeof(u32) >= h->slot_count &&
+      h->entries_offset <= size &&
+      (size - h->entries_offset) / sizeof(pack_entry) >= h->entry_count &&
+      h->names_offset <= size;
+  if (!toc_valid) {
+    NS_ERROR("pack_open - '%s' has an invalid table of contents", path);
+    return false;
+  }
+
+  usize names_size = size - h->names_offset;
+  for (u32 i = 0; i < h->entry_count; i++) {
+    pack_entry const *e = &p->entries[i];
+    bool entry_valid =
+        e->offset <= size && e->stored_size <= size - e->offset &&
+        e->name_offset < names_size &&
+        (e->compression == PackCompression::LZ4 ||
+         (e->compression == PackCompression::NONE &&
+          e->stored_size == e->size));
+    if (entry_valid) {
+      // The name ends in the file
+      cstr name = p->names + e->name_offset;
+      usize max_length = names_size - e->name_offset;
+      usize length = 0;
+      while (length < max_length && name[length] != '\0') {
+        length++;
+      }
+      entry_valid = length < max_length;
+    }
+    if (!entry_valid) {
+      NS_ERROR("pack_open - '%s' has an invalid entry %u", path, i);
+      return false;
+    }
+  }
+
+  // Lookups stop on an empty slot: there must be one
+  u32 used_slots = 0;
+  for (u32 i = 0; i < h->slot_count; i++) {
+    if (p->slots[i] == INVALID_ID) {
+      continue;
+    }
+    if (p->slots[i] >= h->entry_count) {
+      NS_ERROR("pack_open - '%s' has an invalid slot %u", path, i);
+      return false;
+    }
+    used_slots++;
+  }
+  if (used_slots != h->entry_count) {
+    NS_ERROR("pack_open - '%s' has an invalid table of contents", path);
+    return false;
+  }
+  return true;
+}
+
+bool pack_open(cstr path, pack *out_pack) {
+  NS_PROFILE_FUNCTION();
+  mem_zero(out_pack, sizeof(pack));
+  if (!fs::map(path, &out_pack->file)) {
+    return false;
+  }
+  u8 const *data = out_pack->file.data;
+  out_pack->header = reinterpret_cast<pack_header const *>(data);
+  if (out_pack->file.size >= sizeof(pack_header)) {
+    pack_header const *h = out_pack->header;
+    out_pack->slots = reinterpret_cast<u32 const *>(data + h->slots_offset);
+    out_pack->entries =
+        reinterpret_cast<pack_entry const *>(data + h->entries_offset);
+    out_pack->names = reinterpret_cast<char const *>(data + h->names_offset);
+  }
+  if (!pack_validate(out_pack, path)) {
+    pack_close(out_pack);
+    return false;
+  }
+  return true;
+}
+
+void pack_close(pack *p) {
+  fs::unmap(&p->file);
+  mem_zero(p, sizeof(pack));
+}
+
+pack_entry const *pack_find(pack const *p, cstr name) {
+  u64 hash = pack_hash(name);
+  u32 mask = p->header->slot_count - 1;
+  for (u32 i = static_cast<u32>(hash) & mask;; i = (i + 1) & mask) {
+    u32 index = p->slots[i];
+    if (index == INVALID_ID) {
+      return nullptr;
+    }
+    pack_entry const *e = &p->entries[index];
+    if (e->hash == hash && string_eq(pack_entry_name(p, e), name)) {
+      return e;
+    }
+  }
+}
+
+bool pack_view(pack const *p, pack_entry const *entry, Slice<u8> *out_view) {
+  if (entry->compression != PackCompression::NONE) {
+    return false;
+  }
+  *out_view = Slice<u8>::from_parts(p->file.data + entry->offset, entry->size);
+  return true;
+}
+
+bool pack_read(pack const *p, pack_entry const *entry, u8 *out) {
+  u8 const *blob = p->file.data + entry->offset;
+  if (entry->compression == PackCompression::NONE) {
+    mem_copy(out, blob, entry->size);
+    return true;
+  }
+  if (!lz4_decompress(blob, entry->stored_size, out, entry->size)) {
+    NS_ERROR("pack_read - Entry '%s' is corrupted", pack_entry_name(p, entry));
+    return false;
+  }
+  return true;
+}
+
+static bool pack_write_file(cstr path, u8 const *toc, usize toc_size,
+                            pack_source const *sources, u8 *const *compressed,
+                            pack_entry const *entries, u32 count) {
+  static const u8 zeros[PACK_ALIGNMENT] = {};
+  fs::File f;
+  if (!fs::open(path, fs::Mode::WRITE, true, &f)) {
+    return false;
+  }
+  usize written = 0;
+  bool ok = fs::write(&f, toc_size, toc, &written);
+  u64 position = toc_size;
+  for (u32 i = 0; ok && i < count; i++) {
+    pack_entry const *e = &entries[i];
+    ok = fs::write(&f, e->offset - position, zeros, &written);
+    u8 const *blob = compressed[i] ? compressed[i] : sources[i].data;
+    ok = ok && fs::write(&f, e->stored_size, blob, &written);
+    position = e->offset + e->stored_size;
+  }
+  fs::close(&f);
+  if (!ok) {
+    NS_ERROR("pack_write - Failed to write '%s'", path);
+  }
+  return ok;
+}
+
+bool pack_write(cstr path, pack_source const *sources, u32 count,
+                bool compress) {
+  NS_PROFILE_FUNCTION();
+  u32 slot_count = 2;
+  while (slot_count < count * 2) {
+    slot_count *= 2;
+  }
+  usize names_size = 0;
+  for (u32 i = 0; i < count; i++) {
+    names_size += string_length(sources[i].name) + 1;
+  }
+  u64 slots_offset = sizeof(pack_header);
+  u64 entries_offset = slots_offset + sizeof(u32) * slot_count;
+  entries_offset = (entries_offset + 7) & ~7ull;
+  u64 names_offset = entries_offset + sizeof(pack_entry) * count;
+  usize toc_size = names_offset + names_size;
+
+  u8 *toc = reinterpret_cast<u8 *>(ns::alloc(toc_size, MemTag::ARRAY));
+  mem_zero(toc, toc_size);
+  pack_header *header = reinterpret_cast<pack_header *>(toc);
+  u32 *slots = reinterpret_cast<u32 *>(toc + slots_offset);
+  pack_entry *entries = reinterpret_cast<pack_entry *>(toc + entries_offset);
+  char *names = reinterpret_cast<char *>(toc + names_offset);
+  // The compressed blobs, nullptr for the files stored as is
+  u8 **compressed =
+      count > 0 ? ns::alloc_n<u8 *>(count, MemTag::ARRAY) : nullptr;
+  mem_set(slots, 0xFF, sizeof(u32) * slot_count);
+
+  bool ok = true;
+  u64 offset = pack_align(toc_size);
+  u32 name_offset = 0;
+  for (u32 i = 0; i < count; i++) {
+    pack_source const *s = &sources[i];
+    pack_entry *e = &entries[i];
+    compressed[i] = nullptr;
+    e->hash = pack_hash(s->name);
+    e->size = s->size;
+    e->stored_size = s->size;
+    e->compression = PackCompression::NONE;
+    e->name_offset = name_offset;
+    usize name_length = string_length(s->name);
+    mem_copy(names + name_offset, s->name, name_length + 1);
+    name_offset += static_cast<u32>(name_length + 1);
+
+    u32 mask = slot_count - 1;
+    u32 slot = static_cast<u32>(e->hash) & mask;
+    while (ok && slots[slot] != INVALID_ID) {
+      pack_entry const *other = &entries[slots[slot]];
+      if (other->hash == e->hash && string_eq(names + other->name_offset,
+                                              names + e->name_offset)) {
+        NS_ERROR("pack_write - Duplicate entry '%s'", s->name);
+        ok = false;
+      }
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = i;
+
+    if (compress && s->size > 0) {
+      usize capacity = lz4_compress_bound(s->size);
+      u8 *buffer = reinterpret_cast<u8 *>(ns::alloc(capacity, MemTag::ARRAY));
+      usize compressed_size = lz4_compress(s->data, s->size, buffer, capacity);
+      if (compressed_size > 0 && compressed_size <= s->size - s->size / 8) {
+        compressed[i] = buffer;
+        e->stored_size = compressed_size;
+        e->compression = PackCompression::LZ4;
+      } else {
+        ns::free(buffer, capacity, MemTag::ARRAY);
+      }
+    }
+    e->offset = offset;
+    offset = pack_align(offset + e->stored_size);
+  }
+
+  header->magic = PACK_MAGIC;
+  header->version = PACK_VERSION;
+  header->entry_count = count;
+  header->slot_count = slot_count;
+  header->slots_offset = slots_offset;
+  header->entries_offset = entries_offset;
+  header->names_offset = names_offset;
+  // The last blob is not padded
+  header->file_size = count > 0
+                          ? entries[count - 1].offset +
+                                entries[count - 1].stored_size
+                          : toc_size;
+
+  ok = ok && pack_write_file(path, toc, toc_size, sources, compressed, entries,
+                             count);
+
+  for (u32 i = 0; i < count; i++) {
+    if (compressed[i]) {
+      ns::free(compressed[i], lz4_compress_bound(sources[i].size),
+               MemTag::ARRAY);
+    }
+  }
+  if (compressed) {
+    ns::free_n(compressed, count, MemTag::ARRAY);
+  }
+  ns::free(toc, toc_size, MemTag::ARRAY);
+  return ok;
+}
+
+} // namespace ns
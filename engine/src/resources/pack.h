@@ -0,0 +1,144 @@
+#ifndef PACK_HEADER_INCLUDED
+#define PACK_HEADER_INCLUDED
+
+#include "../core/slice.h"
+#include "../platform/filesystem.h"
+
+// .nspak asset archive, mapped in memory once and read in place.
+//
+// Layout (little endian):
+//   pack_header
+//   u32 slots[slot_count]          open addressing table of entry indices,
+//                                  hashed name, linear probing
+//   pack_entry entries[entry_count]
+//   char names[]                   null-terminated entry names
+//   blobs                          each starts on a PACK_ALIGNMENT boundary
+//
+// The entries are named by their path relative to the asset directory, with
+// '/' separators (e.g. "textures/prototype.png").
+
+namespace ns {
+
+#define PACK_MAGIC 0x4B50534Eu // "NSPK"
+#define PACK_VERSION 1
+#define PACK_ALIGNMENT 4096
+
+enum class PackCompression : u32 {
+  NONE = 0,
+  LZ4 = 1,
+};
+
+struct pack_header {
+  u32 magic;
+  u32 version;
+  u32 entry_count;
+  // power of two, at least twice the entry count
+  u32 slot_count;
+  u64 slots_offset;
+  u64 entries_offset;
+  u64 names_offset;
+  u64 file_size;
+};
+
+struct pack_entry {
+  u64 hash;
+  u64 offset;
+  // size of the file
+  u64 size;
+  // size of the blob, size when not compressed
+  u64 stored_size;
+  u32 name_offset;
+  PackCompression compression;
+};
+
+NS_STATIC_ASSERT(sizeof(pack_header) == 48, "pack_header is a file format");
+NS_STATIC_ASSERT(sizeof(pack_entry) == 40, "pack_entry is a file format");
+
+struct pack {
+  fs::MappedFile file;
+  pack_header const *header;
+  u32 const *slots;
+  pack_entry const *entries;
+  char const *names;
+};
+
+/**
+ * A file to put in a pack
+ * @field name the name of the entry
+ * @field data the content of the file
+ * @field size the size of the file
+ */
+struct pack_source {
+  cstr name;
+  u8 const *data;
+  usize size;
+};
+
+/**
+ * Hashes an entry name (64-bit FNV-1a)
+ */
+NS_API u64 pack_hash(cstr name);
+
+/**
+ * Maps a pack and checks its table of contents
+ * @param path the path of the .nspak file
+ * @param out_pack the pack
+ * @returns false if the file can't be mapped or is not a valid pack
+ */
+NS_API bool pack_open(cstr path, pack *out_pack);
+
+/**
+ * Unmaps a pack. The views into it become invalid.
+ */
+NS_API void pack_close(pack *p);
+
+/**
+ * Finds an entry. Only reads the pack: can be called from any thread.
+ * @param p the pack
+ * @param name the name of the entry
+ * @returns the entry, nullptr if there is none with this name
+ */
+NS_API pack_entry const *pack_find(pack const *p, cstr name);
+
+/**
+ * Gets the name of an entry
+ */
+NS_INLINE cstr pack_entry_name(pack const *p, pack_entry const *entry) {
+  return p->names + entry->name_offset;
+}
+
+/**
+ * Gets a view of an uncompressed entry, without copy. The view is aligned on
+ * PACK_ALIGNMENT and valid until the pack is closed.
+ * @param p the pack
+ * @param entry the entry
+ * @param out_view the content of the entry
+ * @returns false if the entry is compressed
+ */
+NS_API bool pack_view(pack const *p, pack_entry const *entry,
+                      Slice<u8> *out_view);
+
+/**
+ * Copies the content of an entry, decompressing it if needed
+ * @param p the pack
+ * @param entry the entry
+ * @param out a buffer of entry->size bytes
+ * @returns false if the compressed data is corrupted
+ */
+NS_API bool pack_read(pack const *p, pack_entry const *entry, u8 *out);
+
+/**
+ * Writes a pack
+ * @param path the path of the .nspak file
+ * @param sources the files, with distinct names
+ * @param count the number of files
+ * @param compress whether to LZ4-compress the files that shrink by at least
+ *        1/8 (the others stay uncompressed, readable without copy)
+ * @returns false if the file can't be written or a name is duplicated
+ */
+NS_API bool pack_write(cstr path, pack_source const *sources, u32 count,
+                       bool compress);
+
+} // namespace ns
+
+#endif // PACK_HEADER_INCLUDED
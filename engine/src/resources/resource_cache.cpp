@@ -0,0 +1,304 @@
+#include "./resource_cache.h"
+
+#include "../core/logger.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
+#include "../core/string.h"
+#include "./pack.h"
+
+namespace ns {
+
+struct resource_cache_entry {
+  // As loaded, with no cache_id: what the unload gets
+  Resource resource;
+  char name[RESOURCE_CACHE_NAME_MAX_LENGTH];
+  u64 hash;
+  u64 size;
+  ResourceType type;
+  u32 loader_id;
+  // 0 when released
+  u32 reference_count;
+  // Released list, or free list (next only)
+  u32 previous;
+  u32 next;
+};
+
+// The entries are found with an open addressing table of entry index + 1
+// (0 when empty), linear probing, at most half full. The released entries
+// are a list from the most recently released (head) to the least (tail).
+struct resource_cache_state {
+  resource_cache_config config;
+  void (*unload)(Resource *resource);
+  resource_cache_entry *entries;
+  u32 *slots;
+  u32 slot_mask;
+  u32 free_head;
+  u32 released_head;
+  u32 released_tail;
+  resource_cache_stats stats;
+};
+
+static u64 resource_cache_hash(cstr name, u32 loader_id) {
+  return pack_hash(name) ^ (static_cast<u64>(loader_id + 1) *
+                            0x9E3779B97F4A7C15ull);
+}
+
+static u32 resource_cache_slot_count(u32 max_entry_count) {
+  u32 count = 16;
+  while (count < max_entry_count * 2) {
+    count *= 2;
+  }
+  return count;
+}
+
+// Slot of an entry, or the empty slot it would go in
+static u32 resource_cache_find_slot(resource_cache_state const *state,
+                                    cstr name, u32 loader_id, u64 hash) {
+  u32 slot = static_cast<u32>(hash) & state->slot_mask;
+  while (state->slots[slot] != 0) {
+    resource_cache_entry const &e = state->entries[state->slots[slot] - 1];
+    if (e.hash == hash && e.loader_id == loader_id &&
+        string_eq(e.name, name)) {
+      break;
+    }
+    slot = (slot + 1) & state->slot_mask;
+  }
+  return slot;
+}
+
+// Backward shift deletion: the next entries of the probe sequence move up,
+// so that no lookup stops at the hole
+static void resource_cache_remove_slot(resource_cache_state *state, u32 hole) {
+  state->slots[hole] = 0;
+  u32 slot = hole;
+  for (;;) {
+    slot = (slot + 1) & state->slot_mask;
+    u32 index = state->slots[slot];
+    if (index == 0) {
+      return;
+    }
+    u32 home = static_cast<u32>(state->entries[index - 1].hash) &
+               state->slot_mask;
+    // Whether home is cyclically in (hole, slot]: then the entry stays
+    bool stays = hole <= slot ? (hole < home && home <= slot)
+                              : (hole < home || home <= slot);
+    if (!stays) {
+      state->slots[hole] = index;
+      state->slots[slot] = 0;
+      hole = slot;
+    }
+  }
+}
+
+static void resource_cache_unlink(resource_cache_state *state, u32 index) {
+  resource_cache_entry &e = state->entries[index];
+  if (e.previous != INVALID_ID) {
+    state->entries[e.previous].next = e.next;
+  } else {
+    state->released_head = e.next;
+  }
+  if (e.next != INVALID_ID) {
+    state->entries[e.next].previous = e.previous;
+  } else {
+    state->released_tail = e.previous;
+  }
+  state->stats.released_count--;
+}
+
+static void resource_cache_evict(resource_cache_state *state, u32 index) {
+  resource_cache_entry &e = state->entries[index];
+  resource_cache_unlink(state, index);
+  resource_cache_remove_slot(
+      state, resource_cache_find_slot(state, e.name, e.loader_id, e.hash));
+  state->unload(&e.resource);
+  state->stats.size -= e.size;
+  state->stats.type_sizes[static_cast<u32>(e.type)] -= e.size;
+  state->stats.entry_count--;
+  state->stats.eviction_count++;
+  e.next = state->free_head;
+  state->free_head = index;
+}
+
+static bool resource_cache_over_budget(resource_cache_state const *state,
+                                       ResourceType type) {
+  u64 type_budget = state->config.type_budgets[static_cast<u32>(type)];
+  return state->stats.size > state->config.budget ||
+         (type_budget > 0 &&
+          state->stats.type_sizes[static_cast<u32>(type)] > type_budget);
+}
+
+// Evicts the least recently released entries of the types over their
+// budget, or of any type when the cache is over its budget
+static void resource_cache_trim(resource_cache_state *state) {
+  u32 index = state->released_tail;
+  while (index != INVALID_ID) {
+    u32 previous = state->entries[index].previous;
+    if (resource_cache_over_budget(state, state->entries[index].type)) {
+      resource_cache_evict(state, index);
+    }
+    index = previous;
+  }
+}
+
+void resource_cache_create(resource_cache_config config,
+                           void (*unload)(Resource *resource),
+                           usize *memory_requirement, void *memory,
+                           resource_cache *out_cache) {
+  u32 slot_count = resource_cache_slot_count(config.max_entry_count);
+  usize entries_requirement =
+      sizeof(resource_cache_entry) * config.max_entry_count;
+  *memory_requirement = sizeof(resource_cache_state) + entries_requirement +
+                        sizeof(u32) * slot_count;
+  if (memory == nullptr) {
+    return;
+  }
+  resource_cache_state *state =
+      reinterpret_cast<resource_cache_state *>(memory);
+  state->config = config;
+  state->unload = unload;
+  state->entries = reinterpret_cast<resource_cache_entry *>(state + 1);
+  state->slots = reinterpret_cast<u32 *>(AS_BYTES(state->entries) +
+                                         entries_requirement);
+  state->slot_mask = slot_count - 1;
+  mem_zero(state->slots, sizeof(u32) * slot_count);
+  for (u32 i = 0; i < config.max_entry_count; i++) {
+    state->entries[i].next =
+        i + 1 < config.max_entry_count ? i + 1 : INVALID_ID;
+  }
+  state->free_head = config.max_entry_count > 0 ? 0 : INVALID_ID;
+  state->released_head = INVALID_ID;
+  state->released_tail = INVALID_ID;
+  state->stats = {};
+  out_cache->memory = memory;
+}
+
+void resource_cache_destroy(resource_cache *cache) {
+  if (!cache || !cache->memory) {
+    return;
+  }
+  resource_cache_state *state =
+      reinterpret_cast<resource_cache_state *>(cache->memory);
+  NS_DEBUG("Resource cache: %llu hits, %llu misses, %llu evictions.",
+           state->stats.hit_count, state->stats.miss_count,
+           state->stats.eviction_count);
+  u32 referenced = state->stats.entry_count - state->stats.released_count;
+  if (referenced > 0) {
+    NS_WARN("resource_cache_destroy - %u resources are still referenced",
+            referenced);
+  }
+  for (u32 slot = 0; slot <= state->slot_mask; slot++) {
+    if (state->slots[slot] != 0) {
+      state->unload(&state->entries[state->slots[slot] - 1].resource);
+    }
+  }
+  cache->memory = nullptr;
+}
+
+bool resource_cache_acquire(resource_cache cache, cstr name, u32 loader_id,
+                            Resource *out_resource) {
+  resource_cache_state *state =
+      reinterpret_cast<resource_cache_state *>(cache.memory);
+  u32 slot = resource_cache_find_slot(state, name, loader_id,
+                                      resource_cache_hash(name, loader_id));
+  if (state->slots[slot] == 0) {
+    state->stats.miss_count++;
+    return false;
+  }
+  u32 index = state->slots[slot] - 1;
+  resource_cache_entry &e = state->entries[index];
+  if (e.reference_count == 0) {
+    resource_cache_unlink(state, index);
+  }
+  e.reference_count++;
+  state->stats.hit_count++;
+  *out_resource = e.resource;
+  out_resource->name = e.name;
+  out_resource->cache_id = index;
+  return true;
+}
+
+void resource_cache_insert(resource_cache cache, cstr name, ResourceType type,
+                           u64 size, Resource *resource) {
+  NS_PROFILE_FUNCTION();
+  resource_cache_state *state =
+      reinterpret_cast<resource_cache_state *>(cache.memory);
+  resource->cache_id = INVALID_ID;
+  if (string_length(name) >= RESOURCE_CACHE_NAME_MAX_LENGTH) {
+    return;
+  }
+  u64 hash = resource_cache_hash(name, resource->loader_id);
+  if (state->slots[resource_cache_find_slot(state, name, resource->loader_id,
+                                            hash)] != 0) {
+    return;
+  }
+  if (state->free_head == INVALID_ID) {
+    if (state->released_tail == INVALID_ID) {
+      NS_WARN("resource_cache_insert - All the %u entries are referenced, "
+              "'%s' is not cached.",
+              state->config.max_entry_count, name);
+      return;
+    }
+    resource_cache_evict(state, state->released_tail);
+  }
+  u32 index = state->free_head;
+  resource_cache_entry &e = state->entries[index];
+  state->free_head = e.next;
+
+  e.resource = *resource;
+  string_ncpy(e.name, name, RESOURCE_CACHE_NAME_MAX_LENGTH);
+  e.resource.name = e.name;
+  e.hash = hash;
+  e.size = size;
+  e.type = type;
+  e.loader_id = resource->loader_id;
+  e.reference_count = 1;
+  e.previous = INVALID_ID;
+  e.next = INVALID_ID;
+  state->slots[resource_cache_find_slot(state, name, e.loader_id, e.hash)] =
+      index + 1;
+  state->stats.entry_count++;
+  state->stats.size += size;
+  state->stats.type_sizes[static_cast<u32>(type)] += size;
+
+  resource->name = e.name;
+  resource->cache_id = index;
+  resource_cache_trim(state);
+}
+
+void resource_cache_release(resource_cache cache, Resource *resource) {
+  resource_cache_state *state =
+      reinterpret_cast<resource_cache_state *>(cache.memory);
+  u32 index = resource->cache_id;
+  resource_cache_entry &e = state->entries[index];
+  resource->full_path[0] = '\0';
+  resource->data = nullptr;
+  resource->data_size = 0;
+  resource->loader_id = INVALID_ID;
+  resource->cache_id = INVALID_ID;
+  if (e.reference_count == 0) {
+    NS_WARN("resource_cache_release - '%s' is already released", e.name);
+    return;
+  }
+  if (--e.reference_count > 0) {
+    return;
+  }
+  e.previous = INVALID_ID;
+  e.next = state->released_head;
+  if (state->released_head != INVALID_ID) {
+    state->entries[state->released_head].previous = index;
+  } else {
+    state->released_tail = index;
+  }
+  state->released_head = index;
+  state->stats.released_count++;
+  resource_cache_trim(state);
+}
+
+resource_cache_stats resource_cache_get_stats(resource_cache cache) {
+  if (!cache.memory) {
+    return {};
+  }
+  return reinterpret_cast<resource_cache_state *>(cache.memory)->stats;
+}
+
+} // namespace ns
@@ -0,0 +1,111 @@
+#ifndef RESOURCE_CACHE_HEADER_INCLUDED
+#define RESOURCE_CACHE_HEADER_INCLUDED
+
+#include "./resource_types.h"
+
+// Reference-counted cache of the loaded resources, so that a resource
+// released then loaded again (a texture swapped back a frame later) is not
+// read and decoded again.
+//
+// The resources are keyed by loader and name. A load of a cached resource
+// is a hit and shares its data; the last release keeps it loaded, in a list
+// of released resources. When the cached resources exceed the budget (or
+// the budget of their type), the least recently released ones are unloaded.
+// The referenced resources are never unloaded: they count in the budget,
+// but can exceed it.
+//
+// Used by the resource system, on the main thread.
+
+namespace ns {
+
+#define RESOURCE_TYPE_COUNT (static_cast<u32>(ResourceType::CUSTOM) + 1)
+// Resources with a longer name are not cached
+#define RESOURCE_CACHE_NAME_MAX_LENGTH 256
+
+/**
+ * @field max_entry_count the maximum number of cached resources, referenced
+ *        or released. 0 for no cache.
+ * @field budget the maximum size of the cached resources, in bytes. 0
+ *        unloads the resources on their last release.
+ * @field type_budgets the maximum size per ResourceType, 0 for no other
+ *        limit than the budget
+ */
+struct resource_cache_config {
+  u32 max_entry_count = 0;
+  u64 budget = 0;
+  u64 type_budgets[RESOURCE_TYPE_COUNT] = {};
+};
+
+struct resource_cache {
+  void *memory;
+};
+
+struct resource_cache_stats {
+  u64 hit_count;
+  u64 miss_count;
+  u64 eviction_count;
+  u32 entry_count;
+  u32 released_count;
+  // size of the cached resources, all types and per ResourceType
+  u64 size;
+  u64 type_sizes[RESOURCE_TYPE_COUNT];
+};
+
+/**
+ * Creates a cache. Call once with memory = nullptr to get the memory
+ * requirement, then with a block of that size.
+ * @param config the size of the cache
+ * @param unload unloads an evicted resource
+ * @param memory_requirement the size of the memory block
+ * @param memory the memory block
+ * @param out_cache the cache
+ */
+NS_API void resource_cache_create(resource_cache_config config,
+                                  void (*unload)(Resource *resource),
+                                  usize *memory_requirement, void *memory,
+                                  resource_cache *out_cache);
+
+/**
+ * Unloads the cached resources
+ */
+NS_API void resource_cache_destroy(resource_cache *cache);
+
+/**
+ * Gets a cached resource, and references it
+ * @param cache the cache
+ * @param name the name of the resource
+ * @param loader_id the loader of the resource
+ * @param out_resource the resource, sharing the data of the cached one
+ * @returns false (a miss) if the resource is not cached
+ */
+NS_API bool resource_cache_acquire(resource_cache cache, cstr name,
+                                   u32 loader_id, Resource *out_resource);
+
+/**
+ * Caches a loaded resource, referenced once. Released resources are evicted
+ * when the cache is full.
+ * @param cache the cache
+ * @param name the name of the resource
+ * @param type the type of its loader
+ * @param size the memory held by the resource, in bytes
+ * @param resource the resource. Its cache_id is INVALID_ID when it can't be
+ *        cached (full of referenced resources, a name too long, or already
+ *        cached: loaded again meanwhile).
+ */
+NS_API void resource_cache_insert(resource_cache cache, cstr name,
+                                  ResourceType type, u64 size,
+                                  Resource *resource);
+
+/**
+ * Releases a reference to a cached resource, and evicts the released
+ * resources over the budgets
+ * @param cache the cache
+ * @param resource the resource (with a cache_id), cleared as an unload does
+ */
+NS_API void resource_cache_release(resource_cache cache, Resource *resource);
+
+NS_API resource_cache_stats resource_cache_get_stats(resource_cache cache);
+
+} // namespace ns
+
+#endif // RESOURCE_CACHE_HEADER_INCLUDED
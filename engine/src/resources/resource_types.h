@@ -1,7 +1,9 @@
 #ifndef RESOURCE_TYPES_HEADER_INCLUDED
 #define RESOURCE_TYPES_HEADER_INCLUDED
 
+#include "../math/bounds.h"
 #include "../math/math.h"
+#include "../platform/filesystem.h"
 
 namespace ns {
 
@@ -15,18 +17,62 @@ enum class ResourceType {
 };
 
 struct Resource {
+  static constexpr usize PATH_MAX_LENGTH = 512;
   u32 loader_id;
   cstr name;
-  pstr full_path;
+  char full_path[PATH_MAX_LENGTH];
   usize data_size;
   ptr data;
+  // data points into the asset pack: read-only, not freed on unload
+  bool data_is_view;
+  // The file data is mapped from (read-only), unmapped on unload instead of
+  // freeing data. Empty when data was read.
+  fs::MappedFile mapped;
+  // Entry of the resource cache (see resource_cache.h) sharing the data,
+  // INVALID_ID when the resource is not cached
+  u32 cache_id;
+};
+
+// Layout of the pixels of an image, or of a texture (see block_compression.h)
+enum class TextureFormat : u32 {
+  // 4 bytes per texel
+  RGBA8,
+  // Blocks of 4x4 texels: 8 bytes, opaque
+  BC1,
+  // Blocks of 4x4 texels: 16 bytes, with alpha
+  BC3,
 };
 
 struct ImageResourceData {
   u8 channel_count;
   u32 width;
   u32 height;
+  TextureFormat format;
+  // Levels of the mip chain in pixels (see mipmap.h)
+  u32 mip_count;
   bytes pixels;
+  // The cached image the pixels point into (read-only), unmapped instead of
+  // freeing them. Empty when the image was decoded.
+  fs::MappedFile cached;
+};
+
+struct MeshResourceData {
+  u32 vertex_count;
+  u32 index_count;
+  // sizeof(u16) or sizeof(u32), see geometry_index_size
+  u32 index_size;
+  aabb bounds;
+  vertex_3d const *vertices;
+  // One per vertex. Not uploaded: the vertex layouts have no normals yet.
+  vertex_3d_frame const *frames;
+  roptr indices;
+  // The .nsmesh image the arrays point into (see mesh_loader.h)
+  u8 const *data;
+  usize data_size;
+  // The cooked file data is mapped from, unmapped instead of freeing it
+  fs::MappedFile cached;
+  // data points into the asset pack: not freed
+  bool data_is_view;
 };
 
 struct Texture {
@@ -35,6 +81,8 @@ struct Texture {
   u32 width;
   u32 height;
   u8 channel_count;
+  TextureFormat format;
+  u32 mip_count;
   bool has_transparency;
   u32 generation;
   char name[NAME_MAX_LENGTH];
@@ -79,6 +127,11 @@ struct Geometry {
   u32 generation;
   char name[NAME_MAX_LENGTH];
   Material *material;
+  // Bounds of the vertices, in model space
+  aabb bounds;
+  // Layout of the vertices in the vertex buffer. Packed positions are
+  // relative to bounds.
+  VertexFormat vertex_format;
 };
 
 } // namespace ns
@@ -0,0 +1,37 @@
+#include "./row_bands.h"
+
+#include <thread>
+
+namespace ns {
+
+void row_bands_run(u32 row_count, u64 row_cost, u64 min_band_cost,
+                   u32 thread_count,
+                   void (*process)(ptr user_data, u32 row_begin, u32 row_end),
+                   ptr user_data) {
+  if (thread_count == 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  thread_count = thread_count > 0 ? thread_count : 1;
+  thread_count = thread_count < ROW_BANDS_MAX_THREAD_COUNT
+                     ? thread_count
+                     : ROW_BANDS_MAX_THREAD_COUNT;
+
+  u64 band_count = row_cost * row_count / min_band_cost;
+  band_count = band_count < thread_count ? band_count : thread_count;
+  band_count = band_count < row_count ? band_count : row_count;
+  band_count = band_count > 0 ? band_count : 1;
+  auto band_begin = [row_count, band_count](u64 band) {
+    return static_cast<u32>(row_count * band / band_count);
+  };
+  std::thread threads[ROW_BANDS_MAX_THREAD_COUNT];
+  for (u32 i = 1; i < band_count; i++) {
+    threads[i] =
+        std::thread(process, user_data, band_begin(i), band_begin(i + 1));
+  }
+  process(user_data, 0, band_begin(1));
+  for (u32 i = 1; i < band_count; i++) {
+    threads[i].join();
+  }
+}
+
+} // namespace ns
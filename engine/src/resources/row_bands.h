@@ -0,0 +1,33 @@
+#ifndef ROW_BANDS_HEADER_INCLUDED
+#define ROW_BANDS_HEADER_INCLUDED
+
+#include "../defines.h"
+
+// Rows of an image split in bands processed by different threads, for the
+// mip generation and the block compression. The calling thread processes the
+// first band, then waits for the others: with a single band, no thread is
+// started.
+
+namespace ns {
+
+#define ROW_BANDS_MAX_THREAD_COUNT 16
+
+/**
+ * Processes the rows [0, row_count) in bands
+ * @param row_count the number of rows
+ * @param row_cost the work of a row, e.g. its pixel count
+ * @param min_band_cost the work under which a band is not worth a thread
+ * @param thread_count the maximum number of threads, 0 for one per core. 1
+ *        from threads already running side by side (the image decoder).
+ * @param process processes the rows [row_begin, row_end), maybe on another
+ *        thread
+ * @param user_data passed to process
+ */
+void row_bands_run(u32 row_count, u64 row_cost, u64 min_band_cost,
+                   u32 thread_count,
+                   void (*process)(ptr user_data, u32 row_begin, u32 row_end),
+                   ptr user_data);
+
+} // namespace ns
+
+#endif // ROW_BANDS_HEADER_INCLUDED
@@ -0,0 +1,283 @@
+#include "./texture_cache.h"
+
+#include "../core/logger.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
+#include "../core/string.h"
+#include "../platform/platform.h"
+#include "./block_compression.h"
+#include "./loaders/loader_utils.h"
+#include "./mipmap.h"
+#include "./pack.h"
+
+#include <mutex>
+#include <new>
+
+namespace ns {
+
+#define TEXTURE_CACHE_MAX_CHANNEL_COUNT 4
+
+// The mutex guards the stats and the trims. The files are written with
+// resource_write_file, so that a reader never maps a partial file.
+struct texture_cache_state {
+  std::mutex mutex;
+  u64 budget;
+  texture_cache_stats stats;
+  char directory[Resource::PATH_MAX_LENGTH];
+};
+
+struct texture_cache_file {
+  char name[64];
+  u64 size;
+  i64 modified_time;
+};
+
+// Files of the cache directory, for a trim
+struct texture_cache_listing {
+  texture_cache_state const *state;
+  texture_cache_file *files;
+  u32 count;
+  u32 capacity;
+};
+
+static void texture_cache_file_path(texture_cache_state const *state,
+                                    cstr source_path, pstr out_path) {
+  string_fmt(out_path, Resource::PATH_MAX_LENGTH, "%s/%016llx%s",
+             state->directory, pack_hash(source_path),
+             TEXTURE_CACHE_EXTENSION);
+}
+
+static bool texture_cache_header_valid(texture_cache_header const *header,
+                                       u64 source_key, u64 file_size) {
+  return header->magic == TEXTURE_CACHE_MAGIC &&
+         header->version == TEXTURE_CACHE_VERSION &&
+         header->source_key == source_key && header->width > 0 &&
+         header->height > 0 && header->channel_count > 0 &&
+         header->channel_count <= TEXTURE_CACHE_MAX_CHANNEL_COUNT &&
+         header->mip_count > 0 &&
+         header->mip_count <= mip_count(header->width, header->height) &&
+         header->format <= static_cast<u32>(TextureFormat::BC3) &&
+         header->pixels_size ==
+             texture_format_chain_size(
+                 static_cast<TextureFormat>(header->format), header->width,
+                 header->height, header->mip_count) &&
+         file_size == sizeof(texture_cache_header) + header->pixels_size;
+}
+
+static void texture_cache_trim_locked(texture_cache_state *state);
+
+texture_cache_header
+texture_cache_header_create(ImageResourceData const *image, u64 source_key) {
+  texture_cache_header header = {};
+  header.magic = TEXTURE_CACHE_MAGIC;
+  header.version = TEXTURE_CACHE_VERSION;
+  header.source_key = source_key;
+  header.width = image->width;
+  header.height = image->height;
+  header.channel_count = image->channel_count;
+  header.mip_count = image->mip_count;
+  header.format = static_cast<u32>(image->format);
+  header.pixels_size = texture_format_chain_size(
+      image->format, image->width, image->height, image->mip_count);
+  return header;
+}
+
+bool texture_cache_view(u8 const *data, usize size, u64 source_key,
+                        ImageResourceData *out) {
+  auto header = reinterpret_cast<texture_cache_header const *>(data);
+  if (size < sizeof(texture_cache_header) ||
+      !texture_cache_header_valid(header, source_key, size)) {
+    return false;
+  }
+  out->width = header->width;
+  out->height = header->height;
+  out->channel_count = static_cast<u8>(header->channel_count);
+  out->format = static_cast<TextureFormat>(header->format);
+  out->mip_count = header->mip_count;
+  // Read-only: the renderer only copies them
+  out->pixels = const_cast<u8 *>(data) + sizeof(texture_cache_header);
+  out->cached = {};
+  return true;
+}
+
+bool texture_cache_create(cstr directory, u64 budget,
+                          usize *memory_requirement, void *memory,
+                          texture_cache *out_cache) {
+  *memory_requirement = sizeof(texture_cache_state);
+  if (memory == nullptr) {
+    return true;
+  }
+  out_cache->memory = nullptr;
+  if (!fs::create_directory(directory)) {
+    NS_ERROR("texture_cache_create - Failed to create the directory '%s'",
+             directory);
+    return false;
+  }
+
+  texture_cache_state *state = new (memory) texture_cache_state();
+  state->budget = budget;
+  state->stats = {};
+  string_ncpy(state->directory, directory, Resource::PATH_MAX_LENGTH);
+  out_cache->memory = memory;
+
+  texture_cache_trim(*out_cache);
+  return true;
+}
+
+void texture_cache_destroy(texture_cache *cache) {
+  if (!cache || !cache->memory) {
+    return;
+  }
+  texture_cache_state *state =
+      reinterpret_cast<texture_cache_state *>(cache->memory);
+  state->~texture_cache_state();
+  cache->memory = nullptr;
+}
+
+bool texture_cache_find(texture_cache cache, cstr source_path,
+                        ImageResourceData *out) {
+  NS_PROFILE_FUNCTION();
+  texture_cache_state *state =
+      reinterpret_cast<texture_cache_state *>(cache.memory);
+  char path[Resource::PATH_MAX_LENGTH];
+  texture_cache_file_path(state, source_path, path);
+
+  bool hit = false;
+  fs::FileStat source;
+  fs::MappedFile file;
+  // The pixels are uploaded as a whole
+  if (fs::stat(source_path, &source) &&
+      resource_map_existing(path, fs::MapHint::WILL_NEED, &file)) {
+    hit = texture_cache_view(file.data, file.size,
+                             resource_source_key(source_path, source), out);
+    if (hit) {
+      out->cached = file;
+    } else {
+      fs::unmap(&file);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  if (hit) {
+    state->stats.hit_count++;
+  } else {
+    state->stats.miss_count++;
+  }
+  return hit;
+}
+
+bool texture_cache_store(texture_cache cache, cstr source_path,
+                         ImageResourceData const *image) {
+  NS_PROFILE_FUNCTION();
+  texture_cache_state *state =
+      reinterpret_cast<texture_cache_state *>(cache.memory);
+  fs::FileStat source;
+  if (!fs::stat(source_path, &source)) {
+    return false;
+  }
+  texture_cache_header header = texture_cache_header_create(
+      image, resource_source_key(source_path, source));
+  u64 file_size = sizeof(header) + header.pixels_size;
+  if (file_size > state->budget) {
+    return false;
+  }
+
+  char path[Resource::PATH_MAX_LENGTH];
+  texture_cache_file_path(state, source_path, path);
+  resource_file_part parts[] = {{&header, sizeof(header)},
+                                {image->pixels, header.pixels_size}};
+  if (!resource_write_file(path, parts, 2)) {
+    NS_WARN("texture_cache_store - Failed to cache '%s'", source_path);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->stats.store_count++;
+  // Replacing an entry counts it twice until the next trim
+  state->stats.size += file_size;
+  if (state->stats.size > state->budget) {
+    texture_cache_trim_locked(state);
+  }
+  return true;
+}
+
+static void texture_cache_list_file(cstr name, ptr user_data) {
+  auto listing = reinterpret_cast<texture_cache_listing *>(user_data);
+  usize length = string_length(name);
+  usize extension_length = string_length(TEXTURE_CACHE_EXTENSION);
+  // Only the cache files: the temporary ones may be being written
+  if (length >= sizeof(texture_cache_file::name) ||
+      length < extension_length ||
+      !string_eq(name + length - extension_length, TEXTURE_CACHE_EXTENSION)) {
+    return;
+  }
+  char path[Resource::PATH_MAX_LENGTH];
+  string_fmt(path, Resource::PATH_MAX_LENGTH, "%s/%s",
+             listing->state->directory, name);
+  fs::FileStat stat;
+  if (!fs::stat(path, &stat)) {
+    return;
+  }
+  if (listing->count == listing->capacity) {
+    listing->capacity = listing->capacity ? listing->capacity * 2 : 64;
+    // Not the engine allocator: trims run on the decoder threads
+    listing->files =
+        reinterpret_cast<texture_cache_file *>(platform::reallocate_memory(
+            listing->files, sizeof(texture_cache_file) * listing->capacity,
+            false));
+  }
+  texture_cache_file *file = &listing->files[listing->count++];
+  string_ncpy(file->name, name, sizeof(file->name));
+  file->size = stat.size;
+  file->modified_time = stat.modified_time;
+}
+
+// With the lock held
+static void texture_cache_trim_locked(texture_cache_state *state) {
+  NS_PROFILE_FUNCTION();
+  texture_cache_listing listing = {state, nullptr, 0, 0};
+  fs::list_directory(state->directory, texture_cache_list_file, &listing);
+  u64 size = 0;
+  for (u32 i = 0; i < listing.count; i++) {
+    size += listing.files[i].size;
+  }
+
+  // The oldest written first: few files, a sort is not worth it
+  while (size > state->budget && listing.count > 0) {
+    u32 oldest = 0;
+    for (u32 i = 1; i < listing.count; i++) {
+      if (listing.files[i].modified_time <
+          listing.files[oldest].modified_time) {
+        oldest = i;
+      }
+    }
+    char path[Resource::PATH_MAX_LENGTH];
+    string_fmt(path, Resource::PATH_MAX_LENGTH, "%s/%s", state->directory,
+               listing.files[oldest].name);
+    if (fs::remove(path)) {
+      size -= listing.files[oldest].size;
+      state->stats.eviction_count++;
+    }
+    listing.files[oldest] = listing.files[--listing.count];
+  }
+  state->stats.size = size;
+  if (listing.files) {
+    platform::free_memory(listing.files, false);
+  }
+}
+
+void texture_cache_trim(texture_cache cache) {
+  texture_cache_state *state =
+      reinterpret_cast<texture_cache_state *>(cache.memory);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  texture_cache_trim_locked(state);
+}
+
+texture_cache_stats texture_cache_get_stats(texture_cache cache) {
+  texture_cache_state *state =
+      reinterpret_cast<texture_cache_state *>(cache.memory);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  return state->stats;
+}
+
+} // namespace ns
@@ -0,0 +1,129 @@
+#ifndef TEXTURE_CACHE_HEADER_INCLUDED
+#define TEXTURE_CACHE_HEADER_INCLUDED
+
+#include "./resource_types.h"
+
+// On-disk cache of decoded images, so that a warm start maps the pixels
+// instead of inflating the PNG files again.
+//
+// One file per source image, named after the hash of its path:
+//   texture_cache_header
+//   pixels                 as the image loader returns them (flipped
+//                          vertically): the levels of the mip chain (see
+//                          mipmap.h), RGBA or compressed blocks
+//
+// The header holds a hash of the source path, size and modification time: a
+// modified source is a miss and its entry is overwritten. When the files
+// exceed the budget, the oldest written ones are deleted.
+//
+// nspak cooks the images of an asset pack to the same format, with a source
+// key of 0 (see image_cook).
+
+namespace ns {
+
+#define TEXTURE_CACHE_MAGIC 0x4354534Eu // "NSTC"
+#define TEXTURE_CACHE_VERSION 3
+#define TEXTURE_CACHE_EXTENSION ".nstc"
+
+struct texture_cache_header {
+  u32 magic;
+  u32 version;
+  // hash of the path, size and modification time of the source
+  u64 source_key;
+  u32 width;
+  u32 height;
+  // of the source
+  u32 channel_count;
+  u32 mip_count;
+  // TextureFormat of the pixels
+  u32 format;
+  u32 reserved;
+  // size of all the levels
+  u64 pixels_size;
+};
+
+NS_STATIC_ASSERT(sizeof(texture_cache_header) == 48,
+                 "texture_cache_header is a file format");
+
+/**
+ * Fills the header of the file of an image
+ * @param image the image, with its mip levels
+ * @param source_key the key of its source (see resource_source_key)
+ * @returns the header, followed in the file by the pixels of the image
+ */
+NS_API texture_cache_header
+texture_cache_header_create(ImageResourceData const *image, u64 source_key);
+
+/**
+ * Reads a file of the texture cache format, e.g. an image cooked into an
+ * asset pack
+ * @param data the file
+ * @param size its size
+ * @param source_key the key the file must have
+ * @param out the image, whose pixels point into the file
+ * @returns false if the file is invalid or of another source
+ */
+NS_API bool texture_cache_view(u8 const *data, usize size, u64 source_key,
+                               ImageResourceData *out);
+
+struct texture_cache {
+  void *memory;
+};
+
+struct texture_cache_stats {
+  u64 hit_count;
+  u64 miss_count;
+  u64 store_count;
+  u64 eviction_count;
+  // size of the cache files, as of the last trim
+  u64 size;
+};
+
+/**
+ * Creates a cache in a directory (created if needed), and trims it to the
+ * budget. Call once with memory = nullptr to get the memory requirement, then
+ * with a block of that size.
+ * @param directory the directory of the cache files. Its parent must exist.
+ * @param budget the maximum size of the cache files, in bytes
+ * @param memory_requirement the size of the memory block
+ * @param memory the memory block
+ * @param out_cache the cache
+ * @returns false if the directory can't be created
+ */
+NS_API bool texture_cache_create(cstr directory, u64 budget,
+                                 usize *memory_requirement, void *memory,
+                                 texture_cache *out_cache);
+
+NS_API void texture_cache_destroy(texture_cache *cache);
+
+/**
+ * Maps the cached image of a source file. Can be called from any thread.
+ * @param cache the cache
+ * @param source_path the path of the source image
+ * @param out the image, freed with image_loader_free_pixels
+ * @returns false if the image is not cached or its source was modified
+ */
+NS_API bool texture_cache_find(texture_cache cache, cstr source_path,
+                               ImageResourceData *out);
+
+/**
+ * Caches the decoded image of a source file, replacing the previous one.
+ * Can be called from any thread.
+ * @param cache the cache
+ * @param source_path the path of the source image
+ * @param image the image, with its mip levels
+ * @returns false if the cache file can't be written
+ */
+NS_API bool texture_cache_store(texture_cache cache, cstr source_path,
+                                ImageResourceData const *image);
+
+/**
+ * Deletes the oldest cache files until the cache fits in its budget
+ */
+NS_API void texture_cache_trim(texture_cache cache);
+
+NS_API texture_cache_stats texture_cache_get_stats(texture_cache cache);
+
+} // namespace ns
+
+#endif // TEXTURE_CACHE_HEADER_INCLUDED
@@ -2,8 +2,11 @@
 
 #include "../core/logger.h"
 #include "../core/memory.h"
+#include "../core/profiler.h"
 #include "../core/string.h"
+#include "../math/packing.h"
 #include "../renderer/renderer_frontend.h"
+#include "../resources/mesh_optimizer.h"
 #include "./material_system.h"
 
 namespace ns {
@@ -75,6 +78,7 @@ Geometry *geometry_system_acquire(NSID id) {
 }
 
 Geometry *geometry_system_acquire(geometry_config config, bool auto_release) {
+  NS_PROFILE_FUNCTION();
   Geometry *g = nullptr;
   for (u32 i = 0; i < state_ptr->config.max_geometry_count; i++) {
     if (state_ptr->registered_geometries[i].geometry.id == INVALID_ID) {
@@ -134,6 +138,24 @@ Geometry *geometry_system_get_default_2d() {
   return &state_ptr->default_2d_geometry;
 }
 
+static void geometry_config_names(geometry_config *config, cstr name,
+                                  cstr material_name) {
+  if (name && string_length(name) > 0) {
+    string_ncpy(config->name, name, Geometry::NAME_MAX_LENGTH);
+  } else {
+    string_ncpy(config->name, DEFAULT_GEOMETRY_NAME,
+                Geometry::NAME_MAX_LENGTH);
+  }
+
+  if (material_name && string_length(material_name) > 0) {
+    string_ncpy(config->material_name, material_name,
+                Material::NAME_MAX_LENGTH);
+  } else {
+    string_ncpy(config->material_name, DEFAULT_MATERIAL_NAME,
+                Material::NAME_MAX_LENGTH);
+  }
+}
+
 geometry_config geometry_config::plane(f32 width, f32 height,
                                        u32 x_segment_count, u32 y_segment_count,
                                        f32 tile_x, f32 tile_y, cstr name,
@@ -169,10 +191,10 @@ geometry_config geometry_config::plane(f32 width, f32 height,
   config.vertex_count = x_segment_count * y_segment_count * 4;
   config.vertices = reinterpret_cast<vertex_3d *>(
       ns::alloc(sizeof(vertex_3d) * config.vertex_count, MemTag::ARRAY));
-  config.index_size = sizeof(u32);
+  config.index_size = geometry_index_size(config.vertex_count);
   config.index_count = x_segment_count * y_segment_count * 6;
-  config.indices = reinterpret_cast<u32 *>(
-      ns::alloc(sizeof(u32) * config.index_count, MemTag::ARRAY));
+  config.indices = ns::alloc(config.index_size * config.index_count,
+                             MemTag::ARRAY);
 
   f32 seg_width = width / static_cast<f32>(x_segment_count);
   f32 seg_height = height / static_cast<f32>(y_segment_count);
@@ -206,37 +228,167 @@ geometry_config geometry_config::plane(f32 width, f32 height,
       v3->texcoord = {max_uvx, min_uvy};
 
       u32 i_offset = ((y * x_segment_count) + x) * 6;
-      u32 *indices = reinterpret_cast<u32 *>(config.indices);
-      indices[i_offset + 0] = v_offset + 0;
-      indices[i_offset + 1] = v_offset + 1;
-      indices[i_offset + 2] = v_offset + 2;
-      indices[i_offset + 3] = v_offset + 0;
-      indices[i_offset + 4] = v_offset + 3;
-      indices[i_offset + 5] = v_offset + 1;
+      u32 quad[6] = {v_offset + 0, v_offset + 1, v_offset + 2,
+                     v_offset + 0, v_offset + 3, v_offset + 1};
+      if (config.index_size == sizeof(u16)) {
+        geometry_indices_to_u16(
+            quad, 6, reinterpret_cast<u16 *>(config.indices) + i_offset);
+      } else {
+        mem_copy(reinterpret_cast<u32 *>(config.indices) + i_offset, quad,
+                 sizeof(quad));
+      }
     }
   }
 
-  if (name && string_length(name) > 0) {
-    string_ncpy(config.name, name, Geometry::NAME_MAX_LENGTH);
+  geometry_config_names(&config, name, material_name);
+  return config;
+}
+
+geometry_config geometry_config::mesh(MeshResourceData const *mesh, cstr name,
+                                      cstr material_name) {
+  geometry_config config;
+  config.vertex_size = sizeof(vertex_3d);
+  config.vertex_count = mesh->vertex_count;
+  // Read-only: create_geometry only copies them
+  config.vertices = const_cast<vertex_3d *>(mesh->vertices);
+  config.index_size = mesh->index_size;
+  config.index_count = mesh->index_count;
+  config.indices = const_cast<ptr>(mesh->indices);
+  geometry_config_names(&config, name, material_name);
+  return config;
+}
+
+void geometry_config::optimize(bool reduce_overdraw) {
+  NS_PROFILE_FUNCTION();
+  if (index_count < 6) {
+    return;
+  }
+  u32 *work = reinterpret_cast<u32 *>(
+      ns::alloc(sizeof(u32) * index_count, MemTag::ARRAY));
+  if (index_size == sizeof(u16)) {
+    u16 const *narrow = reinterpret_cast<u16 const *>(indices);
+    for (u32 i = 0; i < index_count; i++) {
+      work[i] = narrow[i];
+    }
   } else {
-    string_ncpy(config.name, DEFAULT_GEOMETRY_NAME, Geometry::NAME_MAX_LENGTH);
+    mem_copy(work, indices, sizeof(u32) * index_count);
   }
-
-  if (material_name && string_length(material_name) > 0) {
-    string_ncpy(config.material_name, material_name, Material::NAME_MAX_LENGTH);
+  mesh_cache_stats before = mesh_analyze_vertex_cache(
+      work, index_count, vertex_count, MESH_CACHE_SIMULATION_SIZE);
+
+  mesh_optimize_vertex_cache(work, index_count, vertex_count);
+  if (reduce_overdraw && vertex_size == sizeof(vertex_3d)) {
+    mesh_optimize_overdraw(
+        work, index_count, &reinterpret_cast<vertex_3d *>(vertices)->position,
+        sizeof(vertex_3d), vertex_count, MESH_OVERDRAW_DEFAULT_THRESHOLD);
+  }
+  u32 *remap = reinterpret_cast<u32 *>(
+      ns::alloc(sizeof(u32) * vertex_count, MemTag::ARRAY));
+  mesh_optimize_vertex_fetch(work, index_count, vertex_count, remap);
+  usize vertices_size = static_cast<usize>(vertex_size) * vertex_count;
+  ptr remapped = ns::alloc(vertices_size, MemTag::ARRAY);
+  mesh_remap_vertices(vertices, vertex_count, vertex_size, remap, remapped);
+  mem_copy(vertices, remapped, vertices_size);
+  ns::free(remapped, vertices_size, MemTag::ARRAY);
+  ns::free(remap, sizeof(u32) * vertex_count, MemTag::ARRAY);
+
+  mesh_cache_stats after = mesh_analyze_vertex_cache(
+      work, index_count, vertex_count, MESH_CACHE_SIMULATION_SIZE);
+  NS_DEBUG("Geometry '%s': ACMR %.3f -> %.3f, ATVR %.3f -> %.3f.", name,
+           before.acmr, after.acmr, before.atvr, after.atvr);
+  if (index_size == sizeof(u16)) {
+    geometry_indices_to_u16(work, index_count,
+                            reinterpret_cast<u16 *>(indices));
   } else {
-    string_ncpy(config.material_name, DEFAULT_MATERIAL_NAME,
-                Material::NAME_MAX_LENGTH);
+    mem_copy(indices, work, sizeof(u32) * index_count);
   }
+  ns::free(work, sizeof(u32) * index_count, MemTag::ARRAY);
+}
 
-  return config;
+void geometry_indices_to_u16(u32 const *indices, u32 count, u16 *out) {
+  for (u32 i = 0; i < count; i++) {
+    out[i] = static_cast<u16>(indices[i]);
+  }
+}
+
+static aabb geometry_bounds(u32 vertex_size, u32 vertex_count,
+                            roptr vertices) {
+  if (vertex_size == sizeof(vertex_3d)) {
+    return aabb::from_points(
+        &reinterpret_cast<vertex_3d const *>(vertices)->position, vertex_count,
+        sizeof(vertex_3d));
+  }
+  if (vertex_size == sizeof(vertex_2d)) {
+    return aabb::from_points(
+        &reinterpret_cast<vertex_2d const *>(vertices)->position, vertex_count,
+        sizeof(vertex_2d));
+  }
+  NS_WARN("geometry_bounds - unknown vertex format, the geometry will not be "
+          "culled.");
+  return {vec3(-NS_INF), vec3(NS_INF)};
 }
 
 bool create_geometry(geometry_system_state *state, geometry_config config,
                      Geometry *g) {
-  if (!renderer_create_geometry(g, config.vertex_size, config.vertex_count,
-                                config.vertices, config.index_size,
-                                config.index_count, config.indices)) {
+  g->bounds =
+      geometry_bounds(config.vertex_size, config.vertex_count, config.vertices);
+
+  VertexFormat format = config.vertex_format;
+  u32 vertex_size = config.vertex_size;
+  roptr vertices = config.vertices;
+  vertex_3d_packed *packed = nullptr;
+  bool packable = config.vertex_size == sizeof(vertex_3d);
+  if (format != VertexFormat::FLOAT && !packable) {
+    NS_WARN("create_geometry - only vertex_3d vertices can be packed, '%s' "
+            "keeps its vertices.",
+            config.name);
+    format = VertexFormat::FLOAT;
+  }
+  usize packed_size = sizeof(vertex_3d_packed) * config.vertex_count;
+  if (format != VertexFormat::FLOAT) {
+    packed = reinterpret_cast<vertex_3d_packed *>(
+        ns::alloc(packed_size, MemTag::ARRAY));
+    vertices_pack(format, reinterpret_cast<vertex_3d const *>(config.vertices),
+                  config.vertex_count, g->bounds, packed);
+    vertex_size = sizeof(vertex_3d_packed);
+    vertices = packed;
+    NS_DEBUG("Geometry '%s': %s vertices, %u bytes per vertex instead of %u "
+             "(%u bytes saved).",
+             config.name, vertex_format_name(format), vertex_size,
+             config.vertex_size,
+             (config.vertex_size - vertex_size) * config.vertex_count);
+  }
+
+  u32 index_size = config.index_size;
+  roptr indices = config.indices;
+  u16 *narrowed = nullptr;
+  if (config.index_count && index_size == sizeof(u32) &&
+      geometry_index_size(config.vertex_count) == sizeof(u16)) {
+    narrowed = reinterpret_cast<u16 *>(
+        ns::alloc(sizeof(u16) * config.index_count, MemTag::ARRAY));
+    geometry_indices_to_u16(reinterpret_cast<u32 const *>(config.indices),
+                            config.index_count, narrowed);
+    index_size = sizeof(u16);
+    indices = narrowed;
+  }
+
+  bool created = false;
+  if (config.index_count && index_size != sizeof(u16) &&
+      index_size != sizeof(u32)) {
+    NS_ERROR("create_geometry - '%s' has %u byte indices, expected 2 or 4.",
+             config.name, index_size);
+  } else {
+    created = renderer_create_geometry(g, format, vertex_size,
+                                       config.vertex_count, vertices,
+                                       index_size, config.index_count, indices);
+  }
+  if (packed) {
+    ns::free(packed, packed_size, MemTag::ARRAY);
+  }
+  if (narrowed) {
+    ns::free(narrowed, sizeof(u16) * config.index_count, MemTag::ARRAY);
+  }
+  if (!created) {
     state->registered_geometries[g->id].reference_count = 0;
     state->registered_geometries[g->id].auto_release = false;
     g->id = INVALID_ID;
@@ -260,6 +412,7 @@ void destroy_geometry(geometry_system_state * /*state*/, Geometry *g) {
   g->internal_id = INVALID_ID;
   g->id = INVALID_ID;
   g->generation = INVALID_ID;
+  g->vertex_format = VertexFormat::FLOAT;
 
   string_clear(g->name);
 
@@ -284,13 +437,15 @@ bool create_default_geometries(geometry_system_state *state) {
   verts[3].position = {0.5f * f, -0.5f * f, 0.0f};
   verts[3].texcoord = {1.0f, 0.0f};
 
-  u32 indices[6] = {0, 1, 2, 0, 3, 1};
+  u16 indices[6] = {0, 1, 2, 0, 3, 1};
 
   state->default_geometry.id = INVALID_ID;
   state->default_geometry.generation = INVALID_ID;
   state->default_geometry.internal_id = INVALID_ID;
-  if (!renderer_create_geometry(&state->default_geometry, sizeof(vertex_3d), 4,
-                                verts, sizeof(u32), 6, indices)) {
+  state->default_geometry.bounds = geometry_bounds(sizeof(vertex_3d), 4, verts);
+  if (!renderer_create_geometry(&state->default_geometry, VertexFormat::FLOAT,
+                                sizeof(vertex_3d), 4, verts, sizeof(u16), 6,
+                                indices)) {
     NS_FATAL("Failed to create default geometry.");
     return false;
   }
@@ -309,10 +464,13 @@ bool create_default_geometries(geometry_system_state *state) {
   verts2[3].position = {0.5f * f, -0.5f * f};
   verts2[3].texcoord = {1.0f, 0.0f};
 
-  u32 indices2[6] = {2, 1, 0, 3, 0, 1};
+  u16 indices2[6] = {2, 1, 0, 3, 0, 1};
 
-  if (!renderer_create_geometry(&state->default_2d_geometry, sizeof(vertex_2d),
-                                4, verts2, sizeof(u32), 6, indices2)) {
+  state->default_2d_geometry.bounds =
+      geometry_bounds(sizeof(vertex_2d), 4, verts2);
+  if (!renderer_create_geometry(&state->default_2d_geometry,
+                                VertexFormat::FLOAT, sizeof(vertex_2d), 4,
+                                verts2, sizeof(u16), 6, indices2)) {
     NS_FATAL("Failed to create default geometry.");
     return false;
   }
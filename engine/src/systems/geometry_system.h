@@ -13,17 +13,60 @@ struct geometry_config {
   u32 vertex_size;
   u32 vertex_count;
   ptr vertices;
+  // Format of the uploaded vertices: vertex_3d vertices are packed when a
+  // packed format is chosen.
+  VertexFormat vertex_format = VertexFormat::FLOAT;
+  // sizeof(u16) or sizeof(u32). 32 bit indices are uploaded as 16 bit ones
+  // when the vertices fit (see geometry_index_size).
   u32 index_size;
   u32 index_count;
   ptr indices;
   char name[Geometry::NAME_MAX_LENGTH];
   char material_name[Material::NAME_MAX_LENGTH];
 
+  /**
+   * Generates a plane, with indices of geometry_index_size(vertex_count)
+   * bytes. The vertices and indices are allocated with MemTag::ARRAY and
+   * belong to the caller.
+   */
   static geometry_config plane(f32 width, f32 height, u32 x_segment_count,
                                u32 y_segment_count, f32 tile_x, f32 tile_y,
                                cstr name, cstr material_name);
+
+  /**
+   * Describes a static mesh (see mesh_loader.h). The vertices and indices
+   * point into the mesh, which must stay loaded until the geometry is
+   * acquired.
+   */
+  static geometry_config mesh(MeshResourceData const *mesh, cstr name,
+                              cstr material_name);
+
+  /**
+   * Reorders the triangles and the vertices for the GPU caches (see
+   * mesh_optimizer.h). The vertices and indices must be writable: not the
+   * ones of a mesh, which are optimized at import.
+   * @param reduce_overdraw whether to draw the triangles facing outwards
+   *        first, for vertex_3d vertices
+   */
+  void optimize(bool reduce_overdraw);
 };
 
+/**
+ * Gets the smallest index size for a number of vertices: 16 bit indices
+ * address up to 65535 vertices.
+ */
+NS_INLINE u32 geometry_index_size(u32 vertex_count) {
+  return vertex_count <= 65535 ? sizeof(u16) : sizeof(u32);
+}
+
+/**
+ * Converts 32 bit indices to 16 bit ones
+ * @param indices the indices, all below 65536
+ * @param count the number of indices
+ * @param out the converted indices
+ */
+void geometry_indices_to_u16(u32 const *indices, u32 count, u16 *out);
+
 #define DEFAULT_GEOMETRY_NAME "default"
 
 bool geometry_system_initialize(u64 *memory_requirement, ptr state,
@@ -2,6 +2,8 @@
 
 #include "../containers/hashtable.h"
 #include "../core/logger.h"
+#include "../core/memory.h"
+#include "../core/profiler.h"
 #include "../core/string.h"
 #include "../math/math.h"
 #include "../renderer/renderer_frontend.h"
@@ -95,10 +97,25 @@ void material_system_shutdown(ptr state) {
 }
 
 Material *material_system_acquire(cstr name) {
+  NS_PROFILE_FUNCTION();
   if (state_ptr == nullptr) {
     NS_FATAL("material_system_acquire - State pointer is null");
     return nullptr;
   }
+  if (string_EQ(name, DEFAULT_MATERIAL_NAME)) {
+    return &state_ptr->default_material;
+  }
+
+  // Already loaded: no need to read and parse its file again
+  material_reference ref{};
+  if (state_ptr->registered_material_table.get(name, &ref) &&
+      ref.handle != INVALID_ID) {
+    ref.reference_count++;
+    state_ptr->registered_material_table.set(name, &ref);
+    NS_TRACE("Material '%s' already exists. ref count = %d", name,
+             ref.reference_count);
+    return &state_ptr->registered_materials[ref.handle];
+  }
 
   Resource material_resource;
   if (!resource_system_load(name, ResourceType::MATERIAL, &material_resource)) {
@@ -126,6 +143,7 @@ Material *material_system_acquire(cstr name) {
 }
 
 Material *material_system_acquire(MaterialConfig config) {
+  NS_PROFILE_FUNCTION();
   if (state_ptr == nullptr) {
     NS_FATAL("material_system_acquire - State pointer is null");
     return nullptr;
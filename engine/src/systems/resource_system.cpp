@@ -1,11 +1,14 @@
 #include "./resource_system.h"
 
 #include "../core/memory.h"
+#include "../core/profiler.h"
 #include "../core/string.h"
 
+#include "../resources/block_compression.h"
 #include "../resources/loaders/binary_loader.h"
 #include "../resources/loaders/image_loader.h"
 #include "../resources/loaders/material_loader.h"
+#include "../resources/loaders/mesh_loader.h"
 #include "../resources/loaders/text_loader.h"
 
 namespace ns {
@@ -13,11 +16,17 @@ namespace ns {
 struct resource_system_state {
   resource_system_config config;
   resource_loader *registered_loaders;
+  bool has_pack;
+  pack assets;
+  texture_cache textures;
+  resource_cache resources;
 };
 
 static resource_system_state *state_ptr = nullptr;
 
 bool load(cstr name, resource_loader *loader, Resource *out_resource);
+static void unload_evicted(Resource *resource);
+static u64 resource_size(ResourceType type, Resource const *resource);
 
 bool resource_system_initialize(usize *memory_requirement, ptr state,
                                 resource_system_config config) {
@@ -28,7 +37,19 @@ bool resource_system_initialize(usize *memory_requirement, ptr state,
   }
   u64 struct_requirement = sizeof(resource_system_state);
   u64 array_requirement = sizeof(resource_loader) * config.max_loader_count;
-  *memory_requirement = struct_requirement + array_requirement;
+  usize cache_requirement = 0;
+  if (config.texture_cache_path) {
+    texture_cache_create(config.texture_cache_path,
+                         config.texture_cache_budget, &cache_requirement,
+                         nullptr, nullptr);
+  }
+  usize resource_cache_requirement = 0;
+  if (config.cache.max_entry_count > 0) {
+    resource_cache_create(config.cache, unload_evicted,
+                          &resource_cache_requirement, nullptr, nullptr);
+  }
+  *memory_requirement = struct_requirement + array_requirement +
+                        cache_requirement + resource_cache_requirement;
   if (state == nullptr) {
     return true;
   }
@@ -44,19 +65,63 @@ bool resource_system_initialize(usize *memory_requirement, ptr state,
     state_ptr->registered_loaders[i].id = INVALID_ID;
   }
 
+  state_ptr->has_pack = false;
+  if (config.pack_path) {
+    if (!pack_open(config.pack_path, &state_ptr->assets)) {
+      NS_FATAL("resource_system_initialize - Failed to open the asset pack "
+               "'%s'",
+               config.pack_path);
+      state_ptr = nullptr;
+      return false;
+    }
+    state_ptr->has_pack = true;
+  }
+
+  // Not fatal: the images are decoded
+  state_ptr->textures.memory = nullptr;
+  if (config.texture_cache_path && !state_ptr->has_pack) {
+    ptr cache_block = AS_BYTES(array_block) + array_requirement;
+    if (!texture_cache_create(config.texture_cache_path,
+                              config.texture_cache_budget, &cache_requirement,
+                              cache_block, &state_ptr->textures)) {
+      NS_WARN("resource_system_initialize - The texture cache is disabled");
+    }
+  }
+
+  state_ptr->resources.memory = nullptr;
+  if (config.cache.max_entry_count > 0) {
+    ptr resource_cache_block =
+        AS_BYTES(array_block) + array_requirement + cache_requirement;
+    resource_cache_create(config.cache, unload_evicted,
+                          &resource_cache_requirement, resource_cache_block,
+                          &state_ptr->resources);
+  }
+
   resource_system_register_loader(image_resource_loader_create());
   resource_system_register_loader(material_resource_loader_create());
+  resource_system_register_loader(mesh_resource_loader_create());
   resource_system_register_loader(binary_resource_loader_create());
   resource_system_register_loader(text_resource_loader_create());
 
-  NS_INFO("Resource system initialized with base path '%s'.",
-          config.asset_base_path);
+  if (state_ptr->has_pack) {
+    NS_INFO("Resource system initialized with asset pack '%s'.",
+            config.pack_path);
+  } else {
+    NS_INFO("Resource system initialized with base path '%s'.",
+            config.asset_base_path);
+  }
 
   return true;
 }
 
 void resource_system_shutdown(ptr /*state*/) {
   if (state_ptr) {
+    // Before the pack: the resources may point into it
+    resource_cache_destroy(&state_ptr->resources);
+    if (state_ptr->has_pack) {
+      pack_close(&state_ptr->assets);
+    }
+    texture_cache_destroy(&state_ptr->textures);
     state_ptr = nullptr;
   }
 }
@@ -95,24 +160,82 @@ bool resource_system_register_loader(resource_loader loader) {
   return false;
 }
 
+static resource_loader *find_loader(ResourceType type) {
+  for (u32 i = 0; i < state_ptr->config.max_loader_count; i++) {
+    resource_loader *l = &state_ptr->registered_loaders[i];
+    if (l->id != INVALID_ID && l->type == type) {
+      return l;
+    }
+  }
+  return nullptr;
+}
+
 bool resource_system_load(cstr name, ResourceType type,
                           Resource *out_resource) {
+  NS_PROFILE_FUNCTION();
   if (!state_ptr || type == ResourceType::CUSTOM) {
     out_resource->loader_id = INVALID_ID;
     NS_ERROR("resource_system_load - State pointer is null or invalid type ");
     return false;
   }
-  for (u32 i = 0; i < state_ptr->config.max_loader_count; i++) {
-    resource_loader *l = &state_ptr->registered_loaders[i];
-    if (l->id != INVALID_ID && l->type == type) {
-      return load(name, l, out_resource);
-    }
+  resource_loader *l = find_loader(type);
+  if (l) {
+    return load(name, l, out_resource);
   }
   NS_ERROR("resource_system_load - No loader found for type %d", type);
   return false;
 }
 
+bool resource_system_load_cached(cstr name, ResourceType type,
+                                 Resource *out_resource) {
+  out_resource->loader_id = INVALID_ID;
+  if (!state_ptr || !state_ptr->resources.memory ||
+      type == ResourceType::CUSTOM) {
+    return false;
+  }
+  resource_loader *l = find_loader(type);
+  if (!l) {
+    return false;
+  }
+  out_resource->data_is_view = false;
+  out_resource->mapped = {};
+  out_resource->cache_id = INVALID_ID;
+  if (!resource_cache_acquire(state_ptr->resources, name, l->id,
+                              out_resource)) {
+    out_resource->loader_id = INVALID_ID;
+    return false;
+  }
+  return true;
+}
+
+bool resource_system_adopt(cstr name, ResourceType type, ptr data,
+                           usize data_size, Resource *out_resource) {
+  out_resource->loader_id = INVALID_ID;
+  resource_loader *l = state_ptr && type != ResourceType::CUSTOM
+                           ? find_loader(type)
+                           : nullptr;
+  if (!l) {
+    NS_ERROR("resource_system_adopt - No loader found for type %d", type);
+    return false;
+  }
+  out_resource->loader_id = l->id;
+  out_resource->name = name;
+  out_resource->full_path[0] = '\0';
+  out_resource->data = data;
+  out_resource->data_size = data_size;
+  out_resource->data_is_view = false;
+  out_resource->mapped = {};
+  out_resource->cache_id = INVALID_ID;
+  resource_cache cache = state_ptr->resources;
+  if (cache.memory) {
+    resource_cache_insert(cache, name, type, resource_size(type, out_resource),
+                          out_resource);
+  }
+  return true;
+}
+
 bool resource_system_load(cstr name, cstr custom_type, Resource *out_resource) {
+  NS_PROFILE_FUNCTION();
   if (!state_ptr || !custom_type || string_length(custom_type) < 1) {
     out_resource->loader_id = INVALID_ID;
     NS_ERROR("resource_system_load - State pointer is null or invalid type ");
@@ -134,6 +257,14 @@ void resource_system_unload(Resource *resource) {
   if (!state_ptr || !resource || resource->loader_id == INVALID_ID) {
     return;
   }
+  if (resource->cache_id != INVALID_ID) {
+    resource_cache_release(state_ptr->resources, resource);
+    return;
+  }
+  unload_evicted(resource);
+}
+
+static void unload_evicted(Resource *resource) {
   resource_loader *l = &state_ptr->registered_loaders[resource->loader_id];
   if (l->id != INVALID_ID && l->unload) {
     l->unload(l, resource);
@@ -148,13 +279,79 @@ cstr resource_system_base_path() {
   return state_ptr->config.asset_base_path;
 }
 
+pack const *resource_system_pack() {
+  if (!state_ptr || !state_ptr->has_pack) {
+    return nullptr;
+  }
+  return &state_ptr->assets;
+}
+
+texture_cache resource_system_texture_cache() {
+  if (!state_ptr) {
+    return {nullptr};
+  }
+  return state_ptr->textures;
+}
+
+bool resource_system_compress_textures() {
+  return state_ptr && state_ptr->config.compress_textures;
+}
+
+void resource_system_set_compress_textures(bool compress) {
+  if (state_ptr) {
+    state_ptr->config.compress_textures = compress;
+  }
+}
+
+bool resource_system_cook_materials() {
+  return state_ptr && state_ptr->config.cook_materials;
+}
+
+resource_cache resource_system_resource_cache() {
+  if (!state_ptr) {
+    return {nullptr};
+  }
+  return state_ptr->resources;
+}
+
+// Memory held by a loaded resource, for the budgets of the cache
+static u64 resource_size(ResourceType type, Resource const *resource) {
+  if (type == ResourceType::IMAGE) {
+    auto image = reinterpret_cast<ImageResourceData const *>(resource->data);
+    return resource->data_size +
+           texture_format_chain_size(image->format, image->width,
+                                     image->height, image->mip_count);
+  }
+  if (type == ResourceType::STATIC_MESH) {
+    auto mesh = reinterpret_cast<MeshResourceData const *>(resource->data);
+    return resource->data_size + mesh->data_size;
+  }
+  return resource->data_size;
+}
+
 bool load(cstr name, resource_loader *loader, Resource *out_resource) {
   if (!state_ptr || !loader || !out_resource) {
     out_resource->loader_id = INVALID_ID;
     return false;
   }
   out_resource->loader_id = loader->id;
-  return loader->load(loader, name, out_resource);
+  out_resource->data_is_view = false;
+  out_resource->mapped = {};
+  out_resource->cache_id = INVALID_ID;
+  resource_cache cache = state_ptr->resources;
+  if (cache.memory &&
+      resource_cache_acquire(cache, name, loader->id, out_resource)) {
+    return true;
+  }
+  if (!loader->load(loader, name, out_resource)) {
+    return false;
+  }
+  if (cache.memory) {
+    resource_cache_insert(cache, name, loader->type,
+                          resource_size(loader->type, out_resource),
+                          out_resource);
+  }
+  return true;
 }
 
 } // namespace ns
@@ -1,13 +1,42 @@
 #ifndef RESOURCE_SYSTEM_HEADER_INCLUDED
 #define RESOURCE_SYSTEM_HEADER_INCLUDED
 
+#include "../resources/pack.h"
+#include "../resources/resource_cache.h"
 #include "../resources/resource_types.h"
+#include "../resources/texture_cache.h"
 
 namespace ns {
 
+/**
+ * The defaults read the loose files of ../assets, without any cache.
+ * @field max_loader_count the maximum number of loaders
+ * @field asset_base_path the directory of the loose asset files
+ * @field pack_path an .nspak of the asset directory (see pack.h), mapped at
+ *        initialization: the loaders read from it instead of the loose files.
+ *        nullptr for the loose files.
+ * @field texture_cache_path the directory of the decoded images cache (see
+ *        texture_cache.h), for the loose files. nullptr to always decode.
+ * @field texture_cache_budget the maximum size of the cache, in bytes
+ * @field compress_textures whether the images are block compressed (see
+ *        block_compression.h)
+ * @field cook_materials whether the material loader reads the .nsmt text
+ *        files, as in development: it cooks them into their .nsmb file when
+ *        that one is missing or older. Off, only the .nsmb files are read
+ *        (see material_loader.h).
+ * @field cache the loaded resources kept after their release (see
+ *        resource_cache.h). None by default: the resources are unloaded on
+ *        their release.
+ */
 struct resource_system_config {
-  u32 max_loader_count;
-  cstr asset_base_path;
+  u32 max_loader_count = 32;
+  cstr asset_base_path = "../assets";
+  cstr pack_path = nullptr;
+  cstr texture_cache_path = nullptr;
+  u64 texture_cache_budget = 0;
+  bool compress_textures = false;
+  bool cook_materials = false;
+  resource_cache_config cache = {};
 };
 
 struct resource_loader {
@@ -35,8 +64,72 @@ NS_API bool resource_system_load(cstr name, cstr custom_type,
 
 NS_API void resource_system_unload(Resource *resource);
 
+/**
+ * Gets a resource from the resource cache, without loading it on a miss
+ * @param name the name of the resource
+ * @param type the type of the resource
+ * @param out_resource the resource, unloaded with resource_system_unload
+ * @returns false if the resource is not cached (or there is no cache)
+ */
+NS_API bool resource_system_load_cached(cstr name, ResourceType type,
+                                        Resource *out_resource);
+
+/**
+ * Takes a resource loaded outside of the resource system, e.g. an image of
+ * the image decoder, as if its loader had loaded it: it is cached like the
+ * loaded ones
+ * @param name the name of the resource
+ * @param type the type of the resource
+ * @param data its data, allocated as its loader does (an ImageResourceData
+ *        with ns::alloc and MemTag::TEXTURE for an image)
+ * @param data_size the size of the data
+ * @param out_resource the resource, unloaded with resource_system_unload
+ * @returns false if there is no loader of the type: the data is not taken
+ */
+NS_API bool resource_system_adopt(cstr name, ResourceType type, ptr data,
+                                  usize data_size, Resource *out_resource);
+
 NS_API cstr resource_system_base_path();
 
+/**
+ * Gets the asset pack
+ * @returns the pack, nullptr when the assets are loose files
+ */
+NS_API pack const *resource_system_pack();
+
+/**
+ * Gets the cache of the decoded images
+ * @returns the cache, with null memory when there is none
+ */
+NS_API texture_cache resource_system_texture_cache();
+
+/**
+ * Checks if the images are loaded block compressed
+ * @returns the compress_textures of the configuration
+ */
+NS_API bool resource_system_compress_textures();
+
+/**
+ * Sets the compress_textures of the configuration, e.g. once the renderer
+ * knows if the device samples the compressed textures. The images loaded
+ * before are not compressed again, but the cached ones are replaced on their
+ * next load.
+ * @param compress whether the images are block compressed
+ */
+NS_API void resource_system_set_compress_textures(bool compress);
+
+/**
+ * Checks if the material loader reads and cooks the text files
+ * @returns the cook_materials of the configuration
+ */
+NS_API bool resource_system_cook_materials();
+
+/**
+ * Gets the cache of the loaded resources
+ * @returns the cache, with null memory when there is none
+ */
+NS_API resource_cache resource_system_resource_cache();
+
 } // namespace ns
 
 #endif // RESOURCE_SYSTEM_HEADER_INCLUDED
@@ -3,9 +3,11 @@
 #include "../containers/hashtable.h"
 #include "../core/logger.h"
 #include "../core/memory.h"
+#include "../core/profiler.h"
 #include "../core/string.h"
 
 #include "../renderer/renderer_frontend.h"
+#include "../resources/image_decoder.h"
 
 #include <new>
 
@@ -20,6 +22,13 @@ struct texture_system_state {
   Texture *registered_textures;
 
   chashtable registered_textures_table;
+
+  // Decodes the textures of texture_system_acquire_async. The request ids
+  // are the texture handles. Their images stay in the resource cache once
+  // uploaded, as those of load_texture: an auto-released texture acquired
+  // again is uploaded from there, not decoded again.
+  image_decoder decoder;
+  image_decode_result *decoded;
 };
 
 struct texture_reference {
@@ -33,6 +42,8 @@ static texture_system_state *state_ptr = nullptr;
 bool create_default_textures(texture_system_state *state);
 void destroy_default_textures(texture_system_state *state);
 bool load_texture(cstr texture_name, Texture *t);
+void upload_texture(cstr texture_name, ImageResourceData const *data,
+                    Texture *t);
 void destroy_texture(Texture *t);
 
 bool texture_system_initialize(usize *memory_requirement, ptr state,
@@ -46,8 +57,17 @@ bool texture_system_initialize(usize *memory_requirement, ptr state,
   u64 array_requirement = sizeof(Texture) * config.max_texture_count;
   u64 hashtable_requirement =
       sizeof(texture_reference) * config.max_texture_count;
-  *memory_requirement =
-      struct_requirement + array_requirement + hashtable_requirement;
+  usize decoder_requirement = 0;
+  usize decoded_requirement = 0;
+  if (config.async_worker_count > 0) {
+    image_decoder_create(config.async_worker_count, config.async_queue_size,
+                         &decoder_requirement, nullptr, nullptr);
+    decoded_requirement =
+        sizeof(image_decode_result) * config.async_queue_size;
+  }
+  *memory_requirement = struct_requirement + array_requirement +
+                        hashtable_requirement + decoder_requirement +
+                        decoded_requirement;
   if (state == nullptr) {
     return true;
   }
@@ -73,6 +93,17 @@ bool texture_system_initialize(usize *memory_requirement, ptr state,
     state_ptr->registered_textures[i].generation = INVALID_ID;
   }
 
+  state_ptr->decoder.memory = nullptr;
+  state_ptr->decoded = nullptr;
+  if (config.async_worker_count > 0) {
+    ptr decoder_block = AS_BYTES(hashtable_block) + hashtable_requirement;
+    image_decoder_create(config.async_worker_count, config.async_queue_size,
+                         &decoder_requirement, decoder_block,
+                         &state_ptr->decoder);
+    state_ptr->decoded = reinterpret_cast<image_decode_result *>(
+        AS_BYTES(decoder_block) + decoder_requirement);
+  }
+
   create_default_textures(state_ptr);
 
   return true;
@@ -82,6 +113,7 @@ void texture_system_shutdown(ptr /*state*/) {
   if (state_ptr == nullptr) {
     return;
   }
+  image_decoder_destroy(&state_ptr->decoder);
   for (u32 i = 0; i < state_ptr->config.max_texture_count; i++) {
     Texture *t = &state_ptr->registered_textures[i];
     if (t->generation != INVALID_ID) {
@@ -92,7 +124,7 @@ void texture_system_shutdown(ptr /*state*/) {
   state_ptr = nullptr;
 }
 
-Texture *texture_system_acquire(cstr name, bool auto_release) {
+static Texture *acquire_texture(cstr name, bool auto_release, bool async) {
   if (state_ptr == nullptr) {
     NS_FATAL("texture_system_acquire - State pointer is null");
     return nullptr;
@@ -130,9 +162,22 @@ Texture *texture_system_acquire(cstr name, bool auto_release) {
                "config to allow more.");
       return nullptr;
     }
-    if (!load_texture(name, t)) {
-      NS_ERROR("Failed to load texture '%s'.", name);
-      return nullptr;
+    if (async && state_ptr->decoder.memory &&
+        image_decoder_submit(state_ptr->decoder, ref.handle, name)) {
+      // Bound to the default texture until uploaded
+      string_ncpy(t->name, name, Texture::NAME_MAX_LENGTH);
+      t->generation = INVALID_ID;
+      t->internal_data = nullptr;
+    } else {
+      if (async) {
+        NS_WARN("texture_system_acquire_async - Queue full, loading '%s' "
+                "synchronously.",
+                name);
+      }
+      if (!load_texture(name, t)) {
+        NS_ERROR("Failed to load texture '%s'.", name);
+        return nullptr;
+      }
     }
     t->id = ref.handle;
     NS_TRACE("Texture '%s' created, and ref_count is now %i.", name,
@@ -147,6 +192,45 @@ Texture *texture_system_acquire(cstr name, bool auto_release) {
   return &state_ptr->registered_textures[ref.handle];
 }
 
+Texture *texture_system_acquire(cstr name, bool auto_release) {
+  NS_PROFILE_FUNCTION();
+  return acquire_texture(name, auto_release, false);
+}
+
+Texture *texture_system_acquire_async(cstr name, bool auto_release) {
+  NS_PROFILE_FUNCTION();
+  return acquire_texture(name, auto_release, true);
+}
+
+void texture_system_process_async_loads() {
+  NS_PROFILE_FUNCTION();
+  if (state_ptr == nullptr || state_ptr->decoder.memory == nullptr) {
+    return;
+  }
+  u32 max_count = state_ptr->config.max_uploads_per_frame;
+  if (max_count == 0 || max_count > state_ptr->config.async_queue_size) {
+    max_count = state_ptr->config.async_queue_size;
+  }
+  u32 count =
+      image_decoder_poll(state_ptr->decoder, state_ptr->decoded, max_count);
+  for (u32 i = 0; i < count; i++) {
+    image_decode_result *result = &state_ptr->decoded[i];
+    // Released textures are cancelled: the handle is still the texture's
+    Texture *t = &state_ptr->registered_textures[result->id];
+    if (!result->succeeded) {
+      NS_ERROR("Failed to load texture '%s', the default texture is used.",
+               t->name);
+      continue;
+    }
+    char name[Texture::NAME_MAX_LENGTH];
+    string_ncpy(name, t->name, Texture::NAME_MAX_LENGTH);
+    u32 id = t->id;
+    upload_texture(name, &result->image, t);
+    t->id = id;
+    resource_system_unload(&result->resource);
+  }
+}
+
 void texture_system_release(cstr name) {
   if (state_ptr == nullptr) {
     NS_FATAL("texture_system_release - State pointer is null");
@@ -171,6 +255,9 @@ void texture_system_release(cstr name) {
   if (ref.reference_count == 0 && ref.auto_release) {
     Texture *t = &state_ptr->registered_textures[ref.handle];
 
+    if (state_ptr->decoder.memory) {
+      image_decoder_cancel(state_ptr->decoder, ref.handle);
+    }
     destroy_texture(t);
 
     ref.handle = INVALID_ID;
@@ -224,6 +311,8 @@ bool create_default_textures(texture_system_state *state) {
   state->default_texture.width = tex_dimension;
   state->default_texture.height = tex_dimension;
   state->default_texture.channel_count = channels;
+  state->default_texture.format = TextureFormat::RGBA8;
+  state->default_texture.mip_count = 1;
   state->default_texture.has_transparency = false;
   state->default_texture.generation = INVALID_ID;
   renderer_create_texture(pixels, &state->default_texture);
@@ -246,19 +335,32 @@ bool load_texture(cstr texture_name, Texture *t) {
     return false;
   }
 
-  ImageResourceData *data =
-      reinterpret_cast<ImageResourceData *>(img_resource.data);
+  upload_texture(texture_name,
+                 reinterpret_cast<ImageResourceData *>(img_resource.data), t);
+
+  resource_system_unload(&img_resource);
+  return true;
+}
 
+void upload_texture(cstr texture_name, ImageResourceData const *data,
+                    Texture *t) {
   // temp texture to load into
   Texture temp_texture;
   temp_texture.width = data->width;
   temp_texture.height = data->height;
   temp_texture.channel_count = data->channel_count;
+  temp_texture.format = data->format;
+  temp_texture.mip_count = data->mip_count;
 
   u32 current_generation = t->generation;
   t->generation = INVALID_ID;
-  usize total_size =
-      temp_texture.width * temp_texture.height * temp_texture.channel_count;
+  // The image loader only keeps the alpha of the compressed images with
+  // transparency
+  temp_texture.has_transparency = data->format == TextureFormat::BC3;
+  usize total_size = data->format == TextureFormat::RGBA8
+                         ? temp_texture.width * temp_texture.height *
+                               temp_texture.channel_count
+                         : 0;
   for (usize i = 0; i < total_size; i += temp_texture.channel_count) {
     if (data->pixels[i + 3] < 255) {
       temp_texture.has_transparency = true;
@@ -274,16 +376,17 @@ bool load_texture(cstr texture_name, Texture *t) {
   Texture old = *t;
   *t = temp_texture;
 
-  renderer_destroy_texture(&old);
+  // Textures loaded asynchronously have nothing to destroy before their
+  // first upload
+  if (old.internal_data) {
+    renderer_destroy_texture(&old);
+  }
 
   if (current_generation == INVALID_ID) {
     t->generation = 0;
   } else {
     t->generation = current_generation + 1;
   }
-
-  resource_system_unload(&img_resource);
-  return true;
 }
 
 void destroy_texture(Texture *t) {
@@ -7,6 +7,14 @@ namespace ns {
 
 struct texture_system_config {
   u32 max_texture_count;
+  // Threads decoding the textures of texture_system_acquire_async. With 0,
+  // texture_system_acquire_async loads synchronously.
+  u32 async_worker_count;
+  // Maximum number of textures being decoded at the same time
+  u32 async_queue_size;
+  // Maximum number of decoded textures uploaded by
+  // texture_system_process_async_loads (0: all of them)
+  u32 max_uploads_per_frame;
 };
 
 #define DEFAULT_TEXTURE_NAME "default"
@@ -18,6 +26,26 @@ void texture_system_shutdown(ptr state);
 
 Texture *texture_system_acquire(cstr name, bool auto_release);
 
+/**
+ * Acquires a texture without waiting for it to load: a new texture is
+ * decoded on a worker thread and uploaded by
+ * texture_system_process_async_loads. Until then its generation is
+ * INVALID_ID, so the renderer binds the default texture instead; the upload
+ * bumps the generation, which rebinds the real image.
+ * @param name the name of the texture
+ * @param auto_release whether to unload the texture when its reference count
+ *        reaches 0
+ * @returns the texture, or nullptr on failure
+ */
+Texture *texture_system_acquire_async(cstr name, bool auto_release);
+
+/**
+ * Uploads the textures decoded since the last call (at most
+ * max_uploads_per_frame). Call it once per frame, outside of the render
+ * passes.
+ */
+void texture_system_process_async_loads();
+
 void texture_system_release(cstr name);
 
 Texture *texture_system_get_default_texture();
@@ -0,0 +1,288 @@
+#include <core/logger.h>
+#include <core/memory.h>
+#include <core/string.h>
+#include <platform/filesystem.h>
+#include <resources/loaders/image_loader.h>
+#include <resources/loaders/loader_utils.h>
+#include <resources/loaders/material_loader.h>
+#include <resources/loaders/mesh_loader.h>
+#include <resources/obj_importer.h>
+#include <resources/pack.h>
+#include <resources/texture_cache.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Builds an asset pack (see engine/src/resources/pack.h) from a directory.
+// The entries are named by their path relative to the directory. The
+// materials are cooked: "materials/x.nsmt" is packed as "materials/x.nsmb",
+// and so are the meshes: "models/x.obj" is packed as "models/x.nsmesh", and
+// the images: "textures/x.png" is packed as "textures/x.nstc", with its mips
+// and block compressed (see image_cook).
+//
+// Usage: nspak <asset directory> <output.nspak> [--compress]
+//        nspak --cook <asset directory>
+//
+// --cook writes the cooked materials next to the text files instead, for the
+// release builds reading loose files.
+
+struct nspak_file {
+  std::string name;
+  std::string path;
+  usize size;
+  // The cooked image, when the file is one
+  std::vector<u8> cooked;
+};
+
+static bool is_material_text(std::filesystem::path const &path) {
+  return path.extension() == MATERIAL_TEXT_EXTENSION &&
+         path.parent_path().filename() == "materials";
+}
+
+// Replaces the text of a material by its cooked version
+static void cook_material(nspak_file *file, ns::pack_source *source) {
+  std::filesystem::path path = file->name;
+  ns::material_binary *binary = ns::alloc_n<ns::material_binary>(
+      1, ns::MemTag::ARRAY);
+  ns::material_cook(path.stem().string().c_str(),
+                    reinterpret_cast<cstr>(source->data), source->size,
+                    binary);
+  if (source->data) {
+    ns::free(const_cast<u8 *>(source->data), source->size,
+             ns::MemTag::ARRAY);
+  }
+  file->name = path.replace_extension(MATERIAL_BINARY_EXTENSION)
+                   .generic_string();
+  source->name = file->name.c_str();
+  source->data = AS_BYTES(binary);
+  source->size = sizeof(ns::material_binary);
+}
+
+static bool is_mesh_source(std::filesystem::path const &path) {
+  return path.extension() == MESH_SOURCE_EXTENSION &&
+         path.parent_path().filename() == "models";
+}
+
+// Replaces an OBJ file by its cooked mesh
+static bool cook_mesh(nspak_file *file, ns::pack_source *source) {
+  ns::MeshResourceData mesh;
+  if (!ns::obj_import(reinterpret_cast<cstr>(source->data), source->size,
+                      file->path.c_str(), &mesh)) {
+    return false;
+  }
+  u8 *binary =
+      reinterpret_cast<u8 *>(ns::alloc(mesh.data_size, ns::MemTag::ARRAY));
+  ns::mem_copy(binary, mesh.data, mesh.data_size);
+  if (source->data) {
+    ns::free(const_cast<u8 *>(source->data), source->size,
+             ns::MemTag::ARRAY);
+  }
+  std::filesystem::path path = file->name;
+  file->name =
+      path.replace_extension(MESH_BINARY_EXTENSION).generic_string();
+  source->name = file->name.c_str();
+  source->data = binary;
+  source->size = mesh.data_size;
+  ns::mesh_loader_free(&mesh);
+  return true;
+}
+
+static bool is_texture_source(std::filesystem::path const &path) {
+  return path.extension() == ".png" &&
+         path.parent_path().filename() == "textures";
+}
+
+// Replaces a PNG file by its cooked image. Before the memory system, whose
+// size depends on the cooked files: image_cook does not use it.
+static bool cook_texture(nspak_file *file) {
+  std::vector<u8> png(file->size);
+  ns::fs::File f;
+  usize read_size = 0;
+  bool ok = ns::fs::open(file->path.c_str(), ns::fs::Mode::READ, true, &f) &&
+            (png.empty() || ns::fs::read_all_bytes(&f, png.data(),
+                                                   &read_size));
+  ns::fs::close(&f);
+  ns::ImageResourceData image;
+  if (!ok || !ns::image_cook(file->name.c_str(), png.data(), png.size(),
+                             &image)) {
+    NS_ERROR("Failed to cook '%s'", file->path.c_str());
+    return false;
+  }
+  ns::texture_cache_header header = ns::texture_cache_header_create(&image, 0);
+  file->cooked.resize(sizeof(header) + header.pixels_size);
+  ns::mem_copy(file->cooked.data(), &header, sizeof(header));
+  ns::mem_copy(file->cooked.data() + sizeof(header), image.pixels,
+               header.pixels_size);
+  ns::image_loader_free_pixels(&image);
+  std::filesystem::path path = file->name;
+  file->name =
+      path.replace_extension(TEXTURE_CACHE_EXTENSION).generic_string();
+  file->size = file->cooked.size();
+  return true;
+}
+
+static int cook_materials(cstr directory) {
+  std::error_code error;
+  u32 count = 0;
+  for (auto const &entry :
+       std::filesystem::recursive_directory_iterator(directory, error)) {
+    if (!entry.is_regular_file() || !is_material_text(entry.path())) {
+      continue;
+    }
+    std::string path = entry.path().string();
+    std::string text(static_cast<usize>(entry.file_size()), '\0');
+    ns::fs::File f;
+    usize size = 0;
+    bool ok = ns::fs::open(path.c_str(), ns::fs::Mode::READ, true, &f) &&
+              (text.empty() || ns::fs::read(&f, text.size(), text.data(),
+                                            &size));
+    ns::fs::close(&f);
+    if (!ok) {
+      NS_ERROR("Failed to read '%s'", path.c_str());
+      return 1;
+    }
+
+    ns::material_binary binary;
+    ns::material_cook(entry.path().stem().string().c_str(), text.data(),
+                      text.size(), &binary);
+    // Checked by the development loader (cook_materials), which cooks the
+    // material again if its path to the text file is spelled otherwise
+    ns::fs::FileStat source;
+    if (ns::fs::stat(path.c_str(), &source)) {
+      binary.source_key = ns::resource_source_key(path.c_str(), source);
+    }
+    std::string out_path =
+        std::filesystem::path(path)
+            .replace_extension(MATERIAL_BINARY_EXTENSION)
+            .string();
+    usize written = 0;
+    ok = ns::fs::open(out_path.c_str(), ns::fs::Mode::WRITE, true, &f) &&
+         ns::fs::write(&f, sizeof(binary), &binary, &written);
+    ns::fs::close(&f);
+    if (!ok) {
+      NS_ERROR("Failed to write '%s'", out_path.c_str());
+      return 1;
+    }
+    count++;
+  }
+  if (error) {
+    NS_ERROR("Failed to list '%s': %s", directory, error.message().c_str());
+    return 1;
+  }
+  NS_INFO("%s: %u materials cooked.", directory, count);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc == 3 && ns::string_eq(argv[1], "--cook")) {
+    return cook_materials(argv[2]);
+  }
+  bool compress = argc == 4 && ns::string_eq(argv[3], "--compress");
+  if (argc != 3 && !compress) {
+    NS_ERROR("Usage: %s <asset directory> <output.nspak> [--compress]",
+             argv[0]);
+    NS_ERROR("       %s --cook <asset directory>", argv[0]);
+    return 1;
+  }
+  std::filesystem::path root = argv[1];
+  std::vector<nspak_file> files;
+  usize total_size = 0;
+  std::error_code error;
+  for (auto const &entry :
+       std::filesystem::recursive_directory_iterator(root, error)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    // Cooked from the text file and the OBJ file
+    if (entry.path().extension() == MATERIAL_BINARY_EXTENSION ||
+        entry.path().extension() == MESH_BINARY_EXTENSION) {
+      continue;
+    }
+    nspak_file file;
+    file.name = entry.path().lexically_relative(root).generic_string();
+    file.path = entry.path().string();
+    file.size = static_cast<usize>(entry.file_size());
+    if (is_texture_source(file.name) && !cook_texture(&file)) {
+      return 1;
+    }
+    total_size += file.size;
+    files.push_back(std::move(file));
+  }
+  if (error) {
+    NS_ERROR("Failed to list '%s': %s", argv[1], error.message().c_str());
+    return 1;
+  }
+  // Same pack for the same files
+  std::sort(files.begin(), files.end(),
+            [](nspak_file const &a, nspak_file const &b) {
+              return a.name < b.name;
+            });
+
+  // The files, their compressed copies and the table of contents
+  ns::memory_system_configuration memory_config;
+  memory_config.total_alloc_size =
+      total_size * 3 + files.size() * 1024 + 16 * 1024 * 1024;
+  ns::memory_system_initialize(memory_config);
+
+  std::vector<ns::pack_source> sources(files.size());
+  bool ok = true;
+  for (usize i = 0; i < files.size() && ok; i++) {
+    ns::pack_source &s = sources[i];
+    s.name = files[i].name.c_str();
+    s.size = files[i].size;
+    s.data = nullptr;
+    if (!files[i].cooked.empty()) {
+      s.data = files[i].cooked.data();
+      continue;
+    }
+    if (s.size == 0) {
+      continue;
+    }
+    u8 *data = reinterpret_cast<u8 *>(ns::alloc(s.size, ns::MemTag::ARRAY));
+    s.data = data;
+    ns::fs::File f;
+    usize read_size = 0;
+    ok = ns::fs::open(files[i].path.c_str(), ns::fs::Mode::READ, true, &f) &&
+         ns::fs::read_all_bytes(&f, data, &read_size);
+    ns::fs::close(&f);
+    if (!ok) {
+      NS_ERROR("Failed to read '%s'", files[i].path.c_str());
+    }
+  }
+  for (usize i = 0; i < files.size() && ok; i++) {
+    if (is_material_text(files[i].name)) {
+      cook_material(&files[i], &sources[i]);
+    } else if (is_mesh_source(files[i].name)) {
+      ok = cook_mesh(&files[i], &sources[i]);
+    }
+  }
+
+  ok = ok && ns::pack_write(argv[2], sources.data(),
+                            static_cast<u32>(sources.size()), compress);
+
+  if (ok) {
+    ns::pack p;
+    ok = ns::pack_open(argv[2], &p);
+    if (ok) {
+      u32 compressed = 0;
+      for (u32 i = 0; i < p.header->entry_count; i++) {
+        compressed += p.entries[i].compression != ns::PackCompression::NONE;
+      }
+      NS_INFO("%s: %u files (%u compressed), %llu bytes from %llu bytes.",
+              argv[2], p.header->entry_count, compressed, p.file.size,
+              total_size);
+      ns::pack_close(&p);
+    }
+  }
+
+  for (usize i = 0; i < sources.size(); i++) {
+    if (sources[i].data && files[i].cooked.empty()) {
+      ns::free(const_cast<u8 *>(sources[i].data), sources[i].size,
+               ns::MemTag::ARRAY);
+    }
+  }
+  ns::memory_system_shutdown();
+  return ok ? 0 : 1;
+}
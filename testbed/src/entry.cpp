@@ -9,6 +9,11 @@ bool create_game(game *out_game) {
   out_game->app_config.start_width = 1280;
   out_game->app_config.start_height = 720;
   out_game->app_config.name = "Test app";
+  out_game->app_config.target_frame_rate = 60.0f;
+  out_game->app_config.limit_frames = true;
+  out_game->app_config.fixed_update_rate = 60.0f;
+  out_game->app_config.late_input_sampling = true;
+  out_game->app_config.cook_materials = true;
 
   out_game->initialize = game_initialize;
   out_game->update = game_update;
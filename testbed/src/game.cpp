@@ -1,25 +1,23 @@
 #include "./game.h"
+#include <core/application.h>
 #include <core/event.h>
 #include <core/input.h>
 #include <core/logger.h>
 #include <core/memory.h>
+#include <core/profiler.h>
 #include <math/math.h>
 
 // HACK: remove include when possible
 #include <renderer/renderer_frontend.h>
 
-void recalculate_view_matrix(game_state *state) {
-  if (state->camera_dirty) {
-    state->view = ns::mat4::mk_euler_xyz(state->camera_euler)
-                      .translate(state->camera_position)
-                      .inverse();
-    state->camera_dirty = false;
-  }
+ns::mat4 interpolated_view_matrix(game_state *state, f32 t) {
+  return ns::transform::interpolate(state->prev_camera, state->camera, t)
+      .inverse_matrix();
 }
 
 void camera_yaw(game_state *state, f32 amount) {
   state->camera_euler.y += amount;
-  state->camera_dirty = true;
+  state->camera.set_rotation(ns::quat::from_euler_xyz(state->camera_euler));
 }
 
 void camera_pitch(game_state *state, f32 amount) {
@@ -32,16 +30,15 @@ void camera_pitch(game_state *state, f32 amount) {
     state->camera_euler.x = -89.0f;
   }
 
-  state->camera_dirty = true;
+  state->camera.set_rotation(ns::quat::from_euler_xyz(state->camera_euler));
 }
 
 bool game_initialize(game *game_inst) {
   game_state *state = reinterpret_cast<game_state *>(game_inst->state);
 
-  state->camera_position = {0.0f, 0.0f, 30.0f};
+  state->camera = ns::transform({0.0f, 0.0f, 30.0f});
   state->camera_euler = {};
-  state->camera_dirty = false;
-  state->view = ns::mat4::mk_translate(state->camera_position).inverse();
+  state->prev_camera = state->camera;
 
   return true;
 }
@@ -57,6 +54,25 @@ bool game_update(game *game_inst, f32 delta_time) {
              alloc_count - prev_alloc_count);
   }
 
+  if (ns::keyboard::pressed(NSK_P)) {
+    ns::profiler_log_stats();
+  }
+  if (ns::keyboard::pressed(NSK_O)) {
+    ns::profiler_capture(10, "profile.json");
+  }
+  if (ns::keyboard::pressed(NSK_L)) {
+    ns::frame_pacer_stats stats;
+    ns::application_get_frame_stats(&stats);
+    NS_DEBUG("Frame time (ms): target %.3f, min %.3f, avg %.3f, max %.3f, "
+             "jitter %.3f, max error %.3f, missed %u/%u",
+             stats.target * 1000.0, stats.min * 1000.0, stats.avg * 1000.0,
+             stats.max * 1000.0, stats.jitter * 1000.0,
+             stats.max_error * 1000.0, stats.missed_frames,
+             stats.frame_count);
+  }
+
+  state->prev_camera = state->camera;
+
   // TODO(ClementChambard): Temp
   if (ns::keyboard::released(NSK_T)) {
     NS_DEBUG("Swapping texture!");
@@ -80,17 +96,26 @@ bool game_update(game *game_inst, f32 delta_time) {
   if (ns::keyboard::down(NSK_DOWN)) {
     camera_pitch(state, -1.0f * delta_time);
   }
-  if (ns::keyboard::down(NSK_W)) {
-    vel += state->view.forward();
-  }
-  if (ns::keyboard::down(NSK_S)) {
-    vel += state->view.backward();
-  }
-  if (ns::keyboard::down(NSK_A)) {
-    vel += state->view.left();
-  }
-  if (ns::keyboard::down(NSK_D)) {
-    vel += state->view.right();
+  bool forward = ns::keyboard::down(NSK_W);
+  bool backward = ns::keyboard::down(NSK_S);
+  bool left = ns::keyboard::down(NSK_A);
+  bool right = ns::keyboard::down(NSK_D);
+  if (forward || backward || left || right) {
+    // The axes of the camera. It has no scale: its inverse is a transpose,
+    // not a full inverse
+    ns::mat4 view = state->camera.inverse_matrix();
+    if (forward) {
+      vel += view.forward();
+    }
+    if (backward) {
+      vel += view.backward();
+    }
+    if (left) {
+      vel += view.left();
+    }
+    if (right) {
+      vel += view.right();
+    }
   }
   if (ns::keyboard::down(NSK_SPACE)) {
     vel += ns::vec3::up();
@@ -99,18 +124,19 @@ bool game_update(game *game_inst, f32 delta_time) {
     vel += ns::vec3::down();
   }
   if (vel != ns::vec3{}) {
-    state->camera_position += mv_speed * vel.normalized();
-    state->camera_dirty = true;
+    state->camera.translate(mv_speed * vel.normalized());
   }
 
-  recalculate_view_matrix(state);
+  return true;
+}
+
+bool game_render(game *game_inst, f32 /*delta_time*/, f32 interpolation) {
+  game_state *state = reinterpret_cast<game_state *>(game_inst->state);
 
   // HACK: remove this call when possible
-  ns::renderer_set_view(state->view);
+  ns::renderer_set_view(interpolated_view_matrix(state, interpolation));
 
   return true;
 }
 
-bool game_render(game * /*game_inst*/, f32 /*delta_time*/) { return true; }
-
 void game_on_resize(game * /*game_inst*/, u32 /*width*/, u32 /*height*/) {}
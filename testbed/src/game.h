@@ -4,20 +4,21 @@
 #include <defines.h>
 #include <game_types.h>
 #include <math/math.h>
+#include <math/transform.h>
 
 struct game_state {
   f32 delta_time;
-  ns::mat4 view;
-  ns::vec3 camera_position;
+  ns::transform camera;
+  ns::transform prev_camera;
+  // pitch, yaw and roll: the rotation of camera is built from them
   ns::vec3 camera_euler;
-  bool camera_dirty;
 };
 
 bool game_initialize(game *game_inst);
 
 bool game_update(game *game_inst, f32 delta_time);
 
-bool game_render(game *game_inst, f32 delta_time);
+bool game_render(game *game_inst, f32 delta_time, f32 interpolation);
 
 void game_on_resize(game *game_inst, u32 width, u32 height);
 
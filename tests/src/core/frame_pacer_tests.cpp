@@ -0,0 +1,135 @@
+#include "./frame_pacer_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/frame_pacer.h>
+#include <defines.h>
+#include <math/math.h>
+
+// A clock that only moves when it is read or slept on: each read takes
+// FAKE_CLOCK_READ seconds, each sleep of 1ms oversleeps to
+// FAKE_CLOCK_SLEEP seconds, so the schedule is the same on every run.
+#define FAKE_CLOCK_READ 0.000001
+#define FAKE_CLOCK_SLEEP 0.0013
+
+struct fake_clock {
+  f64 time;
+  u32 sleep_count;
+};
+
+static f64 fake_clock_now(ptr user_data) {
+  fake_clock *c = reinterpret_cast<fake_clock *>(user_data);
+  c->time += FAKE_CLOCK_READ;
+  return c->time;
+}
+
+static void fake_clock_sleep(ptr user_data, u64 ms) {
+  fake_clock *c = reinterpret_cast<fake_clock *>(user_data);
+  c->time += static_cast<f64>(ms) * FAKE_CLOCK_SLEEP;
+  c->sleep_count++;
+}
+
+static ns::frame_pacer_clock fake_clock_make(fake_clock *c) {
+  *c = {};
+  return {fake_clock_now, fake_clock_sleep, c};
+}
+
+u8 frame_pacer_should_hold_target_rate() {
+  fake_clock c;
+  ns::frame_pacer_clock clock = fake_clock_make(&c);
+  ns::frame_pacer pacer;
+  pacer.start(100.0, &clock);
+
+  for (u32 i = 0; i < 25; i++) {
+    pacer.end_frame(true);
+  }
+
+  ns::frame_pacer_stats stats;
+  pacer.get_stats(&stats);
+  expect(25, stats.frame_count);
+  expect_f(0.01, stats.target);
+  // The spin never returns before the deadline, and stops at the first read
+  // after it
+  expect_true(stats.min >= 0.01 - 2 * FAKE_CLOCK_READ);
+  expect_true(stats.max <= 0.01 + 2 * FAKE_CLOCK_READ);
+  expect(0, stats.missed_frames);
+  // The coarse wait sleeps while more than a measured sleep is left
+  expect_true(c.sleep_count > 0);
+  expect_true(pacer.sleep_estimate >= FAKE_CLOCK_SLEEP);
+  expect_true(pacer.sleep_estimate <= FAKE_CLOCK_SLEEP + 2 * FAKE_CLOCK_READ);
+
+  return true;
+}
+
+u8 frame_pacer_should_not_catch_up_after_a_stall() {
+  fake_clock c;
+  ns::frame_pacer_clock clock = fake_clock_make(&c);
+  ns::frame_pacer pacer;
+  pacer.start(250.0, &clock);
+
+  pacer.end_frame(true);
+  // A frame three times too long
+  c.time += 0.012;
+  f64 stalled = pacer.end_frame(true);
+  f64 next = pacer.end_frame(true);
+
+  expect_true(stalled >= 0.012);
+  // The next frame gets a full target, not a shorter one to catch up
+  expect_true(next >= 0.004 - 2 * FAKE_CLOCK_READ);
+  expect_true(next <= 0.004 + 2 * FAKE_CLOCK_READ);
+  ns::frame_pacer_stats stats;
+  pacer.get_stats(&stats);
+  expect(1, stats.missed_frames);
+
+  return true;
+}
+
+u8 frame_pacer_should_not_wait_when_unlimited() {
+  fake_clock c;
+  ns::frame_pacer_clock clock = fake_clock_make(&c);
+  ns::frame_pacer pacer;
+  pacer.start(1.0, &clock);
+
+  for (u32 i = 0; i < 10; i++) {
+    pacer.end_frame(false);
+  }
+
+  ns::frame_pacer_stats stats;
+  pacer.get_stats(&stats);
+  expect(10, stats.frame_count);
+  expect(0, c.sleep_count);
+  expect_true(stats.max <= 2 * FAKE_CLOCK_READ);
+
+  return true;
+}
+
+u8 frame_pacer_should_keep_bounded_history() {
+  fake_clock c;
+  ns::frame_pacer_clock clock = fake_clock_make(&c);
+  ns::frame_pacer pacer;
+  pacer.start(0.0, &clock);
+
+  for (u32 i = 0; i < FRAME_PACER_HISTORY_SIZE + 10; i++) {
+    pacer.end_frame(true);
+  }
+
+  ns::frame_pacer_stats stats;
+  pacer.get_stats(&stats);
+  expect(FRAME_PACER_HISTORY_SIZE, stats.frame_count);
+  expect_f(0.0, stats.target);
+  expect(0, stats.missed_frames);
+  expect(0, c.sleep_count);
+
+  return true;
+}
+
+void frame_pacer_register_tests() {
+  test_manager_register_test(frame_pacer_should_hold_target_rate,
+                             "Frame pacer should hold target rate");
+  test_manager_register_test(frame_pacer_should_not_catch_up_after_a_stall,
+                             "Frame pacer should not catch up after a stall");
+  test_manager_register_test(frame_pacer_should_not_wait_when_unlimited,
+                             "Frame pacer should not wait when unlimited");
+  test_manager_register_test(frame_pacer_should_keep_bounded_history,
+                             "Frame pacer should keep bounded history");
+}
@@ -0,0 +1,6 @@
+#ifndef FRAME_PACER_TESTS_HEADER_INCLUDED
+#define FRAME_PACER_TESTS_HEADER_INCLUDED
+
+void frame_pacer_register_tests();
+
+#endif // FRAME_PACER_TESTS_HEADER_INCLUDED
@@ -0,0 +1,110 @@
+#include "./input_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/input.h>
+#include <core/memory.h>
+#include <defines.h>
+
+static ptr test_input_create(usize *memory_requirement) {
+  ns::InputManager::initialize(memory_requirement, nullptr);
+  ptr state = ns::alloc(*memory_requirement, ns::MemTag::UNKNOWN);
+  ns::InputManager::initialize(memory_requirement, state);
+  return state;
+}
+
+static void test_input_destroy(ptr state, usize memory_requirement) {
+  ns::InputManager::cleanup(state);
+  ns::free(state, memory_requirement, ns::MemTag::UNKNOWN);
+}
+
+u8 input_should_record_events_in_order() {
+  usize memory_requirement = 0;
+  ptr state = test_input_create(&memory_requirement);
+
+  ns::InputManager::process_key(NSK_A, true);
+  ns::InputManager::process_mouse_move(10, 20);
+  ns::InputManager::process_key(NSK_A, false);
+  ns::InputManager::process_button(NSB_LEFT, true);
+
+  expect(4, ns::input_event_count());
+  expect_true(ns::input_get_event(0)->type ==
+              ns::input_event_type::KEY_PRESSED);
+  expect(NSK_A, ns::input_get_event(0)->code);
+  expect_true(ns::input_get_event(1)->type ==
+              ns::input_event_type::MOUSE_MOVED);
+  expect(20, ns::input_get_event(1)->y);
+  expect_true(ns::input_get_event(2)->type ==
+              ns::input_event_type::KEY_RELEASED);
+  expect_true(ns::input_get_event(3)->type ==
+              ns::input_event_type::BUTTON_PRESSED);
+  expect(nullptr, ns::input_get_event(4));
+
+  for (u32 i = 1; i < 4; i++) {
+    expect_true(ns::input_get_event(i)->timestamp >=
+                ns::input_get_event(i - 1)->timestamp);
+  }
+
+  test_input_destroy(state, memory_requirement);
+  return true;
+}
+
+u8 input_should_count_presses_within_a_frame() {
+  usize memory_requirement = 0;
+  ptr state = test_input_create(&memory_requirement);
+
+  // Pressed and released between two updates: the state arrays miss it.
+  ns::InputManager::process_key(NSK_SPACE, true);
+  ns::InputManager::process_key(NSK_SPACE, false);
+  ns::InputManager::process_key(NSK_SPACE, true);
+  ns::InputManager::process_key(NSK_SPACE, false);
+  ns::InputManager::process_button(NSB_RIGHT, true);
+  ns::InputManager::process_mouse_wheel(2);
+  ns::InputManager::process_mouse_wheel(-1);
+
+  expect_false(ns::keyboard::pressed(NSK_SPACE));
+  expect(2, ns::keyboard::press_count(NSK_SPACE));
+  expect(0, ns::keyboard::press_count(NSK_A));
+  expect(1, ns::mouse::press_count(NSB_RIGHT));
+  expect(1, ns::mouse::wheel());
+
+  ns::InputManager::update(0.0);
+
+  expect(0, ns::input_event_count());
+  expect(0, ns::keyboard::press_count(NSK_SPACE));
+  expect(0, ns::mouse::wheel());
+  expect_true(ns::mouse::down(NSB_RIGHT));
+
+  test_input_destroy(state, memory_requirement);
+  return true;
+}
+
+u8 input_should_keep_latest_events_on_overflow() {
+  usize memory_requirement = 0;
+  ptr state = test_input_create(&memory_requirement);
+
+  for (i16 i = 1; i <= INPUT_EVENT_CAPACITY + 100; i++) {
+    ns::InputManager::process_mouse_move(i, 0);
+  }
+
+  expect(INPUT_EVENT_CAPACITY, ns::input_event_count());
+  expect(101, ns::input_get_event(0)->x);
+  expect(INPUT_EVENT_CAPACITY + 100,
+         ns::input_get_event(INPUT_EVENT_CAPACITY - 1)->x);
+
+  i32 x, y;
+  ns::mouse::position(&x, &y);
+  expect(INPUT_EVENT_CAPACITY + 100, x);
+
+  test_input_destroy(state, memory_requirement);
+  return true;
+}
+
+void input_register_tests() {
+  test_manager_register_test(input_should_record_events_in_order,
+                             "Input should record events in order");
+  test_manager_register_test(input_should_count_presses_within_a_frame,
+                             "Input should count presses within a frame");
+  test_manager_register_test(input_should_keep_latest_events_on_overflow,
+                             "Input should keep latest events on overflow");
+}
@@ -0,0 +1,6 @@
+#ifndef INPUT_TESTS_HEADER_INCLUDED
+#define INPUT_TESTS_HEADER_INCLUDED
+
+void input_register_tests();
+
+#endif // INPUT_TESTS_HEADER_INCLUDED
@@ -0,0 +1,170 @@
+#include "./profiler_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/memory.h>
+#include <core/profiler.h>
+#include <defines.h>
+#include <math/math.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+static ns::profiler_config test_profiler_config() {
+  return ns::profiler_config{4, 256, 32, 8, 256};
+}
+
+static ptr test_profiler_create(usize *memory_requirement) {
+  ns::profiler_system_initialize(memory_requirement, nullptr,
+                                 test_profiler_config());
+  ptr state = ns::alloc(*memory_requirement, ns::MemTag::UNKNOWN);
+  ns::profiler_system_initialize(memory_requirement, state,
+                                 test_profiler_config());
+  return state;
+}
+
+static void test_profiler_destroy(ptr state, usize memory_requirement) {
+  ns::profiler_system_shutdown(state);
+  ns::free(state, memory_requirement, ns::MemTag::UNKNOWN);
+}
+
+u8 profiler_should_build_hierarchy() {
+  usize memory_requirement = 0;
+  ptr state = test_profiler_create(&memory_requirement);
+
+  ns::profiler_begin_frame();
+  {
+    ns::profile_scope outer("outer");
+    for (u32 i = 0; i < 3; i++) {
+      ns::profile_scope inner("inner");
+    }
+  }
+  {
+    ns::profile_scope other("other");
+  }
+  ns::profiler_end_frame();
+
+  ns::profiler_stats outer{};
+  ns::profiler_stats inner{};
+  ns::profiler_stats other{};
+  ns::profiler_stats frame{};
+  expect_true(ns::profiler_get_stats("outer", &outer));
+  expect_true(ns::profiler_get_stats("outer/inner", &inner));
+  expect_true(ns::profiler_get_stats("other", &other));
+  expect_false(ns::profiler_get_stats("inner", &inner));
+  expect_false(ns::profiler_get_stats("outer/missing", &inner));
+  ns::profiler_get_frame_stats(&frame);
+
+  expect(1, outer.calls);
+  expect(3, inner.calls);
+  expect(1, other.calls);
+  expect_true(inner.last <= outer.last);
+  expect_true(outer.last + other.last <= frame.last);
+
+  test_profiler_destroy(state, memory_requirement);
+  return true;
+}
+
+u8 profiler_should_keep_rolling_stats() {
+  usize memory_requirement = 0;
+  ptr state = test_profiler_create(&memory_requirement);
+
+  // More frames than the stats window.
+  for (u32 f = 0; f < 20; f++) {
+    ns::profiler_begin_frame();
+    if (f % 2 == 0) {
+      ns::profile_scope scope("even");
+    }
+    ns::profiler_end_frame();
+  }
+
+  ns::profiler_stats even{};
+  expect_true(ns::profiler_get_stats("even", &even));
+  // The last frame was odd: no call, and the window contains empty frames.
+  expect(0, even.calls);
+  expect_f(0.0, even.min);
+  expect_true(even.min <= even.avg);
+  expect_true(even.avg <= even.max);
+
+  test_profiler_destroy(state, memory_requirement);
+  return true;
+}
+
+u8 profiler_should_merge_worker_threads() {
+  usize memory_requirement = 0;
+  ptr state = test_profiler_create(&memory_requirement);
+
+  ns::profiler_begin_frame();
+  std::thread workers[2];
+  for (auto &w : workers) {
+    w = std::thread([]() {
+      for (u32 i = 0; i < 10; i++) {
+        ns::profile_scope scope("job");
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  ns::profiler_end_frame();
+
+  ns::profiler_stats job{};
+  expect_true(ns::profiler_get_stats("job", &job));
+  expect(20, job.calls);
+
+  test_profiler_destroy(state, memory_requirement);
+  return true;
+}
+
+// Written in the working directory and removed by the test
+#define PROFILER_TEST_CAPTURE_PATH "profiler_test_capture.json"
+
+u8 profiler_should_escape_capture_names() {
+  usize memory_requirement = 0;
+  ptr state = test_profiler_create(&memory_requirement);
+
+  expect_true(ns::profiler_capture(1, PROFILER_TEST_CAPTURE_PATH));
+  ns::profiler_begin_frame();
+  {
+    ns::profile_scope scope("load \"a\\b\"\t");
+  }
+  ns::profiler_end_frame();
+  test_profiler_destroy(state, memory_requirement);
+
+  char text[1024];
+  FILE *f = fopen(PROFILER_TEST_CAPTURE_PATH, "rb");
+  expect_true(f != nullptr);
+  usize size = fread(text, 1, sizeof(text) - 1, f);
+  fclose(f);
+  remove(PROFILER_TEST_CAPTURE_PATH);
+  text[size] = '\0';
+
+  expect_true(strstr(text, "\"name\":\"load \\\"a\\\\b\\\"\\u0009\"") !=
+              nullptr);
+  return true;
+}
+
+u8 profiler_should_ignore_scopes_when_not_initialized() {
+  {
+    ns::profile_scope scope("orphan");
+  }
+  ns::profiler_stats stats{};
+  expect_false(ns::profiler_get_stats("orphan", &stats));
+  expect_false(ns::profiler_capture(1, "unused.json"));
+  return true;
+}
+
+void profiler_register_tests() {
+  test_manager_register_test(profiler_should_build_hierarchy,
+                             "Profiler should build scope hierarchy");
+  test_manager_register_test(profiler_should_keep_rolling_stats,
+                             "Profiler should keep rolling stats");
+  test_manager_register_test(profiler_should_merge_worker_threads,
+                             "Profiler should merge worker thread scopes");
+  test_manager_register_test(profiler_should_escape_capture_names,
+                             "Profiler should escape capture names");
+  test_manager_register_test(
+      profiler_should_ignore_scopes_when_not_initialized,
+      "Profiler should ignore scopes when not initialized");
+}
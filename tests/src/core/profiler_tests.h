@@ -0,0 +1,6 @@
+#ifndef PROFILER_TESTS_HEADER_INCLUDED
+#define PROFILER_TESTS_HEADER_INCLUDED
+
+void profiler_register_tests();
+
+#endif // PROFILER_TESTS_HEADER_INCLUDED
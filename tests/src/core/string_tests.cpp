@@ -0,0 +1,160 @@
+#include "./string_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/memory.h>
+#include <core/string.h>
+#include <core/string/strbuf.h>
+#include <core/string/string.h>
+#include <defines.h>
+
+u8 string_should_stay_inline_when_short() {
+  ns::String s;
+  expect_true(s.is_inline());
+  expect(0, s.len());
+  expect_true(s.c_str() == nullptr);
+  expect_true(ns::string_eq(s.data(), ""));
+
+  // Exactly the inline capacity: the tag byte doubles as the terminator.
+  s.push("0123456789012345678901");
+  s.push('2');
+  expect_true(s.is_inline());
+  expect(ns::String::INLINE_CAPACITY, s.len());
+  expect_true(ns::string_eq(s.c_str(), "01234567890123456789012"));
+
+  expect('2', s.pop());
+  expect(22, s.len());
+  s.erase(static_cast<usize>(0));
+  expect_true(ns::string_eq(s.c_str(), "123456789012345678901"));
+  return true;
+}
+
+u8 string_should_move_to_the_heap_when_long() {
+  ns::String s("short");
+  s.push(" and now long enough to leave the inline storage");
+  expect_false(s.is_inline());
+  expect(53, s.len());
+  expect_true(ns::string_eq(
+      s.c_str(), "short and now long enough to leave the inline storage"));
+
+  s.clear();
+  expect(0, s.len());
+  expect_false(s.is_inline());
+
+  s.free();
+  expect_true(s.is_inline());
+  expect(0, s.len());
+  return true;
+}
+
+u8 string_should_copy_and_move() {
+  ns::String small("abc");
+  ns::String large("a string that does not fit inline");
+
+  ns::String small_copy(small);
+  ns::String large_copy(large);
+  expect_true(ns::string_eq(small_copy.c_str(), "abc"));
+  expect_true(ns::string_eq(large_copy.c_str(), large.c_str()));
+  expect_true(large_copy.c_str() != large.c_str());
+
+  cstr large_data = large.c_str();
+  ns::String moved(static_cast<ns::String &&>(large));
+  expect_true(moved.c_str() == large_data);
+  expect(0, large.len());
+  expect_true(large.is_inline());
+
+  small = moved;
+  expect_true(ns::string_eq(small.c_str(), large_data));
+  moved = static_cast<ns::String &&>(small_copy);
+  expect_true(ns::string_eq(moved.c_str(), "abc"));
+  expect_true(moved.is_inline());
+  return true;
+}
+
+u8 string_should_format_without_allocating_when_it_fits() {
+  ns::String s;
+  u64 alloc_count = ns::get_memory_alloc_count();
+  s.push_fmt("%s/%d", "id", 42);
+  expect(alloc_count, ns::get_memory_alloc_count());
+  expect_true(s.is_inline());
+  expect_true(ns::string_eq(s.c_str(), "id/42"));
+
+  s.push_fmt("/%s", "a longer suffix that has to grow the string");
+  expect_false(s.is_inline());
+  expect_true(ns::string_eq(
+      s.c_str(), "id/42/a longer suffix that has to grow the string"));
+  return true;
+}
+
+u8 string_buffer_should_truncate_and_terminate() {
+  char buffer[8];
+  ns::StrBuf b(buffer);
+  expect(7, b.capacity());
+
+  b.push("ab").push('c').push_fmt("%d", 12);
+  expect(5, b.len());
+  expect_false(b.truncated());
+  expect_true(ns::string_eq(buffer, "abc12"));
+
+  b.push_fmt("%s", "overflow");
+  expect(7, b.len());
+  expect_true(b.truncated());
+  expect_true(ns::string_eq(buffer, "abc12ov"));
+
+  b.clear();
+  b.push(ns::Str("xyz"));
+  expect_false(b.truncated());
+  expect_true(ns::string_eq(b.c_str(), "xyz"));
+  return true;
+}
+
+u8 string_scratch_fmt_should_return_terminated_views() {
+  ns::Str a = ns::string_scratch_fmt("%s_%d", "tex", 1);
+  ns::Str b = ns::string_scratch_fmt("%s_%d", "tex", 2);
+  expect(5, a.len());
+  expect_true(ns::string_eq(a.begin(), "tex_1"));
+  expect_true(ns::string_eq(b.begin(), "tex_2"));
+
+  // Wrapping around the ring never produces a view past its end.
+  for (u32 i = 0; i < 100; i++) {
+    ns::Str s = ns::string_scratch_fmt("%0512d", i);
+    expect(512, s.len());
+    expect(0, s.begin()[s.len()]);
+  }
+  return true;
+}
+
+u8 str_should_trim_and_compare() {
+  ns::Str s(" \tdiffuse_color = 1 0 0 1  ");
+  isize equal_index = s.indexof('=');
+  expect(16, equal_index);
+  ns::Str name = ns::Str(s.sub(0, static_cast<usize>(equal_index))).trim();
+  ns::Str value = ns::Str(s.sub(static_cast<usize>(equal_index) + 1)).trim();
+  expect_true(name.eq("diffuse_color"));
+  expect_true(name.EQ("Diffuse_Color"));
+  expect_false(name.eq("diffuse"));
+  expect_false(name.eq("diffuse_color_2"));
+  expect(7, value.len());
+  expect_true(value.eq("1 0 0 1"));
+  expect(-1, value.indexof('='));
+  expect(0, ns::Str("   ").trim().len());
+  return true;
+}
+
+void string_register_tests() {
+  test_manager_register_test(string_should_stay_inline_when_short,
+                             "String stays inline up to 23 characters");
+  test_manager_register_test(string_should_move_to_the_heap_when_long,
+                             "String moves to the heap when too long");
+  test_manager_register_test(string_should_copy_and_move,
+                             "String copies and moves");
+  test_manager_register_test(
+      string_should_format_without_allocating_when_it_fits,
+      "String formats without allocating when it fits");
+  test_manager_register_test(string_buffer_should_truncate_and_terminate,
+                             "StrBuf truncates and stays terminated");
+  test_manager_register_test(string_scratch_fmt_should_return_terminated_views,
+                             "Scratch format returns terminated views");
+  test_manager_register_test(str_should_trim_and_compare,
+                             "Str trims and compares without copying");
+}
@@ -0,0 +1,6 @@
+#ifndef STRING_TESTS_HEADER_INCLUDED
+#define STRING_TESTS_HEADER_INCLUDED
+
+void string_register_tests();
+
+#endif // STRING_TESTS_HEADER_INCLUDED
@@ -2,7 +2,32 @@
 
 #include "./containers/freelist_tests.h"
 #include "./containers/hashtable_tests.h"
+#include "./core/frame_pacer_tests.h"
+#include "./core/input_tests.h"
+#include "./core/profiler_tests.h"
+#include "./core/string_tests.h"
+#include "./math/batch_tests.h"
+#include "./math/bounds_tests.h"
+#include "./math/fast_tests.h"
+#include "./math/packing_tests.h"
+#include "./math/random_tests.h"
+#include "./math/simd_tests.h"
+#include "./math/transform_tests.h"
+#include "./math/types_tests.h"
+#include "./memory/dynamic_allocator_tests.h"
 #include "./memory/linear_allocator_tests.h"
+#include "./platform/ticks_tests.h"
+#include "./resources/block_compression_tests.h"
+#include "./resources/image_decoder_tests.h"
+#include "./resources/material_loader_tests.h"
+#include "./resources/mesh_loader_tests.h"
+#include "./resources/mesh_optimizer_tests.h"
+#include "./resources/mipmap_tests.h"
+#include "./resources/pack_tests.h"
+#include "./resources/resource_cache_tests.h"
+#include "./resources/texture_cache_tests.h"
+#include "./systems/geometry_tests.h"
+#include "./systems/resource_system_tests.h"
 
 #include <core/logger.h>
 
@@ -10,9 +35,33 @@ int main() {
   NS_DEBUG("Starting tests...");
 
   linear_allocator_register_tests();
+  dynamic_allocator_register_tests();
   hashtable_register_tests();
   freelist_register_tests();
-  NS_WARN("Dynamic allocator tests not implemented. TODO!");
+  profiler_register_tests();
+  frame_pacer_register_tests();
+  ticks_register_tests();
+  input_register_tests();
+  string_register_tests();
+  resource_system_register_tests();
+  image_decoder_register_tests();
+  pack_register_tests();
+  material_loader_register_tests();
+  texture_cache_register_tests();
+  mipmap_register_tests();
+  block_compression_register_tests();
+  mesh_loader_register_tests();
+  mesh_optimizer_register_tests();
+  resource_cache_register_tests();
+  simd_register_tests();
+  math_types_register_tests();
+  batch_register_tests();
+  random_register_tests();
+  bounds_register_tests();
+  fast_register_tests();
+  packing_register_tests();
+  transform_register_tests();
+  geometry_register_tests();
 
   test_manager_run_tests();
 
@@ -0,0 +1,220 @@
+#include "./batch_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <defines.h>
+#include <math/batch.h>
+#include <math/math.h>
+
+// The kernels are checked against the per-element mat4 math. The counts are
+// not multiples of the SIMD widths so the scalar tails are covered too.
+
+#define BATCH_TEST_COUNT 1003
+#define BATCH_TEST_TOLERANCE 1e-5f
+
+static u32 batch_test_seed = 7;
+
+static f32 batch_test_rand(f32 min, f32 max) {
+  batch_test_seed = batch_test_seed * 1664525u + 1013904223u;
+  f32 t = static_cast<f32>(batch_test_seed >> 8) / static_cast<f32>(1u << 24);
+  return min + (max - min) * t;
+}
+
+static bool batch_test_near(f32 expected, f32 actual,
+                            f32 tolerance = BATCH_TEST_TOLERANCE) {
+  f32 scale = ns::abs(expected) > 1.0f ? ns::abs(expected) : 1.0f;
+  return ns::abs(expected - actual) <= tolerance * scale;
+}
+
+static bool batch_test_near(ns::mat4 const &expected, ns::mat4 const &actual,
+                            f32 tolerance = BATCH_TEST_TOLERANCE) {
+  for (u32 i = 0; i < 16; i++) {
+    if (!batch_test_near(expected.data[i], actual.data[i], tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static ns::mat4 batch_test_mat4() {
+  return ns::mat4::mk_euler_xyz(batch_test_rand(-3.0f, 3.0f),
+                                batch_test_rand(-3.0f, 3.0f),
+                                batch_test_rand(-3.0f, 3.0f))
+      .pre_translate(ns::vec3(batch_test_rand(-10.0f, 10.0f),
+                              batch_test_rand(-10.0f, 10.0f),
+                              batch_test_rand(-10.0f, 10.0f)));
+}
+
+struct batch_test_vec3_arrays {
+  f32 x[BATCH_TEST_COUNT];
+  f32 y[BATCH_TEST_COUNT];
+  f32 z[BATCH_TEST_COUNT];
+
+  ns::vec3_soa soa() { return {x, y, z}; }
+};
+
+static batch_test_vec3_arrays batch_in;
+static batch_test_vec3_arrays batch_out;
+
+static void batch_test_fill(batch_test_vec3_arrays &a, f32 min, f32 max) {
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    a.x[i] = batch_test_rand(min, max);
+    a.y[i] = batch_test_rand(min, max);
+    a.z[i] = batch_test_rand(min, max);
+  }
+}
+
+u8 batch_transform_should_match_mat4() {
+  ns::mat4 m = batch_test_mat4();
+  batch_test_fill(batch_in, -100.0f, 100.0f);
+
+  for (u32 w = 0; w < 2; w++) {
+    if (w) {
+      ns::batch_transform_points(m, batch_in.soa(), batch_out.soa(),
+                                 BATCH_TEST_COUNT);
+    } else {
+      ns::batch_transform_directions(m, batch_in.soa(), batch_out.soa(),
+                                     BATCH_TEST_COUNT);
+    }
+    for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+      // Row vector times matrix
+      ns::vec4 p(batch_in.x[i], batch_in.y[i], batch_in.z[i],
+                 static_cast<f32>(w));
+      ns::vec4 expected = m.transposed() * p;
+      expect_true(batch_test_near(expected.x, batch_out.x[i]));
+      expect_true(batch_test_near(expected.y, batch_out.y[i]));
+      expect_true(batch_test_near(expected.z, batch_out.z[i]));
+    }
+  }
+
+  // In place, in chunks
+  batch_out = batch_in;
+  usize chunks = ns::batch_chunk_count(BATCH_TEST_COUNT, 100);
+  for (usize c = 0; c < chunks; c++) {
+    ns::batch_range r = ns::batch_chunk(c, BATCH_TEST_COUNT, 100);
+    ns::vec3_soa arrays = batch_out.soa().offset(r.begin);
+    ns::batch_transform_points(m, arrays, arrays, r.count());
+  }
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    ns::vec4 expected =
+        m.transposed() * ns::vec4(batch_in.x[i], batch_in.y[i], batch_in.z[i],
+                                  1.0f);
+    expect_true(batch_test_near(expected.x, batch_out.x[i]));
+    expect_true(batch_test_near(expected.y, batch_out.y[i]));
+    expect_true(batch_test_near(expected.z, batch_out.z[i]));
+  }
+  return true;
+}
+
+u8 batch_chunks_should_cover_the_array() {
+  const usize counts[] = {0, 1, 7, 8, 100, 1003, BATCH_CHUNK_SIZE * 3 + 5};
+  const usize chunk_sizes[] = {1, 8, 100, BATCH_CHUNK_SIZE};
+  for (usize count : counts) {
+    for (usize chunk_size : chunk_sizes) {
+      usize chunks = ns::batch_chunk_count(count, chunk_size);
+      usize next = 0;
+      for (usize c = 0; c < chunks; c++) {
+        ns::batch_range r = ns::batch_chunk(c, count, chunk_size);
+        expect(next, r.begin);
+        expect_true(r.end > r.begin);
+        expect(0ull, r.begin % BATCH_CHUNK_ALIGN);
+        next = r.end;
+      }
+      expect(count, next);
+    }
+  }
+  return true;
+}
+
+static f32 batch_qx[BATCH_TEST_COUNT], batch_qy[BATCH_TEST_COUNT],
+    batch_qz[BATCH_TEST_COUNT], batch_qw[BATCH_TEST_COUNT];
+static batch_test_vec3_arrays batch_scales;
+static ns::mat4 batch_matrices[BATCH_TEST_COUNT];
+static ns::mat4 batch_local[BATCH_TEST_COUNT];
+static ns::mat4 batch_world[BATCH_TEST_COUNT];
+static u32 batch_parents[BATCH_TEST_COUNT];
+
+u8 batch_model_matrices_should_match_mat4() {
+  batch_test_fill(batch_in, -50.0f, 50.0f);
+  batch_test_fill(batch_scales, 0.1f, 4.0f);
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    ns::quat q(batch_test_rand(-1.0f, 1.0f), batch_test_rand(-1.0f, 1.0f),
+               batch_test_rand(-1.0f, 1.0f), batch_test_rand(-1.0f, 1.0f));
+    q.normalize();
+    batch_qx[i] = q.x;
+    batch_qy[i] = q.y;
+    batch_qz[i] = q.z;
+    batch_qw[i] = q.w;
+  }
+
+  ns::batch_model_matrices(batch_in.soa(),
+                           {batch_qx, batch_qy, batch_qz, batch_qw},
+                           batch_scales.soa(), batch_matrices,
+                           BATCH_TEST_COUNT);
+
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    ns::quat q(batch_qx[i], batch_qy[i], batch_qz[i], batch_qw[i]);
+    ns::mat4 expected =
+        ns::mat4::mk_scale(
+            ns::vec3(batch_scales.x[i], batch_scales.y[i], batch_scales.z[i])) *
+        q.matrix() *
+        ns::mat4::mk_translate(
+            ns::vec3(batch_in.x[i], batch_in.y[i], batch_in.z[i]));
+    expect_true(batch_test_near(expected, batch_matrices[i]));
+  }
+  return true;
+}
+
+u8 batch_compose_should_match_mat4() {
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    batch_local[i] = batch_test_mat4();
+    batch_matrices[i] = batch_test_mat4();
+  }
+
+  ns::batch_multiply(batch_local, batch_matrices, batch_world,
+                     BATCH_TEST_COUNT);
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    expect_true(batch_test_near(batch_local[i] * batch_matrices[i], batch_world[i],
+                                0.0f));
+  }
+
+  // A hierarchy sorted parents first: every 10th node is a root.
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    batch_parents[i] = i % 10 == 0 ? INVALID_ID : i - 1 - (i % 3 == 0);
+  }
+  ns::batch_compose_hierarchy(batch_local, batch_parents, batch_world,
+                              BATCH_TEST_COUNT);
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    ns::mat4 expected = batch_local[i];
+    for (u32 p = batch_parents[i]; p != INVALID_ID; p = batch_parents[p]) {
+      expected = expected * batch_local[p];
+    }
+    // The products are not associated in the same order.
+    expect_true(batch_test_near(expected, batch_world[i], 1e-4f));
+  }
+
+  // One level against fixed parents
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    batch_parents[i] = i % 4 == 0 ? INVALID_ID : (i * 7) % BATCH_TEST_COUNT;
+  }
+  ns::batch_compose(batch_local, batch_matrices, batch_parents, batch_world,
+                    BATCH_TEST_COUNT);
+  for (u32 i = 0; i < BATCH_TEST_COUNT; i++) {
+    ns::mat4 expected = batch_parents[i] == INVALID_ID
+                            ? batch_local[i]
+                            : batch_local[i] * batch_matrices[batch_parents[i]];
+    expect_true(batch_test_near(expected, batch_world[i], 0.0f));
+  }
+  return true;
+}
+
+void batch_register_tests() {
+  test_manager_register_test(batch_transform_should_match_mat4,
+                             "Batch transforms should match mat4");
+  test_manager_register_test(batch_chunks_should_cover_the_array,
+                             "Batch chunks should cover the array");
+  test_manager_register_test(batch_model_matrices_should_match_mat4,
+                             "Batch model matrices should match mat4");
+  test_manager_register_test(batch_compose_should_match_mat4,
+                             "Batch compose should match mat4");
+}
@@ -0,0 +1,6 @@
+#ifndef BATCH_TESTS_HEADER_INCLUDED
+#define BATCH_TESTS_HEADER_INCLUDED
+
+void batch_register_tests();
+
+#endif // BATCH_TESTS_HEADER_INCLUDED
@@ -0,0 +1,148 @@
+#include "./bounds_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <defines.h>
+#include <math/bounds.h>
+#include <math/math.h>
+#include <math/random.h>
+
+#define BOUNDS_TEST_COUNT 1003
+
+// The camera of the renderer: 45 degrees, 16/9, looking down -z from z = 30
+static ns::frustum bounds_test_frustum() {
+  ns::mat4 projection =
+      ns::mat4::perspective(ns::PI_1_4<f32>, 1280.0f / 720.0f, 0.01f, 1000.0f);
+  ns::mat4 view = ns::mat4::mk_translate({0.0f, 0.0f, -30.0f});
+  return ns::frustum(view * projection);
+}
+
+static ns::vec3 bounds_test_point(ns::vec3 const &p, ns::mat4 const &m) {
+  ns::vec4 v = m.transposed() * ns::vec4(p.x, p.y, p.z, 1.0f);
+  return {v.x, v.y, v.z};
+}
+
+u8 aabb_should_bound_points_and_transforms() {
+  ns::vec3 points[] = {{1.0f, -2.0f, 3.0f}, {-4.0f, 5.0f, 0.5f},
+                       {2.0f, 2.0f, -6.0f}};
+  ns::aabb box = ns::aabb::from_points(points, 3);
+  expect_true(box.min == ns::vec3(-4.0f, -2.0f, -6.0f));
+  expect_true(box.max == ns::vec3(2.0f, 5.0f, 3.0f));
+  for (ns::vec3 const &p : points) {
+    expect_true(box.contains(p));
+  }
+
+  ns::mat4 m = ns::mat4::mk_euler_xyz(0.3f, -1.1f, 2.0f)
+                   .pre_translate(ns::vec3(5.0f, -3.0f, 8.0f));
+  ns::aabb t = box.transformed(m);
+  // The transformed corners define the exact box.
+  ns::vec3 corners[8];
+  for (u32 i = 0; i < 8; i++) {
+    ns::vec3 c((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y,
+               (i & 4) ? box.max.z : box.min.z);
+    corners[i] = bounds_test_point(c, m);
+  }
+  ns::aabb expected = ns::aabb::from_points(corners, 8);
+  for (u32 i = 0; i < 3; i++) {
+    expect_f(expected.min.elements[i], t.min.elements[i]);
+    expect_f(expected.max.elements[i], t.max.elements[i]);
+  }
+  return true;
+}
+
+u8 frustum_should_match_the_projection() {
+  ns::frustum f = bounds_test_frustum();
+  for (ns::plane const &p : f.planes) {
+    expect_f(1.0f, p.normal.length());
+  }
+
+  expect_true(f.contains({0.0f, 0.0f, 0.0f}));
+  expect_true(f.contains({0.0f, 0.0f, -900.0f}));
+  // Behind the camera, beyond the far plane, outside the sides
+  expect_false(f.contains({0.0f, 0.0f, 31.0f}));
+  expect_false(f.contains({0.0f, 0.0f, -1000.0f}));
+  expect_false(f.contains({30.0f, 0.0f, 0.0f}));
+  expect_false(f.contains({0.0f, -20.0f, 0.0f}));
+
+  // Random points against their clip coordinates
+  ns::mat4 view_projection =
+      ns::mat4::mk_translate({0.0f, 0.0f, -30.0f}) *
+      ns::mat4::perspective(ns::PI_1_4<f32>, 1280.0f / 720.0f, 0.01f, 1000.0f);
+  ns::rng g(3);
+  for (u32 i = 0; i < 1000; i++) {
+    ns::vec3 p(g.range_f32(-100.0f, 100.0f), g.range_f32(-100.0f, 100.0f),
+               g.range_f32(-200.0f, 40.0f));
+    ns::vec4 clip =
+        view_projection.transposed() * ns::vec4(p.x, p.y, p.z, 1.0f);
+    bool inside = clip.x >= -clip.w && clip.x <= clip.w &&
+                  clip.y >= -clip.w && clip.y <= clip.w &&
+                  clip.z >= -clip.w && clip.z <= clip.w;
+    expect(inside, f.contains(p));
+  }
+
+  // A box and a sphere straddling the left plane are visible.
+  expect_true(f.intersects(ns::aabb({-40.0f, -1.0f, -1.0f}, {-5.0f, 1.0f, 1.0f})));
+  expect_false(f.intersects(ns::aabb({-40.0f, -1.0f, -1.0f}, {-30.0f, 1.0f, 1.0f})));
+  expect_true(f.intersects(ns::sphere{{-25.0f, 0.0f, 0.0f}, 15.0f}));
+  expect_false(f.intersects(ns::sphere{{-25.0f, 0.0f, 0.0f}, 1.0f}));
+  return true;
+}
+
+static f32 bounds_cx[BOUNDS_TEST_COUNT], bounds_cy[BOUNDS_TEST_COUNT],
+    bounds_cz[BOUNDS_TEST_COUNT];
+static f32 bounds_ex[BOUNDS_TEST_COUNT], bounds_ey[BOUNDS_TEST_COUNT],
+    bounds_ez[BOUNDS_TEST_COUNT];
+
+u8 frustum_cull_should_match_scalar() {
+  ns::frustum f = bounds_test_frustum();
+  ns::rng g(11);
+  for (u32 i = 0; i < BOUNDS_TEST_COUNT; i++) {
+    bounds_cx[i] = g.range_f32(-60.0f, 60.0f);
+    bounds_cy[i] = g.range_f32(-40.0f, 40.0f);
+    bounds_cz[i] = g.range_f32(-100.0f, 50.0f);
+    bounds_ex[i] = g.range_f32(0.0f, 5.0f);
+    bounds_ey[i] = g.range_f32(0.0f, 5.0f);
+    bounds_ez[i] = g.range_f32(0.0f, 5.0f);
+  }
+
+  u32 visibility[ns::cull_mask_word_count(BOUNDS_TEST_COUNT)];
+  u32 visible = ns::frustum_cull_aabbs(
+      f, {bounds_cx, bounds_cy, bounds_cz, bounds_ex, bounds_ey, bounds_ez},
+      BOUNDS_TEST_COUNT, visibility);
+  u32 expected_visible = 0;
+  for (u32 i = 0; i < BOUNDS_TEST_COUNT; i++) {
+    ns::vec3 c(bounds_cx[i], bounds_cy[i], bounds_cz[i]);
+    ns::vec3 e(bounds_ex[i], bounds_ey[i], bounds_ez[i]);
+    bool expected = f.intersects(ns::aabb(c - e, c + e));
+    expect(expected, ns::cull_mask_visible(visibility, i));
+    expected_visible += expected;
+  }
+  expect(expected_visible, visible);
+  // Both cases are covered.
+  expect_true(visible > 100 && visible < BOUNDS_TEST_COUNT - 100);
+
+  visible = ns::frustum_cull_spheres(
+      f, {bounds_cx, bounds_cy, bounds_cz, bounds_ex}, BOUNDS_TEST_COUNT,
+      visibility);
+  expected_visible = 0;
+  for (u32 i = 0; i < BOUNDS_TEST_COUNT; i++) {
+    ns::sphere s{{bounds_cx[i], bounds_cy[i], bounds_cz[i]}, bounds_ex[i]};
+    bool expected = f.intersects(s);
+    expect(expected, ns::cull_mask_visible(visibility, i));
+    expected_visible += expected;
+  }
+  expect(expected_visible, visible);
+
+  // The bits past count stay clear.
+  expect(0u, visibility[BOUNDS_TEST_COUNT / 32] >> (BOUNDS_TEST_COUNT % 32));
+  return true;
+}
+
+void bounds_register_tests() {
+  test_manager_register_test(aabb_should_bound_points_and_transforms,
+                             "Aabb bounds points and transforms");
+  test_manager_register_test(frustum_should_match_the_projection,
+                             "Frustum matches the projection");
+  test_manager_register_test(frustum_cull_should_match_scalar,
+                             "Frustum culling matches the scalar tests");
+}
@@ -0,0 +1,6 @@
+#ifndef BOUNDS_TESTS_HEADER_INCLUDED
+#define BOUNDS_TESTS_HEADER_INCLUDED
+
+void bounds_register_tests();
+
+#endif // BOUNDS_TESTS_HEADER_INCLUDED
@@ -0,0 +1,99 @@
+#include "./fast_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <defines.h>
+#include <math/fast.h>
+#include <math/math.h>
+
+#include <math.h>
+
+// Checks the error bounds documented in math/fast.h against libm (in double
+// precision), on a dense sweep of the valid range.
+
+#define FAST_TRIG_MAX_ERROR 4e-7
+#define FAST_TRIG_RANGE 1e4f
+#define FAST_TRIG_STEPS 2000000
+
+static f32 fast_test_angle(u32 i) {
+  // Dense around 0, then the whole range
+  f32 t = static_cast<f32>(i) / static_cast<f32>(FAST_TRIG_STEPS);
+  if (i % 2 == 0) {
+    return (t - 0.5f) * 4.0f * ns::PI<f32>;
+  }
+  return (t - 0.5f) * 2.0f * FAST_TRIG_RANGE;
+}
+
+u8 fast_sin_cos_should_be_within_bounds() {
+  f64 max_sin = 0.0;
+  f64 max_cos = 0.0;
+  for (u32 i = 0; i < FAST_TRIG_STEPS; i++) {
+    f32 x = fast_test_angle(i);
+    max_sin = fmax(max_sin, fabs(::sin(static_cast<f64>(x)) - ns::fast_sin(x)));
+    max_cos = fmax(max_cos, fabs(::cos(static_cast<f64>(x)) - ns::fast_cos(x)));
+  }
+  NS_DEBUG("fast_sin max error: %g, fast_cos max error: %g", max_sin, max_cos);
+  expect_true(max_sin <= FAST_TRIG_MAX_ERROR);
+  expect_true(max_cos <= FAST_TRIG_MAX_ERROR);
+  expect_true(ns::fast_sin(0.0f) == 0.0f);
+  return true;
+}
+
+u8 fast_rsqrt_should_be_within_bounds() {
+  f64 max_error = 0.0;
+  // Every exponent, with many mantissas
+  for (f32 x = 1e-30f; x < 1e30f; x *= 1.0001f) {
+    f64 expected = 1.0 / ::sqrt(static_cast<f64>(x));
+    max_error = fmax(max_error, fabs(ns::fast_rsqrt(x) - expected) / expected);
+    expect_true(ns::fast_sqrt(x) == sqrtf(x));
+  }
+  NS_DEBUG("fast_rsqrt max relative error: %g", max_error);
+  expect_true(max_error <= NS_FAST_RSQRT_MAX_ERROR);
+
+  // The bound of fast_rsqrt, plus the rounding of the products
+  f32 length_error = static_cast<f32>(NS_FAST_RSQRT_MAX_ERROR) + 5e-7f;
+  ns::vec3 v(3.0f, -4.0f, 12.0f);
+  expect_true(ns::abs(v.normalized_fast().length() - 1.0f) <= length_error);
+  ns::vec4 v4(3.0f, -4.0f, 12.0f, 84.0f);
+  expect_true(ns::abs(v4.normalized_fast().length() - 1.0f) <= length_error);
+  ns::quat q(1.0f, 2.0f, 3.0f, 4.0f);
+  expect_true(ns::abs(q.normalized_fast().normal() - 1.0f) <= length_error);
+  return true;
+}
+
+u8 fast_simd_should_match_scalar() {
+#if defined(NS_USE_SIMD)
+  for (u32 i = 0; i < FAST_TRIG_STEPS; i += 4) {
+    f32 x[4] = {fast_test_angle(i), fast_test_angle(i + 1),
+                fast_test_angle(i + 2), fast_test_angle(i + 3)};
+    f32 s[4];
+    f32 c[4];
+    _mm_storeu_ps(s, ns::simd_fast_sin(_mm_loadu_ps(x)));
+    _mm_storeu_ps(c, ns::simd_fast_cos(_mm_loadu_ps(x)));
+    for (u32 j = 0; j < 4; j++) {
+      expect_true(fabs(::sin(static_cast<f64>(x[j])) - s[j]) <=
+                  FAST_TRIG_MAX_ERROR);
+      expect_true(fabs(::cos(static_cast<f64>(x[j])) - c[j]) <=
+                  FAST_TRIG_MAX_ERROR);
+    }
+  }
+  for (f32 x = 1e-30f; x < 1e30f; x *= 1.01f) {
+    f32 r[4];
+    _mm_storeu_ps(r, ns::simd_fast_rsqrt(_mm_set1_ps(x)));
+    f64 expected = 1.0 / ::sqrt(static_cast<f64>(x));
+    expect_true(fabs(r[0] - expected) / expected <= NS_FAST_RSQRT_MAX_ERROR);
+  }
+  return true;
+#else
+  return BYPASS;
+#endif
+}
+
+void fast_register_tests() {
+  test_manager_register_test(fast_sin_cos_should_be_within_bounds,
+                             "fast_sin and fast_cos are within their bounds");
+  test_manager_register_test(fast_rsqrt_should_be_within_bounds,
+                             "fast_rsqrt is within its bounds");
+  test_manager_register_test(fast_simd_should_match_scalar,
+                             "SIMD fast functions are within their bounds");
+}
@@ -0,0 +1,6 @@
+#ifndef FAST_TESTS_HEADER_INCLUDED
+#define FAST_TESTS_HEADER_INCLUDED
+
+void fast_register_tests();
+
+#endif // FAST_TESTS_HEADER_INCLUDED
@@ -0,0 +1,189 @@
+#include "./packing_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <defines.h>
+#include <math/math.h>
+#include <math/packing.h>
+#include <math/random.h>
+
+#include <math.h>
+
+// Checks the error bounds documented in math/packing.h.
+
+#define PACKING_OCT16_MAX_ANGLE 1e-4
+#define PACKING_VERTEX_COUNT 10000
+
+union packing_test_bits {
+  f32 f;
+  u32 u;
+};
+
+u8 packing_half_should_round_trip() {
+  // Every half that is not a NaN decodes to a float that encodes back to it
+  for (u32 h = 0; h < 0x10000u; h++) {
+    if ((h & 0x7C00u) == 0x7C00u && (h & 0x03FFu) != 0) {
+      continue;
+    }
+    expect(ns::half_encode(ns::half_decode(static_cast<u16>(h))),
+           static_cast<u16>(h));
+  }
+
+  expect_f(ns::half_decode(ns::half_encode(1.0f)), 1.0f);
+  expect_f(ns::half_decode(ns::half_encode(-2.5f)), -2.5f);
+  expect(ns::half_encode(65504.0f), 0x7BFFu);
+  expect(ns::half_encode(70000.0f), 0x7C00u);
+  expect(ns::half_encode(-INFINITY), 0xFC00u);
+  expect_true(isnan(ns::half_decode(ns::half_encode(NAN))));
+  // Ties go to the even mantissa
+  expect(ns::half_encode(1.0f + 1.0f / 2048.0f), 0x3C00u);
+  expect(ns::half_encode(1.0f + 3.0f / 2048.0f), 0x3C02u);
+
+  // Relative error of 2^-11 on the normal range, 2^-25 absolute below
+  f64 max_relative = 0.0;
+  f64 max_absolute = 0.0;
+  for (packing_test_bits x = {6.1e-5f}; x.f < 65504.0f; x.u += 4099) {
+    f64 error = fabs(static_cast<f64>(ns::half_decode(ns::half_encode(x.f))) -
+                     static_cast<f64>(x.f));
+    max_relative = fmax(max_relative, error / static_cast<f64>(x.f));
+  }
+  for (f32 x = 0.0f; x < 6.1e-5f; x += 1e-9f) {
+    f64 error = fabs(static_cast<f64>(ns::half_decode(ns::half_encode(x))) -
+                     static_cast<f64>(x));
+    max_absolute = fmax(max_absolute, error);
+  }
+  NS_DEBUG("half max relative error: %g, subnormal max error: %g",
+           max_relative, max_absolute);
+  expect_true(max_relative <= 1.0 / 2048.0);
+  expect_true(max_absolute <= 1.0 / 33554432.0);
+  return true;
+}
+
+u8 packing_unorm_snorm_should_be_within_bounds() {
+  f32 max_unorm = 0.0f;
+  f32 max_snorm = 0.0f;
+  for (u32 i = 0; i <= 1000000; i++) {
+    f32 u = static_cast<f32>(i) / 1000000.0f;
+    f32 s = u * 2.0f - 1.0f;
+    max_unorm = fmaxf(max_unorm,
+                      fabsf(ns::unorm16_decode(ns::unorm16_encode(u)) - u));
+    max_snorm = fmaxf(max_snorm,
+                      fabsf(ns::snorm16_decode(ns::snorm16_encode(s)) - s));
+  }
+  expect_true(max_unorm <= 0.5f / 65535.0f + 1e-7f);
+  expect_true(max_snorm <= 0.5f / 32767.0f + 1e-7f);
+
+  expect(ns::unorm16_encode(-1.0f), 0);
+  expect(ns::unorm16_encode(2.0f), 65535);
+  expect(ns::snorm16_encode(-1.0f), -32767);
+  expect(ns::snorm16_encode(1.0f), 32767);
+  expect_f(ns::snorm16_decode(-32768), -1.0f);
+  return true;
+}
+
+u8 packing_octahedral_normals_should_be_within_bounds() {
+  ns::rng g(38);
+  f64 max_angle = 0.0;
+  f32 max_length_error = 0.0f;
+  auto check = [&max_angle, &max_length_error](ns::vec3 const &n) {
+    ns::vec3 decoded = ns::normal_unpack_oct16(ns::normal_pack_oct16(n));
+    // atan2 of |cross| and dot: acos loses the small angles in rounding
+    ns::vec3 c = decoded.cross(n);
+    max_angle = fmax(max_angle, atan2(static_cast<f64>(c.length()),
+                                      static_cast<f64>(decoded.dot(n))));
+    max_length_error = fmaxf(max_length_error, fabsf(decoded.length() - 1.0f));
+  };
+
+  // The axes and the diagonals, where the folding is discontinuous
+  for (i32 x = -1; x <= 1; x++) {
+    for (i32 y = -1; y <= 1; y++) {
+      for (i32 z = -1; z <= 1; z++) {
+        if (x || y || z) {
+          check(ns::vec3(static_cast<f32>(x), static_cast<f32>(y),
+                         static_cast<f32>(z))
+                    .normalized());
+        }
+      }
+    }
+  }
+  for (u32 i = 0; i < 1000000; i++) {
+    ns::vec3 n(g.range_f32(-1.0f, 1.0f), g.range_f32(-1.0f, 1.0f),
+               g.range_f32(-1.0f, 1.0f));
+    if (n.dot(n) > 1e-6f) {
+      check(n.normalized());
+    }
+  }
+  NS_DEBUG("octahedral normal max angle error: %g rad", max_angle);
+  expect_true(max_angle <= PACKING_OCT16_MAX_ANGLE);
+  expect_true(max_length_error < 1e-6f);
+  return true;
+}
+
+u8 packed_vertices_should_decode_within_the_bounds() {
+  static ns::vertex_3d vertices[PACKING_VERTEX_COUNT];
+  static ns::vertex_3d_packed packed[PACKING_VERTEX_COUNT];
+  ns::rng g(3);
+  for (u32 i = 0; i < PACKING_VERTEX_COUNT; i++) {
+    // Flat in z, like the planes
+    vertices[i].position = ns::vec3(g.range_f32(-50.0f, 50.0f),
+                                    g.range_f32(-2.0f, 8.0f), 3.0f);
+    vertices[i].texcoord =
+        ns::vec2(g.range_f32(0.0f, 1.0f), g.range_f32(0.0f, 1.0f));
+  }
+  ns::aabb bounds = ns::aabb::from_points(&vertices->position,
+                                          PACKING_VERTEX_COUNT,
+                                          sizeof(ns::vertex_3d));
+  ns::vec3 step = (bounds.max - bounds.min) * (0.5f / 65535.0f);
+  ns::mat4 dequantize = ns::vertex_dequantize_transform(bounds);
+
+  ns::VertexFormat formats[] = {ns::VertexFormat::PACKED_HALF_UV,
+                                ns::VertexFormat::PACKED_UNORM_UV};
+  for (ns::VertexFormat format : formats) {
+    ns::vertices_pack(format, vertices, PACKING_VERTEX_COUNT, bounds, packed);
+    f32 uv_bound =
+        format == ns::VertexFormat::PACKED_HALF_UV ? 1.0f / 2048.0f
+                                                   : 0.5f / 65535.0f + 1e-7f;
+    for (u32 i = 0; i < PACKING_VERTEX_COUNT; i++) {
+      ns::vertex_3d v = ns::vertex_unpack(format, packed[i], bounds);
+      ns::vec3 error = v.position - vertices[i].position;
+      expect_true(fabsf(error.x) <= step.x + 1e-5f);
+      expect_true(fabsf(error.y) <= step.y + 1e-5f);
+      expect_true(error.z == 0.0f);
+      expect_true(fabsf(v.texcoord.x - vertices[i].texcoord.x) <= uv_bound);
+      expect_true(fabsf(v.texcoord.y - vertices[i].texcoord.y) <= uv_bound);
+
+      // The shader sees the unorm values and the dequantizing model matrix
+      ns::vec4 q(ns::unorm16_decode(packed[i].position[0]),
+                 ns::unorm16_decode(packed[i].position[1]),
+                 ns::unorm16_decode(packed[i].position[2]), 1.0f);
+      ns::vec4 p = dequantize.transposed() * q;
+      expect_true(fabsf(p.x - v.position.x) < 1e-4f);
+      expect_true(fabsf(p.y - v.position.y) < 1e-4f);
+      expect_true(fabsf(p.z - v.position.z) < 1e-4f);
+    }
+  }
+
+  // Tiled texcoords need half floats
+  ns::vertex_3d tiled = {ns::vec3(0.0f), ns::vec2(2.0f, -3.25f)};
+  ns::vertices_pack(ns::VertexFormat::PACKED_HALF_UV, &tiled, 1, bounds,
+                    packed);
+  ns::vertex_3d v =
+      ns::vertex_unpack(ns::VertexFormat::PACKED_HALF_UV, packed[0], bounds);
+  expect_f(v.texcoord.x, 2.0f);
+  expect_f(v.texcoord.y, -3.25f);
+
+  expect(ns::vertex_format_size(ns::VertexFormat::FLOAT), 20u);
+  expect(ns::vertex_format_size(ns::VertexFormat::PACKED_HALF_UV), 12u);
+  return true;
+}
+
+void packing_register_tests() {
+  test_manager_register_test(packing_half_should_round_trip,
+                             "Half floats round trip and round to even");
+  test_manager_register_test(packing_unorm_snorm_should_be_within_bounds,
+                             "unorm16 and snorm16 are within their bounds");
+  test_manager_register_test(packing_octahedral_normals_should_be_within_bounds,
+                             "Octahedral normals are within their bounds");
+  test_manager_register_test(packed_vertices_should_decode_within_the_bounds,
+                             "Packed vertices decode within their bounds");
+}
@@ -0,0 +1,6 @@
+#ifndef PACKING_TESTS_HEADER_INCLUDED
+#define PACKING_TESTS_HEADER_INCLUDED
+
+void packing_register_tests();
+
+#endif // PACKING_TESTS_HEADER_INCLUDED
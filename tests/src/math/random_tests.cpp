@@ -0,0 +1,168 @@
+#include "./random_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <defines.h>
+#include <math/math.h>
+#include <math/random.h>
+
+#include <thread>
+
+u8 rng_same_seed_should_give_same_sequence() {
+  ns::rng a(1234);
+  ns::rng b(1234);
+  ns::rng c(1235);
+  u32 differences = 0;
+  for (u32 i = 0; i < 1000; i++) {
+    u64 va = a.next_u64();
+    expect_true(va == b.next_u64());
+    differences += va != c.next_u64();
+  }
+  expect_true(differences > 990);
+
+  // Seed 0 is a valid seed (the state is expanded with splitmix64).
+  ns::rng zero(0);
+  expect_true(zero.next_u64() != 0 || zero.next_u64() != 0);
+  return true;
+}
+
+u8 rng_ranges_should_be_bounded_and_unbiased() {
+  ns::rng g(42);
+  for (u32 i = 0; i < 10000; i++) {
+    i32 v = g.range(-3, 5);
+    expect_true(v >= -3 && v <= 5);
+    f32 f = g.next_f32();
+    expect_true(f >= 0.0f && f < 1.0f);
+    f = g.range_f32(-2.0f, 6.0f);
+    expect_true(f >= -2.0f && f < 6.0f);
+    f64 d = g.next_f64();
+    expect_true(d >= 0.0 && d < 1.0);
+  }
+  expect(7, g.range(7, 7));
+  // The full range does not overflow the span.
+  g.range(-2147483647 - 1, 2147483647);
+
+  // A bound close to 2^32 is where modulo would be the most biased: 3/4 of
+  // the values would be below 2^31.
+  const u32 bound = 0xC0000000u;
+  u32 low = 0;
+  for (u32 i = 0; i < 100000; i++) {
+    low += g.below(bound) < 0x80000000u;
+  }
+  // Expected 2/3 (66667), with a standard deviation of ~150.
+  expect_true(low > 65500 && low < 67800);
+
+  u32 buckets[6] = {};
+  for (u32 i = 0; i < 60000; i++) {
+    buckets[g.below(6)]++;
+  }
+  for (u32 b : buckets) {
+    expect_true(b > 9500 && b < 10500);
+  }
+  return true;
+}
+
+u8 rng_fill_should_match_the_streams() {
+  ns::rng g(99);
+  ns::rng copy = g;
+
+  // Reference: the 4 streams, seeded from the generator
+  ns::rng lanes[4];
+  for (u32 l = 0; l < 4; l++) {
+    u64 sm = copy.next_u64();
+    for (u32 w = 0; w < 4; w++) {
+      lanes[l].s[w] = ns::splitmix64(&sm);
+    }
+  }
+
+  // Not a multiple of 8, for the tail
+  const u32 count = 1003;
+  static u32 bits[count];
+  static f32 floats[count];
+  g.fill_u32(bits, count);
+  for (u32 i = 0; i < count; i += 8) {
+    for (u32 l = 0; l < 4; l++) {
+      u64 v = lanes[l].next_u64();
+      if (i + 2 * l < count) {
+        expect_true(bits[i + 2 * l] == static_cast<u32>(v));
+      }
+      if (i + 2 * l + 1 < count) {
+        expect_true(bits[i + 2 * l + 1] == static_cast<u32>(v >> 32));
+      }
+    }
+  }
+  // The generator advanced by the 4 stream seeds only.
+  expect_true(g.s[0] == copy.s[0] && g.s[3] == copy.s[3]);
+
+  copy = g;
+  g.fill_u32(bits, count);
+  copy.fill_f32(floats, count, -4.0f, 12.0f);
+  for (u32 i = 0; i < count; i++) {
+    f32 expected =
+        static_cast<f32>(bits[i] >> 9) / static_cast<f32>(1u << 23) * 16.0f -
+        4.0f;
+    expect_true(ns::abs(expected - floats[i]) < 1e-5f);
+    expect_true(floats[i] >= -4.0f && floats[i] < 12.0f);
+  }
+  return true;
+}
+
+u8 rng_jump_should_give_distinct_streams() {
+  ns::rng a(5);
+  ns::rng b = a;
+  b.jump();
+  for (u32 i = 0; i < 100; i++) {
+    expect_true(a.next_u64() != b.next_u64());
+  }
+  return true;
+}
+
+u8 thread_rng_should_be_reproducible() {
+  ns::random_seed(2024);
+  ns::rng expected(2024);
+  for (u32 i = 0; i < 100; i++) {
+    expect_true(ns::thread_rng().next_u64() == expected.next_u64());
+  }
+
+  // The next thread to use its generator gets the next jumped stream.
+  ns::rng second(2024);
+  second.jump();
+  u64 from_thread[100];
+  std::thread t([&from_thread]() {
+    for (u32 i = 0; i < 100; i++) {
+      from_thread[i] = ns::thread_rng().next_u64();
+    }
+  });
+  t.join();
+  for (u32 i = 0; i < 100; i++) {
+    expect_true(from_thread[i] == second.next_u64());
+  }
+
+  // Reseeding restarts the sequence.
+  ns::random_seed(2024);
+  ns::rng again(2024);
+  expect_true(ns::thread_rng().next_u64() == again.next_u64());
+
+  ns::random_seed(7);
+  for (u32 i = 0; i < 1000; i++) {
+    i32 v = ns::randrange(1, 6);
+    expect_true(v >= 1 && v <= 6);
+    expect_true(ns::rand() >= 0);
+    f32 f = ns::frand();
+    expect_true(f >= 0.0f && f < 1.0f);
+  }
+  return true;
+}
+
+void random_register_tests() {
+  test_manager_register_test(rng_same_seed_should_give_same_sequence,
+                             "Rng with the same seed gives the same sequence");
+  test_manager_register_test(rng_ranges_should_be_bounded_and_unbiased,
+                             "Rng ranges are bounded and unbiased");
+  test_manager_register_test(rng_fill_should_match_the_streams,
+                             "Rng bulk fill matches its streams");
+  test_manager_register_test(rng_jump_should_give_distinct_streams,
+                             "Rng jump gives distinct streams");
+  test_manager_register_test(thread_rng_should_be_reproducible,
+                             "Thread rng is reproducible after random_seed");
+}
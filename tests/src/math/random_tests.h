@@ -0,0 +1,6 @@
+#ifndef RANDOM_TESTS_HEADER_INCLUDED
+#define RANDOM_TESTS_HEADER_INCLUDED
+
+void random_register_tests();
+
+#endif // RANDOM_TESTS_HEADER_INCLUDED
@@ -0,0 +1,308 @@
+#include "./simd_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <defines.h>
+#include <math/math.h>
+
+#include <math.h>
+
+// The math types are checked against plain scalar references, so the tests
+// are meaningful with and without NS_USE_SIMD. Element-wise operations and
+// matrix products keep the scalar evaluation order and must be bit-exact,
+// unless FMA changes the rounding.
+
+#define SIMD_TEST_COUNT 256
+
+#if defined(__FMA__)
+#define SIMD_PRODUCT_TOLERANCE 1e-5f
+#else
+#define SIMD_PRODUCT_TOLERANCE 0.0f
+#endif
+
+static u32 simd_test_seed = 1;
+
+static f32 simd_test_rand(f32 min, f32 max) {
+  simd_test_seed = simd_test_seed * 1664525u + 1013904223u;
+  f32 t = static_cast<f32>(simd_test_seed >> 8) / static_cast<f32>(1u << 24);
+  return min + (max - min) * t;
+}
+
+static ns::vec4 simd_test_vec4() {
+  return {simd_test_rand(-10.0f, 10.0f), simd_test_rand(-10.0f, 10.0f),
+          simd_test_rand(-10.0f, 10.0f), simd_test_rand(-10.0f, 10.0f)};
+}
+
+static ns::quat simd_test_quat() {
+  ns::quat q(simd_test_rand(-1.0f, 1.0f), simd_test_rand(-1.0f, 1.0f),
+             simd_test_rand(-1.0f, 1.0f), simd_test_rand(-1.0f, 1.0f));
+  q.normalize();
+  return q;
+}
+
+static ns::mat4 simd_test_mat4() {
+  ns::mat4 m;
+  for (u32 i = 0; i < 16; i++) {
+    m.data[i] = simd_test_rand(-2.0f, 2.0f);
+  }
+  // Keep the matrices well conditioned.
+  for (u32 i = 0; i < 4; i++) {
+    m.d[i][i] += 8.0f;
+  }
+  return m;
+}
+
+static bool simd_test_near(f32 expected, f32 actual, f32 tolerance) {
+  f32 scale = ns::abs(expected) > 1.0f ? ns::abs(expected) : 1.0f;
+  return ns::abs(expected - actual) <= tolerance * scale;
+}
+
+static bool simd_test_near(ns::vec4 const &expected, ns::vec4 const &actual,
+                           f32 tolerance) {
+  for (u32 i = 0; i < 4; i++) {
+    if (!simd_test_near(expected[i], actual[i], tolerance)) {
+      NS_ERROR("--> Component %u: expected %f, got %f", i, expected[i],
+               actual[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool simd_test_near(ns::mat4 const &expected, ns::mat4 const &actual,
+                           f32 tolerance) {
+  for (u32 i = 0; i < 16; i++) {
+    if (!simd_test_near(expected.data[i], actual.data[i], tolerance)) {
+      NS_ERROR("--> Element %u: expected %f, got %f", i, expected.data[i],
+               actual.data[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static ns::mat4 ref_mat4_mul(ns::mat4 const &a, ns::mat4 const &b) {
+  ns::mat4 out;
+  for (u32 i = 0; i < 4; i++) {
+    for (u32 j = 0; j < 4; j++) {
+      out.d[i][j] = a.d[i][0] * b.d[0][j] + a.d[i][1] * b.d[1][j] +
+                    a.d[i][2] * b.d[2][j] + a.d[i][3] * b.d[3][j];
+    }
+  }
+  return out;
+}
+
+static ns::vec4 ref_mat4_mul_vec4(ns::mat4 const &m, ns::vec4 const &v) {
+  ns::vec4 out;
+  for (u32 i = 0; i < 4; i++) {
+    out[i] = v.x * m.d[i][0] + v.y * m.d[i][1] + v.z * m.d[i][2] +
+             v.w * m.d[i][3];
+  }
+  return out;
+}
+
+// Gauss-Jordan elimination in double precision
+static ns::mat4 ref_mat4_inverse(ns::mat4 const &m) {
+  f64 a[4][8];
+  for (u32 i = 0; i < 4; i++) {
+    for (u32 j = 0; j < 4; j++) {
+      a[i][j] = m.d[i][j];
+      a[i][j + 4] = i == j ? 1.0 : 0.0;
+    }
+  }
+  for (u32 c = 0; c < 4; c++) {
+    u32 pivot = c;
+    for (u32 r = c + 1; r < 4; r++) {
+      if (ns::abs(a[r][c]) > ns::abs(a[pivot][c])) {
+        pivot = r;
+      }
+    }
+    for (u32 j = 0; j < 8; j++) {
+      f64 t = a[c][j];
+      a[c][j] = a[pivot][j];
+      a[pivot][j] = t;
+    }
+    f64 inv = 1.0 / a[c][c];
+    for (u32 j = 0; j < 8; j++) {
+      a[c][j] *= inv;
+    }
+    for (u32 r = 0; r < 4; r++) {
+      if (r == c) {
+        continue;
+      }
+      f64 f = a[r][c];
+      for (u32 j = 0; j < 8; j++) {
+        a[r][j] -= f * a[c][j];
+      }
+    }
+  }
+  ns::mat4 out;
+  for (u32 i = 0; i < 4; i++) {
+    for (u32 j = 0; j < 4; j++) {
+      out.d[i][j] = static_cast<f32>(a[i][j + 4]);
+    }
+  }
+  return out;
+}
+
+static ns::quat ref_quat_mul(ns::quat const &a, ns::quat const &b) {
+  return {a.x * b.w + a.y * b.z - a.z * b.y + a.w * b.x,
+          -a.x * b.z + a.y * b.w + a.z * b.x + a.w * b.y,
+          a.x * b.y - a.y * b.x + a.z * b.w + a.w * b.z,
+          -a.x * b.x - a.y * b.y - a.z * b.z + a.w * b.w};
+}
+
+static ns::vec4 ref_quat_slerp(ns::quat const &a, ns::quat const &b, f32 t) {
+  f64 q0[4] = {a.x, a.y, a.z, a.w};
+  f64 q1[4] = {b.x, b.y, b.z, b.w};
+  f64 dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+  if (dot < 0.0) {
+    for (u32 i = 0; i < 4; i++) {
+      q1[i] = -q1[i];
+    }
+    dot = -dot;
+  }
+  ns::vec4 out;
+  f64 theta_0 = ::acos(dot < 1.0 ? dot : 1.0);
+  f64 s0 = 1.0 - t;
+  f64 s1 = t;
+  if (theta_0 > 1e-3) {
+    s0 = ::sin((1.0 - t) * theta_0) / ::sin(theta_0);
+    s1 = ::sin(t * theta_0) / ::sin(theta_0);
+  }
+  for (u32 i = 0; i < 4; i++) {
+    out[i] = static_cast<f32>(q0[i] * s0 + q1[i] * s1);
+  }
+  return out;
+}
+
+u8 simd_vec4_arithmetic_should_match_scalar() {
+  for (u32 n = 0; n < SIMD_TEST_COUNT; n++) {
+    ns::vec4 a = simd_test_vec4();
+    ns::vec4 b = simd_test_vec4();
+    f32 f = simd_test_rand(0.5f, 4.0f);
+
+    ns::vec4 sum = a + b;
+    ns::vec4 diff = a - b;
+    ns::vec4 prod = a * b;
+    ns::vec4 quot = a / b;
+    ns::vec4 scaled = a * f;
+    ns::vec4 divided = a / f;
+    ns::vec4 neg = -a;
+    ns::vec4 acc = a;
+    acc += b;
+    acc *= f;
+    for (u32 i = 0; i < 4; i++) {
+      expect_true(sum[i] == a[i] + b[i]);
+      expect_true(diff[i] == a[i] - b[i]);
+      expect_true(prod[i] == a[i] * b[i]);
+      expect_true(quot[i] == a[i] / b[i]);
+      expect_true(scaled[i] == a[i] * f);
+      expect_true(divided[i] == a[i] / f);
+      expect_true(neg[i] == -a[i]);
+      expect_true(acc[i] == (a[i] + b[i]) * f);
+    }
+  }
+  return true;
+}
+
+u8 simd_vec4_dot_cross_normalize_should_match_scalar() {
+  for (u32 n = 0; n < SIMD_TEST_COUNT; n++) {
+    ns::vec4 a = simd_test_vec4();
+    ns::vec4 b = simd_test_vec4();
+
+    f32 dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    expect_true(simd_test_near(dot, a.dot(b), 1e-5f));
+
+    ns::vec4 cross = a.cross(b);
+    ns::vec4 expected_cross(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+                            a.x * b.y - a.y * b.x, 0.0f);
+    expect_true(simd_test_near(expected_cross, cross, 1e-6f));
+    expect_true(cross.w == 0.0f);
+
+    f32 len = ns::sqrt(a.x * a.x + a.y * a.y + a.z * a.z + a.w * a.w);
+    ns::vec4 expected_normalized(a.x / len, a.y / len, a.z / len, a.w / len);
+    expect_true(simd_test_near(expected_normalized, a.normalized(), 1e-6f));
+    expect_true(simd_test_near(1.0f, a.normalized().length(), 1e-6f));
+  }
+  return true;
+}
+
+u8 simd_quat_should_match_scalar() {
+  for (u32 n = 0; n < SIMD_TEST_COUNT; n++) {
+    ns::quat a = simd_test_quat();
+    ns::quat b = simd_test_quat();
+
+    ns::quat expected = ref_quat_mul(a, b);
+    ns::quat prod = a * b;
+    for (u32 i = 0; i < 4; i++) {
+      expect_true(simd_test_near(expected[i], prod[i], 1e-6f));
+    }
+
+    f32 t = simd_test_rand(0.0f, 1.0f);
+    ns::quat slerp(a, b, t);
+    ns::vec4 expected_slerp = ref_quat_slerp(a, b, t);
+    for (u32 i = 0; i < 4; i++) {
+      // The nearly parallel case uses a normalized lerp.
+      expect_true(simd_test_near(expected_slerp[i], slerp[i], 1e-3f));
+    }
+    expect_true(simd_test_near(1.0f, slerp.normal(), 1e-5f));
+  }
+  return true;
+}
+
+u8 simd_mat4_product_should_match_scalar() {
+  for (u32 n = 0; n < SIMD_TEST_COUNT; n++) {
+    ns::mat4 a = simd_test_mat4();
+    ns::mat4 b = simd_test_mat4();
+    ns::vec4 v = simd_test_vec4();
+
+    expect_true(simd_test_near(ref_mat4_mul(a, b), a * b,
+                               SIMD_PRODUCT_TOLERANCE));
+    expect_true(simd_test_near(ref_mat4_mul_vec4(a, v), a * v,
+                               SIMD_PRODUCT_TOLERANCE));
+
+    ns::mat4 t = a.transposed();
+    for (u32 i = 0; i < 4; i++) {
+      for (u32 j = 0; j < 4; j++) {
+        expect_true(t.d[i][j] == a.d[j][i]);
+      }
+    }
+  }
+  return true;
+}
+
+u8 simd_mat4_inverse_should_match_scalar() {
+  for (u32 n = 0; n < SIMD_TEST_COUNT; n++) {
+    ns::mat4 m = simd_test_mat4();
+    ns::mat4 inv = m.inverse();
+    expect_true(simd_test_near(ref_mat4_inverse(m), inv, 1e-5f));
+    expect_true(simd_test_near(ns::mat4::identity(), m * inv, 1e-5f));
+  }
+
+  // Typical camera and model matrices
+  ns::mat4 view = ns::mat4::lookat(ns::vec3(1.0f, 2.0f, 3.0f),
+                                   ns::vec3(0.0f, 0.0f, 0.0f),
+                                   ns::vec3(0.0f, 1.0f, 0.0f));
+  ns::mat4 projection = ns::mat4::perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+  ns::mat4 model = ns::mat4::mk_euler_xyz(0.3f, 1.2f, -0.7f)
+                       .pre_translate(ns::vec3(5.0f, -3.0f, 2.0f));
+  ns::mat4 matrices[] = {view, projection, model};
+  for (ns::mat4 const &m : matrices) {
+    expect_true(simd_test_near(ref_mat4_inverse(m), m.inverse(), 1e-4f));
+  }
+  return true;
+}
+
+void simd_register_tests() {
+  test_manager_register_test(simd_vec4_arithmetic_should_match_scalar,
+                             "SIMD vec4 arithmetic is bit-exact");
+  test_manager_register_test(simd_vec4_dot_cross_normalize_should_match_scalar,
+                             "SIMD vec4 dot/cross/normalize match scalar");
+  test_manager_register_test(simd_quat_should_match_scalar,
+                             "SIMD quat multiply/slerp match scalar");
+  test_manager_register_test(simd_mat4_product_should_match_scalar,
+                             "SIMD mat4 products and transpose match scalar");
+  test_manager_register_test(simd_mat4_inverse_should_match_scalar,
+                             "SIMD mat4 inverse matches scalar");
+}
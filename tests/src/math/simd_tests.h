@@ -0,0 +1,6 @@
+#ifndef SIMD_TESTS_HEADER_INCLUDED
+#define SIMD_TESTS_HEADER_INCLUDED
+
+void simd_register_tests();
+
+#endif // SIMD_TESTS_HEADER_INCLUDED
@@ -0,0 +1,100 @@
+#include "./transform_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <defines.h>
+#include <math/math.h>
+#include <math/random.h>
+#include <math/transform.h>
+
+#include <math.h>
+
+static f32 max_difference(ns::mat4 const &a, ns::mat4 const &b) {
+  f32 out = 0.0f;
+  for (u32 i = 0; i < 16; i++) {
+    out = fmaxf(out, fabsf(a.data[i] - b.data[i]));
+  }
+  return out;
+}
+
+static ns::quat random_rotation(ns::rng &g) {
+  return ns::quat(g.range_f32(-1.0f, 1.0f), g.range_f32(-1.0f, 1.0f),
+                  g.range_f32(-1.0f, 1.0f), g.range_f32(0.1f, 1.0f))
+      .normalized();
+}
+
+u8 mat4_inverse_rigid_should_match_inverse() {
+  ns::rng g(40);
+  for (u32 i = 0; i < 1000; i++) {
+    ns::vec3 t(g.range_f32(-100.0f, 100.0f), g.range_f32(-100.0f, 100.0f),
+               g.range_f32(-100.0f, 100.0f));
+    ns::mat4 m = random_rotation(g).matrix() * ns::mat4::mk_translate(t);
+    ns::mat4 inverse = m.inverse_rigid();
+    expect_true(max_difference(inverse, m.inverse()) < 1e-4f);
+    expect_true(max_difference(m * inverse, ns::mat4::identity()) < 1e-4f);
+  }
+  return true;
+}
+
+u8 transform_should_cache_its_matrix() {
+  ns::vec3 position(1.0f, -2.0f, 3.0f);
+  ns::vec3 euler(0.3f, -0.7f, 1.1f);
+  ns::vec3 scale(2.0f, 0.5f, 1.5f);
+  ns::transform t(position, ns::quat::from_euler_xyz(euler), scale);
+  expect_true(t.is_dirty());
+  expect_false(t.is_rigid());
+
+  ns::mat4 expected = ns::mat4::mk_scale(scale) *
+                      ns::mat4::mk_euler_xyz(euler) *
+                      ns::mat4::mk_translate(position);
+  expect_true(max_difference(t.local_matrix(), expected) < 1e-5f);
+  expect_false(t.is_dirty());
+  expect_true(max_difference(t.inverse_matrix(), expected.inverse()) < 1e-5f);
+
+  t.translate(ns::vec3(1.0f, 1.0f, 1.0f));
+  expect_true(t.is_dirty());
+  expect_f(t.local_matrix().d[3][0], 2.0f);
+  expect_f(t.local_matrix().d[3][1], -1.0f);
+  expect_f(t.local_matrix().d[3][2], 4.0f);
+
+  // The default transform is the identity, already up to date
+  ns::transform identity;
+  expect_false(identity.is_dirty());
+  expect_true(identity.is_rigid());
+  expect_true(max_difference(identity.local_matrix(), ns::mat4::identity()) ==
+              0.0f);
+  return true;
+}
+
+u8 transform_should_give_the_camera_view() {
+  // The view matrix of the testbed camera, before the transform type
+  ns::rng g(41);
+  for (u32 i = 0; i < 100; i++) {
+    ns::vec3 position(g.range_f32(-50.0f, 50.0f), g.range_f32(-50.0f, 50.0f),
+                      g.range_f32(-50.0f, 50.0f));
+    ns::vec3 euler(g.range_f32(-1.5f, 1.5f), g.range_f32(-3.0f, 3.0f), 0.0f);
+    ns::mat4 expected =
+        ns::mat4::mk_euler_xyz(euler).translate(position).inverse();
+    ns::transform camera(position, ns::quat::from_euler_xyz(euler));
+    expect_true(camera.is_rigid());
+    expect_true(max_difference(camera.inverse_matrix(), expected) < 1e-4f);
+  }
+
+  ns::transform a(ns::vec3(0.0f, 0.0f, 10.0f));
+  ns::transform b(ns::vec3(4.0f, 0.0f, 10.0f),
+                  ns::quat::from_euler_xyz(ns::vec3(0.0f, 1.0f, 0.0f)));
+  ns::transform half = ns::transform::interpolate(a, b, 0.5f);
+  ns::mat4 expected = ns::mat4::mk_rotate_y(0.5f) *
+                      ns::mat4::mk_translate(ns::vec3(2.0f, 0.0f, 10.0f));
+  expect_true(max_difference(half.local_matrix(), expected) < 1e-5f);
+  return true;
+}
+
+void transform_register_tests() {
+  test_manager_register_test(mat4_inverse_rigid_should_match_inverse,
+                             "Rigid inverse matches the general inverse");
+  test_manager_register_test(transform_should_cache_its_matrix,
+                             "Transform caches its local matrix");
+  test_manager_register_test(transform_should_give_the_camera_view,
+                             "Transform gives the camera view matrix");
+}
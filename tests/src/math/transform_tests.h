@@ -0,0 +1,6 @@
+#ifndef TRANSFORM_TESTS_HEADER_INCLUDED
+#define TRANSFORM_TESTS_HEADER_INCLUDED
+
+void transform_register_tests();
+
+#endif // TRANSFORM_TESTS_HEADER_INCLUDED
@@ -0,0 +1,64 @@
+#include "./types_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/memory.h>
+#include <defines.h>
+#include <math/math.h>
+
+// Compile-time tables of math types
+static constexpr ns::vec3 cube_corners[] = {
+    {-1.0f, -1.0f, -1.0f}, {1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, -1.0f},
+    {-1.0f, 1.0f, -1.0f},  {-1.0f, -1.0f, 1.0f}, {1.0f, -1.0f, 1.0f},
+    {1.0f, 1.0f, 1.0f},    {-1.0f, 1.0f, 1.0f},
+};
+static constexpr ns::vec4 colors[] = {ns::vec4::one(), ns::vec4(0.5f),
+                                      ns::vec4(ns::vec3(1.0f, 0.0f, 0.0f),
+                                               1.0f)};
+static constexpr ns::mat4 flip_y(ns::vec4(1.0f, 0.0f, 0.0f, 0.0f),
+                                 ns::vec4(0.0f, -1.0f, 0.0f, 0.0f),
+                                 ns::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+                                 ns::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+static constexpr ns::mat4 identity = ns::mat4::identity();
+static constexpr ns::quat no_rotation = ns::quat::identity();
+
+NS_STATIC_ASSERT(cube_corners[6].z == 1.0f, "Expected a constexpr vec3.");
+NS_STATIC_ASSERT(colors[2].x == 1.0f && colors[2].w == 1.0f,
+                 "Expected a constexpr vec4.");
+NS_STATIC_ASSERT(identity.data[15] == 1.0f && identity.data[1] == 0.0f,
+                 "Expected a constexpr mat4.");
+NS_STATIC_ASSERT(no_rotation.w == 1.0f, "Expected a constexpr quat.");
+
+u8 math_types_should_copy_in_bulk() {
+  ns::mat4 matrices[8];
+  for (u32 i = 0; i < 8; i++) {
+    matrices[i] = ns::mat4::mk_translate(cube_corners[i]);
+  }
+  ns::mat4 copies[8];
+  ns::mem_copy(copies, matrices, sizeof(matrices));
+  for (u32 i = 0; i < 8; i++) {
+    expect_true(copies[i][3][0] == cube_corners[i].x);
+    expect_true(copies[i][3][2] == cube_corners[i].z);
+  }
+
+  ns::mat4 flipped = flip_y * copies[2];
+  expect_true(flipped[1][1] == -1.0f);
+  expect_true(ns::mat4()[0][0] == 0.0f);
+  expect_true(ns::mat4(2.0f)[3][3] == 1.0f);
+  return true;
+}
+
+u8 quat_from_axis_angle_should_be_a_rotation() {
+  ns::quat q(ns::vec3(0.0f, 0.0f, 1.0f), ns::PI_1_2<f32>, false);
+  expect_f(1.0f, q.normal());
+  expect_f(ns::cos(ns::PI_1_4<f32>), q.w);
+  expect_f(ns::sin(ns::PI_1_4<f32>), q.z);
+  return true;
+}
+
+void math_types_register_tests() {
+  test_manager_register_test(math_types_should_copy_in_bulk,
+                             "Math types are constexpr and copy in bulk");
+  test_manager_register_test(quat_from_axis_angle_should_be_a_rotation,
+                             "Quat from axis and angle is a rotation");
+}
@@ -0,0 +1,6 @@
+#ifndef MATH_TYPES_TESTS_HEADER_INCLUDED
+#define MATH_TYPES_TESTS_HEADER_INCLUDED
+
+void math_types_register_tests();
+
+#endif // MATH_TYPES_TESTS_HEADER_INCLUDED
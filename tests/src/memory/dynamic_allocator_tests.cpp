@@ -0,0 +1,71 @@
+#include "./dynamic_allocator_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/memory.h>
+#include <defines.h>
+#include <memory/dynamic_allocator.h>
+
+using ns::dynamic_allocator;
+
+#define DYNAMIC_ALLOCATOR_TEST_SIZE 1024
+
+u8 dynamic_allocator_should_allocate_and_free() {
+  usize memory_requirement = 0;
+  dynamic_allocator alloc;
+  ns::dynamic_allocator_create(DYNAMIC_ALLOCATOR_TEST_SIZE,
+                               &memory_requirement, nullptr, &alloc);
+  alignas(16) u8 memory[4096];
+  expect_true(memory_requirement <= sizeof(memory));
+  expect_true(ns::dynamic_allocator_create(DYNAMIC_ALLOCATOR_TEST_SIZE,
+                                           &memory_requirement, memory,
+                                           &alloc));
+  ptr block = ns::dynamic_allocator_allocate(&alloc, 64);
+  expect_not(nullptr, block);
+  expect_true(ns::dynamic_allocator_free(&alloc, block, 64));
+  expect(DYNAMIC_ALLOCATOR_TEST_SIZE,
+         ns::dynamic_allocator_free_space(&alloc));
+  ns::dynamic_allocator_destroy(&alloc);
+  return true;
+}
+
+u8 dynamic_allocator_reallocate_should_return_the_moved_block() {
+  usize memory_requirement = 0;
+  dynamic_allocator alloc;
+  ns::dynamic_allocator_create(DYNAMIC_ALLOCATOR_TEST_SIZE,
+                               &memory_requirement, nullptr, &alloc);
+  alignas(16) u8 memory[4096];
+  expect_true(memory_requirement <= sizeof(memory));
+  ns::dynamic_allocator_create(DYNAMIC_ALLOCATOR_TEST_SIZE,
+                               &memory_requirement, memory, &alloc);
+
+  // The next block keeps the first one from growing in place
+  u8 *block =
+      reinterpret_cast<u8 *>(ns::dynamic_allocator_allocate(&alloc, 32));
+  ptr next = ns::dynamic_allocator_allocate(&alloc, 32);
+  expect_not(nullptr, next);
+  for (u8 i = 0; i < 32; i++) {
+    block[i] = i;
+  }
+  u8 *moved = reinterpret_cast<u8 *>(
+      ns::dynamic_allocator_reallocate(&alloc, block, 32, 128));
+  expect_not(nullptr, moved);
+  expect_true(moved != block);
+  for (u8 i = 0; i < 32; i++) {
+    expect(i, moved[i]);
+  }
+  ns::dynamic_allocator_free(&alloc, moved, 128);
+  ns::dynamic_allocator_free(&alloc, next, 32);
+  expect(DYNAMIC_ALLOCATOR_TEST_SIZE,
+         ns::dynamic_allocator_free_space(&alloc));
+  ns::dynamic_allocator_destroy(&alloc);
+  return true;
+}
+
+void dynamic_allocator_register_tests() {
+  test_manager_register_test(dynamic_allocator_should_allocate_and_free,
+                             "Dynamic allocator allocates and frees");
+  test_manager_register_test(
+      dynamic_allocator_reallocate_should_return_the_moved_block,
+      "Dynamic allocator reallocation returns the moved block");
+}
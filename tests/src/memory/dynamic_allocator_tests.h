@@ -0,0 +1,6 @@
+#ifndef DYNAMIC_ALLOCATOR_TESTS_HEADER_INCLUDED
+#define DYNAMIC_ALLOCATOR_TESTS_HEADER_INCLUDED
+
+void dynamic_allocator_register_tests();
+
+#endif // DYNAMIC_ALLOCATOR_TESTS_HEADER_INCLUDED
@@ -3,6 +3,7 @@
 #include "../test_manager.h"
 
 #include <defines.h>
+#include <math/math.h>
 #include <memory/linear_allocator.h>
 
 using ns::linear_allocator;
@@ -33,14 +34,14 @@ u8 linear_allocator_single_allocation_all_space() {
 
 u8 linear_allocator_multi_allocation_all_space() {
   u64 max_allocs = 1024;
-  linear_allocator alloc(sizeof(u64) * max_allocs, 0);
+  linear_allocator alloc(LINEAR_ALLOCATOR_ALIGNMENT * max_allocs, 0);
 
   ptr block;
   for (u64 i = 0; i < max_allocs; i++) {
-    block = alloc.allocate(sizeof(u64));
+    block = alloc.allocate(LINEAR_ALLOCATOR_ALIGNMENT);
 
     expect_not(nullptr, block);
-    expect(sizeof(u64) * (i + 1), alloc.allocated);
+    expect(LINEAR_ALLOCATOR_ALIGNMENT * (i + 1), alloc.allocated);
   }
 
   return true;
@@ -48,33 +49,33 @@ u8 linear_allocator_multi_allocation_all_space() {
 
 u8 linear_allocator_multi_allocation_over_allocate() {
   u64 max_allocs = 3;
-  linear_allocator alloc(sizeof(u64) * max_allocs, 0);
+  linear_allocator alloc(LINEAR_ALLOCATOR_ALIGNMENT * max_allocs, 0);
 
   ptr block;
   for (u64 i = 0; i < max_allocs; i++) {
-    block = alloc.allocate(sizeof(u64));
+    block = alloc.allocate(LINEAR_ALLOCATOR_ALIGNMENT);
     expect_not(nullptr, block);
-    expect(sizeof(u64) * (i + 1), alloc.allocated);
+    expect(LINEAR_ALLOCATOR_ALIGNMENT * (i + 1), alloc.allocated);
   }
 
   NS_DEBUG("Note: The following error is intentionnally caused by this test.");
 
-  block = alloc.allocate(sizeof(u64));
+  block = alloc.allocate(LINEAR_ALLOCATOR_ALIGNMENT);
   expect(nullptr, block);
-  expect(sizeof(u64) * max_allocs, alloc.allocated);
+  expect(LINEAR_ALLOCATOR_ALIGNMENT * max_allocs, alloc.allocated);
 
   return true;
 }
 
 u8 linear_allocator_multi_allocation_all_space_then_free() {
   u64 max_allocs = 1024;
-  linear_allocator alloc(sizeof(u64) * max_allocs, 0);
+  linear_allocator alloc(LINEAR_ALLOCATOR_ALIGNMENT * max_allocs, 0);
 
   ptr block;
   for (u64 i = 0; i < max_allocs; i++) {
-    block = alloc.allocate(sizeof(u64));
+    block = alloc.allocate(LINEAR_ALLOCATOR_ALIGNMENT);
     expect_not(nullptr, block);
-    expect(sizeof(u64) * (i + 1), alloc.allocated);
+    expect(LINEAR_ALLOCATOR_ALIGNMENT * (i + 1), alloc.allocated);
   }
 
   alloc.free_all();
@@ -83,6 +84,24 @@ u8 linear_allocator_multi_allocation_all_space_then_free() {
   return true;
 }
 
+u8 linear_allocator_should_align_blocks() {
+  linear_allocator alloc(1024, 0);
+
+  ptr odd = alloc.allocate(3);
+  expect_not(nullptr, odd);
+  ns::mat4 *m =
+      reinterpret_cast<ns::mat4 *>(alloc.allocate(sizeof(ns::mat4)));
+  expect_not(nullptr, m);
+  expect(0, reinterpret_cast<usize>(m) % LINEAR_ALLOCATOR_ALIGNMENT);
+  expect(LINEAR_ALLOCATOR_ALIGNMENT + sizeof(ns::mat4), alloc.allocated);
+
+  // Aligned loads and stores in the SIMD build.
+  *m = ns::mat4::identity() * ns::mat4::identity();
+  expect_f(1.0f, m->data[15]);
+
+  return true;
+}
+
 void linear_allocator_register_tests() {
   test_manager_register_test(linear_allocator_should_create_and_destroy,
                              "Linear allocator should create and destroy");
@@ -95,4 +114,6 @@ void linear_allocator_register_tests() {
   test_manager_register_test(
       linear_allocator_multi_allocation_all_space_then_free,
       "Linear allocator multi allocation all space then free");
+  test_manager_register_test(linear_allocator_should_align_blocks,
+                             "Linear allocator should align blocks");
 }
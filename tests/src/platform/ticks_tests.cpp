@@ -0,0 +1,55 @@
+#include "./ticks_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/clock.h>
+#include <defines.h>
+#include <math/math.h>
+#include <platform/platform.h>
+
+u8 ticks_should_be_monotonic() {
+  u64 prev = ns::platform::get_ticks();
+  for (u32 i = 0; i < 100000; i++) {
+    u64 now = ns::platform::get_ticks();
+    expect_true(now >= prev);
+    prev = now;
+  }
+  expect_true(ns::platform::get_tick_frequency() > 0);
+  return true;
+}
+
+u8 ticks_should_match_absolute_time() {
+  f64 start_time = ns::platform::get_absolute_time();
+  u64 start_ticks = ns::platform::get_ticks();
+  ns::platform::sleep(20);
+  u64 end_ticks = ns::platform::get_ticks();
+  f64 end_time = ns::platform::get_absolute_time();
+
+  f64 elapsed = ns::platform::ticks_to_seconds(end_ticks - start_ticks);
+  expect_true(ns::abs(elapsed - (end_time - start_time)) < 0.001);
+  return true;
+}
+
+u8 tick_clock_should_measure_elapsed_time() {
+  ns::tick_clock_t clock;
+  clock.start();
+  expect(0, clock.elapsed_ticks);
+  ns::platform::sleep(5);
+  clock.update();
+  expect_true(clock.elapsed() >= 0.004);
+
+  clock.stop();
+  u64 elapsed_ticks = clock.elapsed_ticks;
+  clock.update();
+  expect(elapsed_ticks, clock.elapsed_ticks);
+  return true;
+}
+
+void ticks_register_tests() {
+  test_manager_register_test(ticks_should_be_monotonic,
+                             "Ticks should be monotonic");
+  test_manager_register_test(ticks_should_match_absolute_time,
+                             "Ticks should match absolute time");
+  test_manager_register_test(tick_clock_should_measure_elapsed_time,
+                             "Tick clock should measure elapsed time");
+}
@@ -0,0 +1,6 @@
+#ifndef TICKS_TESTS_HEADER_INCLUDED
+#define TICKS_TESTS_HEADER_INCLUDED
+
+void ticks_register_tests();
+
+#endif // TICKS_TESTS_HEADER_INCLUDED
@@ -0,0 +1,180 @@
+#include "./block_compression_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+#include "./test_resources.h"
+
+#include <core/memory.h>
+#include <math/math.h>
+#include <platform/filesystem.h>
+#include <resources/block_compression.h>
+#include <resources/loaders/image_loader.h>
+#include <systems/resource_system.h>
+
+#include <cmath>
+#include <vector>
+
+// Peak signal to noise ratio of the color channels, in dB
+static f64 block_compression_test_psnr(u8 const *a, u8 const *b,
+                                       usize texel_count) {
+  f64 error = 0.0;
+  for (usize i = 0; i < texel_count * 4; i++) {
+    if (i % 4 == 3) {
+      continue;
+    }
+    f64 d = static_cast<f64>(a[i]) - b[i];
+    error += d * d;
+  }
+  f64 mse = error / (texel_count * 3);
+  return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 1000.0;
+}
+
+static std::vector<u8> block_compression_test_round_trip(ns::TextureFormat f,
+                                                         u8 const *rgba,
+                                                         u32 width,
+                                                         u32 height) {
+  std::vector<u8> blocks(ns::texture_format_level_size(f, width, height));
+  std::vector<u8> decoded(static_cast<usize>(width) * height * 4);
+  ns::bc_compress(f, rgba, width, height, blocks.data(), 0);
+  ns::bc_decompress(f, blocks.data(), width, height, decoded.data());
+  return decoded;
+}
+
+u8 block_compression_sizes_should_count_blocks() {
+  using ns::TextureFormat;
+  expect(24ull, ns::texture_format_level_size(TextureFormat::RGBA8, 3, 2));
+  expect(8ull, ns::texture_format_level_size(TextureFormat::BC1, 4, 4));
+  // Partial blocks are whole blocks
+  expect(32ull, ns::texture_format_level_size(TextureFormat::BC1, 5, 5));
+  expect(16ull, ns::texture_format_level_size(TextureFormat::BC3, 1, 1));
+  // 8x8, 4x4, 2x2, 1x1
+  expect(56ull, ns::texture_format_chain_size(TextureFormat::BC1, 8, 8, 4));
+  expect(112ull, ns::texture_format_chain_size(TextureFormat::BC3, 8, 8, 4));
+  return true;
+}
+
+u8 block_compression_should_keep_exact_colors() {
+  // Two colors of 5:6:5 (black and red, alpha 0 and 255) on an odd size:
+  // both formats keep them
+  u32 width = 7;
+  u32 height = 5;
+  std::vector<u8> rgba(width * height * 4);
+  for (u32 i = 0; i < width * height; i++) {
+    bool red = (i * 7) % 3 == 0;
+    rgba[i * 4 + 0] = red ? 255 : 0;
+    rgba[i * 4 + 1] = 0;
+    rgba[i * 4 + 2] = 0;
+    rgba[i * 4 + 3] = red ? 255 : 0;
+  }
+  std::vector<u8> bc3 = block_compression_test_round_trip(
+      ns::TextureFormat::BC3, rgba.data(), width, height);
+  expect_true(bc3 == rgba);
+
+  // BC1 is opaque
+  std::vector<u8> bc1 = block_compression_test_round_trip(
+      ns::TextureFormat::BC1, rgba.data(), width, height);
+  for (u32 i = 0; i < width * height; i++) {
+    expect(rgba[i * 4 + 0], bc1[i * 4 + 0]);
+    expect(0, bc1[i * 4 + 1]);
+    expect(255, bc1[i * 4 + 3]);
+  }
+
+  // Alpha gradients are within the half step of the 8 value mode
+  for (u32 i = 0; i < width * height; i++) {
+    rgba[i * 4 + 3] = static_cast<u8>(100 + (i % 16) * 4);
+  }
+  bc3 = block_compression_test_round_trip(ns::TextureFormat::BC3, rgba.data(),
+                                          width, height);
+  for (u32 i = 0; i < width * height; i++) {
+    i32 d = bc3[i * 4 + 3] - rgba[i * 4 + 3];
+    expect_true(d >= -5 && d <= 5);
+  }
+  return true;
+}
+
+u8 block_compression_should_preserve_gradients() {
+  // Smooth content, as most of a texture: about 40 dB
+  u32 size = 64;
+  std::vector<u8> rgba(size * size * 4);
+  for (u32 y = 0; y < size; y++) {
+    for (u32 x = 0; x < size; x++) {
+      u8 *texel = &rgba[(y * size + x) * 4];
+      texel[0] = static_cast<u8>(x * 4);
+      texel[1] = static_cast<u8>(y * 4);
+      texel[2] = static_cast<u8>(128 + 100 * ns::sin(x * 0.1f + y * 0.05f));
+      texel[3] = 255;
+    }
+  }
+  std::vector<u8> bc1 = block_compression_test_round_trip(
+      ns::TextureFormat::BC1, rgba.data(), size, size);
+  f64 psnr = block_compression_test_psnr(rgba.data(), bc1.data(), size * size);
+  NS_DEBUG("BC1 gradient PSNR: %.2f dB", psnr);
+  expect_true(psnr > 36.0);
+  return true;
+}
+
+u8 block_compression_loader_should_compress_the_textures() {
+  cstr first = NS_TEST_ASSET_PATH "/textures/Brick_01.png";
+  if (!ns::fs::exists(first)) {
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    return BYPASS;
+  }
+  test_memory_start();
+  ns::resource_system_config config;
+  config.asset_base_path = NS_TEST_ASSET_PATH;
+  test_resource_system system;
+  test_resource_system_start(config, &system);
+  ns::ImageResourceData rgba;
+  expect_true(ns::image_loader_decode("Brick_01", &rgba));
+  ns::ImageResourceData normals;
+  expect_true(ns::image_loader_decode("Brick_01_Nrm", &normals));
+  test_resource_system_stop(&system);
+
+  config.compress_textures = true;
+  test_resource_system_start(config, &system);
+  ns::ImageResourceData compressed;
+  expect_true(ns::image_loader_decode("Brick_01", &compressed));
+  expect_true(compressed.format == ns::TextureFormat::BC1);
+  expect(rgba.mip_count, compressed.mip_count);
+  // The normal maps stay RGBA
+  ns::ImageResourceData normals_compressed;
+  expect_true(ns::image_loader_decode("Brick_01_Nrm", &normals_compressed));
+  expect_true(normals_compressed.format == ns::TextureFormat::RGBA8);
+
+  // Level 0 looks like the uncompressed one
+  usize texel_count = static_cast<usize>(rgba.width) * rgba.height;
+  std::vector<u8> decoded(texel_count * 4);
+  ns::bc_decompress(compressed.format, compressed.pixels, compressed.width,
+                    compressed.height, decoded.data());
+  f64 psnr =
+      block_compression_test_psnr(rgba.pixels, decoded.data(), texel_count);
+  NS_DEBUG("BC1 Brick_01 PSNR: %.2f dB", psnr);
+  expect_true(psnr > 30.0);
+
+  // Turned off for a device without BC support
+  ns::resource_system_set_compress_textures(false);
+  ns::ImageResourceData fallback;
+  expect_true(ns::image_loader_decode("Brick_01", &fallback));
+  expect_true(fallback.format == ns::TextureFormat::RGBA8);
+  expect(rgba.mip_count, fallback.mip_count);
+  ns::image_loader_free_pixels(&fallback);
+
+  ns::image_loader_free_pixels(&normals_compressed);
+  ns::image_loader_free_pixels(&compressed);
+  ns::image_loader_free_pixels(&normals);
+  ns::image_loader_free_pixels(&rgba);
+  test_resource_system_stop(&system);
+  ns::memory_system_shutdown();
+  return true;
+}
+
+void block_compression_register_tests() {
+  test_manager_register_test(block_compression_sizes_should_count_blocks,
+                             "Compressed sizes count whole 4x4 blocks");
+  test_manager_register_test(block_compression_should_keep_exact_colors,
+                             "BC1 and BC3 keep exact colors and alpha");
+  test_manager_register_test(block_compression_should_preserve_gradients,
+                             "BC1 round trip of a gradient is above 36 dB");
+  test_manager_register_test(
+      block_compression_loader_should_compress_the_textures,
+      "Image loader compresses the textures but the normal maps");
+}
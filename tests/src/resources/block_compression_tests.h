@@ -0,0 +1,6 @@
+#ifndef BLOCK_COMPRESSION_TESTS_HEADER_INCLUDED
+#define BLOCK_COMPRESSION_TESTS_HEADER_INCLUDED
+
+void block_compression_register_tests();
+
+#endif // BLOCK_COMPRESSION_TESTS_HEADER_INCLUDED
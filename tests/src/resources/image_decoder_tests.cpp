@@ -0,0 +1,257 @@
+#include "./image_decoder_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+#include "./test_resources.h"
+
+#include <core/memory.h>
+#include <platform/platform.h>
+#include <resources/image_decoder.h>
+#include <resources/loaders/image_loader.h>
+#include <resources/resource_cache.h>
+#include <systems/resource_system.h>
+
+#include <string.h>
+#include <thread>
+
+#define IMAGE_DECODER_TEST_COUNT 100
+#define IMAGE_DECODER_TEST_MAX_WORKERS 4
+
+static cstr test_images[] = {
+    "Brick_01", "Brick_01_Nrm", "Brick_02", "Brick_02_Nrm", "Brick_03",
+    "Brick_03_Nrm", "Brick_04", "Brick_04_Nrm", "prototype",
+};
+
+#define TEST_IMAGE_COUNT (sizeof(test_images) / sizeof(cstr))
+
+struct image_decoder_test_context {
+  test_resource_system resources;
+  ptr decoder_memory;
+  usize decoder_requirement;
+  ns::image_decoder decoder;
+};
+
+static void
+image_decoder_test_begin(image_decoder_test_context *context,
+                         u32 worker_count, u32 capacity,
+                         ns::resource_cache_config cache = {}) {
+  test_memory_start(cache.budget + TEST_MEMORY_SIZE);
+  ns::resource_system_config config;
+  config.asset_base_path = NS_TEST_ASSET_PATH;
+  config.cache = cache;
+  test_resource_system_start(config, &context->resources);
+
+  ns::image_decoder_create(worker_count, capacity,
+                           &context->decoder_requirement, nullptr, nullptr);
+  context->decoder_memory =
+      ns::alloc(context->decoder_requirement, ns::MemTag::JOB);
+  ns::image_decoder_create(worker_count, capacity,
+                           &context->decoder_requirement,
+                           context->decoder_memory, &context->decoder);
+}
+
+static void image_decoder_test_end(image_decoder_test_context *context) {
+  ns::image_decoder_destroy(&context->decoder);
+  ns::free(context->decoder_memory, context->decoder_requirement,
+           ns::MemTag::JOB);
+  test_resource_system_stop(&context->resources);
+  ns::memory_system_shutdown();
+}
+
+u8 image_decoder_should_not_stall_the_main_thread() {
+  // The workers leave a core to the main thread. With a single core, they
+  // preempt it whatever the decoder does: the stall is only reported.
+  u32 core_count = std::thread::hardware_concurrency();
+  u32 worker_count = core_count > 1 ? core_count - 1 : 1;
+  if (worker_count > IMAGE_DECODER_TEST_MAX_WORKERS) {
+    worker_count = IMAGE_DECODER_TEST_MAX_WORKERS;
+  }
+  image_decoder_test_context context;
+  image_decoder_test_begin(&context, worker_count, IMAGE_DECODER_TEST_COUNT);
+
+  // Synchronous reference: the stall of one texture before the decoder
+  ns::ImageResourceData expected[TEST_IMAGE_COUNT];
+  f64 start = ns::platform::get_absolute_time();
+  for (u32 i = 0; i < TEST_IMAGE_COUNT; i++) {
+    if (!ns::image_loader_decode(test_images[i], &expected[i])) {
+      for (u32 j = 0; j < i; j++) {
+        ns::image_loader_free_pixels(&expected[j]);
+      }
+      image_decoder_test_end(&context);
+      NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+      return BYPASS;
+    }
+  }
+  f64 sync_time =
+      (ns::platform::get_absolute_time() - start) / TEST_IMAGE_COUNT;
+
+  // Main thread time only: submitting, then polling as a frame would
+  f64 stall = 0.0;
+  start = ns::platform::get_absolute_time();
+  for (u32 i = 0; i < IMAGE_DECODER_TEST_COUNT; i++) {
+    expect_true(ns::image_decoder_submit(context.decoder, i,
+                                         test_images[i % TEST_IMAGE_COUNT]));
+  }
+  stall += ns::platform::get_absolute_time() - start;
+
+  static ns::image_decode_result results[IMAGE_DECODER_TEST_COUNT];
+  static bool received[IMAGE_DECODER_TEST_COUNT];
+  u32 received_count = 0;
+  f64 max_poll = 0.0;
+  f64 timeout = ns::platform::get_absolute_time() + 60.0;
+  while (received_count < IMAGE_DECODER_TEST_COUNT &&
+         ns::platform::get_absolute_time() < timeout) {
+    start = ns::platform::get_absolute_time();
+    u32 count = ns::image_decoder_poll(context.decoder, results,
+                                       IMAGE_DECODER_TEST_COUNT);
+    f64 poll = ns::platform::get_absolute_time() - start;
+    stall += poll;
+    max_poll = poll > max_poll ? poll : max_poll;
+
+    for (u32 i = 0; i < count; i++) {
+      ns::image_decode_result &r = results[i];
+      expect_true(r.succeeded);
+      expect_false(received[r.id]);
+      received[r.id] = true;
+      ns::ImageResourceData const &e = expected[r.id % TEST_IMAGE_COUNT];
+      expect(e.width, r.image.width);
+      expect(e.height, r.image.height);
+      expect(e.channel_count, r.image.channel_count);
+      expect_true(memcmp(e.pixels, r.image.pixels, e.width * e.height * 4) ==
+                  0);
+      ns::resource_system_unload(&r.resource);
+    }
+    received_count += count;
+    ns::platform::sleep(1);
+  }
+
+  NS_DEBUG("%u textures, %u workers: main thread stall %.3f ms (longest "
+           "poll %.3f ms), synchronous decode %.3f ms per texture",
+           IMAGE_DECODER_TEST_COUNT, worker_count, stall * 1000.0,
+           max_poll * 1000.0, sync_time * 1000.0);
+
+  for (u32 i = 0; i < TEST_IMAGE_COUNT; i++) {
+    ns::image_loader_free_pixels(&expected[i]);
+  }
+  image_decoder_test_end(&context);
+
+  expect(IMAGE_DECODER_TEST_COUNT, received_count);
+  if (core_count > 1) {
+    // All of the 100 textures stall less than a single synchronous one
+    expect_true(stall < sync_time);
+  }
+  return true;
+}
+
+u8 image_decoder_should_drop_cancelled_images() {
+  image_decoder_test_context context;
+  // One worker: the requests finish in order
+  image_decoder_test_begin(&context, 1, 16);
+
+  for (u32 i = 0; i < 8; i++) {
+    expect_true(ns::image_decoder_submit(context.decoder, i, "prototype"));
+  }
+  for (u32 i = 0; i < 8; i += 2) {
+    ns::image_decoder_cancel(context.decoder, i);
+  }
+  expect_true(ns::image_decoder_submit(context.decoder, 8, "missing"));
+
+  ns::image_decode_result results[16];
+  u32 received = 0;
+  bool done = false;
+  f64 timeout = ns::platform::get_absolute_time() + 10.0;
+  while (!done && ns::platform::get_absolute_time() < timeout) {
+    u32 count = ns::image_decoder_poll(context.decoder, results, 16);
+    for (u32 i = 0; i < count; i++) {
+      if (results[i].id == 8) {
+        // Missing files fail, without pixels
+        expect_false(results[i].succeeded);
+        done = true;
+        continue;
+      }
+      if (!results[i].succeeded) {
+        image_decoder_test_end(&context);
+        NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+        return BYPASS;
+      }
+      expect(1u, results[i].id % 2);
+      ns::resource_system_unload(&results[i].resource);
+      received++;
+    }
+    ns::platform::sleep(1);
+  }
+  image_decoder_test_end(&context);
+
+  expect_true(done);
+  expect(4u, received);
+  return true;
+}
+
+// Submits an image and waits for it
+static bool image_decoder_test_decode(image_decoder_test_context *context,
+                                      u32 id, cstr name,
+                                      ns::image_decode_result *out) {
+  if (!ns::image_decoder_submit(context->decoder, id, name)) {
+    return false;
+  }
+  f64 timeout = ns::platform::get_absolute_time() + 10.0;
+  while (ns::platform::get_absolute_time() < timeout) {
+    if (ns::image_decoder_poll(context->decoder, out, 1) == 1) {
+      return out->succeeded;
+    }
+    ns::platform::sleep(1);
+  }
+  return false;
+}
+
+u8 image_decoder_should_take_swapped_back_images_from_the_cache() {
+  ns::resource_cache_config cache;
+  cache.max_entry_count = 8;
+  cache.budget = 32 * 1024 * 1024;
+  image_decoder_test_context context;
+  image_decoder_test_begin(&context, 1, 4, cache);
+
+  // A texture swapped for another (A -> B), then back (B -> A), as the
+  // texture system uploads then releases them
+  ns::image_decode_result a;
+  if (!image_decoder_test_decode(&context, 0, "Brick_01", &a)) {
+    image_decoder_test_end(&context);
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    return BYPASS;
+  }
+  u8 const *a_pixels = a.image.pixels;
+  ns::resource_system_unload(&a.resource);
+  ns::image_decode_result b;
+  expect_true(image_decoder_test_decode(&context, 1, "Brick_02", &b));
+  ns::resource_system_unload(&b.resource);
+
+  ns::resource_cache cached = ns::resource_system_resource_cache();
+  ns::resource_cache_stats before = ns::resource_cache_get_stats(cached);
+  expect(2u, before.entry_count);
+  expect(2u, before.released_count);
+  // Returned by the first poll: no worker decodes it
+  expect_true(ns::image_decoder_submit(context.decoder, 2, "Brick_01"));
+  ns::image_decode_result again;
+  expect(1u, ns::image_decoder_poll(context.decoder, &again, 1));
+  expect_true(again.succeeded);
+  ns::resource_cache_stats after = ns::resource_cache_get_stats(cached);
+  expect(before.hit_count + 1, after.hit_count);
+  expect(before.miss_count, after.miss_count);
+  expect(2u, after.entry_count);
+  // The pixels decoded the first time
+  expect_true(again.image.pixels == a_pixels);
+  ns::resource_system_unload(&again.resource);
+
+  image_decoder_test_end(&context);
+  return true;
+}
+
+void image_decoder_register_tests() {
+  test_manager_register_test(image_decoder_should_not_stall_the_main_thread,
+                             "Decoding 100 textures does not stall the "
+                             "main thread");
+  test_manager_register_test(image_decoder_should_drop_cancelled_images,
+                             "Cancelled images are not returned");
+  test_manager_register_test(
+      image_decoder_should_take_swapped_back_images_from_the_cache,
+      "A texture swapped back is taken from the cache, not decoded again");
+}
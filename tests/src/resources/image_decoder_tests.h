@@ -0,0 +1,6 @@
+#ifndef IMAGE_DECODER_TESTS_HEADER_INCLUDED
+#define IMAGE_DECODER_TESTS_HEADER_INCLUDED
+
+void image_decoder_register_tests();
+
+#endif // IMAGE_DECODER_TESTS_HEADER_INCLUDED
@@ -0,0 +1,218 @@
+#include "./material_loader_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+#include "./test_resources.h"
+
+#include <core/memory.h>
+#include <core/string.h>
+#include <resources/loaders/material_loader.h>
+#include <systems/resource_system.h>
+
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+
+// Created in the working directory and removed by the tests
+#define MATERIAL_TEST_DIR "material_test_assets"
+
+static void material_test_resource_system(cstr base_path, bool cook,
+                                          test_resource_system *out_system) {
+  ns::resource_system_config config;
+  config.asset_base_path = base_path;
+  config.cook_materials = cook;
+  test_resource_system_start(config, out_system);
+}
+
+static bool material_test_write(cstr path, void const *data, usize size) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    return false;
+  }
+  bool written = fwrite(data, 1, size, f) == size;
+  fclose(f);
+  return written;
+}
+
+static bool material_test_same(ns::MaterialConfig const *config,
+                               ns::material_binary const *binary) {
+  return ns::string_eq(config->name, binary->name) &&
+         static_cast<u32>(config->type) == binary->type &&
+         config->diffuse_color.x == binary->diffuse_color[0] &&
+         config->diffuse_color.y == binary->diffuse_color[1] &&
+         config->diffuse_color.z == binary->diffuse_color[2] &&
+         config->diffuse_color.w == binary->diffuse_color[3] &&
+         ns::string_eq(config->diffuse_map_name, binary->diffuse_map_name);
+}
+
+u8 material_cook_should_match_the_text_loader() {
+  test_memory_start();
+  test_resource_system system;
+  material_test_resource_system(NS_TEST_ASSET_PATH, true, &system);
+
+  cstr names[] = {"test_material", "test_ui_material"};
+  cstr files[] = {"materials/test_material.nsmt",
+                  "materials/test_ui_material.nsmt"};
+  for (u32 i = 0; i < 2; i++) {
+    ns::Resource text;
+    if (!ns::resource_system_load(files[i], ns::ResourceType::BINARY, &text)) {
+      test_resource_system_stop(&system);
+      ns::memory_system_shutdown();
+      NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+      return BYPASS;
+    }
+    ns::material_binary binary;
+    expect_true(ns::material_cook(names[i],
+                                  reinterpret_cast<cstr>(text.data),
+                                  text.data_size, &binary));
+    ns::resource_system_unload(&text);
+    expect(MATERIAL_BINARY_MAGIC, binary.magic);
+    expect(static_cast<u32>(MATERIAL_BINARY_VERSION), binary.version);
+
+    ns::Resource material;
+    expect_true(
+        ns::resource_system_load(names[i], ns::ResourceType::MATERIAL,
+                                 &material));
+    expect_true(material_test_same(
+        reinterpret_cast<ns::MaterialConfig *>(material.data), &binary));
+    ns::resource_system_unload(&material);
+  }
+
+  // Without a name in the file, the material is named after it
+  cstr text = "version=0.1\ndiffuse_map_name=tex\n  type = ui  \n";
+  ns::material_binary binary;
+  expect_true(ns::material_cook("unnamed", text, strlen(text), &binary));
+  expect_true(ns::string_eq(binary.name, "unnamed"));
+  expect_true(ns::string_eq(binary.diffuse_map_name, "tex"));
+  expect(static_cast<u32>(ns::MaterialType::UI), binary.type);
+  expect(1.0f, binary.diffuse_color[0]);
+
+  test_resource_system_stop(&system);
+  ns::memory_system_shutdown();
+  return true;
+}
+
+u8 material_loader_should_prefer_the_cooked_file() {
+  test_memory_start();
+  std::filesystem::create_directories(MATERIAL_TEST_DIR "/materials");
+  test_resource_system system;
+  material_test_resource_system(MATERIAL_TEST_DIR, false, &system);
+
+  cstr text = "name=from_text\ndiffuse_color=0.5 0.5 0.5 1\n";
+  cstr cooked_text = "name=from_binary\ndiffuse_color=0.25 0.5 0.75 1\n";
+  ns::material_binary binary;
+  expect_true(
+      ns::material_cook("m", cooked_text, strlen(cooked_text), &binary));
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmt", text,
+                                  strlen(text)));
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmb",
+                                  &binary, sizeof(binary)));
+
+  ns::Resource material;
+  expect_true(
+      ns::resource_system_load("m", ns::ResourceType::MATERIAL, &material));
+  auto config = reinterpret_cast<ns::MaterialConfig *>(material.data);
+  expect_true(material_test_same(config, &binary));
+  expect_true(config->auto_release);
+  ns::resource_system_unload(&material);
+
+  // A cooked file from another version is an error, not read as text
+  binary.version = MATERIAL_BINARY_VERSION + 1;
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmb",
+                                  &binary, sizeof(binary)));
+  expect_false(
+      ns::resource_system_load("m", ns::ResourceType::MATERIAL, &material));
+  // So is a truncated one
+  binary.version = MATERIAL_BINARY_VERSION;
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmb",
+                                  &binary, sizeof(binary) - 1));
+  expect_false(
+      ns::resource_system_load("m", ns::ResourceType::MATERIAL, &material));
+
+  // Without cook_materials, the text file is not read
+  remove(MATERIAL_TEST_DIR "/materials/m.nsmb");
+  expect_false(
+      ns::resource_system_load("m", ns::ResourceType::MATERIAL, &material));
+
+  test_resource_system_stop(&system);
+  std::filesystem::remove_all(MATERIAL_TEST_DIR);
+  ns::memory_system_shutdown();
+  return true;
+}
+
+static bool material_test_load_name(cstr expected_name) {
+  ns::Resource material;
+  if (!ns::resource_system_load("m", ns::ResourceType::MATERIAL, &material)) {
+    return false;
+  }
+  bool same = ns::string_eq(
+      reinterpret_cast<ns::MaterialConfig *>(material.data)->name,
+      expected_name);
+  ns::resource_system_unload(&material);
+  return same;
+}
+
+static bool material_test_read_cooked(ns::material_binary *out) {
+  FILE *f = fopen(MATERIAL_TEST_DIR "/materials/m.nsmb", "rb");
+  if (!f) {
+    return false;
+  }
+  bool read = fread(out, 1, sizeof(*out), f) == sizeof(*out);
+  fclose(f);
+  return read;
+}
+
+u8 material_loader_should_cook_the_changed_text() {
+  test_memory_start();
+  std::filesystem::create_directories(MATERIAL_TEST_DIR "/materials");
+  test_resource_system system;
+  material_test_resource_system(MATERIAL_TEST_DIR, true, &system);
+
+  // Missing: cooked next to the text file, then read
+  cstr text = "name=from_text\n";
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmt", text,
+                                  strlen(text)));
+  expect_true(material_test_load_name("from_text"));
+  ns::material_binary cooked;
+  expect_true(material_test_read_cooked(&cooked));
+  expect_true(ns::string_eq(cooked.name, "from_text"));
+  expect_true(cooked.source_key != 0);
+  expect_true(material_test_load_name("from_text"));
+
+  // Cooked from another text file
+  ns::material_binary stale;
+  cstr stale_text = "name=stale\n";
+  expect_true(
+      ns::material_cook("m", stale_text, strlen(stale_text), &stale));
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmb",
+                                  &stale, sizeof(stale)));
+  expect_true(material_test_load_name("from_text"));
+  // From another version
+  cooked.version = MATERIAL_BINARY_VERSION + 1;
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmb",
+                                  &cooked, sizeof(cooked)));
+  expect_true(material_test_load_name("from_text"));
+
+  // The text file changed
+  cstr edited = "name=edited\ndiffuse_color=0.5 0.5 0.5 1\n";
+  expect_true(material_test_write(MATERIAL_TEST_DIR "/materials/m.nsmt",
+                                  edited, strlen(edited)));
+  expect_true(material_test_load_name("edited"));
+  expect_true(material_test_read_cooked(&cooked));
+  expect_true(ns::string_eq(cooked.name, "edited"));
+  expect(0.5f, cooked.diffuse_color[0]);
+
+  test_resource_system_stop(&system);
+  std::filesystem::remove_all(MATERIAL_TEST_DIR);
+  ns::memory_system_shutdown();
+  return true;
+}
+
+void material_loader_register_tests() {
+  test_manager_register_test(material_cook_should_match_the_text_loader,
+                             "Cooked materials match the text loader");
+  test_manager_register_test(material_loader_should_prefer_the_cooked_file,
+                             "Material loader prefers the cooked file");
+  test_manager_register_test(
+      material_loader_should_cook_the_changed_text,
+      "Material loader cooks the text files when they change");
+}
@@ -0,0 +1,6 @@
+#ifndef MATERIAL_LOADER_TESTS_HEADER_INCLUDED
+#define MATERIAL_LOADER_TESTS_HEADER_INCLUDED
+
+void material_loader_register_tests();
+
+#endif // MATERIAL_LOADER_TESTS_HEADER_INCLUDED
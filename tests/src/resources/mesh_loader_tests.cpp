@@ -0,0 +1,221 @@
+#include "./mesh_loader_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+#include "./test_resources.h"
+
+#include <core/memory.h>
+#include <resources/loaders/mesh_loader.h>
+#include <resources/obj_importer.h>
+#include <systems/geometry_system.h>
+#include <systems/resource_system.h>
+
+#include <cmath>
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Created in the working directory and removed by the tests
+#define MESH_LOADER_TEST_ASSETS "mesh_loader_test_assets"
+
+// A unit quad in z = 0 as one polygon, without normals
+static cstr mesh_loader_test_quad = "# quad\n"
+                                    "o quad\n"
+                                    "v 0 0 0\n"
+                                    "v 1.0 0 0\n"
+                                    "v 1 1e0 0\n"
+                                    "v 0 1 -0.0\n"
+                                    "vt 0 0\n"
+                                    "vt 1 0\n"
+                                    "vt 1 1\n"
+                                    "vt 0 1\n"
+                                    "s off\n"
+                                    "f 1/1 2/2 3/3 4/4\r\n";
+
+static bool mesh_loader_test_import(cstr text, ns::MeshResourceData *out) {
+  return ns::obj_import(text, strlen(text), "test.obj", out);
+}
+
+static bool mesh_loader_test_near(ns::vec3 const &a, ns::vec3 const &b) {
+  return std::fabs(a.x - b.x) < 1e-5f && std::fabs(a.y - b.y) < 1e-5f &&
+         std::fabs(a.z - b.z) < 1e-5f;
+}
+
+u8 obj_import_should_triangulate_and_generate_frames() {
+  ns::MeshResourceData mesh;
+  expect_true(mesh_loader_test_import(mesh_loader_test_quad, &mesh));
+  expect(4u, mesh.vertex_count);
+  expect(6u, mesh.index_count);
+  expect(sizeof(u16), mesh.index_size);
+  // A fan around the first corner, in the winding of the file
+  u16 const *indices = reinterpret_cast<u16 const *>(mesh.indices);
+  u16 fan[6] = {0, 1, 2, 0, 2, 3};
+  for (u32 i = 0; i < 6; i++) {
+    expect(fan[i], indices[i]);
+  }
+  expect_true(mesh_loader_test_near(mesh.vertices[2].position,
+                                    ns::vec3{1.0f, 1.0f, 0.0f}));
+  expect_true(mesh.vertices[2].texcoord.x == 1.0f);
+  expect_true(
+      mesh_loader_test_near(mesh.bounds.max, ns::vec3{1.0f, 1.0f, 0.0f}));
+  // Facing the viewer, u along x and v along y
+  for (u32 i = 0; i < mesh.vertex_count; i++) {
+    expect_true(mesh_loader_test_near(mesh.frames[i].normal,
+                                      ns::vec3{0.0f, 0.0f, 1.0f}));
+    expect_true(mesh_loader_test_near(mesh.frames[i].tangent,
+                                      ns::vec3{1.0f, 0.0f, 0.0f}));
+    expect_true(mesh.frames[i].handedness == 1.0f);
+  }
+  ns::mesh_loader_free(&mesh);
+  return true;
+}
+
+u8 obj_import_should_deduplicate_corners() {
+  // Two triangles sharing an edge, with negative indices for the second
+  // one; then a corner of the same position with another normal
+  cstr text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+              "vn 0 0 1\nvn 0 0 -1\n"
+              "f 1//1 2//1 3//1\n"
+              "f -3//-2 -1//-2 -2//-2\n"
+              "f 1//2 3//2 2//2\n";
+  ns::MeshResourceData mesh;
+  expect_true(mesh_loader_test_import(text, &mesh));
+  expect(9u, mesh.index_count);
+  // 4 corners with the first normal, 3 with the second
+  expect(7u, mesh.vertex_count);
+  u16 const *indices = reinterpret_cast<u16 const *>(mesh.indices);
+  expect(1, indices[3]);
+  expect(3, indices[4]);
+  expect(2, indices[5]);
+  expect_true(mesh_loader_test_near(mesh.frames[indices[6]].normal,
+                                    ns::vec3{0.0f, 0.0f, -1.0f}));
+  // No texcoords: any tangent, orthogonal to the normal
+  for (u32 i = 0; i < mesh.vertex_count; i++) {
+    expect_true(std::fabs(mesh.frames[i].normal.dot(mesh.frames[i].tangent)) <
+                1e-5f);
+    expect_true(std::fabs(mesh.frames[i].tangent.length() - 1.0f) < 1e-5f);
+  }
+  ns::mesh_loader_free(&mesh);
+  return true;
+}
+
+u8 obj_import_should_reject_invalid_files() {
+  ns::MeshResourceData mesh;
+  NS_DEBUG("Note: The following errors are intentionally caused by this "
+           "test.");
+  expect_false(mesh_loader_test_import("v 0 0 0\nv 1 0 0\n", &mesh));
+  expect_false(mesh_loader_test_import("v 0 0 0\nv 1 0 0\nf 1 2 3\n", &mesh));
+  expect_false(mesh_loader_test_import("v 0 0 0\nv 1 0 0\nf 1 2\n", &mesh));
+  expect_false(mesh_loader_test_import("v 0 x 0\n", &mesh));
+  expect_false(
+      mesh_loader_test_import("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/1 2 3\n", &mesh));
+  return true;
+}
+
+u8 mesh_binary_view_should_reject_out_of_range_indices() {
+  ns::MeshResourceData mesh;
+  expect_true(mesh_loader_test_import(mesh_loader_test_quad, &mesh));
+  std::vector<u8> image(mesh.data, mesh.data + mesh.data_size);
+  ns::MeshResourceData view;
+  expect_true(ns::mesh_binary_view(image.data(), image.size(), &view));
+
+  // The last index points past the 4 vertices
+  usize last = reinterpret_cast<u8 const *>(view.indices) - image.data() +
+               (view.index_count - 1) * sizeof(u16);
+  u16 index = 4;
+  memcpy(image.data() + last, &index, sizeof(index));
+  expect_false(ns::mesh_binary_view(image.data(), image.size(), &view));
+  index = 3;
+  memcpy(image.data() + last, &index, sizeof(index));
+  expect_true(ns::mesh_binary_view(image.data(), image.size(), &view));
+  ns::mesh_loader_free(&mesh);
+  return true;
+}
+
+static bool mesh_loader_test_write(cstr name, cstr text) {
+  std::error_code error;
+  std::filesystem::create_directories(MESH_LOADER_TEST_ASSETS "/models",
+                                      error);
+  std::string path =
+      std::string(MESH_LOADER_TEST_ASSETS "/models/") + name + ".obj";
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f) {
+    return false;
+  }
+  bool ok = fwrite(text, 1, strlen(text), f) == strlen(text);
+  fclose(f);
+  return ok;
+}
+
+u8 mesh_loader_should_map_the_cooked_mesh() {
+  test_memory_start();
+  ns::resource_system_config resources;
+  resources.asset_base_path = MESH_LOADER_TEST_ASSETS;
+  test_resource_system system;
+  test_resource_system_start(resources, &system);
+  expect_true(mesh_loader_test_write("quad", mesh_loader_test_quad));
+
+  // Imported, then cooked next to the source
+  ns::MeshResourceData imported;
+  expect_true(ns::mesh_loader_decode("quad", &imported));
+  expect_true(imported.cached.data == nullptr);
+  expect_true(
+      std::filesystem::exists(MESH_LOADER_TEST_ASSETS "/models/quad.nsmesh"));
+
+  ns::MeshResourceData cooked;
+  expect_true(ns::mesh_loader_decode("quad", &cooked));
+  expect_true(cooked.cached.data != nullptr);
+  expect(imported.data_size, cooked.data_size);
+  expect(0, memcmp(imported.data, cooked.data, cooked.data_size));
+  ns::mesh_loader_free(&cooked);
+
+  // The geometry points into the mesh
+  ns::geometry_config config =
+      ns::geometry_config::mesh(&imported, "quad", "quad_material");
+  expect(sizeof(ns::vertex_3d), config.vertex_size);
+  expect(4u, config.vertex_count);
+  expect_true(config.vertices == imported.vertices);
+  expect_true(config.indices == imported.indices);
+  expect(sizeof(u16), config.index_size);
+  ns::mesh_loader_free(&imported);
+
+  // A modified source is imported again
+  expect_true(mesh_loader_test_write(
+      "quad", "v 0 0 0\nv 2 0 0\nv 0 2 0\nf 1 2 3\n# modified\n"));
+  ns::MeshResourceData modified;
+  expect_true(ns::mesh_loader_decode("quad", &modified));
+  expect_true(modified.cached.data == nullptr);
+  expect(3u, modified.vertex_count);
+  ns::mesh_loader_free(&modified);
+
+  // Through the resource system
+  ns::Resource resource;
+  expect_true(ns::resource_system_load("quad", ns::ResourceType::STATIC_MESH,
+                                       &resource));
+  auto mesh = reinterpret_cast<ns::MeshResourceData *>(resource.data);
+  expect(3u, mesh->vertex_count);
+  expect_true(mesh->cached.data != nullptr);
+  ns::resource_system_unload(&resource);
+
+  test_resource_system_stop(&system);
+  std::error_code error;
+  std::filesystem::remove_all(MESH_LOADER_TEST_ASSETS, error);
+  ns::memory_system_shutdown();
+  return true;
+}
+
+void mesh_loader_register_tests() {
+  test_manager_register_test(obj_import_should_triangulate_and_generate_frames,
+                             "OBJ polygons are triangulated, with normals and "
+                             "tangents");
+  test_manager_register_test(obj_import_should_deduplicate_corners,
+                             "OBJ corners are shared by their vertex");
+  test_manager_register_test(obj_import_should_reject_invalid_files,
+                             "Invalid OBJ files are rejected");
+  test_manager_register_test(
+      mesh_binary_view_should_reject_out_of_range_indices,
+      "Cooked meshes with an index out of the vertices are rejected");
+  test_manager_register_test(mesh_loader_should_map_the_cooked_mesh,
+                             "Mesh loader maps the cooked mesh until the "
+                             "source changes");
+}
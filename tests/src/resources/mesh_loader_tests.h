@@ -0,0 +1,6 @@
+#ifndef MESH_LOADER_TESTS_HEADER_INCLUDED
+#define MESH_LOADER_TESTS_HEADER_INCLUDED
+
+void mesh_loader_register_tests();
+
+#endif // MESH_LOADER_TESTS_HEADER_INCLUDED
@@ -0,0 +1,6 @@
+#ifndef MESH_OPTIMIZER_TESTS_HEADER_INCLUDED
+#define MESH_OPTIMIZER_TESTS_HEADER_INCLUDED
+
+void mesh_optimizer_register_tests();
+
+#endif // MESH_OPTIMIZER_TESTS_HEADER_INCLUDED
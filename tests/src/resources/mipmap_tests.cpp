@@ -0,0 +1,114 @@
+#include "./mipmap_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <math/random.h>
+#include <resources/mipmap.h>
+
+#include <vector>
+
+static std::vector<u8> mipmap_test_chain(u32 width, u32 height, u64 seed) {
+  std::vector<u8> levels(
+      ns::mip_chain_size(width, height, ns::mip_count(width, height)));
+  ns::rng g(seed);
+  for (usize i = 0; i < static_cast<usize>(width) * height * 4; i++) {
+    levels[i] = static_cast<u8>(g.next_u32());
+  }
+  return levels;
+}
+
+static u32 mipmap_test_max_difference(std::vector<u8> const &a,
+                                      std::vector<u8> const &b) {
+  u32 max = 0;
+  for (usize i = 0; i < a.size(); i++) {
+    u32 d = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    max = d > max ? d : max;
+  }
+  return max;
+}
+
+u8 mipmap_sizes_should_cover_the_chain() {
+  expect(1u, ns::mip_count(1, 1));
+  expect(9u, ns::mip_count(256, 256));
+  expect(9u, ns::mip_count(300, 20));
+  expect(11u, ns::mip_count(1, 1024));
+  // 4x2, 2x1, 1x1
+  expect(static_cast<u64>((8 + 2 + 1) * 4), ns::mip_chain_size(4, 2, 3));
+  expect(static_cast<u64>(4 * 2 * 4), ns::mip_chain_size(4, 2, 1));
+  return true;
+}
+
+u8 mipmap_filters_should_average_in_linear_space() {
+  // Black and white columns, alpha 0 and 255
+  u8 pixels[4 * 4 + 4] = {0,   0,   0,   0,   255, 255, 255, 255,
+                          0,   0,   0,   0,   255, 255, 255, 255};
+  ns::mip_config config = {ns::MipFilter::BOX, false, 1};
+  ns::mip_generate(pixels, 2, 2, 2, &config);
+  expect(128u, pixels[16]);
+  expect(128u, pixels[19]);
+
+  // The mean of the light, not of the encoded values. Alpha stays linear.
+  config.srgb = true;
+  ns::mip_generate(pixels, 2, 2, 2, &config);
+  expect(188u, pixels[16]);
+  expect(188u, pixels[18]);
+  expect(128u, pixels[19]);
+
+  // Constant images stay constant, whatever the filter
+  ns::MipFilter filters[] = {ns::MipFilter::BOX, ns::MipFilter::KAISER};
+  for (ns::MipFilter filter : filters) {
+    for (u32 srgb = 0; srgb < 2; srgb++) {
+      u32 width = 37;
+      u32 height = 20;
+      std::vector<u8> levels(
+          ns::mip_chain_size(width, height, ns::mip_count(width, height)));
+      for (usize i = 0; i < static_cast<usize>(width) * height * 4; i += 4) {
+        levels[i + 0] = 200;
+        levels[i + 1] = 30;
+        levels[i + 2] = 0;
+        levels[i + 3] = 77;
+      }
+      config = {filter, srgb == 1, 0};
+      ns::mip_generate(levels.data(), width, height,
+                       ns::mip_count(width, height), &config);
+      for (usize i = 0; i < levels.size(); i += 4) {
+        expect(200u, levels[i + 0]);
+        expect(30u, levels[i + 1]);
+        expect(0u, levels[i + 2]);
+        expect(77u, levels[i + 3]);
+      }
+    }
+  }
+  return true;
+}
+
+u8 mipmap_should_match_the_scalar_reference() {
+  // Odd sizes, and levels split in bands for several threads
+  u32 sizes[][2] = {{37, 20}, {1, 9}, {512, 384}, {300, 301}};
+  ns::MipFilter filters[] = {ns::MipFilter::BOX, ns::MipFilter::KAISER};
+  for (auto const &size : sizes) {
+    u32 count = ns::mip_count(size[0], size[1]);
+    for (ns::MipFilter filter : filters) {
+      for (u32 srgb = 0; srgb < 2; srgb++) {
+        std::vector<u8> expected = mipmap_test_chain(size[0], size[1], 7);
+        std::vector<u8> actual = expected;
+        ns::mip_config config = {filter, srgb == 1, 4};
+        ns::mip_generate_reference(expected.data(), size[0], size[1], count,
+                                   &config);
+        ns::mip_generate(actual.data(), size[0], size[1], count, &config);
+        expect_true(mipmap_test_max_difference(expected, actual) <= 1);
+      }
+    }
+  }
+  return true;
+}
+
+void mipmap_register_tests() {
+  test_manager_register_test(mipmap_sizes_should_cover_the_chain,
+                             "Mip chain sizes cover every level down to 1x1");
+  test_manager_register_test(
+      mipmap_filters_should_average_in_linear_space,
+      "Mip filters average sRGB colors in linear space");
+  test_manager_register_test(mipmap_should_match_the_scalar_reference,
+                             "Mip generation matches the scalar reference");
+}
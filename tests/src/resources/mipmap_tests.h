@@ -0,0 +1,6 @@
+#ifndef MIPMAP_TESTS_HEADER_INCLUDED
+#define MIPMAP_TESTS_HEADER_INCLUDED
+
+void mipmap_register_tests();
+
+#endif // MIPMAP_TESTS_HEADER_INCLUDED
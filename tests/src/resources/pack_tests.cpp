@@ -0,0 +1,366 @@
+#include "./pack_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+#include "./test_resources.h"
+
+#include <core/memory.h>
+#include <core/string.h>
+#include <math/random.h>
+#include <resources/block_compression.h>
+#include <resources/loaders/image_loader.h>
+#include <resources/lz4.h>
+#include <resources/mipmap.h>
+#include <resources/pack.h>
+#include <resources/texture_cache.h>
+#include <systems/resource_system.h>
+
+#include <stdio.h>
+#include <string.h>
+
+// Written in the working directory and removed by the tests
+#define PACK_TEST_PATH "pack_test.nspak"
+#define PACK_TEST_SIZE (256 * 1024)
+
+static u8 pack_test_data[PACK_TEST_SIZE];
+static u8 pack_test_compressed[PACK_TEST_SIZE + PACK_TEST_SIZE / 255 + 16];
+static u8 pack_test_decompressed[PACK_TEST_SIZE];
+
+static bool lz4_round_trip(usize size, usize *out_compressed_size) {
+  usize compressed_size =
+      ns::lz4_compress(pack_test_data, size, pack_test_compressed,
+                       ns::lz4_compress_bound(size));
+  *out_compressed_size = compressed_size;
+  return compressed_size > 0 &&
+         ns::lz4_decompress(pack_test_compressed, compressed_size,
+                            pack_test_decompressed, size) &&
+         memcmp(pack_test_data, pack_test_decompressed, size) == 0;
+}
+
+u8 lz4_should_round_trip() {
+  ns::rng g(42);
+  usize compressed_size = 0;
+
+  // Incompressible data only grows by the bound
+  for (usize i = 0; i < PACK_TEST_SIZE; i++) {
+    pack_test_data[i] = static_cast<u8>(g.next_u64());
+  }
+  usize sizes[] = {0, 1, 4, 12, 13, 17, 255, 4096, PACK_TEST_SIZE};
+  for (usize size : sizes) {
+    expect_true(lz4_round_trip(size, &compressed_size));
+    expect_true(compressed_size <= ns::lz4_compress_bound(size));
+  }
+
+  // Runs (overlapping matches) and long repeats (offsets up to 65535)
+  for (usize i = 0; i < PACK_TEST_SIZE; i++) {
+    pack_test_data[i] = (i / 1000) % 3 == 0 ? static_cast<u8>(i / 1000)
+                                            : pack_test_data[i % 50000];
+  }
+  expect_true(lz4_round_trip(PACK_TEST_SIZE, &compressed_size));
+  expect_true(compressed_size < PACK_TEST_SIZE / 2);
+
+  // Text-like data
+  cstr words[] = {"vec4 ", "layout(location = 0) ", "in ", "out ", "uniform ",
+                  "void main() {\n", "}\n", "gl_Position = ", "0.5;\n"};
+  for (usize i = 0; i < PACK_TEST_SIZE;) {
+    cstr w = words[g.range(0, 8)];
+    for (; *w && i < PACK_TEST_SIZE; w++) {
+      pack_test_data[i++] = static_cast<u8>(*w);
+    }
+  }
+  expect_true(lz4_round_trip(PACK_TEST_SIZE, &compressed_size));
+  expect_true(compressed_size < PACK_TEST_SIZE / 2);
+
+  // Truncated or wrongly sized data is rejected
+  expect_false(ns::lz4_decompress(pack_test_compressed, compressed_size / 2,
+                                  pack_test_decompressed, PACK_TEST_SIZE));
+  expect_false(ns::lz4_decompress(pack_test_compressed, compressed_size,
+                                  pack_test_decompressed, PACK_TEST_SIZE - 1));
+  expect_false(ns::lz4_compress(pack_test_data, PACK_TEST_SIZE,
+                                pack_test_compressed, PACK_TEST_SIZE));
+  return true;
+}
+
+u8 pack_should_find_the_written_files() {
+  test_memory_start(32 * 1024 * 1024);
+
+  ns::rng g(7);
+  for (usize i = 0; i < PACK_TEST_SIZE; i++) {
+    // The first half compresses, the second does not
+    pack_test_data[i] = i < PACK_TEST_SIZE / 2 ? static_cast<u8>(i % 7)
+                                               : static_cast<u8>(g.next_u64());
+  }
+  char names[100][32];
+  ns::pack_source sources[100];
+  for (u32 i = 0; i < 100; i++) {
+    snprintf(names[i], sizeof(names[i]), "dir/file_%u.bin", i);
+    sources[i].name = names[i];
+    usize offset = (i * 2477) % (PACK_TEST_SIZE / 2);
+    sources[i].data = pack_test_data + offset;
+    sources[i].size = i % 10 == 0 ? 0 : i * 1000;
+  }
+
+  expect_true(ns::pack_write(PACK_TEST_PATH, sources, 100, true));
+  ns::pack p;
+  expect_true(ns::pack_open(PACK_TEST_PATH, &p));
+  expect(100u, p.header->entry_count);
+  u32 compressed_count = 0;
+  for (u32 i = 0; i < 100; i++) {
+    ns::pack_entry const *e = ns::pack_find(&p, names[i]);
+    expect_true(e != nullptr);
+    expect_true(ns::string_eq(ns::pack_entry_name(&p, e), names[i]));
+    expect(sources[i].size, e->size);
+    expect(0u, e->offset % PACK_ALIGNMENT);
+
+    ns::Slice<u8> view = ns::Slice<u8>::from_parts(nullptr, 0);
+    if (ns::pack_view(&p, e, &view)) {
+      expect(sources[i].size, view.len());
+      expect_true(memcmp(view.begin(), sources[i].data, e->size) == 0);
+    } else {
+      compressed_count++;
+    }
+    expect_true(ns::pack_read(&p, e, pack_test_decompressed));
+    expect_true(memcmp(pack_test_decompressed, sources[i].data, e->size) ==
+                0);
+  }
+  // The sources starting in the second half don't shrink by 1/8
+  expect_true(compressed_count > 0 && compressed_count < 90);
+  expect_true(ns::pack_find(&p, "dir/file_100.bin") == nullptr);
+  expect_true(ns::pack_find(&p, "dir/") == nullptr);
+  ns::pack_close(&p);
+
+  // Duplicates are refused
+  sources[1].name = names[0];
+  expect_false(ns::pack_write(PACK_TEST_PATH, sources, 2, false));
+
+  // A truncated pack is refused
+  expect_true(ns::pack_write(PACK_TEST_PATH, sources + 2, 2, false));
+  FILE *f = fopen(PACK_TEST_PATH, "rb");
+  expect_true(f != nullptr);
+  usize size = fread(pack_test_decompressed, 1, PACK_TEST_SIZE, f);
+  fclose(f);
+  f = fopen(PACK_TEST_PATH, "wb");
+  expect_true(f != nullptr);
+  fwrite(pack_test_decompressed, 1, size - 1, f);
+  fclose(f);
+  expect_false(ns::pack_open(PACK_TEST_PATH, &p));
+  remove(PACK_TEST_PATH);
+
+  ns::memory_system_shutdown();
+  return true;
+}
+
+struct pack_test_asset {
+  cstr name;
+  ns::ResourceType type;
+  cstr file;
+};
+
+static const pack_test_asset pack_test_assets[] = {
+    {"test_material", ns::ResourceType::MATERIAL,
+     "materials/test_material.nsmt"},
+    {"test_ui_material", ns::ResourceType::MATERIAL,
+     "materials/test_ui_material.nsmt"},
+    {"prototype", ns::ResourceType::IMAGE, "textures/prototype.png"},
+    {"Brick_01", ns::ResourceType::IMAGE, "textures/Brick_01.png"},
+    {"shaders/Builtin.UIShader.vert.glsl", ns::ResourceType::TEXT,
+     "shaders/Builtin.UIShader.vert.glsl"},
+    {"shaders/Builtin.MaterialShader.frag.glsl", ns::ResourceType::BINARY,
+     "shaders/Builtin.MaterialShader.frag.glsl"},
+};
+
+#define PACK_TEST_ASSET_COUNT                                                  \
+  (sizeof(pack_test_assets) / sizeof(pack_test_asset))
+
+static bool pack_test_resource_system(cstr pack_path,
+                                      test_resource_system *out_system) {
+  ns::resource_system_config config;
+  config.asset_base_path = NS_TEST_ASSET_PATH;
+  config.pack_path = pack_path;
+  // The .nsmt files are packed as they are
+  config.cook_materials = true;
+  return test_resource_system_start(config, out_system);
+}
+
+static bool pack_test_same_resource(ns::ResourceType type,
+                                    ns::Resource const &a,
+                                    ns::Resource const &b) {
+  if (type == ns::ResourceType::IMAGE) {
+    auto ia = reinterpret_cast<ns::ImageResourceData const *>(a.data);
+    auto ib = reinterpret_cast<ns::ImageResourceData const *>(b.data);
+    return ia->width == ib->width && ia->height == ib->height &&
+           memcmp(ia->pixels, ib->pixels, ia->width * ia->height * 4) == 0;
+  }
+  if (type == ns::ResourceType::MATERIAL) {
+    auto ma = reinterpret_cast<ns::MaterialConfig const *>(a.data);
+    auto mb = reinterpret_cast<ns::MaterialConfig const *>(b.data);
+    return ns::string_eq(ma->name, mb->name) && ma->type == mb->type &&
+           ma->diffuse_color == mb->diffuse_color &&
+           ns::string_eq(ma->diffuse_map_name, mb->diffuse_map_name);
+  }
+  return a.data_size == b.data_size &&
+         memcmp(a.data, b.data, a.data_size) == 0;
+}
+
+u8 resource_system_should_load_from_the_pack() {
+  test_memory_start(64 * 1024 * 1024);
+
+  // The loose files, and their bytes for the pack
+  test_resource_system resources;
+  pack_test_resource_system(nullptr, &resources);
+  static ns::Resource loose[PACK_TEST_ASSET_COUNT];
+  static ns::Resource files[PACK_TEST_ASSET_COUNT];
+  ns::pack_source sources[PACK_TEST_ASSET_COUNT];
+  u32 loaded = 0;
+  for (; loaded < PACK_TEST_ASSET_COUNT; loaded++) {
+    pack_test_asset const &a = pack_test_assets[loaded];
+    if (!ns::resource_system_load(a.name, a.type, &loose[loaded]) ||
+        !ns::resource_system_load(a.file, ns::ResourceType::BINARY,
+                                  &files[loaded])) {
+      break;
+    }
+    sources[loaded] = {a.file, reinterpret_cast<u8 const *>(files[loaded].data),
+                       files[loaded].data_size};
+  }
+  bool written = loaded == PACK_TEST_ASSET_COUNT &&
+                 ns::pack_write(PACK_TEST_PATH, sources, loaded, true);
+  for (u32 i = 0; i < loaded; i++) {
+    ns::resource_system_unload(&files[i]);
+  }
+  test_resource_system_stop(&resources);
+  if (loaded < PACK_TEST_ASSET_COUNT) {
+    for (u32 i = 0; i < loaded; i++) {
+      ns::resource_system_unload(&loose[i]);
+    }
+    ns::memory_system_shutdown();
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    return BYPASS;
+  }
+  expect_true(written);
+
+  expect_true(pack_test_resource_system(PACK_TEST_PATH, &resources));
+  ns::pack const *assets = ns::resource_system_pack();
+  expect_true(assets != nullptr);
+  bool same = true;
+  bool views = true;
+  for (u32 i = 0; i < PACK_TEST_ASSET_COUNT; i++) {
+    pack_test_asset const &a = pack_test_assets[i];
+    ns::Resource packed;
+    expect_true(ns::resource_system_load(a.name, a.type, &packed));
+    same = same && pack_test_same_resource(a.type, loose[i], packed);
+    if (a.type == ns::ResourceType::TEXT ||
+        a.type == ns::ResourceType::BINARY) {
+      // Uncompressed entries are not copied
+      ns::pack_entry const *e = ns::pack_find(assets, a.file);
+      bool is_view = e->compression == ns::PackCompression::NONE;
+      views = views && packed.data_is_view == is_view;
+      if (is_view) {
+        views = views && AS_BYTES(packed.data) == assets->file.data + e->offset;
+      }
+    }
+    ns::resource_system_unload(&packed);
+    ns::resource_system_unload(&loose[i]);
+  }
+  expect_true(same);
+  expect_true(views);
+
+  ns::Resource missing;
+  expect_false(ns::resource_system_load("missing", ns::ResourceType::IMAGE,
+                                        &missing));
+
+  test_resource_system_stop(&resources);
+  remove(PACK_TEST_PATH);
+  ns::memory_system_shutdown();
+  return true;
+}
+
+static bool pack_test_same_image(ns::ImageResourceData const *a,
+                                 ns::ImageResourceData const *b) {
+  return a->width == b->width && a->height == b->height &&
+         a->format == b->format && a->mip_count == b->mip_count &&
+         memcmp(a->pixels, b->pixels,
+                ns::texture_format_chain_size(a->format, a->width, a->height,
+                                              a->mip_count)) == 0;
+}
+
+u8 resource_system_should_load_the_cooked_images() {
+  test_memory_start(64 * 1024 * 1024);
+
+  // The image decoded from the loose file, and cooked as nspak does
+  ns::resource_system_config config;
+  config.asset_base_path = NS_TEST_ASSET_PATH;
+  config.compress_textures = true;
+  test_resource_system resources;
+  test_resource_system_start(config, &resources);
+  ns::Resource loose;
+  ns::Resource png;
+  if (!ns::resource_system_load("Brick_01", ns::ResourceType::IMAGE,
+                                &loose)) {
+    test_resource_system_stop(&resources);
+    ns::memory_system_shutdown();
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    return BYPASS;
+  }
+  expect_true(ns::resource_system_load(
+      "textures/Brick_01.png", ns::ResourceType::BINARY, &png));
+  ns::ImageResourceData cooked;
+  expect_true(ns::image_cook("textures/Brick_01.png",
+                             reinterpret_cast<u8 const *>(png.data),
+                             png.data_size, &cooked));
+  ns::resource_system_unload(&png);
+  test_resource_system_stop(&resources);
+  ns::texture_cache_header header =
+      ns::texture_cache_header_create(&cooked, 0);
+  usize file_size = sizeof(header) + header.pixels_size;
+  u8 *file = reinterpret_cast<u8 *>(ns::alloc(file_size, ns::MemTag::ARRAY));
+  ns::mem_copy(file, &header, sizeof(header));
+  ns::mem_copy(file + sizeof(header), cooked.pixels, header.pixels_size);
+  ns::image_loader_free_pixels(&cooked);
+  ns::pack_source source = {"textures/Brick_01.nstc", file, file_size};
+  expect_true(ns::pack_write(PACK_TEST_PATH, &source, 1, true));
+  ns::free(file, file_size, ns::MemTag::ARRAY);
+
+  // Loaded as cooked: no PNG file in the pack to decode
+  config.pack_path = PACK_TEST_PATH;
+  expect_true(test_resource_system_start(config, &resources));
+  auto loose_image = reinterpret_cast<ns::ImageResourceData *>(loose.data);
+  ns::ImageResourceData packed;
+  expect_true(ns::image_loader_decode("Brick_01", &packed));
+  expect_true(packed.format == ns::TextureFormat::BC1);
+  expect_true(pack_test_same_image(loose_image, &packed));
+  ns::image_loader_free_pixels(&packed);
+
+  // Decompressed for a device without BC support
+  ns::resource_system_set_compress_textures(false);
+  expect_true(ns::image_loader_decode("Brick_01", &packed));
+  expect_true(packed.format == ns::TextureFormat::RGBA8);
+  expect(loose_image->mip_count, packed.mip_count);
+  usize level_size = ns::texture_format_level_size(
+      ns::TextureFormat::RGBA8, packed.width, packed.height);
+  u8 *decompressed =
+      reinterpret_cast<u8 *>(ns::alloc(level_size, ns::MemTag::ARRAY));
+  ns::bc_decompress(loose_image->format, loose_image->pixels,
+                    loose_image->width, loose_image->height, decompressed);
+  expect(0, memcmp(decompressed, packed.pixels, level_size));
+  ns::free(decompressed, level_size, ns::MemTag::ARRAY);
+  ns::image_loader_free_pixels(&packed);
+
+  ns::resource_system_unload(&loose);
+  test_resource_system_stop(&resources);
+  remove(PACK_TEST_PATH);
+  ns::memory_system_shutdown();
+  return true;
+}
+
+void pack_register_tests() {
+  test_manager_register_test(
+      lz4_should_round_trip,
+      "LZ4 blocks round trip and bad blocks are refused");
+  test_manager_register_test(pack_should_find_the_written_files,
+                             "Pack entries are found and read back");
+  test_manager_register_test(
+      resource_system_should_load_from_the_pack,
+      "The resource system loads the same resources from a pack");
+  test_manager_register_test(
+      resource_system_should_load_the_cooked_images,
+      "Cooked images load from a pack, decompressed without BC support");
+}
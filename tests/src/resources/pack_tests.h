@@ -0,0 +1,6 @@
+#ifndef PACK_TESTS_HEADER_INCLUDED
+#define PACK_TESTS_HEADER_INCLUDED
+
+void pack_register_tests();
+
+#endif // PACK_TESTS_HEADER_INCLUDED
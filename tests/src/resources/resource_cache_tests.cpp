@@ -0,0 +1,263 @@
+#include "./resource_cache_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+#include "./test_resources.h"
+
+#include <core/memory.h>
+#include <core/string.h>
+#include <systems/resource_system.h>
+
+#include <string>
+#include <vector>
+
+// The resources are the bytes of a buffer, "unloaded" by clearing their
+// byte and recording their name
+static u8 resource_cache_test_data[8];
+static std::vector<std::string> resource_cache_test_unloaded;
+
+static void resource_cache_test_unload(ns::Resource *resource) {
+  *reinterpret_cast<u8 *>(resource->data) = 0;
+  resource_cache_test_unloaded.push_back(resource->name);
+}
+
+struct resource_cache_test_context {
+  std::vector<u8> memory;
+  ns::resource_cache cache;
+};
+
+static void resource_cache_test_begin(resource_cache_test_context *context,
+                                      u32 max_entry_count, u64 budget,
+                                      u64 image_budget = 0) {
+  ns::resource_cache_config config = {};
+  config.max_entry_count = max_entry_count;
+  config.budget = budget;
+  config.type_budgets[static_cast<u32>(ns::ResourceType::IMAGE)] =
+      image_budget;
+  usize requirement = 0;
+  ns::resource_cache_create(config, resource_cache_test_unload, &requirement,
+                            nullptr, nullptr);
+  context->memory.resize(requirement);
+  ns::resource_cache_create(config, resource_cache_test_unload, &requirement,
+                            context->memory.data(), &context->cache);
+  resource_cache_test_unloaded.clear();
+}
+
+// Loads the resource i, from the cache or "from disk"
+static bool resource_cache_test_load(ns::resource_cache cache, cstr name,
+                                     u32 i, ns::ResourceType type, u64 size,
+                                     ns::Resource *out) {
+  if (ns::resource_cache_acquire(cache, name, 0, out)) {
+    return true;
+  }
+  resource_cache_test_data[i] = static_cast<u8>(i + 1);
+  out->loader_id = 0;
+  out->name = name;
+  out->full_path[0] = '\0';
+  out->data = &resource_cache_test_data[i];
+  out->data_size = 1;
+  out->data_is_view = false;
+  ns::resource_cache_insert(cache, name, type, size, out);
+  return false;
+}
+
+u8 resource_cache_should_keep_the_released_resources() {
+  resource_cache_test_context context;
+  resource_cache_test_begin(&context, 8, 1000);
+  ns::Resource a;
+  ns::Resource a_again;
+  expect_false(resource_cache_test_load(context.cache, "a", 0,
+                                        ns::ResourceType::TEXT, 100, &a));
+  expect_true(a.cache_id != INVALID_ID);
+  // Shared while referenced
+  expect_true(resource_cache_test_load(context.cache, "a", 0,
+                                       ns::ResourceType::TEXT, 100,
+                                       &a_again));
+  expect_true(a_again.data == a.data);
+  ns::resource_cache_release(context.cache, &a);
+  expect_true(a.data == nullptr);
+  ns::resource_cache_release(context.cache, &a_again);
+
+  // Released, still loaded
+  ns::resource_cache_stats stats = ns::resource_cache_get_stats(context.cache);
+  expect(1u, stats.entry_count);
+  expect(1u, stats.released_count);
+  expect(100u, stats.size);
+  expect(0u, resource_cache_test_unloaded.size());
+  expect_true(resource_cache_test_load(context.cache, "a", 0,
+                                       ns::ResourceType::TEXT, 100, &a));
+  expect(1, *reinterpret_cast<u8 *>(a.data));
+  ns::resource_cache_release(context.cache, &a);
+  // Another loader, another resource
+  expect_false(ns::resource_cache_acquire(context.cache, "a", 1, &a));
+
+  // Loaded again meanwhile: not cached twice
+  ns::Resource duplicate = a_again;
+  duplicate.loader_id = 0;
+  duplicate.data = &resource_cache_test_data[1];
+  ns::resource_cache_insert(context.cache, "a", ns::ResourceType::TEXT, 100,
+                            &duplicate);
+  expect_true(duplicate.cache_id == INVALID_ID);
+
+  stats = ns::resource_cache_get_stats(context.cache);
+  expect(1u, stats.entry_count);
+  expect(2u, stats.hit_count);
+  expect(2u, stats.miss_count);
+  expect(0u, stats.eviction_count);
+  ns::resource_cache_destroy(&context.cache);
+  expect(1u, resource_cache_test_unloaded.size());
+  return true;
+}
+
+u8 resource_cache_should_evict_the_least_recently_released() {
+  resource_cache_test_context context;
+  resource_cache_test_begin(&context, 8, 300);
+  cstr names[5] = {"a", "b", "c", "d", "e"};
+  ns::Resource r[5];
+  for (u32 i = 0; i < 3; i++) {
+    resource_cache_test_load(context.cache, names[i], i,
+                             ns::ResourceType::TEXT, 100, &r[i]);
+  }
+  for (u32 i = 0; i < 3; i++) {
+    ns::resource_cache_release(context.cache, &r[i]);
+  }
+  // b is used again, so c is now older
+  expect_true(resource_cache_test_load(context.cache, "b", 1,
+                                       ns::ResourceType::TEXT, 100, &r[1]));
+  ns::resource_cache_release(context.cache, &r[1]);
+
+  resource_cache_test_load(context.cache, "d", 3, ns::ResourceType::TEXT,
+                           100, &r[3]);
+  expect(1u, resource_cache_test_unloaded.size());
+  expect_true(resource_cache_test_unloaded[0] == "a");
+  resource_cache_test_load(context.cache, "e", 4, ns::ResourceType::TEXT,
+                           100, &r[4]);
+  expect(2u, resource_cache_test_unloaded.size());
+  expect_true(resource_cache_test_unloaded[1] == "c");
+  expect(0, resource_cache_test_data[2]);
+  expect(2, resource_cache_test_data[1]);
+
+  // Referenced resources stay, over the budget
+  ns::Resource big;
+  resource_cache_test_load(context.cache, "big", 5, ns::ResourceType::TEXT,
+                           1000, &big);
+  expect(3u, resource_cache_test_unloaded.size());
+  ns::resource_cache_stats stats = ns::resource_cache_get_stats(context.cache);
+  expect(1200u, stats.size);
+  expect(3u, stats.eviction_count);
+  ns::resource_cache_release(context.cache, &r[3]);
+  ns::resource_cache_release(context.cache, &r[4]);
+  // Released over the budget: unloaded, the oldest first
+  expect(5u, resource_cache_test_unloaded.size());
+  ns::resource_cache_release(context.cache, &big);
+  expect(6u, resource_cache_test_unloaded.size());
+  expect(0u, ns::resource_cache_get_stats(context.cache).entry_count);
+  ns::resource_cache_destroy(&context.cache);
+  return true;
+}
+
+u8 resource_cache_should_keep_the_type_budgets() {
+  // The images have 150 bytes out of 1000
+  resource_cache_test_context context;
+  resource_cache_test_begin(&context, 8, 1000, 150);
+  ns::Resource r[4];
+  resource_cache_test_load(context.cache, "image_a", 0,
+                           ns::ResourceType::IMAGE, 100, &r[0]);
+  resource_cache_test_load(context.cache, "text", 1, ns::ResourceType::TEXT,
+                           400, &r[1]);
+  resource_cache_test_load(context.cache, "image_b", 2,
+                           ns::ResourceType::IMAGE, 100, &r[2]);
+  for (u32 i = 0; i < 3; i++) {
+    ns::resource_cache_release(context.cache, &r[i]);
+  }
+  expect(1u, resource_cache_test_unloaded.size());
+  expect_true(resource_cache_test_unloaded[0] == "image_a");
+  ns::resource_cache_stats stats = ns::resource_cache_get_stats(context.cache);
+  expect(100u, stats.type_sizes[static_cast<u32>(ns::ResourceType::IMAGE)]);
+  expect(400u, stats.type_sizes[static_cast<u32>(ns::ResourceType::TEXT)]);
+  ns::resource_cache_destroy(&context.cache);
+  return true;
+}
+
+u8 resource_cache_should_reuse_released_entries_when_full() {
+  resource_cache_test_context context;
+  resource_cache_test_begin(&context, 2, 1000);
+  ns::Resource r[3];
+  resource_cache_test_load(context.cache, "a", 0, ns::ResourceType::TEXT, 1,
+                           &r[0]);
+  resource_cache_test_load(context.cache, "b", 1, ns::ResourceType::TEXT, 1,
+                           &r[1]);
+  // Full of referenced resources: not cached
+  NS_DEBUG("Note: The following warning is intentionally caused by this "
+           "test.");
+  resource_cache_test_load(context.cache, "c", 2, ns::ResourceType::TEXT, 1,
+                           &r[2]);
+  expect(INVALID_ID, r[2].cache_id);
+  ns::resource_cache_release(context.cache, &r[0]);
+  resource_cache_test_load(context.cache, "c", 2, ns::ResourceType::TEXT, 1,
+                           &r[2]);
+  expect_true(r[2].cache_id != INVALID_ID);
+  expect(1u, resource_cache_test_unloaded.size());
+  // The table still finds b after the removal of a
+  expect_true(ns::resource_cache_acquire(context.cache, "b", 0, &r[0]));
+  ns::resource_cache_release(context.cache, &r[0]);
+  ns::resource_cache_release(context.cache, &r[1]);
+  ns::resource_cache_release(context.cache, &r[2]);
+  ns::resource_cache_destroy(&context.cache);
+  expect(3u, resource_cache_test_unloaded.size());
+  return true;
+}
+
+u8 resource_system_should_share_the_cached_resources() {
+  test_memory_start(64 * 1024 * 1024);
+  ns::resource_system_config config;
+  config.asset_base_path = NS_TEST_ASSET_PATH;
+  config.cache.max_entry_count = 16;
+  config.cache.budget = 64 * 1024 * 1024;
+  test_resource_system system;
+  test_resource_system_start(config, &system);
+
+  ns::Resource image;
+  bool loaded =
+      ns::resource_system_load("Brick_01", ns::ResourceType::IMAGE, &image);
+  u8 result = BYPASS;
+  if (loaded) {
+    ptr data = image.data;
+    ns::resource_system_unload(&image);
+    // Swapped back: no read, no allocation
+    u64 alloc_count = ns::get_memory_alloc_count();
+    expect_true(ns::resource_system_load("Brick_01", ns::ResourceType::IMAGE,
+                                         &image));
+    expect(alloc_count, ns::get_memory_alloc_count());
+    expect_true(image.data == data);
+    expect_true(ns::string_eq(image.name, "Brick_01"));
+    ns::resource_cache_stats stats =
+        ns::resource_cache_get_stats(ns::resource_system_resource_cache());
+    expect(1u, stats.hit_count);
+    // The struct and the pixels
+    expect_true(stats.size > 512u * 512u * 4u);
+    ns::resource_system_unload(&image);
+    result = true;
+  } else {
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+  }
+
+  test_resource_system_stop(&system);
+  ns::memory_system_shutdown();
+  return result;
+}
+
+void resource_cache_register_tests() {
+  test_manager_register_test(resource_cache_should_keep_the_released_resources,
+                             "Resource cache shares and keeps the resources");
+  test_manager_register_test(
+      resource_cache_should_evict_the_least_recently_released,
+      "Resource cache evicts the least recently released over its budget");
+  test_manager_register_test(resource_cache_should_keep_the_type_budgets,
+                             "Resource cache keeps the budgets of the types");
+  test_manager_register_test(
+      resource_cache_should_reuse_released_entries_when_full,
+      "Resource cache reuses the released entries when full");
+  test_manager_register_test(resource_system_should_share_the_cached_resources,
+                             "Resource system loads a released resource "
+                             "from its cache");
+}
@@ -0,0 +1,6 @@
+#ifndef RESOURCE_CACHE_TESTS_HEADER_INCLUDED
+#define RESOURCE_CACHE_TESTS_HEADER_INCLUDED
+
+void resource_cache_register_tests();
+
+#endif // RESOURCE_CACHE_TESTS_HEADER_INCLUDED
@@ -0,0 +1,33 @@
+#include "./test_resources.h"
+
+#include <core/memory.h>
+
+void test_memory_start(usize total_size) {
+  ns::memory_system_configuration memory_config;
+  memory_config.total_alloc_size = total_size;
+  ns::memory_system_initialize(memory_config);
+}
+
+bool test_resource_system_start(ns::resource_system_config const &config,
+                                test_resource_system *out_system) {
+  ns::resource_system_initialize(&out_system->requirement, nullptr, config);
+  out_system->state =
+      ns::alloc(out_system->requirement, ns::MemTag::APPLICATION);
+  if (!ns::resource_system_initialize(&out_system->requirement,
+                                      out_system->state, config)) {
+    ns::free(out_system->state, out_system->requirement,
+             ns::MemTag::APPLICATION);
+    out_system->state = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void test_resource_system_stop(test_resource_system *system) {
+  if (!system->state) {
+    return;
+  }
+  ns::resource_system_shutdown(system->state);
+  ns::free(system->state, system->requirement, ns::MemTag::APPLICATION);
+  system->state = nullptr;
+}
@@ -0,0 +1,41 @@
+#ifndef TEST_RESOURCES_HEADER_INCLUDED
+#define TEST_RESOURCES_HEADER_INCLUDED
+
+#include <defines.h>
+#include <systems/resource_system.h>
+
+// The tests are run from the build directory.
+#ifndef NS_TEST_ASSET_PATH
+#define NS_TEST_ASSET_PATH "../assets"
+#endif
+
+#define TEST_MEMORY_SIZE (16 * 1024 * 1024)
+
+struct test_resource_system {
+  usize requirement;
+  ptr state;
+};
+
+/**
+ * Starts the memory system, for a test allocating with ns::alloc. The test
+ * shuts it down with ns::memory_system_shutdown.
+ * @param total_size the size of the memory system
+ */
+void test_memory_start(usize total_size = TEST_MEMORY_SIZE);
+
+/**
+ * Starts a resource system, in the memory system
+ * @param config the configuration, the defaults but for what the test sets
+ * @param out_system the started resource system
+ * @returns false if it failed to start (e.g. a missing pack): there is then
+ *          nothing to stop
+ */
+bool test_resource_system_start(ns::resource_system_config const &config,
+                                test_resource_system *out_system);
+
+/**
+ * Shuts down a resource system started by test_resource_system_start
+ */
+void test_resource_system_stop(test_resource_system *system);
+
+#endif // TEST_RESOURCES_HEADER_INCLUDED
@@ -0,0 +1,185 @@
+#include "./texture_cache_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+#include "./test_resources.h"
+
+#include <core/memory.h>
+#include <resources/loaders/image_loader.h>
+#include <resources/mipmap.h>
+#include <resources/texture_cache.h>
+#include <systems/resource_system.h>
+
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Created in the working directory and removed by the tests
+#define TEXTURE_CACHE_TEST_ASSETS "texture_cache_test_assets"
+#define TEXTURE_CACHE_TEST_DIR "texture_cache_test"
+#define TEXTURE_CACHE_TEST_ENTRY_SIZE                                          \
+  (sizeof(ns::texture_cache_header) + ns::mip_chain_size(512, 512, 10))
+
+static void texture_cache_test_begin(test_resource_system *system,
+                                     u64 budget) {
+  ns::resource_system_config config;
+  config.asset_base_path = TEXTURE_CACHE_TEST_ASSETS;
+  config.texture_cache_path = TEXTURE_CACHE_TEST_DIR;
+  config.texture_cache_budget = budget;
+  test_resource_system_start(config, system);
+}
+
+// Copies an image of the assets in the test asset directory
+static bool texture_cache_test_copy(cstr image, cstr name) {
+  std::string source =
+      std::string(NS_TEST_ASSET_PATH "/textures/") + image + ".png";
+  std::error_code error;
+  if (!std::filesystem::exists(source, error)) {
+    return false;
+  }
+  std::filesystem::create_directories(TEXTURE_CACHE_TEST_ASSETS "/textures",
+                                      error);
+  std::filesystem::copy_file(
+      source,
+      std::string(TEXTURE_CACHE_TEST_ASSETS "/textures/") + name + ".png",
+      std::filesystem::copy_options::overwrite_existing, error);
+  return !error;
+}
+
+static void texture_cache_test_cleanup() {
+  std::error_code error;
+  std::filesystem::remove_all(TEXTURE_CACHE_TEST_ASSETS, error);
+  std::filesystem::remove_all(TEXTURE_CACHE_TEST_DIR, error);
+}
+
+static u32 texture_cache_test_file_count() {
+  u32 count = 0;
+  for (auto const &entry :
+       std::filesystem::directory_iterator(TEXTURE_CACHE_TEST_DIR)) {
+    count += entry.path().extension() == TEXTURE_CACHE_EXTENSION;
+  }
+  return count;
+}
+
+u8 texture_cache_should_skip_the_decoding() {
+  texture_cache_test_cleanup();
+  if (!texture_cache_test_copy("prototype", "a")) {
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    texture_cache_test_cleanup();
+    return BYPASS;
+  }
+  test_memory_start();
+  test_resource_system system;
+  texture_cache_test_begin(&system, 64 * 1024 * 1024);
+  ns::texture_cache cache = ns::resource_system_texture_cache();
+  expect_true(cache.memory != nullptr);
+
+  ns::ImageResourceData decoded;
+  expect_true(ns::image_loader_decode("a", &decoded));
+  expect_true(decoded.cached.data == nullptr);
+  std::vector<u8> pixels(decoded.pixels,
+                         decoded.pixels + decoded.width * decoded.height * 4);
+  ns::image_loader_free_pixels(&decoded);
+
+  ns::ImageResourceData cached;
+  expect_true(ns::image_loader_decode("a", &cached));
+  expect_true(cached.cached.data != nullptr);
+  expect(decoded.width, cached.width);
+  expect(decoded.height, cached.height);
+  expect(decoded.channel_count, cached.channel_count);
+  expect_true(memcmp(pixels.data(), cached.pixels, pixels.size()) == 0);
+  ns::image_loader_free_pixels(&cached);
+
+  // The image loader uses it too
+  ns::Resource resource;
+  expect_true(
+      ns::resource_system_load("a", ns::ResourceType::IMAGE, &resource));
+  auto image = reinterpret_cast<ns::ImageResourceData *>(resource.data);
+  expect_true(image->cached.data != nullptr);
+  expect_true(memcmp(pixels.data(), image->pixels, pixels.size()) == 0);
+  ns::resource_system_unload(&resource);
+
+  ns::texture_cache_stats stats = ns::texture_cache_get_stats(cache);
+  expect(2u, stats.hit_count);
+  expect(1u, stats.miss_count);
+  expect(1u, stats.store_count);
+  expect(static_cast<u64>(TEXTURE_CACHE_TEST_ENTRY_SIZE), stats.size);
+  test_resource_system_stop(&system);
+
+  // The next run starts warm
+  texture_cache_test_begin(&system, 64 * 1024 * 1024);
+  expect_true(ns::image_loader_decode("a", &cached));
+  expect_true(cached.cached.data != nullptr);
+  ns::image_loader_free_pixels(&cached);
+  test_resource_system_stop(&system);
+
+  ns::memory_system_shutdown();
+  texture_cache_test_cleanup();
+  return true;
+}
+
+u8 texture_cache_should_invalidate_and_evict() {
+  texture_cache_test_cleanup();
+  if (!texture_cache_test_copy("prototype", "a") ||
+      !texture_cache_test_copy("Brick_01", "b")) {
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    texture_cache_test_cleanup();
+    return BYPASS;
+  }
+  test_memory_start();
+  test_resource_system system;
+  texture_cache_test_begin(&system, TEXTURE_CACHE_TEST_ENTRY_SIZE * 3 / 2);
+  ns::texture_cache cache = ns::resource_system_texture_cache();
+
+  // A modified source is decoded again
+  ns::ImageResourceData image;
+  expect_true(ns::image_loader_decode("a", &image));
+  ns::image_loader_free_pixels(&image);
+  expect_true(texture_cache_test_copy("Brick_01", "a"));
+  expect_true(ns::image_loader_decode("a", &image));
+  expect_true(image.cached.data == nullptr);
+  ns::image_loader_free_pixels(&image);
+  expect_true(ns::image_loader_decode("a", &image));
+  expect_true(image.cached.data != nullptr);
+  ns::image_loader_free_pixels(&image);
+
+  // A damaged cache file is a miss
+  for (auto const &entry :
+       std::filesystem::directory_iterator(TEXTURE_CACHE_TEST_DIR)) {
+    std::filesystem::resize_file(entry.path(), 100);
+  }
+  expect_true(ns::image_loader_decode("a", &image));
+  expect_true(image.cached.data == nullptr);
+  ns::image_loader_free_pixels(&image);
+  expect(1u, texture_cache_test_file_count());
+
+  // Over the budget, the oldest file is deleted
+  expect_true(ns::image_loader_decode("b", &image));
+  ns::image_loader_free_pixels(&image);
+  expect(1u, texture_cache_test_file_count());
+  expect_true(ns::image_loader_decode("b", &image));
+  expect_true(image.cached.data != nullptr);
+  ns::image_loader_free_pixels(&image);
+  expect_true(ns::image_loader_decode("a", &image));
+  expect_true(image.cached.data == nullptr);
+  ns::image_loader_free_pixels(&image);
+
+  ns::texture_cache_stats stats = ns::texture_cache_get_stats(cache);
+  expect(2u, stats.hit_count);
+  expect(5u, stats.miss_count);
+  expect(2u, stats.eviction_count);
+  expect_true(stats.size <= TEXTURE_CACHE_TEST_ENTRY_SIZE * 3 / 2);
+  test_resource_system_stop(&system);
+
+  ns::memory_system_shutdown();
+  texture_cache_test_cleanup();
+  return true;
+}
+
+void texture_cache_register_tests() {
+  test_manager_register_test(texture_cache_should_skip_the_decoding,
+                             "Cached images are mapped instead of decoded");
+  test_manager_register_test(
+      texture_cache_should_invalidate_and_evict,
+      "Texture cache drops modified sources and stays in its budget");
+}
@@ -0,0 +1,74 @@
+#include "./geometry_tests.h"
+#include "../expect.h"
+#include "../test_manager.h"
+
+#include <core/memory.h>
+#include <systems/geometry_system.h>
+
+static void geometry_config_free(ns::geometry_config *config) {
+  ns::free(config->vertices, config->vertex_size * config->vertex_count,
+           ns::MemTag::ARRAY);
+  ns::free(config->indices, config->index_size * config->index_count,
+           ns::MemTag::ARRAY);
+}
+
+u8 geometry_index_size_should_fit_the_vertex_count() {
+  expect(ns::geometry_index_size(0), sizeof(u16));
+  expect(ns::geometry_index_size(4), sizeof(u16));
+  expect(ns::geometry_index_size(65535), sizeof(u16));
+  expect(ns::geometry_index_size(65536), sizeof(u32));
+  expect(ns::geometry_index_size(1000000), sizeof(u32));
+
+  u32 indices[5] = {0, 1, 255, 256, 65535};
+  u16 narrowed[5] = {};
+  ns::geometry_indices_to_u16(indices, 5, narrowed);
+  for (u32 i = 0; i < 5; i++) {
+    expect(narrowed[i], indices[i]);
+  }
+  return true;
+}
+
+u8 geometry_plane_should_emit_16_bit_indices() {
+  ns::geometry_config config = ns::geometry_config::plane(
+      10.0f, 5.0f, 3, 2, 1.0f, 1.0f, "test_plane", "test_material");
+  expect(config.vertex_count, 3u * 2u * 4u);
+  expect(config.index_count, 3u * 2u * 6u);
+  expect(config.index_size, sizeof(u16));
+
+  // Two triangles per quad, on the 4 vertices of the quad
+  u16 const *indices = reinterpret_cast<u16 const *>(config.indices);
+  u32 pattern[6] = {0, 1, 2, 0, 3, 1};
+  for (u32 quad = 0; quad < 3 * 2; quad++) {
+    for (u32 i = 0; i < 6; i++) {
+      expect(indices[quad * 6 + i], quad * 4 + pattern[i]);
+    }
+  }
+  geometry_config_free(&config);
+  return true;
+}
+
+u8 geometry_large_plane_should_emit_32_bit_indices() {
+  // 128 x 128 quads are 65536 vertices, one more than 16 bits address
+  ns::geometry_config config = ns::geometry_config::plane(
+      10.0f, 10.0f, 128, 128, 1.0f, 1.0f, "test_plane", "test_material");
+  expect(config.vertex_count, 65536u);
+  expect(config.index_size, sizeof(u32));
+
+  u32 const *indices = reinterpret_cast<u32 const *>(config.indices);
+  u32 last = config.index_count - 6;
+  expect(indices[last + 0], 65532u);
+  expect(indices[last + 1], 65533u);
+  expect(indices[last + 2], 65534u);
+  expect(indices[last + 4], 65535u);
+  geometry_config_free(&config);
+  return true;
+}
+
+void geometry_register_tests() {
+  test_manager_register_test(geometry_index_size_should_fit_the_vertex_count,
+                             "Index size is the smallest that fits");
+  test_manager_register_test(geometry_plane_should_emit_16_bit_indices,
+                             "Small planes have 16 bit indices");
+  test_manager_register_test(geometry_large_plane_should_emit_32_bit_indices,
+                             "Planes over 65535 vertices have 32 bit indices");
+}
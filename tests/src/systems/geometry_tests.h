@@ -0,0 +1,6 @@
+#ifndef GEOMETRY_TESTS_HEADER_INCLUDED
+#define GEOMETRY_TESTS_HEADER_INCLUDED
+
+void geometry_register_tests();
+
+#endif // GEOMETRY_TESTS_HEADER_INCLUDED
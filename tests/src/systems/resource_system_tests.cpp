@@ -0,0 +1,120 @@
+#include "./resource_system_tests.h"
+#include "../expect.h"
+#include "../resources/test_resources.h"
+#include "../test_manager.h"
+
+#include <core/memory.h>
+#include <core/string.h>
+#include <platform/filesystem.h>
+#include <systems/resource_system.h>
+
+struct test_asset {
+  cstr name;
+  ns::ResourceType type;
+};
+
+// Everything the testbed loads from disk.
+static const test_asset testbed_assets[] = {
+    {"test_material", ns::ResourceType::MATERIAL},
+    {"test_ui_material", ns::ResourceType::MATERIAL},
+    {"Brick_01", ns::ResourceType::IMAGE},
+    {"Brick_01_Nrm", ns::ResourceType::IMAGE},
+    {"Brick_02", ns::ResourceType::IMAGE},
+    {"Brick_02_Nrm", ns::ResourceType::IMAGE},
+    {"Brick_03", ns::ResourceType::IMAGE},
+    {"Brick_03_Nrm", ns::ResourceType::IMAGE},
+    {"Brick_04", ns::ResourceType::IMAGE},
+    {"Brick_04_Nrm", ns::ResourceType::IMAGE},
+    {"prototype", ns::ResourceType::IMAGE},
+    {"shaders/Builtin.MaterialShader.vert.glsl", ns::ResourceType::TEXT},
+    {"shaders/Builtin.MaterialShader.frag.glsl", ns::ResourceType::TEXT},
+    {"shaders/Builtin.UIShader.vert.glsl", ns::ResourceType::TEXT},
+    {"shaders/Builtin.UIShader.frag.glsl", ns::ResourceType::TEXT},
+};
+
+#define TESTBED_ASSET_COUNT (sizeof(testbed_assets) / sizeof(test_asset))
+
+u8 resource_load_should_only_allocate_the_resource_data() {
+  test_memory_start();
+  ns::resource_system_config config;
+  config.asset_base_path = NS_TEST_ASSET_PATH;
+  // The materials are text files, cooked on their first load
+  config.cook_materials = true;
+  test_resource_system system;
+  test_resource_system_start(config, &system);
+
+  ns::Resource resources[TESTBED_ASSET_COUNT];
+  u64 alloc_count = ns::get_memory_alloc_count();
+  u32 loaded = 0;
+  for (u32 i = 0; i < TESTBED_ASSET_COUNT; i++) {
+    if (!ns::resource_system_load(testbed_assets[i].name,
+                                  testbed_assets[i].type, &resources[i])) {
+      break;
+    }
+    loaded++;
+  }
+  u64 load_alloc_count = ns::get_memory_alloc_count() - alloc_count;
+
+  for (u32 i = 0; i < loaded; i++) {
+    ns::resource_system_unload(&resources[i]);
+  }
+  test_resource_system_stop(&system);
+  ns::memory_system_shutdown();
+
+  if (loaded == 0) {
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    return BYPASS;
+  }
+  expect(TESTBED_ASSET_COUNT, loaded);
+  // One block for the data of each resource: the paths and the parsed
+  // strings don't allocate, and the text files are mapped.
+  u64 read_count = 0;
+  for (test_asset const &asset : testbed_assets) {
+    read_count += asset.type != ns::ResourceType::TEXT;
+  }
+  expect(read_count, load_alloc_count);
+  expect_true(ns::string_length(resources[0].full_path) == 0);
+  return true;
+}
+
+u8 resource_load_should_map_text_files() {
+  test_memory_start();
+  ns::resource_system_config config;
+  config.asset_base_path = NS_TEST_ASSET_PATH;
+  test_resource_system system;
+  test_resource_system_start(config, &system);
+
+  cstr name = "shaders/Builtin.UIShader.vert.glsl";
+  ns::Resource resource;
+  bool loaded =
+      ns::resource_system_load(name, ns::ResourceType::TEXT, &resource);
+  bool mapped = loaded && resource.mapped.data == resource.data &&
+                resource.mapped.size == resource.data_size;
+  ns::fs::FileStat stat = {};
+  bool found = loaded && ns::fs::stat(resource.full_path, &stat);
+  u64 data_size = loaded ? resource.data_size : 0;
+  if (loaded) {
+    ns::resource_system_unload(&resource);
+  }
+  test_resource_system_stop(&system);
+  ns::memory_system_shutdown();
+
+  if (!loaded) {
+    NS_WARN("Assets not found in '%s', skipping.", NS_TEST_ASSET_PATH);
+    return BYPASS;
+  }
+  expect_true(mapped);
+  expect_true(found);
+  expect(stat.size, data_size);
+  expect_true(resource.mapped.data == nullptr);
+  expect_true(resource.data == nullptr);
+  return true;
+}
+
+void resource_system_register_tests() {
+  test_manager_register_test(
+      resource_load_should_only_allocate_the_resource_data,
+      "Loading the testbed assets only allocates the resource data");
+  test_manager_register_test(resource_load_should_map_text_files,
+                             "Text resources are mapped from the file");
+}
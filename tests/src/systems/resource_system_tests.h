@@ -0,0 +1,6 @@
+#ifndef RESOURCE_SYSTEM_TESTS_HEADER_INCLUDED
+#define RESOURCE_SYSTEM_TESTS_HEADER_INCLUDED
+
+void resource_system_register_tests();
+
+#endif // RESOURCE_SYSTEM_TESTS_HEADER_INCLUDED
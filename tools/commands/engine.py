@@ -67,6 +67,12 @@ def test(args):
     subprocess.run(["tests/tests"])
 
 
+def bench(args):
+    _compile_all()
+    os.chdir(NSENGINE_BUILD_PATH)
+    subprocess.run(["bench/bench"])
+
+
 def clean(args):
     if args.all:
         subprocess.run(["rm", "-rf", NSENGINE_BUILD_PATH])
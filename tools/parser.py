@@ -29,6 +29,9 @@ def _engine_parser(subparsers):
     test_parser = engine_subparsers.add_parser("test")
     test_parser.set_defaults(func=cmd_engine.test)
 
+    bench_parser = engine_subparsers.add_parser("bench")
+    bench_parser.set_defaults(func=cmd_engine.bench)
+
     clean_parser = engine_subparsers.add_parser("clean")
     clean_parser.set_defaults(func=cmd_engine.clean)
     clean_parser.add_argument(